@@ -0,0 +1 @@
+#include <../private/support/BrotliCompressionAlgorithm.h>
@@ -132,6 +132,8 @@ private:
 			status_t			_SetupServerAllocator();
 			status_t			_InitGUIContext();
 			status_t			_ConnectToServer();
+			status_t			_StartConnectToServer();
+			status_t			_FinishConnectToServer();
 			void				_ReconnectToServer();
 			bool				_QuitAllWindows(bool force);
 			bool				_WindowQuitLoop(bool quitFilePanels,
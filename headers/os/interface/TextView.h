@@ -35,11 +35,18 @@ enum undo_state {
 	B_UNDO_CUT,
 	B_UNDO_PASTE,
 	B_UNDO_CLEAR,
-	B_UNDO_DROP
+	B_UNDO_DROP,
+	B_UNDO_REPLACE
+};
+
+enum text_storage {
+	B_TEXT_STORAGE_GAP_BUFFER,
+	B_TEXT_STORAGE_ROPE
+		// better suited for large texts that are edited all over
 };
 
 namespace BPrivate {
-	class TextGapBuffer;
+	class TextBuffer;
 }
 
 
@@ -115,6 +122,13 @@ public:
 									char* buffer) const;
 			uint8				ByteAt(int32 offset) const;
 
+			int32				Find(const char* string, int32 fromOffset = 0,
+									bool caseSensitive = true,
+									bool backwards = false) const;
+			int32				ReplaceAll(const char* string,
+									const char* replacement,
+									bool caseSensitive = true);
+
 			int32				CountLines() const;
 			int32				CurrentLine() const;
 			void				GoToLine(int32 lineNumber);
@@ -212,6 +226,8 @@ public:
 			bool				DoesUndo() const;
 			void				HideTyping(bool enabled);
 			bool				IsTypingHidden() const;
+			void				SetTextStorage(text_storage storage);
+			text_storage		TextStorage() const;
 
 	virtual	void				ResizeToPreferred();
 	virtual	void				GetPreferredSize(float* _width, float* _height);
@@ -305,6 +321,9 @@ private:
 									int32 scrollTo = INT32_MIN);
 			void				_RecalculateLineBreaks(int32* startLine,
 									int32* endLine);
+			void				_LayoutPending(int32 offset, float y,
+									bigtime_t deadline);
+			void				_LayoutUpToLine(int32 line) const;
 			void				_ValidateTextRect();
 			int32				_FindLineBreak(int32 fromOffset,
 									float* _ascent, float* _descent,
@@ -432,7 +451,7 @@ private:
 			float				_UneditableTint() const;
 
 private:
-			BPrivate::TextGapBuffer*	fText;
+			BPrivate::TextBuffer*	fText;
 			LineBuffer*			fLines;
 			StyleBuffer*		fStyles;
 			BRect				fTextRect;
@@ -21,6 +21,7 @@ class BView;
 
 namespace BPrivate {
 	class PortLink;
+	struct InputLatencyHistogram;
 };
 
 
@@ -366,6 +367,7 @@ private:
 									float* _tabHeight) const;
 			void				_SendShowOrHideMessage();
 			void				_PropagateMessageToChildViews(BMessage*);
+			void				_AccountInputLatency(BMessage* message);
 
 private:
 			char*				fTitle;
@@ -406,8 +408,10 @@ private:
 			::BPrivate::PortLink* fLink;
 			BMessageRunner*		fPulseRunner;
 			BRect				fPreviousFrame;
+			::BPrivate::InputLatencyHistogram* fInputLatency;
+			bigtime_t			fInputLatencyReported;
 
-			uint32				_reserved[9];
+			uint32				_reserved[5];
 };
 
 
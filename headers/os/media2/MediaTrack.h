@@ -46,6 +46,11 @@ public:
 
 			status_t			ReadFrames(void* buffer, int64* outFrameCount,
 									media_header* mh = NULL);
+			status_t			BorrowFrames(const void** _buffer,
+									int64* _frameCount,
+									media_header* mh = NULL);
+			status_t			ReleaseFrames(int64 framesUsed = -1);
+			status_t			SetReadAhead(int32 bufferCount);
 
 			status_t			SeekToTime(bigtime_t* inOutTime, int32 flags = 0);
 			status_t			SeekToFrame(int64* inOutFrame, int32 flags = 0);
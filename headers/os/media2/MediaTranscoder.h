@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef _MEDIA2_MEDIA_TRANSCODER_H
+#define _MEDIA2_MEDIA_TRANSCODER_H
+
+
+#include <Entry.h>
+
+#include <media2/MediaDefs.h>
+
+
+// Called on a worker thread for every decoded buffer of a job; returning
+// false cancels the job.
+typedef bool (*media_transcode_hook)(void* cookie, int32 job,
+	const void* frames, int64 frameCount,
+	const media_raw_audio_format& format);
+
+
+struct media_transcode_statistics {
+	int32		jobs_done;
+	int32		jobs_failed;
+	int64		frames;
+	bigtime_t	media_time;		// decoded duration, summed over all jobs
+	bigtime_t	elapsed;		// since Start()
+};
+
+
+class BMediaTranscoder {
+public:
+								BMediaTranscoder(int32 workerCount = 0);
+	virtual						~BMediaTranscoder();
+
+			status_t			InitCheck() const;
+
+			int32				AddJob(const entry_ref& source,
+									const entry_ref* destination = NULL,
+									const media_file_format* fileFormat
+										= NULL,
+									media_transcode_hook hook = NULL,
+									void* cookie = NULL);
+
+			status_t			Start();
+			status_t			Wait(bigtime_t timeout = B_INFINITE_TIMEOUT);
+			void				Cancel();
+
+			int32				CountJobs() const;
+			status_t			JobStatus(int32 job) const;
+			int64				JobFrames(int32 job) const;
+
+			void				GetStatistics(
+									media_transcode_statistics* stats) const;
+
+private:
+								BMediaTranscoder(const BMediaTranscoder&)
+									= delete;
+			BMediaTranscoder&	operator=(const BMediaTranscoder&) = delete;
+
+			class Impl;
+			Impl*				fImpl;
+};
+
+
+#endif
@@ -43,5 +43,17 @@ struct translator_info {
 	char			MIME[251];
 };
 
+// Translator add-ons may export an array of these as "inputSignatures",
+// terminated by an entry with a NULL MIME type. A stream can only be in one
+// of the input formats if it matches one of the format's signatures; the
+// roster uses this to skip translators that cannot identify a stream.
+struct translation_signature {
+	const char*		MIME;			// MIME type of the input format
+	uint32			offset;			// of the signature in the stream
+	uint32			length;			// of bytes and mask
+	const char*		bytes;
+	const char*		mask;			// NULL to compare all bits
+};
+
 
 #endif	// _TRANSLATION_DEFS_H
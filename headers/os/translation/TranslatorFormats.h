@@ -19,6 +19,8 @@ extern char B_TRANSLATOR_EXT_FRAME[];
 extern char B_TRANSLATOR_EXT_BITMAP_RECT[];
 extern char B_TRANSLATOR_EXT_BITMAP_COLOR_SPACE[];
 extern char B_TRANSLATOR_EXT_BITMAP_PALETTE[];
+extern char B_TRANSLATOR_EXT_BITMAP_TARGET_SIZE[];
+extern char B_TRANSLATOR_EXT_BITMAP_SOURCE_SIZE[];
 extern char B_TRANSLATOR_EXT_SOUND_CHANNEL[];
 extern char B_TRANSLATOR_EXT_SOUND_MONO[];
 extern char B_TRANSLATOR_EXT_SOUND_MARKER[];
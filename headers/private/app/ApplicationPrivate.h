@@ -11,6 +11,7 @@
 
 #include <Application.h>
 
+struct AppBootstrapInfo;
 struct server_read_only_memory;
 
 
@@ -24,6 +25,8 @@ class BApplication::Private {
 		
 		static inline server_read_only_memory* ServerReadOnlyMemory()
 			{ return (server_read_only_memory*)be_app->fServerReadOnlyMemory; }
+
+		static const AppBootstrapInfo* BootstrapInfo();
 };
 
 #endif	// _APPLICATION_PRIVATE_H
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _INPUT_LATENCY_H
+#define _INPUT_LATENCY_H
+
+
+#include <OS.h>
+
+
+// The stages of an input event's way from the kernel to the window that
+// are measured. All of them are measured from the time the kernel stamped
+// the event with (its "when" field).
+enum input_latency_stage {
+	B_INPUT_LATENCY_QUEUED = 0,
+		// the app_server's event dispatcher took the event from its queue
+	B_INPUT_LATENCY_SENT,
+		// the event has been written to the window's port
+	B_INPUT_LATENCY_DISPATCHED,
+		// the window's message loop is about to dispatch the event
+
+	B_INPUT_LATENCY_STAGE_COUNT
+};
+
+
+namespace BPrivate {
+
+
+// A histogram of latencies with logarithmic buckets: bucket i counts the
+// latencies below 2^i microseconds (and at least 2^(i - 1)), the last one
+// everything larger. It's a plain struct so that it can be attached to
+// link messages as is.
+struct InputLatencyHistogram {
+	static const int32	kBucketCount = 24;
+
+	int64				count;
+	bigtime_t			total;
+	bigtime_t			max;
+	uint32				buckets[kBucketCount];
+
+	void Reset()
+	{
+		count = 0;
+		total = 0;
+		max = 0;
+		for (int32 i = 0; i < kBucketCount; i++)
+			buckets[i] = 0;
+	}
+
+	void Add(bigtime_t latency)
+	{
+		if (latency < 0)
+			latency = 0;
+
+		count++;
+		total += latency;
+		if (latency > max)
+			max = latency;
+		buckets[BucketFor(latency)]++;
+	}
+
+	void Merge(const InputLatencyHistogram& other)
+	{
+		count += other.count;
+		total += other.total;
+		if (other.max > max)
+			max = other.max;
+		for (int32 i = 0; i < kBucketCount; i++)
+			buckets[i] += other.buckets[i];
+	}
+
+	bigtime_t Average() const
+	{
+		return count > 0 ? total / count : 0;
+	}
+
+	//! Returns the upper bound of the bucket the given percentile falls in.
+	bigtime_t Percentile(int32 percent) const
+	{
+		int64 wanted = (count * percent + 99) / 100;
+		int64 seen = 0;
+		for (int32 i = 0; i < kBucketCount; i++) {
+			seen += buckets[i];
+			if (seen >= wanted && seen > 0)
+				return i < kBucketCount - 1 ? (bigtime_t)1 << i : max;
+		}
+		return max;
+	}
+
+	static int32 BucketFor(bigtime_t latency)
+	{
+		int32 bucket = 0;
+		while (bucket < kBucketCount - 1 && latency >= (bigtime_t)1 << bucket)
+			bucket++;
+		return bucket;
+	}
+};
+
+
+}	// namespace BPrivate
+
+
+using BPrivate::InputLatencyHistogram;
+
+
+#endif	// _INPUT_LATENCY_H
@@ -95,6 +95,7 @@ enum {
 	B_REG_UNREGISTER_MESSAGE_RUNNER			= 'rgru',
 	B_REG_SET_MESSAGE_RUNNER_PARAMS			= 'rgrx',
 	B_REG_GET_MESSAGE_RUNNER_INFO			= 'rgri',
+	B_REG_GET_MESSAGE_RUNNER_LIST			= 'rgrl',
 
 	// internal registrar messages
 	B_REG_SHUTDOWN_FINISHED					= 'rgsf',
@@ -24,7 +24,7 @@
 #	define SERVER_INPUT_PORT "haiku-test:input port"
 #endif
 
-#define AS_PROTOCOL_VERSION	1
+#define AS_PROTOCOL_VERSION	2
 
 #define AS_REQUEST_COLOR_KEY 0x00010000
 	// additional option for AS_VIEW_SET_VIEW_BITMAP
@@ -369,6 +369,10 @@ enum {
 	AS_VIEW_CLIP_TO_RECT,
 	AS_VIEW_CLIP_TO_SHAPE,
 
+	// input latency tracing
+	AS_REPORT_INPUT_LATENCY,
+	AS_GET_INPUT_LATENCY,
+
 	AS_LAST_CODE
 };
 
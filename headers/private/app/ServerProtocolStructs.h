@@ -10,7 +10,9 @@
 
 
 #include <AffineTransform.h>
+#include <Menu.h>
 #include <Rect.h>
+#include <StorageDefs.h>
 
 
 struct ViewSetStateInfo {
@@ -72,6 +74,27 @@ struct ViewBeginRectTrackingInfo {
 };
 
 
+struct AppBootstrapFontInfo {
+	uint16						familyID;
+	uint16						styleID;
+	float						size;
+	uint16						face;
+	uint32						flags;
+};
+
+
+// The initial interface kit state, sent along with the reply to
+// AS_CREATE_APP
+struct AppBootstrapInfo {
+	char						controlLook[B_PATH_NAME_LENGTH];
+	AppBootstrapFontInfo		plainFont;
+	AppBootstrapFontInfo		boldFont;
+	AppBootstrapFontInfo		fixedFont;
+	menu_info					menuInfo;
+	int32						workspace;
+};
+
+
 struct ViewSetLineModeInfo {
 	join_mode					lineJoin;
 	cap_mode					lineCap;
@@ -18,7 +18,7 @@ class BFont;
 namespace BPrivate {
 
 
-class TextGapBuffer;
+class TextBuffer;
 
 
 struct _width_table_ {
@@ -37,7 +37,7 @@ public:
 			float				StringWidth(const char* inText,
 									int32 fromOffset, int32 length,
 									const BFont* inStyle);
-			float				StringWidth(TextGapBuffer& gapBuffer,
+			float				StringWidth(TextBuffer& buffer,
 									int32 fromOffset, int32 length,
 									const BFont* inStyle);
 
@@ -7,9 +7,11 @@
 #define _B_HTTP_SESSION_H_
 
 #include <memory>
+#include <vector>
 
 #include <ExclusiveBorrow.h>
 #include <Messenger.h>
+#include <String.h>
 
 class BUrl;
 
@@ -22,6 +24,24 @@ class BHttpRequest;
 class BHttpResult;
 
 
+struct BHttpHostStatistics {
+			BString				host;
+			int					port = 0;
+			bool				secure = false;
+
+			uint32				requests = 0;
+			uint32				connectionsOpened = 0;
+			uint32				connectionsReused = 0;
+			uint32				requestsPipelined = 0;
+			bigtime_t			handshakeTime = 0;
+				// total time spent connecting, including the TLS handshake
+
+	// Helpers
+			float				ReuseRate() const noexcept;
+			bigtime_t			AverageHandshakeTime() const noexcept;
+};
+
+
 class BHttpSession
 {
 public:
@@ -45,6 +65,14 @@ public:
 			void				SetMaxConnectionsPerHost(size_t maxConnections);
 			void				SetMaxHosts(size_t maxConnections);
 
+	// Persistent connections
+			void				SetMaxIdleConnectionsPerHost(size_t maxConnections);
+			void				SetIdleTimeout(bigtime_t timeout);
+			void				SetPipelining(bool enabled, size_t maxDepth = 4);
+
+	// Statistics
+			std::vector<BHttpHostStatistics> HostStatistics() const;
+
 private:
 	struct Redirect;
 	class Request;
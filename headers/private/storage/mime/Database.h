@@ -19,6 +19,7 @@
 #include <StorageDefs.h>
 
 #include <mime/AssociatedTypes.h>
+#include <mime/DatabaseSnapshot.h>
 #include <mime/InstalledTypes.h>
 #include <mime/SnifferRules.h>
 #include <mime/SupportingApps.h>
@@ -121,6 +122,9 @@ class Database {
 		void	DeferInstallNotification(const char* type);
 		void	UndeferInstallNotification(const char* type);
 
+		// Snapshot
+		status_t WriteSnapshot(const char *path);
+
 	private:
 		struct DeferredInstallNotification {
 			char	type[B_MIME_TYPE_LENGTH];
@@ -144,6 +148,9 @@ class Database {
 					int32 action);
 		status_t _SendMonitorUpdate(BMessage &msg);
 
+		status_t _GetSnapshotTypeInfo(const char *type,
+					DatabaseSnapshot::TypeInfo &info);
+
 		DeferredInstallNotification* _FindDeferredInstallNotification(
 			const char* type, bool remove = false);
 		bool _CheckDeferredInstallNotification(int32 which, const char* type);
@@ -191,6 +198,7 @@ public:
 
 	virtual	status_t			Notify(BMessage* message,
 									const BMessenger& target) = 0;
+	virtual	void				DatabaseChanged();
 };
 
 
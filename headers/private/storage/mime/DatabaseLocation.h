@@ -34,6 +34,8 @@ public:
 
 			BString				WritablePathForType(const char* type) const
 									{ return _TypeToFilename(type, 0); }
+			status_t			GetPathForType(const char* type,
+									BString& _path) const;
 
 			// opening type nodes
 
@@ -87,6 +89,12 @@ public:
 			status_t			GetIconForType(const char* type,
 									const char* fileType, uint8*& _data,
 									size_t& _size);
+	static	status_t			GetIconForType(BNode& typeNode,
+									const char* fileType, BBitmap& _icon,
+									icon_size which);
+	static	status_t			GetIconForType(BNode& typeNode,
+									const char* fileType, uint8*& _data,
+									size_t& _size);
 			status_t			GetPreferredApp(const char* type,
 									char* signature, app_verb verb);
 			status_t			GetSnifferRule(const char* type,
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _MIME_DATABASE_SNAPSHOT_H
+#define _MIME_DATABASE_SNAPSHOT_H
+
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <Locker.h>
+#include <String.h>
+
+
+class BMessage;
+
+
+namespace BPrivate {
+namespace Storage {
+namespace Mime {
+
+
+class DatabaseLocation;
+
+
+/*!	Read-only, memory mapped image of the MIME database.
+
+	The registrar writes the snapshot whenever the database settles after a
+	change (see Database::WriteSnapshot()) and removes it as soon as the
+	database is modified through it. Clients use it to answer the common
+	queries without a registrar round trip or attribute reads, and fall back
+	to the regular path whenever it is not available.
+
+	Types can also change behind the registrar's back, e.g. when a package
+	is activated or an attribute is written directly. Therefore the per type
+	lookups only use an entry, if the type's file hasn't changed since the
+	snapshot was written.
+*/
+class DatabaseSnapshot {
+public:
+			struct TypeInfo {
+				std::string					name;
+				bool						installed;
+				std::string					shortDescription;
+				std::string					preferredApp;
+				std::string					snifferRule;
+				std::string					path;
+				int64						changeTime;
+				std::vector<std::string>	extensions;
+				std::vector<std::string>	supportingApps;
+
+				TypeInfo() : installed(false), changeTime(0) {}
+			};
+			// keyed by the lower case type
+			typedef std::map<std::string, TypeInfo> TypeMap;
+
+public:
+								DatabaseSnapshot(const char* path,
+									const DatabaseLocation* location);
+								~DatabaseSnapshot();
+
+	static	status_t			Write(const char* path,
+									const TypeMap& types);
+	static	BString				DefaultPath(
+									const DatabaseLocation* location);
+	static	status_t			GetChangeTime(const char* path,
+									int64& _changeTime);
+
+			status_t			GetInstalledTypes(const char* supertype,
+									BMessage* types);
+			status_t			GetInstalledSupertypes(BMessage* types);
+			status_t			GetSupportingApps(const char* type,
+									BMessage* signatures);
+
+			status_t			GetShortDescription(const char* type,
+									char* description);
+			status_t			GetPreferredApp(const char* type,
+									char* signature);
+			status_t			GetFileExtensions(const char* type,
+									BMessage* extensions);
+			status_t			GetSnifferRule(const char* type,
+									BString& rule);
+			status_t			GetIconLocation(const char* type,
+									BString& path);
+
+private:
+			struct Header;
+			struct TypeEntry;
+
+			status_t			_Update();
+			void				_Unset();
+
+			uint32				_LowerBound(const char* key) const;
+			const TypeEntry*	_FindType(const char* type) const;
+			const TypeEntry*	_FindCurrentType(const char* type) const;
+			bool				_IsCurrent(const TypeEntry* entry) const;
+			const char*			_StringAt(uint32 offset) const;
+			status_t			_AddStrings(BMessage* message,
+									const char* field, uint32 list,
+									uint32 count) const;
+
+private:
+			BLocker				fLock;
+			BString				fPath;
+			const DatabaseLocation*	fLocation;
+			void*				fData;
+			size_t				fSize;
+			dev_t				fDevice;
+			ino_t				fNode;
+			const Header*		fHeader;
+			const TypeEntry*	fTypes;
+			const uint32*		fLists;
+			const char*			fStrings;
+};
+
+
+DatabaseSnapshot* default_database_snapshot();
+
+
+} // namespace Mime
+} // namespace Storage
+} // namespace BPrivate
+
+
+#endif	// _MIME_DATABASE_SNAPSHOT_H
@@ -8,8 +8,11 @@
 
 #include <SupportDefs.h>
 
+#include <sniffer/RuleIndex.h>
+
 #include <list>
 #include <string>
+#include <vector>
 
 class BFile;
 class BString;
@@ -57,14 +60,18 @@ private:
 		BString *type);
 	ssize_t MaxBytesNeeded();
 	status_t ProcessType(const char *type, ssize_t *bytesNeeded);
+	void BuildRuleIndex();
 
 	std::list<sniffer_rule> fRuleList;
+	std::vector<const sniffer_rule*> fIndexedRules;
+	BPrivate::Storage::Sniffer::RuleIndex fRuleIndex;
 
 private:
 	DatabaseLocation*	fDatabaseLocation;
 	MimeSniffer*		fMimeSniffer;
 	ssize_t				fMaxBytesNeeded;
 	bool				fHaveDoneFullBuild;
+	bool				fRuleIndexValid;
 };
 
 } // namespace Mime
@@ -32,6 +32,8 @@ public:
 	~SupportingApps();
 
 	status_t GetSupportingApps(const char *type, BMessage *apps);	
+	status_t GetAllSupportingApps(
+		std::map<std::string, std::set<std::string> > &apps);
 
 	status_t SetSupportedTypes(const char *app, const BMessage *types, bool fullSync);
 	status_t DeleteSupportedTypes(const char *app, bool fullSync);
@@ -9,7 +9,10 @@
 #ifndef _SNIFFER_DISJ_LIST_H
 #define _SNIFFER_DISJ_LIST_H
 
+#include <SupportDefs.h>
+
 #include <sys/types.h>
+#include <vector>
 
 class BPositionIO;
 
@@ -17,6 +20,18 @@ namespace BPrivate {
 namespace Storage {
 namespace Sniffer {
 
+/*! \brief A byte that must be present at a fixed offset of the data stream
+	for a pattern to possibly match. Used to build the RuleIndex.
+*/
+struct Anchor {
+	int32	offset;
+	uint8	byte;
+
+	Anchor(int32 offset, uint8 byte) : offset(offset), byte(byte) {}
+};
+
+typedef std::vector<Anchor> AnchorList;
+
 //! Abstract class defining methods acting on a list of ORed patterns
 class DisjList {
 public:
@@ -25,6 +40,7 @@ public:
 
 	virtual bool Sniff(BPositionIO *data) const = 0;
 	virtual ssize_t BytesNeeded() const = 0;
+	virtual bool GetAnchors(AnchorList& anchors) const;
 	
 	void SetCaseInsensitive(bool how);
 	bool IsCaseInsensitive();
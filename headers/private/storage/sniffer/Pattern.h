@@ -11,6 +11,7 @@
 
 #include <SupportDefs.h>
 #include <string>
+#include <sniffer/DisjList.h>
 #include <sniffer/Range.h>
 
 class BPositionIO;
@@ -34,6 +35,8 @@ public:
 	
 	bool Sniff(Range range, BPositionIO *data, bool caseInsensitive) const;
 	ssize_t BytesNeeded() const;
+	bool GetAnchors(int32 offset, bool caseInsensitive,
+		AnchorList& anchors) const;
 	
 	status_t SetTo(const std::string &string, const std::string &mask);
 private:
@@ -35,6 +35,7 @@ public:
 	
 	virtual bool Sniff(BPositionIO *data) const;
 	virtual ssize_t BytesNeeded() const;
+	virtual bool GetAnchors(AnchorList& anchors) const;
 	
 	void Add(Pattern *pattern);
 private:
@@ -9,6 +9,7 @@
 #ifndef _SNIFFER_R_PATTERN_H
 #define _SNIFFER_R_PATTERN_H
 
+#include <sniffer/DisjList.h>
 #include <sniffer/Range.h>
 
 class BPositionIO;
@@ -31,6 +32,7 @@ public:
 	
 	bool Sniff(BPositionIO *data, bool caseInsensitive) const;
 	ssize_t BytesNeeded() const;
+	bool GetAnchors(bool caseInsensitive, AnchorList& anchors) const;
 private:
 	Range fRange;
 	Pattern *fPattern;
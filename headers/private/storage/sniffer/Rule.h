@@ -10,6 +10,7 @@
 #define _SNIFFER_RULE_H
 
 #include <SupportDefs.h>
+#include <sniffer/DisjList.h>
 
 #include <sys/types.h>
 #include <vector>
@@ -34,6 +35,7 @@ public:
 	double Priority() const;	
 	bool Sniff(BPositionIO *data) const;	
 	ssize_t BytesNeeded() const;
+	bool GetAnchors(AnchorList& anchors) const;
 private:
 	friend class Parser;
 
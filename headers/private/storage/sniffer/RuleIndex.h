@@ -0,0 +1,67 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _SNIFFER_RULE_INDEX_H
+#define _SNIFFER_RULE_INDEX_H
+
+
+#include <SupportDefs.h>
+
+#include <vector>
+
+
+namespace BPrivate {
+namespace Storage {
+namespace Sniffer {
+
+
+class Rule;
+
+
+/*!	Compiled form of a set of sniffer rules.
+
+	Each rule is reduced to the bytes at fixed offsets one of which must be
+	present for it to possibly match (see Rule::GetAnchors()). Those are
+	indexed by offset and byte value, so a single pass over the indexed
+	offsets of a buffer yields the rules worth running. Rules that can't be
+	anchored (e.g. only ranged patterns) are kept in a residual list and are
+	always candidates.
+
+	Rules are identified by the slot they were added at; callers add them in
+	priority order and resolve the candidates in that order.
+*/
+class RuleIndex {
+public:
+								RuleIndex();
+								~RuleIndex();
+
+			void				MakeEmpty();
+			int32				Add(const Rule* rule);
+
+			int32				CountRules() const
+									{ return fRuleCount; }
+			int32				CountResidualRules() const
+									{ return fResidual.size(); }
+
+			void				GetCandidates(const void* buffer,
+									size_t length,
+									std::vector<bool>& candidates) const;
+
+private:
+			struct OffsetBuckets;
+
+			OffsetBuckets*		_BucketsFor(int32 offset);
+
+			std::vector<OffsetBuckets*> fOffsets;
+			std::vector<int32>	fResidual;
+			int32				fRuleCount;
+};
+
+
+};	// namespace Sniffer
+};	// namespace Storage
+};	// namespace BPrivate
+
+
+#endif	// _SNIFFER_RULE_INDEX_H
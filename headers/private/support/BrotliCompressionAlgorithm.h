@@ -0,0 +1,48 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _BROTLI_COMPRESSION_ALGORITHM_H_
+#define _BROTLI_COMPRESSION_ALGORITHM_H_
+
+
+#include <CompressionAlgorithm.h>
+
+
+class BBrotliDecompressionParameters : public BDecompressionParameters {
+public:
+								BBrotliDecompressionParameters();
+	virtual						~BBrotliDecompressionParameters();
+
+			size_t				BufferSize() const;
+			void				SetBufferSize(size_t size);
+
+private:
+			size_t				fBufferSize;
+};
+
+
+// Only decompression is supported.
+class BBrotliCompressionAlgorithm : public BCompressionAlgorithm {
+public:
+								BBrotliCompressionAlgorithm();
+	virtual						~BBrotliCompressionAlgorithm();
+
+	virtual	status_t			CreateDecompressingInputStream(BDataIO* input,
+									const BDecompressionParameters* parameters,
+									BDataIO*& _stream);
+	virtual	status_t			CreateDecompressingOutputStream(BDataIO* output,
+									const BDecompressionParameters* parameters,
+									BDataIO*& _stream);
+
+	virtual	status_t			DecompressBuffer(const iovec& input, iovec& output,
+									const BDecompressionParameters* parameters = NULL,
+									iovec* scratch = NULL);
+
+private:
+			template<typename BaseClass> struct Stream;
+			template<typename BaseClass> friend struct Stream;
+};
+
+
+#endif	// _BROTLI_COMPRESSION_ALGORITHM_H_
@@ -9,6 +9,7 @@
 
 #include "AVIFTranslator.h"
 
+#include <AutoDeleter.h>
 #include <BufferIO.h>
 #include <Catalog.h>
 #include <Messenger.h>
@@ -482,6 +483,29 @@ AVIFTranslator::_TranslateFromAVIF(BPositionIO* stream, BMessage* ioExtension,
 		rowBytes = image->yuvRowBytes[0];
 	}
 
+	// libavif cannot decode at a reduced resolution, but if the caller
+	// only needs a smaller bitmap, at least hand out a smaller one
+	uint8* reducedPixels = NULL;
+	int32 reduction = reduction_factor(ioExtension, width, height, 16);
+	if (reduction > 1) {
+		int32 bytesPerPixel = colors == B_RGBA32 ? 4
+			: colors == B_RGB24 ? 3 : 1;
+		int32 reducedWidth = (width + reduction - 1) / reduction;
+		int32 reducedHeight = (height + reduction - 1) / reduction;
+		uint32 reducedRowBytes = reducedWidth * bytesPerPixel;
+		reducedPixels = (uint8*)malloc(reducedRowBytes * reducedHeight);
+		if (reducedPixels != NULL) {
+			reduce_bits(pixels, width, height, rowBytes, bytesPerPixel,
+				reduction, reducedPixels, reducedRowBytes);
+			set_source_size(ioExtension, width, height);
+			pixels = reducedPixels;
+			rowBytes = reducedRowBytes;
+			width = reducedWidth;
+			height = reducedHeight;
+		}
+	}
+	MemoryDeleter reducedPixelsDeleter(reducedPixels);
+
 	uint32 dataSize = rowBytes * height;
 
 	TranslatorBitmap bitmapHeader;
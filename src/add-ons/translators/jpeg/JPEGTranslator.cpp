@@ -1131,9 +1131,6 @@ JPEGTranslator::Decompress(BPositionIO* in, BPositionIO* out,
 		}
 	}
 
-	// Initialize decompression
-	jpeg_start_decompress(&cinfo);
-
 	// retrieve orientation from settings/EXIF
 	int32 orientation;
 	if (ioExtension == NULL
@@ -1142,6 +1139,21 @@ JPEGTranslator::Decompress(BPositionIO* in, BPositionIO* out,
 			orientation = 1;
 	}
 
+	// If the caller only needs a smaller bitmap, let libjpeg scale in the
+	// DCT domain, which skips most of the decoding work.
+	int32 imageWidth = orientation > 4 ? cinfo.image_height : cinfo.image_width;
+	int32 imageHeight = orientation > 4 ? cinfo.image_width : cinfo.image_height;
+	int32 reduction = reduction_factor(ioExtension, imageWidth, imageHeight, 8);
+	if (reduction > 1) {
+		cinfo.scale_num = 1;
+		cinfo.scale_denom = reduction;
+		cinfo.dct_method = JDCT_IFAST;
+		set_source_size(ioExtension, imageWidth, imageHeight);
+	}
+
+	// Initialize decompression
+	jpeg_start_decompress(&cinfo);
+
 	if (orientation != 1 && converter == NULL)
 		converter = translate_8;
 
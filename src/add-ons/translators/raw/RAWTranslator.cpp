@@ -21,6 +21,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
+
 #undef B_TRANSLATION_CONTEXT
 #define B_TRANSLATION_CONTEXT "RAWTranslator"
 
@@ -196,6 +198,64 @@ RAWTranslator::_ProgressMonitor(const char* message, float percentage,
 }
 
 
+#ifdef USES_LIBRAW
+typedef LibRAW RawDecoder;
+#else
+typedef DCRaw RawDecoder;
+#endif
+
+
+/*!	If the caller only needs a reduced size bitmap, returns the index of the
+	smallest embedded preview that still covers that size, so that it can be
+	decoded instead of the raw data. If there is none, the raw data is
+	decoded at half size if that suffices.
+*/
+static int32
+image_index_for_target_size(RawDecoder& raw, BMessage* settings)
+{
+	int32 targetWidth;
+	int32 targetHeight;
+	if (!get_target_size(settings, targetWidth, targetHeight))
+		return 0;
+
+	image_meta_info meta;
+	raw.GetMetaInfo(meta);
+	if (meta.flip > 4)
+		std::swap(targetWidth, targetHeight);
+
+	image_data_info data;
+	if (raw.ImageAt(0, data) != B_OK)
+		return 0;
+
+	int32 width = data.width;
+	int32 height = data.height;
+	if (meta.flip > 4)
+		set_source_size(settings, height, width);
+	else
+		set_source_size(settings, width, height);
+
+	int32 bestIndex = 0;
+	uint64 bestPixels = 0;
+	for (uint32 i = 1; i < raw.CountImages(); i++) {
+		if (raw.ImageAt(i, data) != B_OK || data.is_raw
+			|| ((int32)data.width < min_c(targetWidth, width)
+				&& (int32)data.height < min_c(targetHeight, height)))
+			continue;
+
+		uint64 pixels = (uint64)data.width * data.height;
+		if (bestIndex == 0 || pixels < bestPixels) {
+			bestIndex = i;
+			bestPixels = pixels;
+		}
+	}
+
+	if (bestIndex == 0 && reduction_factor(settings, width, height, 2) == 2)
+		raw.SetHalfSize(true);
+
+	return bestIndex;
+}
+
+
 status_t
 RAWTranslator::DerivedTranslate(BPositionIO* stream,
 	const translator_info* info, BMessage* settings,
@@ -207,11 +267,7 @@ RAWTranslator::DerivedTranslate(BPositionIO* stream,
 		return B_NO_TRANSLATOR;
 
 	BBufferIO io(stream, 1024 * 1024, false);
-#ifdef USES_LIBRAW
-	LibRAW raw(io);
-#else
-	DCRaw raw(io);
-#endif
+	RawDecoder raw(io);
 
 	bool headerOnly = false;
 
@@ -252,6 +308,8 @@ RAWTranslator::DerivedTranslate(BPositionIO* stream,
 			if (imageIndex < 0 || imageIndex >= (int32)raw.CountImages())
 				status = B_BAD_VALUE;
 		}
+		if (status == B_OK && imageIndex == 0)
+			imageIndex = image_index_for_target_size(raw, settings);
 		if (status == B_OK && !headerOnly)
 			status = raw.ReadImageAt(imageIndex, buffer, bufferSize);
 	} catch (status_t error) {
@@ -39,6 +39,8 @@
 
 #include <Catalog.h>
 #include <Locale.h>
+#include <Message.h>
+#include <Size.h>
 
 
 #undef B_TRANSLATION_CONTEXT
@@ -739,3 +741,92 @@ translate_direct_copy(BPositionIO *inSource, BPositionIO *outDestination)
 		ret = inSource->Read(buffer, kbufsize);
 	}
 }
+
+
+bool
+get_target_size(BMessage *ioExtension, int32 &width, int32 &height)
+{
+	BSize target;
+	if (ioExtension == NULL
+		|| ioExtension->FindSize(B_TRANSLATOR_EXT_BITMAP_TARGET_SIZE,
+			&target) != B_OK
+		|| !target.IsWidthSet() || !target.IsHeightSet())
+		return false;
+
+	width = (int32)target.width + 1;
+	height = (int32)target.height + 1;
+	return width > 0 && height > 0;
+}
+
+
+int32
+reduction_factor(BMessage *ioExtension, int32 width, int32 height,
+	int32 maxFactor)
+{
+	int32 targetWidth;
+	int32 targetHeight;
+	if (!get_target_size(ioExtension, targetWidth, targetHeight))
+		return 1;
+
+	// The caller fits the image into the target size, so the image only
+	// has to keep that resolution along its limiting dimension.
+	int32 factor = 1;
+	while (factor * 2 <= maxFactor
+		&& (width >= factor * 2 * targetWidth
+			|| height >= factor * 2 * targetHeight))
+		factor *= 2;
+
+	return factor;
+}
+
+
+void
+set_source_size(BMessage *ioExtension, int32 width, int32 height)
+{
+	// A translator handing an embedded preview on to another translator
+	// has already reported the size of the actual image.
+	if (ioExtension == NULL
+		|| ioExtension->HasSize(B_TRANSLATOR_EXT_BITMAP_SOURCE_SIZE))
+		return;
+
+	ioExtension->AddSize(B_TRANSLATOR_EXT_BITMAP_SOURCE_SIZE,
+		BSize(width - 1, height - 1));
+}
+
+
+void
+reduce_bits(const uint8 *source, int32 width, int32 height,
+	int32 sourceRowBytes, int32 bytesPerPixel, int32 factor, uint8 *dest,
+	int32 destRowBytes)
+{
+	int32 destWidth = (width + factor - 1) / factor;
+	int32 destHeight = (height + factor - 1) / factor;
+	uint32 sums[8];
+
+	for (int32 y = 0; y < destHeight; y++) {
+		int32 top = y * factor;
+		int32 rows = min_c(factor, height - top);
+		uint8 *out = dest + y * destRowBytes;
+
+		for (int32 x = 0; x < destWidth; x++) {
+			int32 left = x * factor;
+			int32 columns = min_c(factor, width - left);
+
+			memset(sums, 0, sizeof(sums));
+			for (int32 row = 0; row < rows; row++) {
+				const uint8 *in = source + (top + row) * sourceRowBytes
+					+ left * bytesPerPixel;
+				for (int32 column = 0; column < columns; column++) {
+					for (int32 i = 0; i < bytesPerPixel; i++)
+						sums[i] += in[i];
+					in += bytesPerPixel;
+				}
+			}
+
+			uint32 count = rows * columns;
+			for (int32 i = 0; i < bytesPerPixel; i++)
+				out[i] = (sums[i] + count / 2) / count;
+			out += bytesPerPixel;
+		}
+	}
+}
@@ -147,5 +147,26 @@ private:
 
 void translate_direct_copy(BPositionIO *inSource, BPositionIO *outDestination);
 
+bool get_target_size(BMessage *ioExtension, int32 &width, int32 &height);
+	// returns whether the caller asked for a reduced resolution decode
+	// (B_TRANSLATOR_EXT_BITMAP_TARGET_SIZE), and the size in pixels
+
+int32 reduction_factor(BMessage *ioExtension, int32 width, int32 height,
+	int32 maxFactor);
+	// returns the largest power of two up to maxFactor by which an image
+	// of the given size can be scaled down and still cover the size
+	// requested by B_TRANSLATOR_EXT_BITMAP_TARGET_SIZE, or 1
+
+void set_source_size(BMessage *ioExtension, int32 width, int32 height);
+	// reports the full size of an image that has been decoded at a
+	// reduced resolution (B_TRANSLATOR_EXT_BITMAP_SOURCE_SIZE), unless
+	// it has been reported already
+
+void reduce_bits(const uint8 *source, int32 width, int32 height,
+	int32 sourceRowBytes, int32 bytesPerPixel, int32 factor, uint8 *dest,
+	int32 destRowBytes);
+	// box filters the image down by factor, the destination must hold
+	// ceil(width / factor) x ceil(height / factor) pixels
+
 #endif // #ifndef BASE_TRANSLATOR_H
 
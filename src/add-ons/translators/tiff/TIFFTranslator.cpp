@@ -24,6 +24,9 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
+#include <new>
+
 
 #undef B_TRANSLATION_CONTEXT
 #define B_TRANSLATION_CONTEXT "TIFFTranslator"
@@ -256,6 +259,48 @@ identify_tiff_header(BPositionIO *inSource, BMessage *ioExtension,
 }
 
 
+// Switches to the smallest reduced resolution subfile of the current page
+// that still covers the target size, if there is any. Returns whether it
+// did so.
+static bool
+select_reduced_image(TIFF *tif, int32 targetWidth, int32 targetHeight)
+{
+	tdir_t page = TIFFCurrentDirectory(tif);
+	uint32 width = 0, height = 0;
+	TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+	TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+
+	tdir_t best = page;
+	uint64 bestPixels = (uint64)width * height;
+	tdir_t index = page;
+	while (TIFFReadDirectory(tif)) {
+		index++;
+
+		// reduced resolution versions of a page directly follow it
+		uint32 subfileType = 0;
+		if (!TIFFGetField(tif, TIFFTAG_SUBFILETYPE, &subfileType)
+			|| (subfileType & FILETYPE_REDUCEDIMAGE) == 0)
+			break;
+
+		uint32 reducedWidth = 0, reducedHeight = 0;
+		TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &reducedWidth);
+		TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &reducedHeight);
+		if (reducedWidth < std::min((uint32)targetWidth, width)
+			&& reducedHeight < std::min((uint32)targetHeight, height))
+			continue;
+
+		uint64 pixels = (uint64)reducedWidth * reducedHeight;
+		if (pixels < bestPixels) {
+			best = index;
+			bestPixels = pixels;
+		}
+	}
+
+	TIFFSetDirectory(tif, best);
+	return best != page;
+}
+
+
 // How this works:
 // Following are a couple of functions,
 //
@@ -839,21 +884,37 @@ TIFFTranslator::translate_from_tiff(BPositionIO *inSource, BMessage *ioExtension
 			result = B_NO_TRANSLATOR;
 			break;
 		}
+
+		int32 targetWidth, targetHeight;
+		if (get_target_size(ioExtension, targetWidth, targetHeight)) {
+			// the caller only needs a smaller bitmap, use a reduced
+			// resolution version of the image, if there is one
+			set_source_size(ioExtension, width, height);
+			if (select_reduced_image(ptif, targetWidth, targetHeight)) {
+				TIFFGetField(ptif, TIFFTAG_IMAGEWIDTH, &width);
+				TIFFGetField(ptif, TIFFTAG_IMAGELENGTH, &height);
+			}
+		}
+
 		size_t npixels = 0;
 		npixels = width * height;
 		praster = static_cast<uint32 *>(_TIFFmalloc(npixels * 4));
 		if (praster && TIFFReadRGBAImage(ptif, width, height, (TIFF_UINT32_TYPE*)praster, 0)) {
+			int32 reduction = reduction_factor(ioExtension, width, height, 16);
+			uint32 outWidth = (width + reduction - 1) / reduction;
+			uint32 outHeight = (height + reduction - 1) / reduction;
+
 			if (!bdataonly) {
 				// Construct and write Be bitmap header
 				TranslatorBitmap bitsHeader;
 				bitsHeader.magic = B_TRANSLATOR_BITMAP;
 				bitsHeader.bounds.left = 0;
 				bitsHeader.bounds.top = 0;
-				bitsHeader.bounds.right = width - 1;
-				bitsHeader.bounds.bottom = height - 1;
-				bitsHeader.rowBytes = 4 * width;
+				bitsHeader.bounds.right = outWidth - 1;
+				bitsHeader.bounds.bottom = outHeight - 1;
+				bitsHeader.rowBytes = 4 * outWidth;
 				bitsHeader.colors = B_RGBA32;
-				bitsHeader.dataSize = bitsHeader.rowBytes * height;
+				bitsHeader.dataSize = bitsHeader.rowBytes * outHeight;
 				if (swap_data(B_UINT32_TYPE, &bitsHeader,
 					sizeof(TranslatorBitmap), B_SWAP_HOST_TO_BENDIAN) != B_OK) {
 					result = B_ERROR;
@@ -862,7 +923,30 @@ TIFFTranslator::translate_from_tiff(BPositionIO *inSource, BMessage *ioExtension
 				outDestination->Write(&bitsHeader, sizeof(TranslatorBitmap));
 			}
 
-			if (!bheaderonly) {
+			if (!bheaderonly && reduction > 1) {
+				// Convert the raster in place to top-down B_RGBA32, then
+				// box filter it down
+				uint8 *pras8 = reinterpret_cast<uint8 *>(praster);
+				uint32 rowBytes = width * 4;
+				for (uint32 i = 0; i < height / 2; i++) {
+					uint32 *top = praster + i * width;
+					uint32 *bottom = praster + (height - (i + 1)) * width;
+					for (uint32 k = 0; k < width; k++)
+						std::swap(top[k], bottom[k]);
+				}
+				for (size_t i = 0; i < npixels; i++)
+					std::swap(pras8[i * 4], pras8[i * 4 + 2]);
+
+				uint8 *pbits = new(std::nothrow) uint8[outWidth * 4 * outHeight];
+				if (!pbits) {
+					result = B_NO_MEMORY;
+					break;
+				}
+				reduce_bits(pras8, width, height, rowBytes, 4, reduction, pbits,
+					outWidth * 4);
+				outDestination->Write(pbits, outWidth * 4 * outHeight);
+				delete[] pbits;
+			} else if (!bheaderonly) {
 				// Convert raw RGBA data to B_RGBA32 colorspace
 				// and write out the results
 				uint8 *pbitsrow = new uint8[width * 4];
@@ -29,21 +29,21 @@
 #define B_TRANSLATION_CONTEXT "WebPTranslator"
 
 
-class FreeAllocation {
+class FreeDecBuffer {
 	public:
-		FreeAllocation(void* buffer)
+		FreeDecBuffer(WebPDecBuffer* buffer)
 			:
 			fBuffer(buffer)
 		{
 		}
 
-		~FreeAllocation()
+		~FreeDecBuffer()
 		{
-			free(fBuffer);
+			WebPFreeDecBuffer(fBuffer);
 		}
 
 	private:
-		void*	fBuffer;
+		WebPDecBuffer*	fBuffer;
 };
 
 
@@ -330,15 +330,40 @@ WebPTranslator::_TranslateFromWebP(BPositionIO* stream, BMessage* ioExtension,
 		return B_IO_ERROR;
 	}
 
-	int width, height;
-	uint8* out = WebPDecodeBGRA((const uint8*)streamData, streamSize, &width,
-		&height);
+	WebPDecoderConfig config;
+	if (!WebPInitDecoderConfig(&config)
+		|| WebPGetFeatures((const uint8*)streamData, streamSize,
+			&config.input) != VP8_STATUS_OK) {
+		free(streamData);
+		return B_ILLEGAL_DATA;
+	}
+
+	// If the caller only needs a smaller bitmap, let libwebp scale while
+	// decoding instead of producing the full size image.
+	int width = config.input.width;
+	int height = config.input.height;
+	int32 reduction = reduction_factor(ioExtension, width, height, 64);
+	if (reduction > 1) {
+		set_source_size(ioExtension, width, height);
+		width = (width + reduction - 1) / reduction;
+		height = (height + reduction - 1) / reduction;
+		config.options.use_scaling = 1;
+		config.options.scaled_width = width;
+		config.options.scaled_height = height;
+	}
+
+	config.output.colorspace = MODE_BGRA;
+	VP8StatusCode decodeStatus = WebPDecode((const uint8*)streamData,
+		streamSize, &config);
 	free(streamData);
 
-	if (out == NULL)
+	if (decodeStatus != VP8_STATUS_OK)
 		return B_ILLEGAL_DATA;
 
-	FreeAllocation _(out);
+	FreeDecBuffer _(&config.output);
+
+	uint8* out = config.output.u.RGBA.rgba;
+	uint32 outRowBytes = config.output.u.RGBA.stride;
 
 	uint32 dataSize = width * 4 * height;
 
@@ -367,18 +392,17 @@ WebPTranslator::_TranslateFromWebP(BPositionIO* stream, BMessage* ioExtension,
 	if (headerOnly)
 		return B_OK;
 
-	uint32 dataLeft = dataSize;
+	uint32 rowBytes = width * 4;
 	uint8* p = out;
-	while (dataLeft) {
-		bytesWritten = target->Write(p, 4);
+	for (int y = 0; y < height; y++) {
+		bytesWritten = target->Write(p, rowBytes);
 		if (bytesWritten < B_OK)
 			return bytesWritten;
 
-		if (bytesWritten != 4)
+		if ((size_t)bytesWritten != rowBytes)
 			return B_IO_ERROR;
 
-		p += 4;
-		dataLeft -= 4;
+		p += outRowBytes;
 	}
 
 	return B_OK;
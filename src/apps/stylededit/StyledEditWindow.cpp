@@ -1186,6 +1186,7 @@ StyledEditWindow::_InitWindow(uint32 encoding)
 	fTextView->SetInsets(TEXT_INSET, TEXT_INSET, TEXT_INSET, TEXT_INSET);
 	fTextView->SetDoesUndo(true);
 	fTextView->SetStylable(true);
+	fTextView->SetTextStorage(B_TEXT_STORAGE_ROPE);
 	fTextView->SetEncoding(encoding);
 
 	fScrollView = new BScrollView("scrollview", fTextView, B_FOLLOW_ALL, 0,
@@ -1760,32 +1761,20 @@ StyledEditWindow::_Search(BString string, bool caseSensitive, bool wrap,
 	if (length == 0)
 		return false;
 
-	BString viewText(fTextView->Text());
 	int32 textStart, textFinish;
 	fTextView->GetSelection(&textStart, &textFinish);
 	if (backSearch) {
-		if (caseSensitive)
-			start = viewText.FindLast(string, textStart);
-		else
-			start = viewText.IFindLast(string, textStart);
-	} else {
-		if (caseSensitive)
-			start = viewText.FindFirst(string, textFinish);
-		else
-			start = viewText.IFindFirst(string, textFinish);
-	}
+		start = fTextView->Find(string.String(), textStart, caseSensitive,
+			true);
+	} else
+		start = fTextView->Find(string.String(), textFinish, caseSensitive);
+
 	if (start == B_ERROR && wrap) {
 		if (backSearch) {
-			if (caseSensitive)
-				start = viewText.FindLast(string, viewText.Length());
-			else
-				start = viewText.IFindLast(string, viewText.Length());
-		} else {
-			if (caseSensitive)
-				start = viewText.FindFirst(string, 0);
-			else
-				start = viewText.IFindFirst(string, 0);
-		}
+			start = fTextView->Find(string.String(), fTextView->TextLength(),
+				caseSensitive, true);
+		} else
+			start = fTextView->Find(string.String(), 0, caseSensitive);
 	}
 
 	if (start != B_ERROR) {
@@ -1809,8 +1798,10 @@ StyledEditWindow::_FindSelection()
 
 	int32 selectionLength = selectionFinish- selectionStart;
 
-	BString viewText = fTextView->Text();
-	viewText.CopyInto(fStringToFind, selectionStart, selectionLength);
+	char* buffer = fStringToFind.LockBuffer(selectionLength + 1);
+	if (buffer != NULL)
+		fTextView->GetText(selectionStart, selectionLength, buffer);
+	fStringToFind.UnlockBuffer(selectionLength);
 	fFindAgainItem->SetEnabled(true);
 	_Search(fStringToFind, fCaseSensitive, fWrapAround, fBackSearch);
 }
@@ -1843,31 +1834,18 @@ void
 StyledEditWindow::_ReplaceAll(BString findThis, BString replaceWith,
 	bool caseSensitive)
 {
-	bool first = true;
-	fTextView->SetSuppressChanges(true);
-
-	// start from the beginning of text
-	fTextView->Select(0, 0);
-
-	// iterate occurences of findThis without wrapping around
-	while (_Search(findThis, caseSensitive, false, false, false)) {
-		if (first) {
-			_UpdateCleanUndoRedoSaveRevert();
-			first = false;
-		}
-		int32 start;
-		int32 finish;
+	if (fTextView->Find(findThis.String(), 0, caseSensitive) == B_ERROR)
+		return;
 
-		fTextView->GetSelection(&start, &finish);
-		fTextView->Delete(start, start + findThis.Length());
-		fTextView->Insert(start, replaceWith.String(), replaceWith.Length());
+	_UpdateCleanUndoRedoSaveRevert();
 
-		// advance the caret behind the inserted text
-		start += replaceWith.Length();
-		fTextView->Select(start, start);
-	}
-	fTextView->ScrollToSelection();
+	// replaces all occurrences at once, and leaves the caret behind the
+	// last one
+	fTextView->SetSuppressChanges(true);
+	fTextView->ReplaceAll(findThis.String(), replaceWith.String(),
+		caseSensitive);
 	fTextView->SetSuppressChanges(false);
+	fTextView->ScrollToSelection();
 }
 
 
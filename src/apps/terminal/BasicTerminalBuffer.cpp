@@ -48,6 +48,27 @@ restrict_value(int32 value, int32 min, int32 max)
 }
 
 
+// 64 bit FNV-1a, wide enough that a collision leaving a stale row on screen
+// is not a practical concern
+static inline uint64
+checksum_add(uint64 checksum, uint32 value)
+{
+	return (checksum ^ value) * 1099511628211ULL;
+}
+
+
+static inline uint64
+checksum_add(uint64 checksum, const Attributes& attributes)
+{
+	checksum = checksum_add(checksum, attributes.state);
+	checksum = checksum_add(checksum, attributes.foreground);
+	checksum = checksum_add(checksum, attributes.background);
+	checksum = checksum_add(checksum, attributes.underline);
+	checksum = checksum_add(checksum, attributes.underlineStyle);
+	return checksum_add(checksum, attributes.hyperlink);
+}
+
+
 // #pragma mark - private inline methods
 
 
@@ -267,10 +288,10 @@ BasicTerminalBuffer::SynchronizeWith(const BasicTerminalBuffer* other,
 				destLine->length = sourceLine->length;
 				destLine->attributes = sourceLine->attributes;
 				destLine->softBreak = sourceLine->softBreak;
-				if (destLine->length > 0) {
-					memcpy(destLine->cells, sourceLine->cells,
-						fWidth * sizeof(TerminalCell));
-				}
+				// the cells beyond the end of the line are needed for their
+				// attributes on the alternate screen
+				memcpy(destLine->cells, sourceLine->cells,
+					fWidth * sizeof(TerminalCell));
 			} else {
 				// The source line was a history line and has been copied
 				// directly into destLine.
@@ -515,6 +536,39 @@ BasicTerminalBuffer::GetLineColor(int32 index, Attributes& attr) const
 }
 
 
+/*!	Returns a checksum of everything that determines how the line looks like:
+	its characters, their attributes, and the attributes of the line. If
+	\a cellsBeyondEnd is \c true, the attributes of the cells beyond the end
+	of the line are included as well.
+*/
+uint64
+BasicTerminalBuffer::LineChecksum(int32 index, bool cellsBeyondEnd) const
+{
+	TerminalLine* lineBuffer = ALLOC_LINE_ON_STACK(fWidth);
+	TerminalLine* line = _HistoryLineAt(index, lineBuffer);
+	if (line == NULL)
+		return 0;
+
+	uint64 checksum = checksum_add(14695981039346656037ULL, line->length);
+	checksum = checksum_add(checksum, line->attributes);
+
+	for (int32 i = 0; i < line->length; i++) {
+		const TerminalCell& cell = line->cells[i];
+		uint32 character = 0;
+		memcpy(&character, cell.character.bytes, cell.character.ByteCount());
+		checksum = checksum_add(checksum, character);
+		checksum = checksum_add(checksum, cell.attributes);
+	}
+
+	if (cellsBeyondEnd) {
+		for (int32 i = line->length; i < fWidth; i++)
+			checksum = checksum_add(checksum, line->cells[i].attributes);
+	}
+
+	return checksum;
+}
+
+
 bool
 BasicTerminalBuffer::Find(const char* _pattern, const TermPos& start,
 	bool forward, bool caseSensitive, bool matchWord, TermPos& _matchStart,
@@ -664,6 +718,53 @@ BasicTerminalBuffer::InsertChar(UTF8Char c)
 }
 
 
+/*!	Inserts \a count printable ASCII characters at once, with the same
+	result as calling InsertChar() for each of them.
+*/
+void
+BasicTerminalBuffer::InsertChars(const char* text, int32 count)
+{
+	if (count <= 0)
+		return;
+
+	fLast = text[count - 1];
+
+	while (count > 0) {
+		if (fSoftWrappedCursor || fCursor.x + HALF_WIDTH > fWidth)
+			_SoftBreakLine();
+		else
+			_PadLineToCursor();
+
+		fSoftWrappedCursor = false;
+
+		int32 chunk = min_c(count, fWidth - fCursor.x);
+		if (!fOverwriteMode)
+			_InsertGap(chunk);
+
+		TerminalLine* line = _LineAt(fCursor.y);
+		TerminalCell* cell = line->cells + fCursor.x;
+		for (int32 i = 0; i < chunk; i++) {
+			cell[i].character = UTF8Char(text[i]);
+			cell[i].attributes = fAttributes;
+		}
+
+		if (line->length < fCursor.x + chunk)
+			line->length = fCursor.x + chunk;
+
+		_Invalidate(fCursor.y, fCursor.y);
+
+		fCursor.x += chunk;
+		text += chunk;
+		count -= chunk;
+
+		if (fCursor.x == fWidth) {
+			fCursor.x -= HALF_WIDTH;
+			fSoftWrappedCursor = true;
+		}
+	}
+}
+
+
 void
 BasicTerminalBuffer::FillScreen(UTF8Char c, Attributes &attributes)
 {
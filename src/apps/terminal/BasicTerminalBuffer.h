@@ -106,6 +106,8 @@ public:
 									TermPos& end) const;
 			int32				LineLength(int32 index) const;
 			void				GetLineColor(int32 index, Attributes& attr) const;
+			uint64				LineChecksum(int32 index,
+									bool cellsBeyondEnd) const;
 
 			bool				PreviousLinePos(TermPos& pos) const;
 			bool				NextLinePos(TermPos& pos, bool normalize) const;
@@ -131,6 +133,7 @@ public:
 
 			// insert chars/lines
 			void				InsertChar(UTF8Char c);
+			void				InsertChars(const char* text, int32 count);
 			void				FillScreen(UTF8Char c, Attributes &attr);
 
 			void				InsertCR();
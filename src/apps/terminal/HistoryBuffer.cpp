@@ -10,31 +10,134 @@
 
 #include "HistoryBuffer.h"
 
+#include <fcntl.h>
 #include <new>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
+#include <FindDirectory.h>
 #include <OS.h>
+#include <ZlibCompressionAlgorithm.h>
+#include <ZstdCompressionAlgorithm.h>
 
 #include "TermConst.h"
 
 
+/*!	The history is kept in segments of kSegmentLines lines. The most recent
+	kHotSegments segments are kept as they are, older ones are compressed,
+	and only decompressed again when one of their lines is needed; the last
+	kCachedSegments of those stay decompressed.
+	When the compressed segments take up more than kMaxResidentCompressedSize
+	bytes, the oldest ones are moved to an (unlinked) temporary file.
+*/
+
+
+static const int32 kSegmentLines = 1024;
+static const int32 kHotSegments = 2;
+static const size_t kMinSegmentCapacity = 16 * 1024;
+static const size_t kMaxResidentCompressedSize = 4 * 1024 * 1024;
+static const off_t kMinSpillFileCompaction = 16 * 1024 * 1024;
+
+enum {
+	COMPRESSION_NONE = 0,
+	COMPRESSION_ZSTD,
+	COMPRESSION_ZLIB
+};
+
+
+// A line as stored in a segment: the header is followed by the attributes
+// runs and the characters of the line, padded to a multiple of 4 bytes.
+struct StoredLine {
+	uint16			attributesRunCount;
+	uint16			byteLength : 15;
+	bool			softBreak : 1;
+	Attributes		attributes;
+
+	AttributesRun* AttributesRuns()
+	{
+		return (AttributesRun*)(this + 1);
+	}
+
+	static size_t SizeFor(int32 attributesRuns, int32 byteLength)
+	{
+		return (sizeof(StoredLine) + attributesRuns * sizeof(AttributesRun)
+			+ byteLength + 3) & ~(size_t)3;
+	}
+};
+
+
+struct HistoryBuffer::Segment {
+	int64			firstLine;
+	int32			lineCount;
+
+	uint8*			data;
+	uint32*			offsets;
+		// the lines and their offsets in data, NULL when not resident
+	size_t			dataSize;
+	size_t			dataCapacity;
+
+	uint8*			compressed;
+		// the compressed data, NULL when it is in the spill file
+	size_t			compressedSize;
+	off_t			fileOffset;
+	uint8			compression;
+
+	Segment(int64 firstLine)
+		:
+		firstLine(firstLine),
+		lineCount(0),
+		data(NULL),
+		offsets(NULL),
+		dataSize(0),
+		dataCapacity(0),
+		compressed(NULL),
+		compressedSize(0),
+		fileOffset(-1),
+		compression(COMPRESSION_NONE)
+	{
+	}
+
+	~Segment()
+	{
+		FreeData();
+		free(compressed);
+	}
+
+	void FreeData()
+	{
+		free(data);
+		data = NULL;
+		free(offsets);
+		offsets = NULL;
+		dataCapacity = 0;
+	}
+};
+
+
 HistoryBuffer::HistoryBuffer()
 	:
-	fLines(NULL),
 	fWidth(0),
 	fCapacity(0),
-	fNextLine(0),
 	fSize(0),
-	fBuffer(NULL),
-	fBufferSize(0),
-	fBufferAllocationOffset(0)
+	fFirstLine(0),
+	fResidentCompressedSize(0),
+	fSpillFile(-1),
+	fSpillFileSize(0),
+	fSpilledSize(0)
 {
+	for (int32 i = 0; i < kCachedSegments; i++)
+		fCache[i] = NULL;
 }
 
 
 HistoryBuffer::~HistoryBuffer()
 {
-	delete[] fLines;
-	delete[] fBuffer;
+	_DeleteSegments();
+
+	if (fSpillFile >= 0)
+		close(fSpillFile);
 }
 
 
@@ -44,22 +147,10 @@ HistoryBuffer::Init(int32 width, int32 capacity)
 	if (width <= 0 || capacity <= 0)
 		return B_BAD_VALUE;
 
-	int32 bufferSize = (width + 4) * capacity;
-
-	if (capacity > 0) {
-		fLines = new(std::nothrow) HistoryLine[capacity];
-		fBuffer = new(std::nothrow) uint8[bufferSize];
-
-		if (fLines == NULL || fBuffer == NULL)
-			return B_NO_MEMORY;
-	}
+	Clear();
 
 	fWidth = width;
 	fCapacity = capacity;
-	fNextLine = 0;
-	fSize = 0;
-	fBufferSize = bufferSize;
-	fBufferAllocationOffset = 0;
 
 	return B_OK;
 }
@@ -68,19 +159,58 @@ HistoryBuffer::Init(int32 width, int32 capacity)
 void
 HistoryBuffer::Clear()
 {
-	fNextLine = 0;
+	_DeleteSegments();
+
 	fSize = 0;
-	fBufferAllocationOffset = 0;
+	fFirstLine = 0;
+
+	if (fSpillFile >= 0)
+		ftruncate(fSpillFile, 0);
+	fSpillFileSize = 0;
+	fSpilledSize = 0;
+}
+
+
+bool
+HistoryBuffer::LineAt(int32 index, HistoryLine& line) const
+{
+	if (index < 0 || index >= fSize)
+		return false;
+
+	int64 number = fFirstLine + fSize - index - 1;
+	Segment* segment = _SegmentFor(number);
+	if (!_MakeResident(segment))
+		return false;
+
+	StoredLine* storedLine = (StoredLine*)(segment->data
+		+ segment->offsets[number - segment->firstLine]);
+
+	line.attributesRuns = storedLine->AttributesRuns();
+	line.attributesRunCount = storedLine->attributesRunCount;
+	line.byteLength = storedLine->byteLength;
+	line.softBreak = storedLine->softBreak;
+	line.attributes = storedLine->attributes;
+	return true;
 }
 
 
 TerminalLine*
 HistoryBuffer::GetTerminalLineAt(int32 index, TerminalLine* buffer) const
 {
-	HistoryLine* line = LineAt(index);
-	if (line == NULL)
+	if (index < 0 || index >= fSize)
 		return NULL;
 
+	HistoryLine historyLine;
+	if (!LineAt(index, historyLine)) {
+		// the line could not be read back -- show it as an empty one
+		buffer->length = 0;
+		buffer->softBreak = false;
+		buffer->attributes.Reset();
+		return buffer;
+	}
+
+	HistoryLine* line = &historyLine;
+
 	int32 charCount = 0;
 	const char* chars = line->Chars();
 	buffer->length = 0;
@@ -93,7 +223,7 @@ HistoryBuffer::GetTerminalLineAt(int32 index, TerminalLine* buffer) const
 	for (int32 i = 0; i < line->byteLength;) {
 		// get attributes
 		if (charCount == nextAttributesAt) {
-			if (charCount < attributesRun->offset) {
+			if (attributesRunCount > 0 && charCount < attributesRun->offset) {
 				// the "hole" in attributes run
 				attributes.Reset();
 				nextAttributesAt = attributesRun->offset;
@@ -160,12 +290,16 @@ HistoryBuffer::AddLine(const TerminalLine* line)
 //debug_printf("  attributesRuns: %ld, byteLength: %ld\n", attributesRuns, byteLength);
 
 	// allocate and translate the line
-	HistoryLine* historyLine = _AllocateLine(attributesRuns, byteLength);
+	HistoryLine historyLine;
+	if (!_AllocateLine(attributesRuns, byteLength, line->softBreak,
+			line->attributes, historyLine)) {
+		return;
+	}
 
 	attributes.Reset();
-	AttributesRun* attributesRun = historyLine->AttributesRuns();
+	AttributesRun* attributesRun = historyLine.AttributesRuns();
 
-	char* chars = historyLine->Chars();
+	char* chars = historyLine.Chars();
 	for (int32 i = 0; i < line->length; i++) {
 		const TerminalCell& cell = line->cells[i];
 
@@ -200,10 +334,7 @@ HistoryBuffer::AddLine(const TerminalLine* line)
 	// set the last attributes run's length
 	if (attributes.state != 0)
 		attributesRun->length = line->length - attributesRun->offset;
-
-	historyLine->softBreak = line->softBreak;
-	historyLine->attributes = line->attributes;
-//debug_printf("  line: \"%.*s\", history size now: %ld\n", historyLine->byteLength, historyLine->Chars(), fSize);
+//debug_printf("  line: \"%.*s\", history size now: %ld\n", historyLine.byteLength, historyLine.Chars(), fSize);
 }
 
 
@@ -216,23 +347,12 @@ HistoryBuffer::AddEmptyLines(int32 count)
 	if (count > fCapacity)
 		count = fCapacity;
 
-	if (count + fSize > fCapacity)
-		DropLines(count + fSize - fCapacity);
-
-	// All lines use the same buffer address, since they don't use any memory.
-	AttributesRun* attributesRun
-		= (AttributesRun*)(fBuffer + fBufferAllocationOffset);
-
+	Attributes attributes;
+	HistoryLine line;
 	for (int32 i = 0; i < count; i++) {
-		HistoryLine* line = &fLines[fNextLine];
-		fNextLine = (fNextLine + 1) % fCapacity;
-		line->attributesRuns = attributesRun;
-		line->attributesRunCount = 0;
-		line->byteLength = 0;
-		line->softBreak = false;
+		if (!_AllocateLine(0, 0, false, attributes, line))
+			break;
 	}
-
-	fSize += count;
 }
 
 
@@ -242,62 +362,359 @@ HistoryBuffer::DropLines(int32 count)
 	if (count <= 0)
 		return;
 
-	if (count < fSize) {
-		fSize -= count;
-	} else {
-		fSize = 0;
-		fNextLine = 0;
-		fBufferAllocationOffset = 0;
+	if (count >= fSize) {
+		Clear();
+		return;
+	}
+
+	fFirstLine += count;
+	fSize -= count;
+
+	while (!fSegments.empty()) {
+		Segment* segment = fSegments.front();
+		if (segment->firstLine + segment->lineCount > fFirstLine)
+			break;
+
+		fSegments.pop_front();
+		_DeleteSegment(segment);
 	}
 }
 
 
-HistoryLine*
-HistoryBuffer::_AllocateLine(int32 attributesRuns, int32 byteLength)
+bool
+HistoryBuffer::_AllocateLine(int32 attributesRuns, int32 byteLength,
+	bool softBreak, const Attributes& attributes, HistoryLine& line)
 {
-	// we need at least one spare line slot
-	int32 toDrop = 0;
 	if (fSize == fCapacity)
-		toDrop = 1;
+		DropLines(1);
+
+	Segment* segment = fSegments.empty() ? NULL : fSegments.back();
+	if (segment == NULL || segment->lineCount == kSegmentLines) {
+		segment = new(std::nothrow) Segment(fFirstLine + fSize);
+		if (segment == NULL)
+			return false;
+
+		segment->offsets = (uint32*)malloc(kSegmentLines * sizeof(uint32));
+		if (segment->offsets == NULL) {
+			delete segment;
+			return false;
+		}
 
-	int32 bytesNeeded = attributesRuns * sizeof(AttributesRun) + byteLength;
+		try {
+			fSegments.push_back(segment);
+		} catch (...) {
+			delete segment;
+			return false;
+		}
+
+		_CompressColdSegment();
+	}
+
+	size_t size = StoredLine::SizeFor(attributesRuns, byteLength);
+	if (segment->dataSize + size > segment->dataCapacity) {
+		size_t capacity = max_c(segment->dataCapacity, kMinSegmentCapacity);
+		while (segment->dataSize + size > capacity)
+			capacity *= 2;
+
+		uint8* data = (uint8*)realloc(segment->data, capacity);
+		if (data == NULL)
+			return false;
 
-	if (fBufferAllocationOffset + bytesNeeded > fBufferSize) {
-		// drop all lines after the allocation index
-		for (; toDrop < fSize; toDrop++) {
-			HistoryLine* line = _LineAt(fSize - toDrop - 1);
-			int32 offset = (uint8*)line->AttributesRuns() - fBuffer;
-			if (offset < fBufferAllocationOffset)
-				break;
+		segment->data = data;
+		segment->dataCapacity = capacity;
+	}
+
+	StoredLine* storedLine = (StoredLine*)(segment->data + segment->dataSize);
+	storedLine->attributesRunCount = attributesRuns;
+	storedLine->byteLength = byteLength;
+	storedLine->softBreak = softBreak;
+	storedLine->attributes = attributes;
+
+	segment->offsets[segment->lineCount++] = segment->dataSize;
+	segment->dataSize += size;
+	fSize++;
+
+	line.attributesRuns = storedLine->AttributesRuns();
+	line.attributesRunCount = attributesRuns;
+	line.byteLength = byteLength;
+	line.softBreak = softBreak;
+	line.attributes = attributes;
+	return true;
+}
+
+
+HistoryBuffer::Segment*
+HistoryBuffer::_SegmentFor(int64 line) const
+{
+	return fSegments[(line - fSegments.front()->firstLine) / kSegmentLines];
+}
+
+
+/*!	Makes sure the lines of the \a segment are in memory, decompressing them
+	if needed.
+*/
+bool
+HistoryBuffer::_MakeResident(Segment* segment) const
+{
+	if (segment->data != NULL) {
+		if (segment->compression != COMPRESSION_NONE)
+			_Cache(segment);
+		return true;
+	}
+
+	uint8* compressed = segment->compressed;
+	uint8* buffer = NULL;
+	if (compressed == NULL) {
+		// read it back from the spill file
+		buffer = (uint8*)malloc(segment->compressedSize);
+		if (buffer == NULL)
+			return false;
+
+		ssize_t bytesRead = pread(fSpillFile, buffer, segment->compressedSize,
+			segment->fileOffset);
+		if (bytesRead != (ssize_t)segment->compressedSize) {
+			free(buffer);
+			return false;
 		}
+		compressed = buffer;
+	}
 
-		fBufferAllocationOffset = 0;
+	uint8* data = (uint8*)malloc(segment->dataSize);
+	uint32* offsets = (uint32*)malloc(segment->lineCount * sizeof(uint32));
+	status_t status = data != NULL && offsets != NULL ? B_OK : B_NO_MEMORY;
+	if (status == B_OK) {
+		iovec input = { compressed, segment->compressedSize };
+		iovec output = { data, segment->dataSize };
+		if (segment->compression == COMPRESSION_ZSTD)
+			status = BZstdCompressionAlgorithm().DecompressBuffer(input, output);
+		else
+			status = BZlibCompressionAlgorithm().DecompressBuffer(input, output);
+		if (status == B_OK && output.iov_len != segment->dataSize)
+			status = B_BAD_DATA;
 	}
 
-	// drop all lines interfering
-	int32 nextOffset = (fBufferAllocationOffset + bytesNeeded + 1) & ~1;
-	for (; toDrop < fSize; toDrop++) {
-		HistoryLine* line = _LineAt(fSize - toDrop - 1);
-		int32 offset = (uint8*)line->AttributesRuns() - fBuffer;
-		if (offset + line->BufferSize() <= fBufferAllocationOffset
-				|| offset >= nextOffset) {
-			break;
+	free(buffer);
+
+	if (status != B_OK) {
+		free(data);
+		free(offsets);
+		return false;
+	}
+
+	size_t offset = 0;
+	for (int32 i = 0; i < segment->lineCount; i++) {
+		StoredLine* storedLine = (StoredLine*)(data + offset);
+		offsets[i] = offset;
+		offset += StoredLine::SizeFor(storedLine->attributesRunCount,
+			storedLine->byteLength);
+	}
+
+	segment->data = data;
+	segment->offsets = offsets;
+	segment->dataCapacity = segment->dataSize;
+
+	_Cache(segment);
+	return true;
+}
+
+
+/*!	Makes the decompressed \a segment the most recently used one, and frees
+	the data of the least recently used one if there are too many.
+*/
+void
+HistoryBuffer::_Cache(Segment* segment) const
+{
+	int32 index = 0;
+	while (index < kCachedSegments - 1 && fCache[index] != NULL
+		&& fCache[index] != segment) {
+		index++;
+	}
+
+	if (fCache[index] != NULL && fCache[index] != segment)
+		fCache[index]->FreeData();
+
+	memmove(fCache + 1, fCache, index * sizeof(Segment*));
+	fCache[0] = segment;
+}
+
+
+void
+HistoryBuffer::_Uncache(Segment* segment) const
+{
+	for (int32 i = 0; i < kCachedSegments; i++) {
+		if (fCache[i] != segment)
+			continue;
+
+		memmove(fCache + i, fCache + i + 1,
+			(kCachedSegments - i - 1) * sizeof(Segment*));
+		fCache[kCachedSegments - 1] = NULL;
+		return;
+	}
+}
+
+
+//! Compresses the segment that just stopped being one of the hot ones.
+void
+HistoryBuffer::_CompressColdSegment()
+{
+	int32 index = (int32)fSegments.size() - kHotSegments - 1;
+	if (index < 0)
+		return;
+
+	Segment* segment = fSegments[index];
+	if (segment->compression != COMPRESSION_NONE || segment->data == NULL)
+		return;
+
+	uint8* buffer = (uint8*)malloc(segment->dataSize);
+	if (buffer == NULL)
+		return;
+
+	// Compressing into a buffer of the original size fails if it isn't
+	// worth it.
+	iovec input = { segment->data, segment->dataSize };
+	iovec output = { buffer, segment->dataSize };
+	uint8 compression = COMPRESSION_ZSTD;
+	BZstdCompressionParameters zstdParameters(B_ZSTD_COMPRESSION_FASTEST);
+	status_t status = BZstdCompressionAlgorithm().CompressBuffer(input,
+		output, &zstdParameters);
+	if (status == B_NOT_SUPPORTED) {
+		compression = COMPRESSION_ZLIB;
+		output.iov_len = segment->dataSize;
+		BZlibCompressionParameters zlibParameters(B_ZLIB_COMPRESSION_FASTEST);
+		status = BZlibCompressionAlgorithm().CompressBuffer(input, output,
+			&zlibParameters);
+	}
+
+	if (status != B_OK) {
+		// keep the lines as they are, but give back the unused space
+		free(buffer);
+		uint8* data = (uint8*)realloc(segment->data, segment->dataSize);
+		if (data != NULL) {
+			segment->data = data;
+			segment->dataCapacity = segment->dataSize;
 		}
+		return;
 	}
 
-	DropLines(toDrop);
+	uint8* compressed = (uint8*)realloc(buffer, output.iov_len);
+	segment->compressed = compressed != NULL ? compressed : buffer;
+	segment->compressedSize = output.iov_len;
+	segment->compression = compression;
+	segment->FreeData();
+
+	fResidentCompressedSize += segment->compressedSize;
+	_Spill();
+}
 
-	// init the line
-	HistoryLine* line = &fLines[fNextLine];
-	fNextLine = (fNextLine + 1) % fCapacity;
-	fSize++;
-	line->attributesRuns = (AttributesRun*)(fBuffer + fBufferAllocationOffset);
-	line->attributesRunCount = attributesRuns;
-	line->byteLength = byteLength;
 
-	fBufferAllocationOffset = (fBufferAllocationOffset + bytesNeeded + 1) & ~1;
-		// DropLines() may have changed fBufferAllocationOffset, so don't use
-		// nextOffset.
+//! Moves the oldest compressed segments to the spill file.
+void
+HistoryBuffer::_Spill()
+{
+	if (fResidentCompressedSize <= kMaxResidentCompressedSize)
+		return;
+
+	if (fSpillFile < 0) {
+		char path[B_PATH_NAME_LENGTH];
+		if (find_directory(B_SYSTEM_TEMP_DIRECTORY, -1, false, path,
+				sizeof(path)) != B_OK) {
+			strlcpy(path, "/tmp", sizeof(path));
+		}
+		strlcat(path, "/Terminal history XXXXXX", sizeof(path));
+
+		fSpillFile = mkstemp(path);
+		if (fSpillFile < 0)
+			return;
+
+		// nobody else needs to see it, and it should go away with us
+		unlink(path);
+		fcntl(fSpillFile, F_SETFD, FD_CLOEXEC);
+	}
+
+	_CompactSpillFile();
 
-	return line;
+	// spill down to half the limit, so that we don't do this every time
+	for (size_t i = 0; i < fSegments.size()
+			&& fResidentCompressedSize > kMaxResidentCompressedSize / 2; i++) {
+		Segment* segment = fSegments[i];
+		if (segment->compressed == NULL)
+			continue;
+
+		ssize_t written = pwrite(fSpillFile, segment->compressed,
+			segment->compressedSize, fSpillFileSize);
+		if (written != (ssize_t)segment->compressedSize)
+			return;
+
+		segment->fileOffset = fSpillFileSize;
+		fSpillFileSize += segment->compressedSize;
+		fSpilledSize += segment->compressedSize;
+
+		free(segment->compressed);
+		segment->compressed = NULL;
+		fResidentCompressedSize -= segment->compressedSize;
+	}
+}
+
+
+/*!	Since segments are spilled and dropped oldest first, the segments still
+	in use form the end of the spill file. Once most of it is unused, they
+	are moved to its start.
+*/
+void
+HistoryBuffer::_CompactSpillFile()
+{
+	off_t unused = fSpillFileSize - fSpilledSize;
+	if (unused < kMinSpillFileCompaction || unused < fSpilledSize)
+		return;
+
+	off_t offset = 0;
+	for (size_t i = 0; i < fSegments.size(); i++) {
+		Segment* segment = fSegments[i];
+		if (segment->compressed != NULL || segment->fileOffset < 0)
+			continue;
+
+		// the segments are moved to lower offsets in order, so this never
+		// overwrites one that hasn't been moved yet
+		uint8* buffer = (uint8*)malloc(segment->compressedSize);
+		if (buffer == NULL)
+			return;
+
+		bool moved = pread(fSpillFile, buffer, segment->compressedSize,
+				segment->fileOffset) == (ssize_t)segment->compressedSize
+			&& pwrite(fSpillFile, buffer, segment->compressedSize, offset)
+				== (ssize_t)segment->compressedSize;
+		free(buffer);
+		if (!moved)
+			return;
+
+		segment->fileOffset = offset;
+		offset += segment->compressedSize;
+	}
+
+	ftruncate(fSpillFile, offset);
+	fSpillFileSize = offset;
+}
+
+
+void
+HistoryBuffer::_DeleteSegment(Segment* segment)
+{
+	_Uncache(segment);
+
+	if (segment->compressed != NULL)
+		fResidentCompressedSize -= segment->compressedSize;
+	else if (segment->fileOffset >= 0)
+		fSpilledSize -= segment->compressedSize;
+
+	delete segment;
+}
+
+
+void
+HistoryBuffer::_DeleteSegments()
+{
+	while (!fSegments.empty()) {
+		_DeleteSegment(fSegments.back());
+		fSegments.pop_back();
+	}
 }
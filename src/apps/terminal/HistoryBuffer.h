@@ -5,6 +5,8 @@
 #ifndef HISTORY_BUFFER_H
 #define HISTORY_BUFFER_H
 
+#include <deque>
+
 #include <SupportDefs.h>
 
 #include "TerminalLine.h"
@@ -27,7 +29,7 @@ public:
 			int32				Capacity() const	{ return fCapacity; }
 			int32				Size() const		{ return fSize; }
 
-	inline	HistoryLine*		LineAt(int32 index) const;
+			bool				LineAt(int32 index, HistoryLine& line) const;
 			TerminalLine*		GetTerminalLineAt(int32 index,
 									TerminalLine* buffer) const;
 
@@ -36,34 +38,43 @@ public:
 			void				DropLines(int32 count);
 
 private:
-			HistoryLine*		_AllocateLine(int32 attributesRuns,
-									int32 byteLength);
-	inline	HistoryLine*		_LineAt(int32 index) const;
+			struct Segment;
+
+			bool				_AllocateLine(int32 attributesRuns,
+									int32 byteLength, bool softBreak,
+									const Attributes& attributes,
+									HistoryLine& line);
+			Segment*			_SegmentFor(int64 line) const;
+			bool				_MakeResident(Segment* segment) const;
+			void				_Cache(Segment* segment) const;
+			void				_Uncache(Segment* segment) const;
+
+			void				_CompressColdSegment();
+			void				_Spill();
+			void				_CompactSpillFile();
+			void				_DeleteSegment(Segment* segment);
+			void				_DeleteSegments();
 
 private:
-			HistoryLine*		fLines;
+	static	const int32			kCachedSegments = 4;
+
 			int32				fWidth;
 			int32				fCapacity;
-			int32				fNextLine;
 			int32				fSize;
-			uint8*				fBuffer;
-			int32				fBufferSize;
-			int32				fBufferAllocationOffset;
+			int64				fFirstLine;
+				// number of the oldest line, counting all lines ever added
+			std::deque<Segment*> fSegments;
+				// oldest first; all but the last one are full
+			size_t				fResidentCompressedSize;
+
+			int					fSpillFile;
+			off_t				fSpillFileSize;
+			off_t				fSpilledSize;
+				// size of the segments in the file that are still in use
+
+	mutable	Segment*			fCache[kCachedSegments];
+				// decompressed segments, most recently used first
 };
 
 
-inline HistoryLine*
-HistoryBuffer::_LineAt(int32 index) const
-{
-	return &fLines[(fCapacity + fNextLine - index - 1) % fCapacity];
-}
-
-
-inline HistoryLine*
-HistoryBuffer::LineAt(int32 index) const
-{
-	return index >= 0 && index < fSize ? _LineAt(index) : NULL;
-}
-
-
 #endif	// HISTORY_BUFFER_H
@@ -75,6 +75,41 @@ TermParse::_NextParseChar()
 }
 
 
+/*!	Returns how many of the bytes left in the parser buffer are printable
+	ASCII characters (0x20 - 0x7e), that is, can be inserted as they are
+	when the parser is in its ground state.
+*/
+inline int32
+TermParse::_PrintableRunLength() const
+{
+	const uchar* text = fParserBuffer + fParserBufferOffset;
+	int32 length = fParserBufferSize - fParserBufferOffset;
+	int32 count = 0;
+
+	// Check eight bytes at a time: a byte is not printable if it is below
+	// 0x20, has its high bit set, or is DEL. The first such byte is always
+	// detected correctly; the bytes after it may be reported wrongly due to
+	// borrows, but those are then sorted out one at a time below.
+	const uint64 kOnes = 0x0101010101010101ULL;
+	const uint64 kHighBits = 0x8080808080808080ULL;
+	for (; count + 8 <= length; count += 8) {
+		uint64 word;
+		memcpy(&word, text + count, sizeof(word));
+
+		uint64 del = word ^ (kOnes * 0x7f);
+		if (((word - kOnes * 0x20) | word | ((del - kOnes) & ~del))
+				& kHighBits) {
+			break;
+		}
+	}
+
+	while (count < length && text[count] >= 0x20 && text[count] < 0x7f)
+		count++;
+
+	return count;
+}
+
+
 TermParse::TermParse(int fd)
 	:
 	fFd(fd),
@@ -250,24 +285,16 @@ TermParse::PtyReader()
 			bufferSize = fReadBufferSize;
 		}
 
-		// Read PTY
-		uchar buf[READ_BUF_SIZE];
-		ssize_t nread = read(fFd, buf, READ_BUF_SIZE - bufferSize);
+		// Read PTY directly into the free space of the ring buffer; the
+		// free space only grows while we're reading
+		int32 toRead = min_c(READ_BUF_SIZE - bufferSize,
+			READ_BUF_SIZE - readPos);
+		ssize_t nread = read(fFd, fReadBuffer + readPos, toRead);
 		if (nread <= 0) {
 			fBuffer->NotifyQuit(errno);
 			return B_OK;
 		}
 
-		// Copy read string to PtyBuffer.
-
-		int32 left = READ_BUF_SIZE - readPos;
-
-		if (nread >= left) {
-			memcpy(fReadBuffer + readPos, buf, left);
-			memcpy(fReadBuffer, buf + left, nread - left);
-		} else
-			memcpy(fReadBuffer + readPos, buf, nread);
-
 		bufferSize = atomic_add(&fReadBufferSize, nread);
 		if (bufferSize == 0)
 			release_sem(fReaderSem);
@@ -422,6 +449,21 @@ TermParse::EscParse()
 							break;
 						}
 					}
+					if (c >= 0x20 && c < 0x7f && curGraphSet == NULL
+						&& parsestate == groundtable) {
+						// Printable ASCII characters don't change the parser
+						// state, insert all that follow this one at once.
+						int32 count = _PrintableRunLength();
+						const char* run = (const char*)fParserBuffer
+							+ fParserBufferOffset - 1;
+#ifdef USE_DEBUG_SNAPSHOTS
+						for (int32 i = 1; i <= count; i++)
+							fBuffer->CaptureChar(run[i]);
+#endif
+						fParserBufferOffset += count;
+						fBuffer->InsertChars(run, count + 1);
+						break;
+					}
 					fBuffer->InsertChar((char)c);
 					break;
 				}
@@ -1379,12 +1421,13 @@ TermParse::_ReadParserBuffer()
 	if (toRead > ESC_PARSER_BUFFER_SIZE)
 		toRead = ESC_PARSER_BUFFER_SIZE;
 
-	for (int32 i = 0; i < toRead; i++) {
-		// TODO: This could be optimized using memcpy instead and
-		// calculating space left as in the PtyReader().
-		fParserBuffer[i] = fReadBuffer[fBufferPosition];
-		fBufferPosition = (fBufferPosition + 1) % READ_BUF_SIZE;
-	}
+	int32 left = READ_BUF_SIZE - fBufferPosition;
+	if (toRead > left) {
+		memcpy(fParserBuffer, fReadBuffer + fBufferPosition, left);
+		memcpy(fParserBuffer + left, fReadBuffer, toRead - left);
+	} else
+		memcpy(fParserBuffer, fReadBuffer + fBufferPosition, toRead);
+	fBufferPosition = (fBufferPosition + toRead) % READ_BUF_SIZE;
 
 	int32 bufferSize = atomic_add(&fReadBufferSize, -toRead);
 
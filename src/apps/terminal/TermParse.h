@@ -19,11 +19,11 @@
 #include <OS.h>
 
 
-#define READ_BUF_SIZE 2048
+#define READ_BUF_SIZE 65536
 	// pty read buffer size
 #define MIN_PTY_BUFFER_SPACE	16
 	// minimal space left before the reader tries to read more
-#define ESC_PARSER_BUFFER_SIZE	64
+#define ESC_PARSER_BUFFER_SIZE	4096
 	// size of the parser buffer
 
 
@@ -39,6 +39,7 @@ public:
 
 private:
 	inline uchar _NextParseChar();
+	inline int32 _PrintableRunLength() const;
 
 	// Initialize TermParse and PtyReader thread.
 	status_t _InitTermParse();
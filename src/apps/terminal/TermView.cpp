@@ -43,6 +43,7 @@
 #include <PropertyInfo.h>
 #include <Region.h>
 #include <Roster.h>
+#include <Screen.h>
 #include <ScrollBar.h>
 #include <ScrollView.h>
 #include <String.h>
@@ -96,6 +97,7 @@ static const uint32 kUpdateSigWinch = 'Rwin';
 static const uint32 kBlinkCursor = 'BlCr';
 
 static const bigtime_t kSyncUpdateGranularity = 100000;	// 0.1 s
+static const bigtime_t kDefaultFrameInterval = 1000000 / 60;
 
 static const int32 kCursorBlinkIntervals = 3;
 static const int32 kCursorVisibleIntervals = 2;
@@ -289,6 +291,10 @@ TermView::_InitObject(const ShellParameters& shellParameters)
 	fScrolledSinceLastSync = 0;
 	fSyncRunner = NULL;
 	fConsiderClockedSync = false;
+	fFrameInterval = kDefaultFrameInterval;
+	fLastFrameSyncTime = 0;
+	fFrameSyncPending = false;
+	fRowChecksums = NULL;
 	fSelection.SetHighlighter(this);
 	fSelection.SetRange(TermPos(0, 0), TermPos(0, 0));
 	fPrevPos = TermPos(-1, - 1);
@@ -325,6 +331,10 @@ TermView::_InitObject(const ShellParameters& shellParameters)
 	if (error != B_OK)
 		return error;
 
+	error = _ResizeRowChecksums();
+	if (error != B_OK)
+		return error;
+
 	fShell = new (std::nothrow) Shell();
 	if (fShell == NULL)
 		return B_NO_MEMORY;
@@ -368,6 +378,7 @@ TermView::~TermView()
 	delete fAutoScrollRunner;
 	delete fCharClassifier;
 	delete fVisibleTextBuffer;
+	delete[] fRowChecksums;
 	delete fTextBuffer;
 	delete shell;
 }
@@ -569,6 +580,8 @@ TermView::SetTermSize(int rows, int columns, bool notifyShell)
 		}
 	}
 
+	_ResizeRowChecksums();
+
 //debug_printf("Invalidate()\n");
 	Invalidate();
 
@@ -629,6 +642,7 @@ TermView::SetTextColor(rgb_color fore, rgb_color back)
 	fTextForeColor = fore;
 
 	SetLowColor(fTextBackColor);
+	_ForgetRowChecksums();
 }
 
 
@@ -651,6 +665,9 @@ TermView::SetSelectColor(rgb_color fore, rgb_color back)
 void
 TermView::SetTermColor(uint index, rgb_color color, bool dynamic)
 {
+	// the rows have to be drawn again even if their contents don't change
+	_ForgetRowChecksums();
+
 	if (!dynamic) {
 		if (index < kTermColorCount)
 			fTextBuffer->SetPaletteColor(index, color);
@@ -823,6 +840,8 @@ TermView::SetTermFont(const BFont *font)
 	_ScrollTo(0, false);
 	if (fScrollBar != NULL)
 		fScrollBar->SetSteps(fFontHeight, fFontHeight * fRows);
+
+	_ForgetRowChecksums();
 }
 
 
@@ -962,6 +981,7 @@ TermView::Clear()
 		fTextBuffer->Clear(true);
 	}
 	fVisibleTextBuffer->Clear(true);
+	_ForgetRowChecksums();
 
 //debug_printf("Invalidate()\n");
 	Invalidate();
@@ -1356,6 +1376,16 @@ TermView::AttachedToWindow()
 		_UpdateScrollBarRange();
 	}
 
+	// coalesce the updates to the refresh rate of the screen
+	display_mode mode;
+	fFrameInterval = kDefaultFrameInterval;
+	if (BScreen(Window()).GetMode(&mode) == B_OK
+		&& mode.timing.pixel_clock > 0) {
+		fFrameInterval = (bigtime_t)mode.timing.h_total * mode.timing.v_total
+			* 1000 / mode.timing.pixel_clock;
+	}
+	fFrameSyncPending = false;
+
 	BMessenger thisMessenger(this);
 
 	BMessage message(kUpdateSigWinch);
@@ -1469,7 +1499,8 @@ TermView::Draw(BRect updateRect)
 						// alternate screen uses cell attributes
 						// beyond the line ends
 						uint32 count = 0;
-						fTextBuffer->GetCellAttributes(j, i, attr, count);
+						fVisibleTextBuffer->GetCellAttributes(j - firstVisible,
+							i, attr, count);
 						rect.right = rect.left + fFontWidth * count - 1;
 						nextColumn = i + count;
 					} else
@@ -1899,6 +1930,11 @@ TermView::MessageReceived(BMessage *message)
 			break;
 		case MSG_TERMINAL_BUFFER_CHANGED:
 		{
+			if (message->GetBool("frame", false))
+				fFrameSyncPending = false;
+			else if (_DeferSynchronization())
+				break;
+
 			TextBufferSyncLocker _(this);
 			_SynchronizeWithTextBuffer(0, -1);
 			break;
@@ -2049,6 +2085,7 @@ TermView::ScrollTo(BPoint where)
 {
 //debug_printf("fVisibleTextBuffer->ScrollBy(%ld)\n", newFirstLine - oldFirstLine);
 			fVisibleTextBuffer->ScrollBy(newFirstLine - oldFirstLine);
+			_ScrollRowChecksums(newFirstLine - oldFirstLine);
 }
 		TextBufferSyncLocker _(this);
 		if (diff < 0)
@@ -2321,11 +2358,13 @@ TermView::_SynchronizeWithTextBuffer(int32 visibleDirtyTop,
 		fScrolledSinceLastSync = 0;
 	}
 
+	fLastFrameSyncTime = now;
 	fVisibleTextBufferChanged = true;
 
 	// Simple case first -- complete invalidation.
 	if (info.invalidateAll) {
 		Invalidate();
+		_ForgetRowChecksums();
 		_UpdateScrollBarRange();
 		_Deselect();
 
@@ -2404,6 +2443,7 @@ TermView::_SynchronizeWithTextBuffer(int32 visibleDirtyTop,
 			CopyBits(sourceRect, destRect);
 
 			fVisibleTextBuffer->ScrollBy(linesScrolled);
+			_ScrollRowChecksums(linesScrolled);
 		}
 
 		// move highlights
@@ -2426,22 +2466,16 @@ TermView::_SynchronizeWithTextBuffer(int32 visibleDirtyTop,
 		}
 	}
 
-	// invalidate dirty region
-	if (info.IsDirtyRegionValid()) {
-		_InvalidateTextRect(0, info.dirtyTop, fTextBuffer->Width() - 1,
-			info.dirtyBottom);
-
-		// clear the selection, if affected
-		if (!fSelection.IsEmpty()) {
-			// TODO: We're clearing the selection more often than necessary --
-			// to avoid that, we'd also need to track the x coordinates of the
-			// dirty range.
-			int32 selectionBottom = fSelection.End().x > 0
-				? fSelection.End().y : fSelection.End().y - 1;
-			if (fSelection.Start().y <= info.dirtyBottom
-				&& info.dirtyTop <= selectionBottom) {
-				_Deselect();
-			}
+	// clear the selection, if affected by the dirty region
+	if (info.IsDirtyRegionValid() && !fSelection.IsEmpty()) {
+		// TODO: We're clearing the selection more often than necessary --
+		// to avoid that, we'd also need to track the x coordinates of the
+		// dirty range.
+		int32 selectionBottom = fSelection.End().x > 0
+			? fSelection.End().y : fSelection.End().y - 1;
+		if (fSelection.Start().y <= info.dirtyBottom
+			&& info.dirtyTop <= selectionBottom) {
+			_Deselect();
 		}
 	}
 
@@ -2453,6 +2487,10 @@ TermView::_SynchronizeWithTextBuffer(int32 visibleDirtyTop,
 			info.dirtyTop, info.dirtyBottom);
 	}
 
+	// invalidate the dirty lines that don't look the same anymore
+	if (info.IsDirtyRegionValid())
+		_InvalidateChangedRows(firstVisible, info.dirtyTop, info.dirtyBottom);
+
 	// invalidate cursor, if it changed
 	TermPos cursor = fTextBuffer->Cursor();
 	if (fCursor != cursor || linesScrolled != 0) {
@@ -2468,6 +2506,129 @@ TermView::_SynchronizeWithTextBuffer(int32 visibleDirtyTop,
 }
 
 
+/*!	Returns whether synchronizing with the text buffer has been postponed
+	until the next refresh of the screen, since the last one was too recent.
+	While the synchronization is pending, the text buffer does not notify us
+	of any further changes.
+*/
+bool
+TermView::_DeferSynchronization()
+{
+	if (fFrameSyncPending)
+		return true;
+
+	// the clocked sync is slower already
+	if (fSyncRunner != NULL)
+		return false;
+
+	bigtime_t delay = fLastFrameSyncTime + fFrameInterval - system_time();
+	if (delay <= 0)
+		return false;
+
+	BMessage message(MSG_TERMINAL_BUFFER_CHANGED);
+	message.AddBool("frame", true);
+	if (BMessageRunner::StartSending(BMessenger(this), &message, delay, 1)
+			!= B_OK) {
+		return false;
+	}
+
+	fFrameSyncPending = true;
+	return true;
+}
+
+
+/*!	Invalidates the lines from \a top to \a bottom, except for those that
+	already show what the visible text buffer contains, so that identical
+	lines are not drawn again. The visible text buffer must have been
+	synchronized already.
+*/
+void
+TermView::_InvalidateChangedRows(int32 firstVisible, int32 top, int32 bottom)
+{
+	if (fRowChecksums == NULL) {
+		_InvalidateTextRect(0, top, fTextBuffer->Width() - 1, bottom);
+		return;
+	}
+
+	bool cellsBeyondEnd = fTextBuffer->IsAlternateScreenActive();
+	int32 first = std::max(top - firstVisible, (int32)0);
+	int32 last = std::min(bottom - firstVisible,
+		fVisibleTextBuffer->Height() - 1);
+	int32 changedFirst = -1;
+
+	for (int32 row = first; row <= last + 1; row++) {
+		bool changed = false;
+		if (row <= last) {
+			uint64 checksum = fVisibleTextBuffer->LineChecksum(row,
+				cellsBeyondEnd);
+			if (checksum == 0)
+				checksum = 1;
+			changed = checksum != fRowChecksums[row];
+			fRowChecksums[row] = checksum;
+		}
+
+		if (changed) {
+			if (changedFirst < 0)
+				changedFirst = row;
+		} else if (changedFirst >= 0) {
+			_InvalidateTextRect(0, firstVisible + changedFirst,
+				fTextBuffer->Width() - 1, firstVisible + row - 1);
+			changedFirst = -1;
+		}
+	}
+}
+
+
+status_t
+TermView::_ResizeRowChecksums()
+{
+	delete[] fRowChecksums;
+	fRowChecksums = new(std::nothrow) uint64[fVisibleTextBuffer->Height()];
+	if (fRowChecksums == NULL)
+		return B_NO_MEMORY;
+
+	_ForgetRowChecksums();
+	return B_OK;
+}
+
+
+void
+TermView::_ForgetRowChecksums()
+{
+	if (fRowChecksums != NULL) {
+		memset(fRowChecksums, 0,
+			fVisibleTextBuffer->Height() * sizeof(uint64));
+	}
+}
+
+
+/*!	Moves the row checksums along with the contents of the view, when it is
+	scrolled by \a lines (positive when the lines move up).
+*/
+void
+TermView::_ScrollRowChecksums(int32 lines)
+{
+	if (fRowChecksums == NULL || lines == 0)
+		return;
+
+	int32 rowCount = fVisibleTextBuffer->Height();
+	if (lines >= rowCount || lines <= -rowCount) {
+		_ForgetRowChecksums();
+		return;
+	}
+
+	if (lines > 0) {
+		memmove(fRowChecksums, fRowChecksums + lines,
+			(rowCount - lines) * sizeof(uint64));
+		memset(fRowChecksums + rowCount - lines, 0, lines * sizeof(uint64));
+	} else {
+		memmove(fRowChecksums - lines, fRowChecksums,
+			(rowCount + lines) * sizeof(uint64));
+		memset(fRowChecksums, 0, -lines * sizeof(uint64));
+	}
+}
+
+
 void
 TermView::_VisibleTextBufferChanged()
 {
@@ -226,9 +226,15 @@ private:
 			void				_DoSecondaryMouseDropAction(BMessage* message);
 			void				_DoFileDrop(entry_ref &ref);
 
+			bool				_DeferSynchronization();
 			void				_SynchronizeWithTextBuffer(
 									int32 visibleDirtyTop,
 									int32 visibleDirtyBottom);
+			void				_InvalidateChangedRows(int32 firstVisible,
+									int32 top, int32 bottom);
+			status_t			_ResizeRowChecksums();
+			void				_ForgetRowChecksums();
+			void				_ScrollRowChecksums(int32 lines);
 			void				_VisibleTextBufferChanged();
 
 			void				_WritePTY(const char* text, int32 numBytes);
@@ -338,6 +344,12 @@ private:
 			int32				fScrolledSinceLastSync;
 			BMessageRunner*		fSyncRunner;
 			bool				fConsiderClockedSync;
+			bigtime_t			fFrameInterval;
+			bigtime_t			fLastFrameSyncTime;
+			bool				fFrameSyncPending;
+			uint64*				fRowChecksums;
+				// checksums of the lines the rows of the visible text buffer
+				// show on screen (or will, once drawn), 0 if unknown
 
 			// selection
 			Highlight			fSelection;
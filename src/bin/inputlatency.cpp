@@ -0,0 +1,111 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Prints the input latencies the app_server collected for each window:
+	the time from the kernel's time stamp of an input event until the event
+	dispatcher dequeued it, until it was written to the window's port, and
+	until the window's message loop dispatched it.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Application.h>
+#include <String.h>
+
+#include <AppServerLink.h>
+#include <InputLatency.h>
+#include <ServerProtocol.h>
+
+
+static const char* kStageNames[B_INPUT_LATENCY_STAGE_COUNT] = {
+	"queued",
+	"sent",
+	"dispatched"
+};
+
+
+static void
+usage(int exitCode)
+{
+	fprintf(exitCode == 0 ? stdout : stderr,
+		"usage: inputlatency [-r] [-a]\n"
+		"Prints the input latencies of all windows in microseconds.\n"
+		"  -r  resets the latencies after printing them\n"
+		"  -a  also lists windows that did not get any input\n");
+	exit(exitCode);
+}
+
+
+static void
+print_histogram(const char* name, const InputLatencyHistogram& histogram)
+{
+	printf("  %-10s %8" B_PRId64 " %8" B_PRId64 " %8" B_PRId64 " %8"
+		B_PRId64 " %8" B_PRId64 "\n", name, histogram.count,
+		histogram.Average(), histogram.Percentile(50),
+		histogram.Percentile(99), histogram.max);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	bool reset = false;
+	bool all = false;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-r"))
+			reset = true;
+		else if (!strcmp(argv[i], "-a"))
+			all = true;
+		else if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help"))
+			usage(0);
+		else
+			usage(1);
+	}
+
+	BApplication app("application/x-vnd.Haiku-inputlatency");
+
+	BPrivate::AppServerLink link;
+	link.StartMessage(AS_GET_INPUT_LATENCY);
+	link.Attach<bool>(reset);
+
+	status_t status;
+	if (link.FlushWithReply(status) != B_OK || status != B_OK) {
+		fprintf(stderr, "inputlatency: could not get the latencies from the "
+			"app_server\n");
+		return 1;
+	}
+
+	int32 count;
+	if (link.Read<int32>(&count) != B_OK)
+		return 1;
+
+	for (int32 i = 0; i < count; i++) {
+		int32 token;
+		team_id team;
+		BString title;
+		InputLatencyHistogram histograms[B_INPUT_LATENCY_STAGE_COUNT];
+		if (link.Read<int32>(&token) != B_OK
+			|| link.Read<team_id>(&team) != B_OK
+			|| link.ReadString(title) != B_OK
+			|| link.Read(histograms, sizeof(histograms)) != B_OK)
+			return 1;
+
+		if (!all && histograms[B_INPUT_LATENCY_SENT].count == 0)
+			continue;
+
+		printf("\"%s\" (window %" B_PRId32 ", team %" B_PRId32 ")\n",
+			title.String(), token, team);
+		printf("  %-10s %8s %8s %8s %8s %8s\n", "stage", "events", "avg",
+			"p50", "p99", "max");
+		for (int32 stage = 0; stage < B_INPUT_LATENCY_STAGE_COUNT; stage++)
+			print_histogram(kStageNames[stage], histograms[stage]);
+	}
+
+	return 0;
+}
@@ -0,0 +1,292 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "MediaTranscode.h"
+
+#include <Directory.h>
+#include <Entry.h>
+#include <Path.h>
+#include <String.h>
+#include <media2/MediaTranscoder.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+
+struct output_format {
+	const char*	name;
+	const char*	mime;
+	const char*	extension;
+};
+
+static const output_format kOutputFormats[] = {
+	{ "wav",	"audio/x-wav",		"wav" },
+	{ "flac",	"audio/x-flac",		"flac" },
+	{ "ogg",	"application/ogg",	"ogg" },
+	{ "mp3",	"audio/mpeg",		"mp3" },
+	{ "opus",	"audio/x-opus",		"opus" },
+};
+
+
+struct peak_info {
+	float	peak;
+	double	sumOfSquares;
+	int64	samples;
+};
+
+
+/*!	Parses the "-j <workers>" option, and returns the index of the first
+	argument after it.
+*/
+static int
+parse_workers(int argc, char** argv, int32& workers)
+{
+	workers = 0;
+	if (argc >= 2 && strcmp(argv[0], "-j") == 0) {
+		workers = atoi(argv[1]);
+		return 2;
+	}
+	return 0;
+}
+
+
+/*!	Collects the files named by the arguments; directories contribute the
+	files they contain.
+*/
+static void
+collect_files(int argc, char** argv, std::vector<entry_ref>& refs)
+{
+	for (int i = 0; i < argc; i++) {
+		BEntry entry(argv[i], true);
+		if (entry.IsDirectory()) {
+			BDirectory directory(&entry);
+			entry_ref ref;
+			while (directory.GetNextRef(&ref) == B_OK) {
+				BEntry child(&ref, true);
+				if (child.IsFile())
+					refs.push_back(ref);
+			}
+			continue;
+		}
+
+		entry_ref ref;
+		if (!entry.Exists() || entry.GetRef(&ref) != B_OK) {
+			fprintf(stderr, "media_client: \"%s\" not found\n", argv[i]);
+			continue;
+		}
+		refs.push_back(ref);
+	}
+}
+
+
+static void
+print_statistics(const char* label, const BMediaTranscoder& transcoder)
+{
+	media_transcode_statistics stats;
+	transcoder.GetStatistics(&stats);
+
+	double seconds = stats.elapsed / 1000000.0;
+	double mediaSeconds = stats.media_time / 1000000.0;
+	printf("%s: %" B_PRId32 " files (%" B_PRId32 " failed), %.1f s of audio"
+		" in %.2f s, %.0f frames/s, %.1fx realtime\n", label,
+		stats.jobs_done + stats.jobs_failed, stats.jobs_failed,
+		mediaSeconds, seconds, seconds > 0 ? stats.frames / seconds : 0.0,
+		seconds > 0 ? mediaSeconds / seconds : 0.0);
+}
+
+
+static void
+print_failures(const BMediaTranscoder& transcoder,
+	const std::vector<entry_ref>& refs)
+{
+	for (int32 i = 0; i < transcoder.CountJobs(); i++) {
+		status_t status = transcoder.JobStatus(i);
+		if (status != B_OK)
+			fprintf(stderr, "%s: %s\n", refs[i].name, strerror(status));
+	}
+}
+
+
+static bool
+measure_peaks(void* cookie, int32 job, const void* frames, int64 frameCount,
+	const media_raw_audio_format& format)
+{
+	if (format.format != media_raw_audio_format::B_AUDIO_FLOAT)
+		return false;
+
+	peak_info& info = ((peak_info*)cookie)[job];
+	const float* samples = (const float*)frames;
+	const int64 count = frameCount * format.channel_count;
+	for (int64 i = 0; i < count; i++) {
+		float value = fabsf(samples[i]);
+		if (value > info.peak)
+			info.peak = value;
+		info.sumOfSquares += (double)samples[i] * samples[i];
+	}
+	info.samples += count;
+	return true;
+}
+
+
+static double
+to_decibel(double value)
+{
+	return value > 0 ? 20 * log10(value) : -INFINITY;
+}
+
+
+int
+media_transcode(int argc, char** argv)
+{
+	const output_format* format = &kOutputFormats[0];
+	if (argc >= 2 && strcmp(argv[0], "-f") == 0) {
+		format = NULL;
+		for (size_t i = 0; i < B_COUNT_OF(kOutputFormats); i++) {
+			if (strcmp(argv[1], kOutputFormats[i].name) == 0)
+				format = &kOutputFormats[i];
+		}
+		if (format == NULL) {
+			fprintf(stderr, "media_client: unknown format \"%s\"\n", argv[1]);
+			return 1;
+		}
+		argc -= 2;
+		argv += 2;
+	}
+
+	int32 workers;
+	int first = parse_workers(argc, argv, workers);
+	if (first >= argc) {
+		fprintf(stderr, "media_client: no output directory given\n");
+		return 1;
+	}
+	BDirectory outputDirectory(argv[first]);
+	if (outputDirectory.InitCheck() != B_OK) {
+		fprintf(stderr, "media_client: \"%s\" is not a directory\n",
+			argv[first]);
+		return 1;
+	}
+
+	std::vector<entry_ref> sources;
+	collect_files(argc - first - 1, argv + first + 1, sources);
+	if (sources.empty())
+		return 1;
+
+	media_file_format fileFormat;
+	memset(&fileFormat, 0, sizeof(fileFormat));
+	strlcpy(fileFormat.mime_type, format->mime, sizeof(fileFormat.mime_type));
+	strlcpy(fileFormat.short_name, format->name,
+		sizeof(fileFormat.short_name));
+	strlcpy(fileFormat.file_extension, format->extension,
+		sizeof(fileFormat.file_extension));
+
+	BMediaTranscoder transcoder(workers);
+	for (size_t i = 0; i < sources.size(); i++) {
+		BString name(sources[i].name);
+		int32 dot = name.FindLast('.');
+		if (dot > 0)
+			name.Truncate(dot);
+		name << "." << format->extension;
+
+		BPath path(&outputDirectory, name.String());
+		entry_ref destination;
+		status_t status = path.InitCheck();
+		if (status == B_OK)
+			status = get_ref_for_path(path.Path(), &destination);
+		if (status == B_OK) {
+			status_t job = transcoder.AddJob(sources[i], &destination,
+				&fileFormat);
+			if (job < 0)
+				status = job;
+		}
+		if (status != B_OK) {
+			fprintf(stderr, "%s: %s\n", sources[i].name, strerror(status));
+			return 1;
+		}
+	}
+
+	transcoder.Start();
+	transcoder.Wait();
+	print_failures(transcoder, sources);
+	print_statistics("transcoded", transcoder);
+
+	media_transcode_statistics stats;
+	transcoder.GetStatistics(&stats);
+	return stats.jobs_failed == 0 ? 0 : 2;
+}
+
+
+int
+media_peaks(int argc, char** argv)
+{
+	int32 workers;
+	int first = parse_workers(argc, argv, workers);
+	std::vector<entry_ref> refs;
+	collect_files(argc - first, argv + first, refs);
+	if (refs.empty())
+		return 1;
+
+	std::vector<peak_info> peaks(refs.size());
+	memset(peaks.data(), 0, peaks.size() * sizeof(peak_info));
+
+	BMediaTranscoder transcoder(workers);
+	for (size_t i = 0; i < refs.size(); i++)
+		transcoder.AddJob(refs[i], NULL, NULL, &measure_peaks, peaks.data());
+
+	transcoder.Start();
+	transcoder.Wait();
+
+	for (size_t i = 0; i < refs.size(); i++) {
+		if (transcoder.JobStatus(i) != B_OK)
+			continue;
+		const peak_info& info = peaks[i];
+		double rms = info.samples > 0
+			? sqrt(info.sumOfSquares / info.samples) : 0.0;
+		printf("%s: peak %.1f dBFS, RMS %.1f dBFS\n", refs[i].name,
+			to_decibel(info.peak), to_decibel(rms));
+	}
+	print_failures(transcoder, refs);
+	print_statistics("analyzed", transcoder);
+	return 0;
+}
+
+
+/*!	Decodes all files once with a single worker, and once with the
+	requested number of workers (all CPUs by default).
+*/
+int
+media_bench(int argc, char** argv)
+{
+	int32 workers;
+	int first = parse_workers(argc, argv, workers);
+	std::vector<entry_ref> refs;
+	collect_files(argc - first, argv + first, refs);
+	if (refs.empty())
+		return 1;
+
+	bigtime_t elapsed[2];
+	for (int32 run = 0; run < 2; run++) {
+		BMediaTranscoder transcoder(run == 0 ? 1 : workers);
+		for (size_t i = 0; i < refs.size(); i++)
+			transcoder.AddJob(refs[i]);
+
+		transcoder.Start();
+		transcoder.Wait();
+		print_statistics(run == 0 ? "1 worker" : "parallel", transcoder);
+		if (run == 0)
+			print_failures(transcoder, refs);
+
+		media_transcode_statistics stats;
+		transcoder.GetStatistics(&stats);
+		elapsed[run] = stats.elapsed;
+	}
+
+	if (elapsed[1] > 0)
+		printf("speed-up: %.2fx\n", (double)elapsed[0] / elapsed[1]);
+	return 0;
+}
@@ -0,0 +1,13 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef _MEDIA_CLIENT_TRANSCODE
+#define _MEDIA_CLIENT_TRANSCODE
+
+int media_transcode(int argc, char** argv);
+int media_peaks(int argc, char** argv);
+int media_bench(int argc, char** argv);
+
+#endif
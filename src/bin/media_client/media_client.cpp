@@ -10,6 +10,7 @@
 
 #include "MediaPlay.h"
 #include "MediaTest.h"
+#include "MediaTranscode.h"
 
 
 void print_usage()
@@ -17,6 +18,10 @@ void print_usage()
 	printf("Usage:\n");
 	printf("  media_client play <uri>\n");
 	printf("  media_client test\n");
+	printf("  media_client transcode [-f wav|flac|ogg|mp3|opus] [-j <workers>]"
+		" <output directory> <file|directory>...\n");
+	printf("  media_client peaks [-j <workers>] <file|directory>...\n");
+	printf("  media_client bench [-j <workers>] <file|directory>...\n");
 }
 
 
@@ -37,6 +42,12 @@ int main(int argc, char *argv[])
 			ret = media_play(argv[2]);
 	} else if (strcmp(argv[1], "test") == 0)
 		media_test();
+	else if (strcmp(argv[1], "transcode") == 0)
+		ret = media_transcode(argc - 2, argv + 2);
+	else if (strcmp(argv[1], "peaks") == 0)
+		ret = media_peaks(argc - 2, argv + 2);
+	else if (strcmp(argv[1], "bench") == 0)
+		ret = media_bench(argc - 2, argv + 2);
 	else
 		print_usage();
 
@@ -12,16 +12,22 @@
 #include <Path.h>
 #include <Entry.h>
 #include <List.h>
+#include <Message.h>
 #include <String.h>
 
+#include <RegistrarDefs.h>
+#include <RosterPrivate.h>
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <getopt.h>
 
 
 static struct option const kLongOptions[] = {
 	{"name", no_argument, 0, 'n'},
 	{"no-trunc", no_argument, 0, 't'},
+	{"runners", no_argument, 0, 'r'},
 	{"help", no_argument, 0, 'h'},
 	{NULL}
 };
@@ -35,6 +41,7 @@ static const int32 kNameFieldWidth = 34;
 static const int32 kStandardMode	= 0x0;
 static const int32 kNameOnlyMode	= 0x1;
 static const int32 kNoTruncateMode	= 0x2;
+static const int32 kRunnersMode		= 0x4;
 
 
 void
@@ -85,12 +92,53 @@ output_team(team_id id, int32 mode)
 }
 
 
+int
+output_runners()
+{
+	BMessage request(BPrivate::B_REG_GET_MESSAGE_RUNNER_LIST);
+	BMessage reply;
+	status_t status = BRoster::Private().SendTo(&request, &reply, false);
+	if (status == B_OK && reply.what != BPrivate::B_REG_SUCCESS) {
+		if (reply.FindInt32("error", &status) != B_OK)
+			status = B_ERROR;
+	}
+	if (status != B_OK) {
+		fprintf(stderr, "%s: could not get the message runner list: %s\n",
+			kProgramName, strerror(status));
+		return 1;
+	}
+
+	printf("  team token     interval count      next in\n");
+	puts("------ ----- ------------ ----- ------------");
+
+	bigtime_t now = system_time();
+	team_id team;
+	for (int32 i = 0; reply.FindInt32("team", i, &team) == B_OK; i++) {
+		int32 token = reply.GetInt32("token", i, -1);
+		bigtime_t interval = reply.GetInt64("interval", i, 0);
+		int32 count = reply.GetInt32("count", i, 0);
+		bigtime_t time = reply.GetInt64("time", i, now);
+
+		printf("%6" B_PRId32 " %5" B_PRId32 " %12" B_PRId64, team, token,
+			interval);
+		if (count < 0)
+			printf("     -");
+		else
+			printf(" %5" B_PRId32, count);
+		printf(" %12" B_PRId64 "\n", time > now ? time - now : 0);
+	}
+
+	return 0;
+}
+
+
 void
 usage(int exitCode)
 {
-	fprintf(stderr, "usage: %s [-nt]\n"
+	fprintf(stderr, "usage: %s [-ntr]\n"
 		"  -n, --name\t\tInstead of the full path, only the name of the teams are written\n"
 		"  -t, --no-trunc\tDon't truncate the path name\n"
+		"  -r, --runners\t\tList the active message runners instead of the teams\n"
 		"  -h, --help\t\tDisplay this help and exit\n",
 		kProgramName);
 
@@ -106,7 +154,7 @@ main(int argc, char **argv)
 	// Don't have an BApplication as it is not needed for what we do
 
 	int c;
-	while ((c = getopt_long(argc, argv, "nth", kLongOptions, NULL)) != -1) {
+	while ((c = getopt_long(argc, argv, "ntrh", kLongOptions, NULL)) != -1) {
 		switch (c) {
 			case 'n':
 				mode |= kNameOnlyMode;
@@ -114,6 +162,9 @@ main(int argc, char **argv)
 			case 't':
 				mode |= kNoTruncateMode;
 				break;
+			case 'r':
+				mode |= kRunnersMode;
+				break;
 			case 0:
 				break;
 			case 'h':
@@ -125,6 +176,9 @@ main(int argc, char **argv)
 		}
 	}
 
+	if ((mode & kRunnersMode) != 0)
+		return output_runners();
+
 	// print title line
 
 	printf("  team %*s  port flags signature\n", 
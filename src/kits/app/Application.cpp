@@ -37,6 +37,7 @@
 
 #include <AppMisc.h>
 #include <AppServerLink.h>
+#include <ApplicationPrivate.h>
 #include <AutoLocker.h>
 #include <BitmapPrivate.h>
 #include <DraggerPrivate.h>
@@ -49,6 +50,7 @@
 #include <RosterPrivate.h>
 #include <ServerMemoryAllocator.h>
 #include <ServerProtocol.h>
+#include <ServerProtocolStructs.h>
 
 
 using namespace BPrivate;
@@ -63,6 +65,33 @@ pthread_once_t sAppResourcesInitOnce = PTHREAD_ONCE_INIT;
 BResources* BApplication::sAppResources = NULL;
 BObjectList<BLooper> sOnQuitLooperList;
 
+// The initial interface kit state app_server sends when we connect; it's only
+// kept until the interface kit has been initialized.
+static AppBootstrapInfo sBootstrapInfo;
+static bool sBootstrapInfoValid = false;
+
+// AS_CREATE_APP has been sent, but its reply has not been read yet
+static bool sServerConnectionPending = false;
+
+// Time spent in each phase of the launch; printed to stderr if the
+// BAPPLICATION_LAUNCH_TIMING environment variable is set.
+enum {
+	kLaunchPhaseAppInfo,
+	kLaunchPhaseRegistrar,
+	kLaunchPhaseAppServer,
+	kLaunchPhaseInterfaceKit,
+	kLaunchPhaseCount
+};
+
+static const char* kLaunchPhaseNames[kLaunchPhaseCount] = {
+	"app info",
+	"registrar",
+	"app_server",
+	"interface kit"
+};
+
+static bigtime_t sLaunchPhaseTimes[kLaunchPhaseCount];
+
 
 enum {
 	kWindowByIndex,
@@ -216,6 +245,31 @@ check_app_signature(const char* signature)
 }
 
 
+//!	Adds the time since \a start to the given launch phase.
+static void
+add_launch_time(int32 phase, bigtime_t& start)
+{
+	bigtime_t now = system_time();
+	sLaunchPhaseTimes[phase] += now - start;
+	start = now;
+}
+
+
+static void
+print_launch_times(const char* signature, bigtime_t total)
+{
+	if (getenv("BAPPLICATION_LAUNCH_TIMING") == NULL)
+		return;
+
+	fprintf(stderr, "%s launch:", signature);
+	for (int32 i = 0; i < kLaunchPhaseCount; i++) {
+		fprintf(stderr, " %s %" B_PRIdBIGTIME " us,", kLaunchPhaseNames[i],
+			sLaunchPhaseTimes[i]);
+	}
+	fprintf(stderr, " total %" B_PRIdBIGTIME " us\n", total);
+}
+
+
 #ifndef RUN_WITHOUT_REGISTRAR
 // Fills the passed BMessage with B_ARGV_RECEIVED infos.
 static void
@@ -368,6 +422,9 @@ BApplication::_InitData(const char* signature, bool initGUI, status_t* _error)
 	fPulseRunner = NULL;
 	fPulseRate = 0;
 
+	bigtime_t launchStart = system_time();
+	bigtime_t phaseStart = launchStart;
+
 	// check signature
 	fInitError = check_app_signature(signature);
 	fAppName = signature;
@@ -414,6 +471,7 @@ BApplication::_InitData(const char* signature, bool initGUI, status_t* _error)
 				"BAppFileInfo: %s\n", strerror(fInitError)));
 		}
 	}
+	add_launch_time(kLaunchPhaseAppInfo, phaseStart);
 
 #ifndef RUN_WITHOUT_REGISTRAR
 	// check whether be_roster is valid
@@ -444,6 +502,19 @@ BApplication::_InitData(const char* signature, bool initGUI, status_t* _error)
 		// check the signature and correct it, if necessary, also the case
 		if (strcmp(appInfo.signature, fAppName))
 			BRoster::Private().SetSignature(team, fAppName);
+	}
+	add_launch_time(kLaunchPhaseRegistrar, phaseStart);
+
+#ifndef RUN_WITHOUT_APP_SERVER
+	// Now that our looper port is settled, let the app_server set up our
+	// connection while the registrar registers us. _InitGUIContext() picks
+	// up the reply.
+	if (fInitError == B_OK && initGUI)
+		_StartConnectToServer();
+	add_launch_time(kLaunchPhaseAppServer, phaseStart);
+#endif
+
+	if (preRegistered) {
 		// complete the registration
 		fInitError = BRoster::Private().CompleteRegistration(team, thread,
 						appInfo.port);
@@ -506,11 +577,22 @@ BApplication::_InitData(const char* signature, bool initGUI, status_t* _error)
 			fInitError = B_ERROR;
 		}
 	}
+	add_launch_time(kLaunchPhaseRegistrar, phaseStart);
 #else
 	// We need to have ReadyToRun called even when we're not using the registrar
 	PostMessage(B_READY_TO_RUN, this);
 #endif	// ifndef RUN_WITHOUT_REGISTRAR
 
+#ifndef RUN_WITHOUT_APP_SERVER
+	if (fInitError != B_OK && sServerConnectionPending) {
+		// we won't need the connection after all
+		if (_FinishConnectToServer() == B_OK) {
+			fServerLink->StartMessage(B_QUIT_REQUESTED);
+			fServerLink->Flush();
+		}
+	}
+#endif
+
 	if (fInitError == B_OK) {
 		const char* readyFdEnv = getenv("JANUS_READY_FD");
 		if (readyFdEnv != NULL && readyFdEnv[0] != '\0') {
@@ -543,6 +625,9 @@ BApplication::_InitData(const char* signature, bool initGUI, status_t* _error)
 #endif	// RUN_WITHOUT_APP_SERVER
 	}
 
+	print_launch_times(fAppName != NULL ? fAppName : "application",
+		system_time() - launchStart);
+
 	// Return the error or exit, if there was an error and no error variable
 	// has been supplied.
 	if (_error != NULL) {
@@ -1391,8 +1476,13 @@ BApplication::_SetupServerAllocator()
 status_t
 BApplication::_InitGUIContext()
 {
+	bigtime_t phaseStart = system_time();
+
 	// An app_server connection is necessary for a lot of stuff, so get that first.
-	status_t error = _ConnectToServer();
+	// _InitData() may have asked for it already.
+	status_t error = sServerConnectionPending
+		? _FinishConnectToServer() : _ConnectToServer();
+	add_launch_time(kLaunchPhaseAppServer, phaseStart);
 	if (error != B_OK)
 		return error;
 
@@ -1407,8 +1497,14 @@ BApplication::_InitGUIContext()
 	B_CURSOR_SYSTEM_DEFAULT = new BCursor(B_HAND_CURSOR);
 	B_CURSOR_I_BEAM = new BCursor(B_I_BEAM_CURSOR);
 
-	// TODO: would be nice to get the workspace at launch time from the registrar
-	fInitialWorkspace = current_workspace();
+	if (sBootstrapInfoValid)
+		fInitialWorkspace = sBootstrapInfo.workspace;
+	else
+		fInitialWorkspace = current_workspace();
+
+	// from now on, the interface kit has to ask for changes
+	sBootstrapInfoValid = false;
+	add_launch_time(kLaunchPhaseInterfaceKit, phaseStart);
 
 	return B_OK;
 }
@@ -1416,6 +1512,21 @@ BApplication::_InitGUIContext()
 
 status_t
 BApplication::_ConnectToServer()
+{
+	status_t status = _StartConnectToServer();
+	if (status != B_OK)
+		return status;
+
+	return _FinishConnectToServer();
+}
+
+
+/*!	Asks the app_server to create our ServerApp, without waiting for the
+	reply; _FinishConnectToServer() has to be called to complete the
+	connection.
+*/
+status_t
+BApplication::_StartConnectToServer()
 {
 	status_t status
 		= create_desktop_connection(fServerLink, "a<app_server", 100);
@@ -1438,18 +1549,45 @@ BApplication::_ConnectToServer()
 	fServerLink->Attach<int32>(_get_object_token_(this));
 	fServerLink->AttachString(fAppName);
 
+	status = fServerLink->Flush(B_INFINITE_TIMEOUT, true);
+	if (status != B_OK)
+		return status;
+
+	sServerConnectionPending = true;
+	return B_OK;
+}
+
+
+status_t
+BApplication::_FinishConnectToServer()
+{
+	sServerConnectionPending = false;
+
+	// AS_CREATE_APP reply:
+	//
+	// 1) port_id - port of our ServerApp
+	// 2) area_id - the shared read-only area
+	// 3) team_id - team of the app_server
+	// 4) bool - whether the bootstrap info follows
+	// 5) AppBootstrapInfo - the initial state of the interface kit
+
 	area_id sharedReadOnlyArea;
 	team_id serverTeam;
 	port_id serverPort;
 
 	int32 code;
-	if (fServerLink->FlushWithReply(code) == B_OK
+	if (fServerLink->GetNextMessage(code) == B_OK
 		&& code == B_OK) {
 		// We don't need to contact the main app_server anymore
 		// directly; we now talk to our server alter ego only.
 		fServerLink->Read<port_id>(&serverPort);
 		fServerLink->Read<area_id>(&sharedReadOnlyArea);
 		fServerLink->Read<team_id>(&serverTeam);
+
+		bool hasBootstrapInfo = false;
+		fServerLink->Read<bool>(&hasBootstrapInfo);
+		sBootstrapInfoValid = hasBootstrapInfo
+			&& fServerLink->Read<AppBootstrapInfo>(&sBootstrapInfo) == B_OK;
 	} else {
 		fServerLink->SetSenderPort(-1);
 		debugger("BApplication: couldn't obtain new app_server comm port");
@@ -1458,7 +1596,7 @@ BApplication::_ConnectToServer()
 	fServerLink->SetTargetTeam(serverTeam);
 	fServerLink->SetSenderPort(serverPort);
 
-	status = _SetupServerAllocator();
+	status_t status = _SetupServerAllocator();
 	if (status != B_OK)
 		return status;
 
@@ -1489,6 +1627,9 @@ BApplication::_ReconnectToServer()
 	if (_ConnectToServer() != B_OK)
 		debugger("Can't reconnect to app server!");
 
+	// the interface kit is initialized already
+	sBootstrapInfoValid = false;
+
 	AutoLocker<BLooperList> listLock(gLooperList);
 	if (!listLock.IsLocked())
 		return;
@@ -1651,6 +1792,19 @@ BApplication::InitialWorkspace()
 }
 
 
+//	#pragma mark - BApplication::Private
+
+
+/*!	Returns the initial interface kit state the app_server sent when we
+	connected, or \c NULL once the interface kit has been initialized.
+*/
+/*static*/ const AppBootstrapInfo*
+BApplication::Private::BootstrapInfo()
+{
+	return sBootstrapInfoValid ? &sBootstrapInfo : NULL;
+}
+
+
 int32
 BApplication::_CountWindows(bool includeMenus) const
 {
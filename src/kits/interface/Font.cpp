@@ -12,9 +12,11 @@
 
 
 #include <AppServerLink.h>
+#include <ApplicationPrivate.h>
 #include <FontPrivate.h>
 #include <ObjectList.h>
 #include <ServerProtocol.h>
+#include <ServerProtocolStructs.h>
 #include <truncate_string.h>
 #include <utf8_functions.h>
 
@@ -342,6 +344,27 @@ FontList::_InitSingleton()
 void
 _init_global_fonts_()
 {
+	const AppBootstrapInfo* bootstrapInfo
+		= BApplication::Private::BootstrapInfo();
+	if (bootstrapInfo != NULL) {
+		// the app_server already sent them along with the connection
+		BFont* fonts[] = { &sPlainFont, &sBoldFont, &sFixedFont };
+		const AppBootstrapFontInfo* infos[] = { &bootstrapInfo->plainFont,
+			&bootstrapInfo->boldFont, &bootstrapInfo->fixedFont };
+
+		for (int32 i = 0; i < 3; i++) {
+			fonts[i]->fFamilyID = infos[i]->familyID;
+			fonts[i]->fStyleID = infos[i]->styleID;
+			fonts[i]->fSize = infos[i]->size;
+			fonts[i]->fFace = infos[i]->face;
+			fonts[i]->fFlags = infos[i]->flags;
+
+			fonts[i]->fHeight.ascent = kUninitializedAscent;
+			fonts[i]->fExtraFlags = kUninitializedExtraFlags;
+		}
+		return;
+	}
+
 	BPrivate::AppServerLink link;
 	link.StartMessage(AS_GET_SYSTEM_FONTS);
 
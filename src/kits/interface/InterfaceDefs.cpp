@@ -48,6 +48,7 @@
 #include <MenuPrivate.h>
 #include <pr_server.h>
 #include <ServerProtocol.h>
+#include <ServerProtocolStructs.h>
 #include <ServerReadOnlyMemory.h>
 #include <truncate_string.h>
 #include <utf8_functions.h>
@@ -1485,8 +1486,20 @@ _init_interface_kit_()
 	if (be_clipboard == NULL)
 		be_clipboard = new BClipboard(NULL);
 
+	// the app_server usually sent us everything we need along with the
+	// connection already
+	const AppBootstrapInfo* bootstrapInfo
+		= BApplication::Private::BootstrapInfo();
+
 	BString path;
-	if (get_control_look(path) && path.Length() > 0) {
+	bool hasControlLook;
+	if (bootstrapInfo != NULL) {
+		path = bootstrapInfo->controlLook;
+		hasControlLook = true;
+	} else
+		hasControlLook = get_control_look(path);
+
+	if (hasControlLook && path.Length() > 0) {
 		BControlLook* (*instantiate)(image_id);
 
 		sControlLookAddon = load_add_on(path.String());
@@ -1513,9 +1526,13 @@ _init_interface_kit_()
 
 	_menu_info_ptr_ = &BMenu::sMenuInfo;
 
-	status = get_menu_info(&BMenu::sMenuInfo);
-	if (status != B_OK)
-		return status;
+	if (bootstrapInfo != NULL)
+		BMenu::sMenuInfo = bootstrapInfo->menuInfo;
+	else {
+		status = get_menu_info(&BMenu::sMenuInfo);
+		if (status != B_OK)
+			return status;
+	}
 
 	general_info.background_color = ui_color(B_PANEL_BACKGROUND_COLOR);
 	general_info.mark_color = ui_color(B_CONTROL_MARK_COLOR);
@@ -57,6 +57,7 @@
 #include "LineBuffer.h"
 #include "StyleBuffer.h"
 #include "TextGapBuffer.h"
+#include "TextRope.h"
 #include "UndoBuffer.h"
 #include "WidthBuffer.h"
 
@@ -158,7 +159,10 @@ struct BTextView::LayoutData {
 		  rightInset(0),
 		  bottomInset(0),
 		  valid(false),
-		  overridden(false)
+		  overridden(false),
+		  layoutPending(false),
+		  layoutQueued(false),
+		  layoutLimited(false)
 	{
 	}
 
@@ -171,6 +175,14 @@ struct BTextView::LayoutData {
 	BSize				preferred;
 	bool				valid : 1;
 	bool				overridden : 1;
+
+	// incremental line breaking, see _LayoutPending()
+	int32				layoutUntilOffset;
+	float				layoutUntilY;
+	bigtime_t			layoutDeadline;
+	bool				layoutPending : 1;
+	bool				layoutQueued : 1;
+	bool				layoutLimited : 1;
 };
 
 
@@ -183,6 +195,13 @@ static const float kVerticalScrollBarStep = 12.0;
 static const int32 kMsgNavigateArrow = '_NvA';
 static const int32 kMsgNavigatePage  = '_NvP';
 static const int32 kMsgRemoveWord    = '_RmW';
+static const int32 kMsgLayoutPending = '_LyP';
+
+// Texts of at least this length are only broken into lines up to a page
+// below the visible part right away, the rest follows in the background in
+// slices of kLayoutSliceTime.
+static const int32 kIncrementalLayoutThreshold = 256 * 1024;
+static const bigtime_t kLayoutSliceTime = 10000;
 
 
 static property_info sPropertyList[] = {
@@ -516,6 +535,11 @@ BTextView::AttachedToWindow()
 	_UpdateScrollbars();
 
 	SetViewCursor(B_CURSOR_SYSTEM_DEFAULT);
+
+	if (fLayoutData->layoutPending && !fLayoutData->layoutQueued
+		&& Looper()->PostMessage(kMsgLayoutPending, this) == B_OK) {
+		fLayoutData->layoutQueued = true;
+	}
 }
 
 
@@ -523,6 +547,8 @@ void
 BTextView::DetachedFromWindow()
 {
 	BView::DetachedFromWindow();
+
+	fLayoutData->layoutQueued = false;
 }
 
 
@@ -1034,6 +1060,11 @@ BTextView::MessageReceived(BMessage* message)
 			break;
 		}
 
+		case kMsgLayoutPending:
+			fLayoutData->layoutQueued = false;
+			_LayoutPending(-1, -1, system_time() + kLayoutSliceTime);
+			break;
+
 		default:
 			BView::MessageReceived(message);
 			break;
@@ -1195,7 +1226,7 @@ BTextView::SetText(BFile* file, int32 offset, int32 length,
 		return;
 
 	// update the start offsets of each line below offset
-	fLines->BumpOffset(length, _LineAt(offset) + 1);
+	fLines->BumpOffset(length, fLines->OffsetToLine(offset) + 1);
 
 	// update the style runs
 	fStyles->BumpOffset(length, fStyles->OffsetToRun(offset - 1) + 1);
@@ -1334,9 +1365,173 @@ BTextView::ByteAt(int32 offset) const
 }
 
 
+/*!	Returns the offset of the first occurrence of \a string that starts at
+	or after \a fromOffset. When searching \a backwards, it returns the last
+	one that ends at or before \a fromOffset instead.
+
+	Unlike searching Text(), this does not need to put the whole text into
+	one piece of memory first.
+
+	\return The offset of the occurrence, or \c B_ERROR if there is none.
+*/
+int32
+BTextView::Find(const char* string, int32 fromOffset, bool caseSensitive,
+	bool backwards) const
+{
+	int32 length = string != NULL ? strlen(string) : 0;
+	if (length == 0)
+		return B_ERROR;
+
+	if (backwards)
+		return fText->FindLast(string, length, fromOffset, caseSensitive);
+
+	return fText->Find(string, length, fromOffset, caseSensitive);
+}
+
+
+/*!	Replaces all occurrences of \a string with \a replacement.
+
+	The text is changed in a single step, no matter how many occurrences
+	there are, and the change can be undone as a whole.
+
+	\return The number of replaced occurrences.
+*/
+int32
+BTextView::ReplaceAll(const char* string, const char* replacement,
+	bool caseSensitive)
+{
+	int32 length = string != NULL ? strlen(string) : 0;
+	int32 replacementLength = replacement != NULL ? strlen(replacement) : 0;
+	if (length == 0)
+		return 0;
+
+	// collect all occurrences first
+	int32* matches = NULL;
+	int32 count = 0;
+	int32 capacity = 0;
+	int32 offset = 0;
+	while ((offset = fText->Find(string, length, offset, caseSensitive))
+			>= 0) {
+		if (count == capacity) {
+			capacity = std::max(capacity * 2, (int32)64);
+			int32* newMatches = (int32*)realloc(matches,
+				capacity * sizeof(int32));
+			if (newMatches == NULL) {
+				free(matches);
+				return 0;
+			}
+			matches = newMatches;
+		}
+		matches[count++] = offset;
+		offset += length;
+	}
+
+	int32 start = count > 0 ? matches[0] : 0;
+	int32 end = count > 0 ? matches[count - 1] + length : 0;
+	int32 newLength = end - start + count * (replacementLength - length);
+	char* text = count > 0 ? (char*)malloc(newLength + 1) : NULL;
+	if (text == NULL
+		|| fText->Length() - (end - start) + newLength > MaxBytes()) {
+		free(matches);
+		free(text);
+		return 0;
+	}
+
+	// build the new text between the first and the last occurrence
+	int32 textOffset = 0;
+	for (int32 i = 0; i < count; i++) {
+		int32 from = i == 0 ? start : matches[i - 1] + length;
+		fText->GetString(from, matches[i] - from, text + textOffset);
+		textOffset += matches[i] - from;
+		memcpy(text + textOffset, replacement, replacementLength);
+		textOffset += replacementLength;
+	}
+
+	// the replacements take the style of the text they replace
+	text_run_array* runs = NULL;
+	int32 runsSize = 0;
+	if (fStylable) {
+		runs = RunArray(start, end, &runsSize);
+		if (runs != NULL) {
+			int32 runCount = 0;
+			for (int32 i = 0; i < runs->count; i++) {
+				int32 runOffset = start + runs->runs[i].offset;
+
+				// the number of occurrences that end before the run
+				int32 before = 0;
+				int32 after = count;
+				while (before < after) {
+					int32 middle = (before + after) / 2;
+					if (matches[middle] + length <= runOffset)
+						before = middle + 1;
+					else
+						after = middle;
+				}
+
+				int32 newOffset = runs->runs[i].offset
+					+ before * (replacementLength - length);
+				if (before < count && matches[before] < runOffset) {
+					// starts within an occurrence, move it behind it
+					newOffset = matches[before] - start
+						+ before * (replacementLength - length)
+						+ replacementLength;
+				}
+				if (newOffset >= newLength && runCount > 0)
+					continue;
+
+				if (runCount > 0 && runs->runs[runCount - 1].offset
+						== newOffset) {
+					runCount--;
+				}
+				runs->runs[runCount] = runs->runs[i];
+				runs->runs[runCount].offset = newOffset;
+				runCount++;
+			}
+			runs->count = runCount;
+		}
+	}
+
+	_CancelInputMethod();
+
+	// hide the caret/unhighlight the selection
+	if (fActive) {
+		if (fSelStart != fSelEnd) {
+			if (fSelectable)
+				Highlight(fSelStart, fSelEnd);
+		} else
+			_HideCaret();
+	}
+
+	// the undo buffer takes the replaced text from the selection
+	fSelStart = start;
+	fSelEnd = end;
+	if (fUndo) {
+		delete fUndo;
+		fUndo = new PasteUndoBuffer(this, text, newLength, runs, runsSize,
+			B_UNDO_REPLACE);
+	}
+
+	DeleteText(start, end);
+	fCaretOffset = fSelEnd = fSelStart = start;
+	InsertText(text, newLength, start, runs);
+		// leaves the caret behind the new text
+
+	// recalculate line breaks and draw the text
+	_Refresh(start, start + newLength, fCaretOffset);
+
+	_ShowCaret();
+
+	FreeRunArray(runs);
+	free(text);
+	free(matches);
+	return count;
+}
+
+
 int32
 BTextView::CountLines() const
 {
+	_LayoutUpToLine(INT32_MAX);
 	return fLines->NumLines();
 }
 
@@ -1934,6 +2129,7 @@ BTextView::OffsetAt(int32 line) const
 	if (line < 0)
 		return 0;
 
+	_LayoutUpToLine(line);
 	if (line > fLines->NumLines())
 		return fText->Length();
 
@@ -2036,6 +2232,7 @@ BTextView::CanEndLine(int32 offset)
 float
 BTextView::LineWidth(int32 lineNumber) const
 {
+	_LayoutUpToLine(lineNumber);
 	if (lineNumber < 0 || lineNumber >= fLines->NumLines())
 		return 0;
 
@@ -2054,6 +2251,7 @@ BTextView::LineWidth(int32 lineNumber) const
 float
 BTextView::LineHeight(int32 lineNumber) const
 {
+	_LayoutUpToLine(lineNumber);
 	float lineHeight = TextHeight(lineNumber, lineNumber);
 	if (lineHeight == 0.0) {
 		// We probably don't have text content yet. Take the initial
@@ -2657,6 +2855,42 @@ BTextView::IsTypingHidden() const
 }
 
 
+/*!	Chooses how the text is stored. The default gap buffer is fastest for
+	editing in one place at a time, the rope keeps edits all over large
+	texts cheap, but needs to copy the text for Text().
+
+	This invalidates the pointer returned by Text().
+*/
+void
+BTextView::SetTextStorage(text_storage storage)
+{
+	if (storage == TextStorage())
+		return;
+
+	BPrivate::TextBuffer* text;
+	if (storage == B_TEXT_STORAGE_ROPE)
+		text = new BPrivate::TextRope;
+	else
+		text = new BPrivate::TextGapBuffer;
+
+	text->InsertText(fText->RealText(), fText->Length(), 0);
+	text->SetPasswordMode(fText->PasswordMode());
+
+	delete fText;
+	fText = text;
+}
+
+
+text_storage
+BTextView::TextStorage() const
+{
+	if (dynamic_cast<BPrivate::TextRope*>(fText) != NULL)
+		return B_TEXT_STORAGE_ROPE;
+
+	return B_TEXT_STORAGE_GAP_BUFFER;
+}
+
+
 // #pragma mark - Size methods
 
 
@@ -2756,8 +2990,8 @@ BTextView::GetHeightForWidth(float width, float* min, float* max,
 		fTextRect.right -= fLayoutData->rightInset;
 	}
 
-	int32 fromLine = _LineAt(0);
-	int32 toLine = _LineAt(fText->Length());
+	int32 fromLine = 0;
+	int32 toLine = fLines->OffsetToLine(fText->Length());
 	_RecalculateLineBreaks(&fromLine, &toLine);
 
 	// If specific insets were set, add the top and bottom margins to the returned preferred height
@@ -3052,7 +3286,7 @@ BTextView::InsertText(const char* text, int32 length, int32 offset,
 		fText->InsertText(text, length, offset);
 
 		// update the start offsets of each line below offset
-		fLines->BumpOffset(length, _LineAt(offset) + 1);
+		fLines->BumpOffset(length, fLines->OffsetToLine(offset) + 1);
 
 		// update the style runs
 		fStyles->BumpOffset(length, fStyles->OffsetToRun(offset - 1) + 1);
@@ -3790,8 +4024,19 @@ BTextView::_HandleAlphaKey(const char* bytes, int32 numBytes)
 			offset++;
 
 		_DoInsertText(bytes, numBytes, fSelStart, NULL);
-		if (start != offset)
-			_DoInsertText(Text() + start, offset - start, fSelStart, NULL);
+		if (start != offset) {
+			// copy just the indentation, Text() would flatten a rope
+			int32 length = offset - start;
+			char stackBuffer[64];
+			char* buffer = length < (int32)sizeof(stackBuffer)
+				? stackBuffer : (char*)malloc(length + 1);
+			if (buffer != NULL) {
+				GetText(start, length, buffer);
+				_DoInsertText(buffer, length, fSelStart, NULL);
+				if (buffer != stackBuffer)
+					free(buffer);
+			}
+		}
 	} else
 		_DoInsertText(bytes, numBytes, fSelStart, NULL);
 
@@ -3817,8 +4062,10 @@ BTextView::_Refresh(int32 fromOffset, int32 toOffset, int32 scrollTo)
 	// TODO: Cleanup
 	float saveHeight = fTextRect.Height();
 	float saveWidth = fTextRect.Width();
-	int32 fromLine = _LineAt(fromOffset);
-	int32 toLine = _LineAt(toOffset);
+	// the lines that have not been laid out yet are left to
+	// _RecalculateLineBreaks(), so use the line buffer directly
+	int32 fromLine = fLines->OffsetToLine(fromOffset);
+	int32 toLine = fLines->OffsetToLine(toOffset);
 	int32 saveFromLine = fromLine;
 	int32 saveToLine = toLine;
 
@@ -3840,14 +4087,14 @@ BTextView::_Refresh(int32 fromOffset, int32 toOffset, int32 scrollTo)
 	if (newHeight != saveHeight) {
 		// the text area has changed
 		if (newHeight < saveHeight)
-			toLine = _LineAt(BPoint(0.0f, saveHeight + fTextRect.top));
+			toLine = fLines->PixelToLine(saveHeight);
 		else
-			toLine = _LineAt(BPoint(0.0f, newHeight + fTextRect.top));
+			toLine = fLines->PixelToLine(newHeight);
 	}
 
 	// draw only those lines that are visible
-	int32 fromVisible = _LineAt(BPoint(0.0f, bounds.top));
-	int32 toVisible = _LineAt(BPoint(0.0f, bounds.bottom));
+	int32 fromVisible = fLines->PixelToLine(bounds.top - fTextRect.top);
+	int32 toVisible = fLines->PixelToLine(bounds.bottom - fTextRect.top);
 	fromLine = std::max(fromVisible, fromLine);
 	toLine = std::min(toLine, toVisible);
 
@@ -3902,6 +4149,20 @@ BTextView::_RecalculateLineBreaks(int32* startLine, int32* endLine)
 	STELine* curLine = (*fLines)[lineIndex];
 	STELine* nextLine = curLine + 1;
 
+	// long texts are only broken up to a page below the visible part (or
+	// as far as _LayoutPending() asks for), the rest is left for later
+	bool incremental = textLength >= kIncrementalLayoutThreshold
+		&& Looper() != NULL;
+	int32 untilOffset = -1;
+	float untilY = Bounds().bottom - fTextRect.top + Bounds().Height();
+	bigtime_t deadline = 0;
+	if (fLayoutData->layoutLimited) {
+		untilOffset = fLayoutData->layoutUntilOffset;
+		untilY = fLayoutData->layoutUntilY;
+		deadline = fLayoutData->layoutDeadline;
+	}
+	bool truncated = false;
+
 	do {
 		float ascent, descent;
 		int32 fromOffset = curLine->offset;
@@ -3951,8 +4212,37 @@ BTextView::_RecalculateLineBreaks(int32* startLine, int32* endLine)
 
 		curLine = (*fLines)[lineIndex];
 		nextLine = curLine + 1;
+
+		if (incremental && curLine->offset < textLength
+			&& curLine->offset > untilOffset && curLine->origin > untilY
+			&& (deadline == 0 || system_time() >= deadline)) {
+			truncated = true;
+			break;
+		}
 	} while (curLine->offset < textLength);
 
+	if (truncated) {
+		// Drop the old lines below the current one, which starts the part
+		// that still needs to be laid out. Its height is estimated from the
+		// lines we have so far.
+		int32 count = fLines->NumLines() - 1 - lineIndex;
+		if (count > 0)
+			fLines->RemoveLines(lineIndex + 1, count);
+
+		curLine = (*fLines)[lineIndex];
+		curLine->ascent = 0;
+		curLine->width = 0;
+		(curLine + 1)->origin = curLine->origin + ceilf(curLine->origin
+			* ((float)(textLength - curLine->offset) / curLine->offset));
+
+		fLayoutData->layoutPending = true;
+		if (!fLayoutData->layoutQueued
+			&& Looper()->PostMessage(kMsgLayoutPending, this) == B_OK) {
+			fLayoutData->layoutQueued = true;
+		}
+	} else if ((*fLines)[lineIndex]->offset >= textLength)
+		fLayoutData->layoutPending = false;
+
 	// make sure that the sentinel line (which starts at the end of the buffer)
 	// has always a width of 0
 	(*fLines)[fLines->NumLines()]->width = 0;
@@ -3996,6 +4286,52 @@ BTextView::_RecalculateLineBreaks(int32* startLine, int32* endLine)
 }
 
 
+/*!	Breaks the part of the text that has not been laid out yet into lines,
+	until the line containing \a offset, and the line at \a y (relative to
+	the text rect) are known. If a \a deadline is given, it instead lays out
+	as much as it can until then.
+*/
+void
+BTextView::_LayoutPending(int32 offset, float y, bigtime_t deadline)
+{
+	if (!fLayoutData->layoutPending || fLayoutData->layoutLimited)
+		return;
+
+	int32 startLine = fLines->NumLines() - 1;
+	const STELine* pending = (*fLines)[startLine];
+	if (deadline == 0 && offset < pending->offset && y < pending->origin)
+		return;
+
+	float saveWidth = fTextRect.Width();
+
+	fLayoutData->layoutLimited = true;
+	fLayoutData->layoutUntilOffset = offset;
+	fLayoutData->layoutUntilY = y;
+	fLayoutData->layoutDeadline = deadline;
+
+	int32 endLine = startLine;
+	_RecalculateLineBreaks(&startLine, &endLine);
+
+	fLayoutData->layoutLimited = false;
+
+	if (Window() != NULL) {
+		if (fTextRect.Width() != saveWidth)
+			Invalidate();
+		_UpdateScrollbars();
+	}
+}
+
+
+//!	Makes sure that all lines up to \a line have been laid out.
+void
+BTextView::_LayoutUpToLine(int32 line) const
+{
+	// there is no telling which line number the pending text starts with
+	if (fLayoutData->layoutPending && line >= fLines->NumLines() - 1)
+		const_cast<BTextView*>(this)->_LayoutPending(INT32_MAX, -1, 0);
+}
+
+
 void
 BTextView::_ValidateTextRect()
 {
@@ -5877,6 +6213,9 @@ BTextView::_CancelInputMethod()
 int32
 BTextView::_LineAt(int32 offset) const
 {
+	if (fLayoutData->layoutPending)
+		const_cast<BTextView*>(this)->_LayoutPending(offset, -1, 0);
+
 	return fLines->OffsetToLine(offset);
 }
 
@@ -5893,6 +6232,13 @@ BTextView::_LineAt(int32 offset) const
 int32
 BTextView::_LineAt(const BPoint& point) const
 {
+	if (fLayoutData->layoutPending) {
+		// lay out an extra page, so that scrolling doesn't need to do it
+		// for every line
+		const_cast<BTextView*>(this)->_LayoutPending(-1,
+			point.y - fTextRect.top + Bounds().Height(), 0);
+	}
+
 	return fLines->PixelToLine(point.y - fTextRect.top);
 }
 
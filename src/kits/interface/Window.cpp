@@ -27,6 +27,7 @@
 #include <Deskbar.h>
 #include <DirectMessageTarget.h>
 #include <FindDirectory.h>
+#include <InputLatency.h>
 #include <InputServerTypes.h>
 #include <Layout.h>
 #include <LayoutUtils.h>
@@ -72,6 +73,8 @@
 #define _SEND_BEHIND_		'_WSB'
 #define _SEND_TO_FRONT_		'_WSF'
 
+static const bigtime_t kInputLatencyReportInterval = 1000000;
+
 
 void do_minimize_team(BRect zoomRect, team_id team, bool zoom);
 
@@ -449,6 +452,8 @@ BWindow::~BWindow()
 	// the sender port belongs to the app_server
 	delete_port(fLink->ReceiverPort());
 	delete fLink;
+
+	delete fInputLatency;
 }
 
 
@@ -2808,6 +2813,9 @@ BWindow::_InitData(BRect frame, const char* title, window_look look,
 	fPulseRate = 500000;
 	fPulseRunner = NULL;
 
+	fInputLatency = NULL;
+	fInputLatencyReported = 0;
+
 	fIsFilePanel = false;
 
 	fMenuSem = -1;
@@ -3007,6 +3015,8 @@ BWindow::task_looper()
 				// dispatch loop.
 				dispatchNextMessage = false;
 			} else {
+				_AccountInputLatency(fLastMessage);
+
 				// Get the target handler
 				BMessage::Private messagePrivate(fLastMessage);
 				bool usePreferred = messagePrivate.UsePreferredTarget();
@@ -4121,6 +4131,55 @@ BWindow::_PropagateMessageToChildViews(BMessage* message)
 }
 
 
+/*!	Accounts the time an input event took from the kernel to the window's
+	message loop, and reports the collected latencies to the app_server
+	about once a second.
+	The window must be locked.
+*/
+void
+BWindow::_AccountInputLatency(BMessage* message)
+{
+	switch (message->what) {
+		case B_MOUSE_MOVED:
+		case B_MOUSE_DOWN:
+		case B_MOUSE_UP:
+		case B_MOUSE_WHEEL_CHANGED:
+		case B_KEY_DOWN:
+		case B_KEY_UP:
+		case B_UNMAPPED_KEY_DOWN:
+		case B_UNMAPPED_KEY_UP:
+		case B_MODIFIERS_CHANGED:
+			break;
+		default:
+			return;
+	}
+
+	bigtime_t when = message->GetInt64("when", 0);
+	if (when <= 0 || fOffscreen)
+		return;
+
+	if (fInputLatency == NULL) {
+		fInputLatency = new(std::nothrow) InputLatencyHistogram;
+		if (fInputLatency == NULL)
+			return;
+		fInputLatency->Reset();
+	}
+
+	bigtime_t now = system_time();
+	fInputLatency->Add(now - when);
+
+	if (now - fInputLatencyReported < kInputLatencyReportInterval)
+		return;
+
+	fLink->StartMessage(AS_REPORT_INPUT_LATENCY);
+	fLink->Attach<InputLatencyHistogram>(*fInputLatency);
+	fLink->Flush();
+
+	fInputLatency->Reset();
+	fInputLatencyReported = now;
+}
+
+
 //	#pragma mark - C++ binary compatibility kludge
 
 
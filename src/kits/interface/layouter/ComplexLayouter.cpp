@@ -32,6 +32,10 @@
 using std::nothrow;
 
 
+// the number of layouts for different sizes each layouter remembers
+static const int32 kLayoutCacheSize = 8;
+
+
 // MyLayoutInfo
 class ComplexLayouter::MyLayoutInfo : public LayoutInfo {
 public:
@@ -168,6 +172,9 @@ ComplexLayouter::ComplexLayouter(int32 elementCount, float spacing)
 	  fSums(new(nothrow) SumItem[elementCount + 1]),
 	  fSumBackups(new(nothrow) SumItemBackup[elementCount + 1]),
 	  fOptimizer(new(nothrow) LayoutOptimizer(elementCount)),
+	  fLayoutCache(new(nothrow) int32[kLayoutCacheSize * (elementCount + 1)]),
+	  fLayoutCacheCount(0),
+	  fNextLayoutCacheEntry(0),
 	  fUnlimited((int32)B_SIZE_UNLIMITED / (elementCount == 0 ? 1 : elementCount)),
 	  fMinMaxValid(false),
 	  fOptimizerConstraintsAdded(false)
@@ -200,6 +207,7 @@ ComplexLayouter::~ComplexLayouter()
 	delete[] fSums;
 	delete[] fSumBackups;
   	delete fOptimizer;
+	delete[] fLayoutCache;
 }
 
 
@@ -207,8 +215,10 @@ ComplexLayouter::~ComplexLayouter()
 status_t
 ComplexLayouter::InitCheck() const
 {
-	if (!fConstraints || !fWeights || !fSums || !fSumBackups || !fOptimizer)
+	if (!fConstraints || !fWeights || !fSums || !fSumBackups || !fOptimizer
+		|| !fLayoutCache) {
 		return B_NO_MEMORY;
+	}
 	return fOptimizer->InitCheck();
 }
 
@@ -252,6 +262,7 @@ ComplexLayouter::AddConstraints(int32 element, int32 length,
 	}
 
 	fMinMaxValid = false;
+	fLayoutCacheCount = 0;
 }
 
 
@@ -263,6 +274,7 @@ ComplexLayouter::SetWeight(int32 element, float weight)
 		return;
 
 	fWeights[element] = max_c(weight, 0);
+	fLayoutCacheCount = 0;
 }
 
 
@@ -329,6 +341,22 @@ ComplexLayouter::Layout(LayoutInfo* _layoutInfo, float _size)
 	if (size > max)
 		size = max;
 
+	// While a window is resized, we often get to see the same sizes again
+	int32 sizes[fElementCount];
+	if (_GetCachedLayout(size, sizes)) {
+		layoutInfo->InitFromSizes(sizes);
+		return;
+	}
+
+	// If the size distributed according to the weights already satisfies all
+	// constraints, none of them is active, and there is nothing to solve.
+	SimpleLayouter::DistributeSize(size, fWeights, sizes, fElementCount);
+	if (_SatisfiesConstraints(sizes)) {
+		_CacheLayout(size, sizes);
+		layoutInfo->InitFromSizes(sizes);
+		return;
+	}
+
 	SumItem sums[fElementCount + 1];
 	memcpy(sums, fSums, (fElementCount + 1) * sizeof(SumItem));
 
@@ -349,9 +377,8 @@ ComplexLayouter::Layout(LayoutInfo* _layoutInfo, float _size)
 	}
 #endif
 
-	int32 sizes[fElementCount];
-	if (!_Layout(size, sums, sizes)) {
-	}
+	if (_Layout(size, sums, sizes))
+		_CacheLayout(size, sizes);
 
 	layoutInfo->InitFromSizes(sizes);
 }
@@ -398,16 +425,12 @@ ComplexLayouter::CloneLayouter()
 
 
 // _Layout
+/*!	Computes the sizes that satisfy the constraints and are closest to the
+	desired solution \a sizes contains when called.
+*/
 bool
 ComplexLayouter::_Layout(int32 size, SumItem* sums, int32* sizes)
 {
-	// prepare the desired solution
-	SimpleLayouter::DistributeSize(size, fWeights, sizes, fElementCount);
-	if (_SatisfiesConstraints(sizes)) {
-		// The desired solution already satisfies all constraints.
-		return true;
-	}
-
 	double realSizes[fElementCount];
 	for (int32 i = 0; i < fElementCount; i++)
 		realSizes[i] = sizes[i];
@@ -458,6 +481,42 @@ ComplexLayouter::_Layout(int32 size, SumItem* sums, int32* sizes)
 }
 
 
+// _GetCachedLayout
+bool
+ComplexLayouter::_GetCachedLayout(int32 size, int32* sizes) const
+{
+	for (int32 i = 0; i < fLayoutCacheCount; i++) {
+		const int32* entry = fLayoutCache + i * (fElementCount + 1);
+		if (entry[0] == size) {
+			memcpy(sizes, entry + 1, fElementCount * sizeof(int32));
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+// _CacheLayout
+void
+ComplexLayouter::_CacheLayout(int32 size, const int32* sizes)
+{
+	// once the cache is full, replace the oldest entry
+	int32 index = fLayoutCacheCount;
+	if (index < kLayoutCacheSize) {
+		fLayoutCacheCount++;
+		fNextLayoutCacheEntry = 0;
+	} else {
+		index = fNextLayoutCacheEntry;
+		fNextLayoutCacheEntry = (index + 1) % kLayoutCacheSize;
+	}
+
+	int32* entry = fLayoutCache + index * (fElementCount + 1);
+	entry[0] = size;
+	memcpy(entry + 1, sizes, fElementCount * sizeof(int32));
+}
+
+
 // _AddOptimizerConstraints
 bool
 ComplexLayouter::_AddOptimizerConstraints()
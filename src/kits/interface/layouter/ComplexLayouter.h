@@ -47,6 +47,9 @@ private:
 
 			bool				_Layout(int32 size, SumItem* sums,
 									int32* sizes);
+			bool				_GetCachedLayout(int32 size,
+									int32* sizes) const;
+			void				_CacheLayout(int32 size, const int32* sizes);
 			bool				_AddOptimizerConstraints();
 			bool				_SatisfiesConstraints(int32* sizes) const;
 			bool				_SatisfiesConstraintsSums(int32* sums) const;
@@ -71,6 +74,9 @@ private:
 			SumItem*			fSums;
 			SumItemBackup*		fSumBackups;
 			LayoutOptimizer*	fOptimizer;
+			int32*				fLayoutCache;
+			int32				fLayoutCacheCount;
+			int32				fNextLayoutCacheEntry;
 			float				fMin;
 			float				fMax;
 			int32				fUnlimited;
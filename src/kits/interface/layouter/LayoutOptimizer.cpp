@@ -57,6 +57,12 @@ using std::nothrow;
 	computed solution. With the adjusted respectively unadjusted solution
 	we enter the next iteration, i.e. by computing a new optimal solution with
 	respect to the active set.
+
+	Consecutive calls with the same constraints, like while a window is being
+	resized, tend to end up with the same active set. Therefore the method
+	doesn't start at the given feasible solution, but moves from there as far
+	towards the previous optimal solution as the constraints allow, and starts
+	with the constraints that are active at that point.
 */
 
 
@@ -532,7 +538,10 @@ struct LayoutOptimizer::Constraint {
 LayoutOptimizer::LayoutOptimizer(int32 variableCount)
 	: fVariableCount(variableCount),
 	  fConstraints(),
-	  fVariables(new (nothrow) double[variableCount])
+	  fVariables(new (nothrow) double[variableCount]),
+	  fPreviousStart(new (nothrow) double[variableCount]),
+	  fPreviousSolution(new (nothrow) double[variableCount]),
+	  fPreviousValid(false)
 {
 	fTemp1 = allocate_matrix(fVariableCount, fVariableCount);
 	fTemp2 = allocate_matrix(fVariableCount, fVariableCount);
@@ -550,6 +559,8 @@ LayoutOptimizer::~LayoutOptimizer()
 	free_matrix(fQ);
 
 	delete[] fVariables;
+	delete[] fPreviousStart;
+	delete[] fPreviousSolution;
 
 	for (int32 i = 0;
 		 Constraint* constraint = (Constraint*)fConstraints.ItemAt(i);
@@ -563,8 +574,10 @@ LayoutOptimizer::~LayoutOptimizer()
 status_t
 LayoutOptimizer::InitCheck() const
 {
-	if (!fVariables || !fTemp1 || !fTemp2 || !fZtrans || !fQ)
+	if (!fVariables || !fPreviousStart || !fPreviousSolution || !fTemp1
+		|| !fTemp2 || !fZtrans || !fQ) {
 		return B_NO_MEMORY;
+	}
 	return B_OK;
 }
 
@@ -604,6 +617,7 @@ LayoutOptimizer::AddConstraint(int32 left, int32 right, double value,
 		return false;
 	}
 
+	fPreviousValid = false;
 	return true;
 }
 
@@ -615,7 +629,7 @@ LayoutOptimizer::AddConstraintsFrom(const LayoutOptimizer* other)
 	if (!other || other->fVariableCount != fVariableCount)
 		return false;
 
-	int32 count = fConstraints.CountItems();
+	int32 count = other->fConstraints.CountItems();
 	for (int32 i = 0; i < count; i++) {
 		Constraint* constraint = (Constraint*)other->fConstraints.ItemAt(i);
 		if (!AddConstraint(constraint->left, constraint->right,
@@ -638,6 +652,7 @@ LayoutOptimizer::RemoveAllConstraints()
 		delete constraint;
 	}
 	fConstraints.MakeEmpty();
+	fPreviousValid = false;
 }
 
 
@@ -666,23 +681,26 @@ LayoutOptimizer::Solve(const double* desired, double size, double* values)
 		return false;
 
 	// add sum constraint
+	bool warmStart = fPreviousValid;
 	if (!AddConstraint(-1, fVariableCount - 1, size, true))
 		return false;
 
-	bool success = _Solve(desired, values);
+	bool success = _Solve(desired, values, warmStart);
 
 	// remove sum constraint
 	Constraint* constraint = (Constraint*)fConstraints.RemoveItem(
 		constraintCount - 1);
 	delete constraint;
 
+	fPreviousValid = success;
 	return success;
 }
 
 
 // _Solve
 bool
-LayoutOptimizer::_Solve(const double* desired, double* values)
+LayoutOptimizer::_Solve(const double* desired, double* values,
+	bool warmStart)
 {
 	int32 constraintCount = fConstraints.CountItems();
 
@@ -705,6 +723,11 @@ TRACE_ONLY(
 	for (int i = 1; i < fVariableCount; i++)
 		x[i] = values[i] + x[i - 1];
 
+	double start[fVariableCount];
+	memcpy(start, x, sizeof(start));
+	if (warmStart)
+		_WarmStart(x);
+
 	// init d
 	// Note that the values of d and of G result from rewriting the
 	// ||x - desired|| we actually want to minimize.
@@ -844,6 +867,10 @@ TRACE_ONLY(
 			// if the min lambda is >= 0, we're done
 			if (minIndex < 0 || fuzzy_equals(minLambda, 0)) {
 				_SetResult(x, values);
+
+				// remember where we started and ended up for the next time
+				memcpy(fPreviousStart, start, sizeof(start));
+				memcpy(fPreviousSolution, x, sizeof(x));
 				return true;
 			}
 
@@ -947,6 +974,49 @@ LayoutOptimizer::_SolveSubProblem(const double* d, int am, double* p)
 }
 
 
+// _WarmStart
+/*!	Moves the feasible solution \a x towards the previous optimal solution,
+	as far as it remains feasible.
+
+	The previous solution is shifted by the same amount the feasible solution
+	differs from the previous one, so that it satisfies the equality
+	constraints, including the sum. The inequality constraints only limit how
+	far we can go.
+*/
+void
+LayoutOptimizer::_WarmStart(double* x) const
+{
+	double direction[fVariableCount];
+	for (int i = 0; i < fVariableCount; i++)
+		direction[i] = fPreviousSolution[i] - fPreviousStart[i];
+
+	double alpha = 1;
+	int32 constraintCount = fConstraints.CountItems();
+	for (int32 i = 0; i < constraintCount; i++) {
+		Constraint* constraint = (Constraint*)fConstraints.ItemAt(i);
+		double divider = constraint->ActualValue(direction);
+		if (constraint->equality) {
+			if (!fuzzy_equals(divider, 0))
+				return;
+			continue;
+		}
+
+		if (divider > 0 || fuzzy_equals(divider, 0))
+			continue;
+
+		double alphaI = (constraint->value - constraint->ActualValue(x))
+			/ divider;
+		if (alphaI < alpha)
+			alpha = alphaI;
+	}
+
+	if (alpha > 0)
+		add_vectors_scaled(x, direction, alpha, fVariableCount);
+
+	TRACE("warm start: alpha: %f\n", alpha);
+}
+
+
 // _SetResult
 void
 LayoutOptimizer::_SetResult(const double* x, double* values)
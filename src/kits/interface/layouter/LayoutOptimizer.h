@@ -33,7 +33,9 @@ public:
 									double* values);
 
 private:
-			bool				_Solve(const double* desired, double* values);
+			bool				_Solve(const double* desired, double* values,
+									bool warmStart);
+			void				_WarmStart(double* x) const;
 			bool				_SolveSubProblem(const double* d, int am,
 									double* p);
 			void				_SetResult(const double* x, double* values);
@@ -44,6 +46,9 @@ private:
 			int32				fVariableCount;
 			BList				fConstraints;
 			double*				fVariables;
+			double*				fPreviousStart;
+			double*				fPreviousSolution;
+			bool				fPreviousValid;
 			double**			fTemp1;
 			double**			fTemp2;
 			double**			fZtrans;
@@ -0,0 +1,322 @@
+/*
+ * Copyright 2001-2006, Haiku, Inc. All Rights Reserved.
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Authors:
+ *		Marc Flerackers (mflerackers@androme.be)
+ *		Stefano Ceccherini (stefano.ceccherini@gmail.com)
+ */
+
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+#include <utf8_functions.h>
+
+#include <InterfaceDefs.h> // for B_UTF8_BULLET
+
+#include "TextBuffer.h"
+
+
+namespace BPrivate {
+
+
+// FindLast() searches backwards in blocks of this size
+static const int32 kFindLastBlockSize = 64 * 1024;
+
+
+TextBuffer::TextBuffer()
+	:
+	fItemCount(0),
+	fScratchBuffer(NULL),
+	fScratchSize(0),
+	fPasswordMode(false)
+{
+}
+
+
+TextBuffer::~TextBuffer()
+{
+	free(fScratchBuffer);
+}
+
+
+bool
+TextBuffer::FindChar(char inChar, int32 fromIndex, int32* ioDelta)
+{
+	// the trailing bytes of a multibyte character are never a match
+	if ((inChar & 0xc0) == 0x80)
+		return false;
+
+	int32 end = fromIndex + *ioDelta;
+	if (end > fItemCount)
+		end = fItemCount;
+
+	int32 offset = fromIndex;
+	while (offset < end) {
+		int32 length;
+		const char* segment = Segment(offset, &length);
+		if (length < 1)
+			break;
+		if (length > end - offset)
+			length = end - offset;
+
+		const char* found = (const char*)memchr(segment, inChar, length);
+		if (found != NULL) {
+			*ioDelta = offset + (found - segment) - fromIndex;
+			return true;
+		}
+		offset += length;
+	}
+
+	return false;
+}
+
+
+/*!	Returns the offset of the first occurrence of \a string that starts at
+	or after \a fromOffset, or \c B_ERROR if there is none.
+*/
+int32
+TextBuffer::Find(const char* string, int32 length, int32 fromOffset,
+	bool caseSensitive) const
+{
+	if (fromOffset < 0)
+		fromOffset = 0;
+
+	return _Find(string, length, fromOffset, fItemCount - length,
+		caseSensitive);
+}
+
+
+/*!	Returns the offset of the last occurrence of \a string that ends at or
+	before \a beforeOffset, or \c B_ERROR if there is none.
+*/
+int32
+TextBuffer::FindLast(const char* string, int32 length, int32 beforeOffset,
+	bool caseSensitive) const
+{
+	if (beforeOffset > fItemCount)
+		beforeOffset = fItemCount;
+
+	int32 lastOffset = beforeOffset - length;
+	while (lastOffset >= 0) {
+		int32 blockOffset = lastOffset - kFindLastBlockSize;
+		if (blockOffset < 0)
+			blockOffset = 0;
+
+		int32 found = B_ERROR;
+		int32 offset = blockOffset;
+		while ((offset = _Find(string, length, offset, lastOffset,
+				caseSensitive)) >= 0) {
+			found = offset++;
+		}
+		if (found >= 0)
+			return found;
+
+		lastOffset = blockOffset - 1;
+	}
+
+	return B_ERROR;
+}
+
+
+const char*
+TextBuffer::Text()
+{
+	const char* realText = RealText();
+
+	if (fPasswordMode) {
+		const uint32 numChars = UTF8CountChars(realText, Length());
+		const uint32 bulletCharLen = UTF8CountBytes(B_UTF8_BULLET, 1);
+		uint32 newSize = numChars * bulletCharLen + 1;
+
+		char* scratchPtr = _ScratchBuffer(newSize);
+		for (uint32 i = 0; i < numChars; i++) {
+			memcpy(scratchPtr, B_UTF8_BULLET, bulletCharLen);
+			scratchPtr += bulletCharLen;
+		}
+		*scratchPtr = '\0';
+
+		return fScratchBuffer;
+	}
+
+	return realText;
+}
+
+
+const char*
+TextBuffer::GetString(int32 fromOffset, int32* _numBytes)
+{
+	const char* result = "";
+	if (_numBytes == NULL)
+		return result;
+
+	int32 numBytes = *_numBytes;
+	if (numBytes < 1)
+		return result;
+
+	int32 segmentLength;
+	result = Segment(fromOffset, &segmentLength);
+	if (segmentLength < numBytes) {
+		// the string is split over several segments
+		char* scratch = _ScratchBuffer(numBytes + 1);
+		GetString(fromOffset, numBytes, scratch);
+		result = scratch;
+	}
+
+	// TODO: this could be improved. We are overwriting what we did some lines
+	// ago, we could just avoid to do that.
+	if (fPasswordMode) {
+		uint32 numChars = UTF8CountChars(result, numBytes);
+		uint32 charLen = UTF8CountBytes(B_UTF8_BULLET, 1);
+		uint32 newSize = numChars * charLen;
+
+		char* scratchPtr = _ScratchBuffer(newSize);
+		result = scratchPtr;
+
+		for (uint32 i = 0; i < numChars; i++) {
+			memcpy(scratchPtr, B_UTF8_BULLET, charLen);
+			scratchPtr += charLen;
+		}
+
+		*_numBytes = newSize;
+	}
+
+	return result;
+}
+
+
+void
+TextBuffer::GetString(int32 offset, int32 length, char* buffer)
+{
+	if (buffer == NULL)
+		return;
+
+	int32 textLen = Length();
+
+	if (offset < 0 || offset > (textLen - 1) || length < 1) {
+		buffer[0] = '\0';
+		return;
+	}
+
+	length = ((offset + length) > textLen) ? textLen - offset : length;
+
+	int32 copied = 0;
+	while (copied < length) {
+		int32 segmentLength;
+		const char* segment = Segment(offset + copied, &segmentLength);
+		if (segmentLength > length - copied)
+			segmentLength = length - copied;
+
+		memcpy(buffer + copied, segment, segmentLength);
+		copied += segmentLength;
+	}
+
+	buffer[length] = '\0';
+}
+
+
+bool
+TextBuffer::PasswordMode() const
+{
+	return fPasswordMode;
+}
+
+
+void
+TextBuffer::SetPasswordMode(bool state)
+{
+	fPasswordMode = state;
+}
+
+
+//!	Searches for a \a string starting between \a fromOffset and \a lastOffset.
+int32
+TextBuffer::_Find(const char* string, int32 length, int32 fromOffset,
+	int32 lastOffset, bool caseSensitive) const
+{
+	if (length < 1)
+		return B_ERROR;
+
+	const char first = string[0];
+	const int lowerFirst = tolower((unsigned char)first);
+
+	int32 offset = fromOffset;
+	while (offset <= lastOffset) {
+		int32 segmentLength;
+		const char* segment = Segment(offset, &segmentLength);
+		if (segmentLength < 1)
+			break;
+		if (segmentLength > lastOffset + 1 - offset)
+			segmentLength = lastOffset + 1 - offset;
+
+		// look for the first character, and compare the rest from there
+		for (int32 i = 0; i < segmentLength; i++) {
+			if (caseSensitive) {
+				const char* found = (const char*)memchr(segment + i, first,
+					segmentLength - i);
+				if (found == NULL)
+					break;
+				i = found - segment;
+			} else if (tolower((unsigned char)segment[i]) != lowerFirst)
+				continue;
+
+			if (_Matches(offset + i, string, length, caseSensitive))
+				return offset + i;
+		}
+
+		offset += segmentLength;
+	}
+
+	return B_ERROR;
+}
+
+
+bool
+TextBuffer::_Matches(int32 offset, const char* string, int32 length,
+	bool caseSensitive) const
+{
+	while (length > 0) {
+		int32 segmentLength;
+		const char* segment = Segment(offset, &segmentLength);
+		if (segmentLength < 1)
+			return false;
+		if (segmentLength > length)
+			segmentLength = length;
+
+		if (caseSensitive) {
+			if (memcmp(segment, string, segmentLength) != 0)
+				return false;
+		} else {
+			for (int32 i = 0; i < segmentLength; i++) {
+				if (tolower((unsigned char)segment[i])
+					!= tolower((unsigned char)string[i])) {
+					return false;
+				}
+			}
+		}
+
+		offset += segmentLength;
+		string += segmentLength;
+		length -= segmentLength;
+	}
+
+	return true;
+}
+
+
+char*
+TextBuffer::_ScratchBuffer(int32 size)
+{
+	if (fScratchSize < size) {
+		fScratchBuffer = (char*)realloc(fScratchBuffer, size);
+		fScratchSize = size;
+	}
+
+	return fScratchBuffer;
+}
+
+
+} // namespace BPrivate
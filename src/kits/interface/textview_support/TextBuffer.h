@@ -0,0 +1,84 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef __TEXTBUFFER_H
+#define __TEXTBUFFER_H
+
+
+#include <SupportDefs.h>
+
+
+class BFile;
+
+
+namespace BPrivate {
+
+
+// The text storage of a BTextView. Implementations only need to provide
+// the editing primitives, and access to the contiguous segments the text
+// is stored in; everything else is built on top of that.
+class TextBuffer {
+public:
+								TextBuffer();
+	virtual						~TextBuffer();
+
+	virtual	void				InsertText(const char* inText, int32 inNumItems,
+									int32 inAtIndex) = 0;
+	virtual	bool				InsertText(BFile* file, int32 fileOffset,
+									int32 amount, int32 atIndex) = 0;
+	virtual	void				RemoveRange(int32 start, int32 end) = 0;
+
+	virtual	const char*			RealText() = 0;
+	virtual	const char*			Segment(int32 offset, int32* _length) const
+									= 0;
+									// the contiguous part of the text that
+									// starts at offset
+	virtual	char				RealCharAt(int32 offset) const = 0;
+
+			bool				FindChar(char inChar, int32 fromIndex,
+									int32* ioDelta);
+			int32				Find(const char* string, int32 length,
+									int32 fromOffset, bool caseSensitive) const;
+			int32				FindLast(const char* string, int32 length,
+									int32 beforeOffset,
+									bool caseSensitive) const;
+
+			const char*			Text();
+			int32				Length() const;
+
+			const char*			GetString(int32 fromOffset, int32* numBytes);
+			void				GetString(int32 offset, int32 length,
+									char* buffer);
+
+			bool				PasswordMode() const;
+			void				SetPasswordMode(bool);
+
+protected:
+			int32				fItemCount;			// logical count
+
+private:
+			int32				_Find(const char* string, int32 length,
+									int32 fromOffset, int32 lastOffset,
+									bool caseSensitive) const;
+			bool				_Matches(int32 offset, const char* string,
+									int32 length, bool caseSensitive) const;
+			char*				_ScratchBuffer(int32 size);
+
+			char*				fScratchBuffer;		// for GetString
+			int32				fScratchSize;		// scratch size
+			bool				fPasswordMode;
+};
+
+
+inline int32
+TextBuffer::Length() const
+{
+	return fItemCount;
+}
+
+
+} // namespace BPrivate
+
+
+#endif //__TEXTBUFFER_H
@@ -12,10 +12,7 @@
 #include <cstdlib>
 #include <cstring>
 
-#include <utf8_functions.h>
-
 #include <File.h>
-#include <InterfaceDefs.h> // for B_UTF8_BULLET
 
 #include "TextGapBuffer.h"
 
@@ -28,24 +25,18 @@ static const int32 kTextGapBufferBlockSize = 2048;
 
 TextGapBuffer::TextGapBuffer()
 	:
-	fItemCount(0),
 	fBuffer(NULL),
 	fBufferCount(kTextGapBufferBlockSize + fItemCount),
 	fGapIndex(fItemCount),
-	fGapCount(fBufferCount - fGapIndex),
-	fScratchBuffer(NULL),
-	fScratchSize(0),
-	fPasswordMode(false)
+	fGapCount(fBufferCount - fGapIndex)
 {
 	fBuffer = (char*)malloc(kTextGapBufferBlockSize + fItemCount);
-	fScratchBuffer = NULL;
 }
 
 
 TextGapBuffer::~TextGapBuffer()
 {
 	free(fBuffer);
-	free(fScratchBuffer);
 }
 
 
@@ -133,109 +124,6 @@ TextGapBuffer::RemoveRange(int32 start, int32 end)
 }
 
 
-const char*
-TextGapBuffer::GetString(int32 fromOffset, int32* _numBytes)
-{
-	const char* result = "";
-	if (_numBytes == NULL)
-		return result;
-
-	int32 numBytes = *_numBytes;
-	if (numBytes < 1)
-		return result;
-
-	bool isStartBeforeGap = fromOffset < fGapIndex;
-	bool isEndBeforeGap = (fromOffset + numBytes - 1) < fGapIndex;
-
-	if (isStartBeforeGap == isEndBeforeGap) {
-		result = fBuffer + fromOffset;
-		if (!isStartBeforeGap)
-			result += fGapCount;
-	} else {
-		if (fScratchSize < numBytes) {
-			fScratchBuffer = (char*)realloc(fScratchBuffer, numBytes);
-			fScratchSize = numBytes;
-		}
-
-		for (int32 i = 0; i < numBytes; i++)
-			fScratchBuffer[i] = RealCharAt(fromOffset + i);
-
-		result = fScratchBuffer;
-	}
-
-	// TODO: this could be improved. We are overwriting what we did some lines
-	// ago, we could just avoid to do that.
-	if (fPasswordMode) {
-		uint32 numChars = UTF8CountChars(result, numBytes);
-		uint32 charLen = UTF8CountBytes(B_UTF8_BULLET, 1);
-		uint32 newSize = numChars * charLen;
-
-		if ((uint32)fScratchSize < newSize) {
-			fScratchBuffer = (char*)realloc(fScratchBuffer, newSize);
-			fScratchSize = newSize;
-		}
-		result = fScratchBuffer;
-
-		char* scratchPtr = fScratchBuffer;
-		for (uint32 i = 0; i < numChars; i++) {
-			memcpy(scratchPtr, B_UTF8_BULLET, charLen);
-			scratchPtr += charLen;
-		}
-
-		*_numBytes = newSize;
-	}
-
-	return result;
-}
-
-
-bool
-TextGapBuffer::FindChar(char inChar, int32 fromIndex, int32* ioDelta)
-{
-	int32 numChars = *ioDelta;
-	for (int32 i = 0; i < numChars; i++) {
-		char realChar = RealCharAt(fromIndex + i);
-		if ((realChar & 0xc0) == 0x80)
-			continue;
-		if (realChar == inChar) {
-			*ioDelta = i;
-			return true;
-		}
-	}
-
-	return false;
-}
-
-
-const char*
-TextGapBuffer::Text()
-{
-	const char* realText = RealText();
-
-	if (fPasswordMode) {
-		const uint32 numChars = UTF8CountChars(realText, Length());
-		const uint32 bulletCharLen = UTF8CountBytes(B_UTF8_BULLET, 1);
-		uint32 newSize = numChars * bulletCharLen + 1;
-
-		if ((uint32)fScratchSize < newSize) {
-			fScratchBuffer = (char*)realloc(fScratchBuffer, newSize);
-			fScratchSize = newSize;
-		}
-
-		char* scratchPtr = fScratchBuffer;
-		for (uint32 i = 0; i < numChars; i++) {
-			memcpy(scratchPtr, B_UTF8_BULLET, bulletCharLen);
-			scratchPtr += bulletCharLen;
-		}
-		*scratchPtr = '\0';
-
-		return fScratchBuffer;
-	}
-
-	return realText;
-}
-
-
 const char*
 TextGapBuffer::RealText()
 {
@@ -249,58 +137,21 @@ TextGapBuffer::RealText()
 }
 
 
-void
-TextGapBuffer::GetString(int32 offset, int32 length, char* buffer)
+const char*
+TextGapBuffer::Segment(int32 offset, int32* _length) const
 {
-	if (buffer == NULL)
-		return;
-
-	int32 textLen = Length();
-
-	if (offset < 0 || offset > (textLen - 1) || length < 1) {
-		buffer[0] = '\0';
-		return;
+	if (offset < 0 || offset >= fItemCount) {
+		*_length = 0;
+		return "";
 	}
 
-	length = ((offset + length) > textLen) ? textLen - offset : length;
-
-	bool isStartBeforeGap = (offset < fGapIndex);
-	bool isEndBeforeGap = ((offset + length - 1) < fGapIndex);
-
-	if (isStartBeforeGap == isEndBeforeGap) {
-		char* source = fBuffer + offset;
-		if (!isStartBeforeGap)
-			source += fGapCount;
-
-		memcpy(buffer, source, length);
-
-	} else {
-		// if we are here, it can only be that start is before gap,
-		// and the end is after gap.
-
-		int32 beforeLen = fGapIndex - offset;
-		int32 afterLen = length - beforeLen;
-
-		memcpy(buffer, fBuffer + offset, beforeLen);
-		memcpy(buffer + beforeLen, fBuffer + fGapIndex + fGapCount, afterLen);
-
+	if (offset < fGapIndex) {
+		*_length = fGapIndex - offset;
+		return fBuffer + offset;
 	}
 
-	buffer[length] = '\0';
-}
-
-
-bool
-TextGapBuffer::PasswordMode() const
-{
-	return fPasswordMode;
-}
-
-
-void
-TextGapBuffer::SetPasswordMode(bool state)
-{
-	fPasswordMode = state;
+	*_length = fItemCount - offset;
+	return fBuffer + offset + fGapCount;
 }
 
 
@@ -9,66 +9,41 @@
 #define __TEXTGAPBUFFER_H
 
 
-#include <SupportDefs.h>
-#include <TextView.h>
+#include <OS.h>
 
-
-class BFile;
+#include "TextBuffer.h"
 
 
 namespace BPrivate {
 
 
-class TextGapBuffer {
+class TextGapBuffer : public TextBuffer {
 public:
 								TextGapBuffer();
-								~TextGapBuffer();
+	virtual						~TextGapBuffer();
 
-			void				InsertText(const char* inText, int32 inNumItems,
+	virtual	void				InsertText(const char* inText, int32 inNumItems,
 									int32 inAtIndex);
-			bool				InsertText(BFile* file, int32 fileOffset,
+	virtual	bool				InsertText(BFile* file, int32 fileOffset,
 									int32 amount, int32 atIndex);
-			void				RemoveRange(int32 start, int32 end);
-
-			bool				FindChar(char inChar, int32 fromIndex,
-									int32* ioDelta);
-
-			const char*			Text();
-			const char*			RealText();
-			int32				Length() const;
-
-			const char*			GetString(int32 fromOffset, int32* numBytes);
-			void				GetString(int32 offset, int32 length,
-									char* buffer);
-
-			char				RealCharAt(int32 offset) const;
+	virtual	void				RemoveRange(int32 start, int32 end);
 
-			bool				PasswordMode() const;
-			void				SetPasswordMode(bool);
+	virtual	const char*			RealText();
+	virtual	const char*			Segment(int32 offset, int32* _length) const;
+	virtual	char				RealCharAt(int32 offset) const;
 
 private:
 			void				_MoveGapTo(int32 toIndex);
 			void				_EnlargeGapTo(int32 inCount);
 			void				_ShrinkGapTo(int32 inCount);
 
-			int32				fItemCount;			// logical count
 			char*				fBuffer;			// allocated memory
 			int32				fBufferCount;		// physical count
 			int32				fGapIndex;			// gap position
 			int32				fGapCount;			// gap count
-			char*				fScratchBuffer;		// for GetString
-			int32				fScratchSize;		// scratch size
-			bool				fPasswordMode;
 };
 
 
-inline int32
-TextGapBuffer::Length() const
-{
-	return fItemCount;
-}
-
-
 inline char
 TextGapBuffer::RealCharAt(int32 index) const
 {
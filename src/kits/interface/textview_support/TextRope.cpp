@@ -0,0 +1,374 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+
+#include <File.h>
+
+#include "TextRope.h"
+
+
+namespace BPrivate {
+
+
+static const int32 kChunkSize = 64 * 1024;
+static const int32 kChunkFill = kChunkSize * 3 / 4;
+	// new chunks leave some room for later insertions
+
+
+TextRope::TextRope()
+	:
+	fChunks(NULL),
+	fChunkCount(0),
+	fChunkCapacity(0),
+	fLastChunk(0),
+	fFlatText(NULL),
+	fFlatTextValid(false)
+{
+}
+
+
+TextRope::~TextRope()
+{
+	for (int32 i = 0; i < fChunkCount; i++)
+		free(fChunks[i].data);
+	free(fChunks);
+	free(fFlatText);
+}
+
+
+void
+TextRope::InsertText(const char* inText, int32 inNumItems, int32 inAtIndex)
+{
+	if (inNumItems < 1)
+		return;
+
+	inAtIndex = (inAtIndex > fItemCount) ? fItemCount : inAtIndex;
+	inAtIndex = (inAtIndex < 0) ? 0 : inAtIndex;
+
+	fFlatTextValid = false;
+
+	int32 index = 0;
+	int32 position = 0;
+	if (fChunkCount > 0) {
+		index = _ChunkAt(inAtIndex);
+		position = inAtIndex - fChunks[index].offset;
+
+		chunk& target = fChunks[index];
+		if (target.length + inNumItems <= kChunkSize) {
+			memmove(target.data + position + inNumItems,
+				target.data + position, target.length - position);
+			memcpy(target.data + position, inText, inNumItems);
+			target.length += inNumItems;
+
+			fItemCount += inNumItems;
+			_UpdateOffsets(index + 1);
+			return;
+		}
+	}
+
+	// Split the chunk at the insertion point, and put the new text and the
+	// rest of the chunk into new chunks behind it
+	const char* tail = NULL;
+	int32 tailLength = 0;
+	if (fChunkCount > 0) {
+		tail = fChunks[index].data + position;
+		tailLength = fChunks[index].length - position;
+	}
+
+	int32 total = inNumItems + tailLength;
+	int32 count = (total + kChunkFill - 1) / kChunkFill;
+	int32 first = fChunkCount > 0 ? index + 1 : 0;
+	if (!_InsertChunks(first, count))
+		return;
+
+	// _InsertChunks() may have moved the chunk array, but not the data
+	int32 copied = 0;
+	for (int32 i = first; i < first + count; i++) {
+		chunk& target = fChunks[i];
+		target.length = std::min(total - copied, kChunkFill);
+
+		for (int32 done = 0; done < target.length;) {
+			const char* source;
+			int32 length;
+			if (copied < inNumItems) {
+				source = inText + copied;
+				length = inNumItems - copied;
+			} else {
+				source = tail + copied - inNumItems;
+				length = total - copied;
+			}
+			length = std::min(length, target.length - done);
+			memcpy(target.data + done, source, length);
+			done += length;
+			copied += length;
+		}
+	}
+
+	if (first > 0) {
+		fChunks[index].length = position;
+		_RemoveEmptyChunks(index, index);
+	}
+
+	fItemCount += inNumItems;
+	_UpdateOffsets(first > 0 ? index : 0);
+}
+
+
+bool
+TextRope::InsertText(BFile* file, int32 fileOffset, int32 inNumItems,
+	int32 inAtIndex)
+{
+	off_t fileSize;
+
+	if (file->GetSize(&fileSize) != B_OK
+		|| !file->IsReadable())
+		return false;
+
+	// Clamp the text length to the file size
+	fileSize -= fileOffset;
+
+	if (fileSize < inNumItems)
+		inNumItems = fileSize;
+
+	if (inNumItems < 1)
+		return false;
+
+	inAtIndex = (inAtIndex > fItemCount) ? fItemCount : inAtIndex;
+	inAtIndex = (inAtIndex < 0) ? 0 : inAtIndex;
+
+	char* buffer = (char*)malloc(kChunkFill);
+	if (buffer == NULL)
+		return false;
+
+	// read the file a chunk at a time, each one goes right behind the
+	// previous one
+	for (int32 done = 0; done < inNumItems;) {
+		ssize_t bytesRead = file->ReadAt(fileOffset + done, buffer,
+			std::min(inNumItems - done, kChunkFill));
+		if (bytesRead <= 0)
+			break;
+
+		InsertText(buffer, bytesRead, inAtIndex + done);
+		done += bytesRead;
+	}
+
+	free(buffer);
+	return true;
+}
+
+
+void
+TextRope::RemoveRange(int32 start, int32 end)
+{
+	if (start < 0)
+		start = 0;
+	if (end > fItemCount)
+		end = fItemCount;
+	if (end - start < 1)
+		return;
+
+	fFlatTextValid = false;
+
+	int32 first = _ChunkAt(start);
+	int32 last = first;
+	for (int32 i = first; i < fChunkCount && fChunks[i].offset < end; i++) {
+		chunk& target = fChunks[i];
+		int32 from = std::max(start, target.offset) - target.offset;
+		int32 to = std::min(end, target.offset + target.length)
+			- target.offset;
+
+		memmove(target.data + from, target.data + to, target.length - to);
+		target.length -= to - from;
+		last = i;
+	}
+
+	fItemCount -= end - start;
+
+	_RemoveEmptyChunks(first, last);
+	if (first > 0)
+		first--;
+	_MergeChunks(first);
+	_UpdateOffsets(first);
+}
+
+
+const char*
+TextRope::RealText()
+{
+	if (!fFlatTextValid) {
+		char* text = (char*)realloc(fFlatText, fItemCount + 1);
+		if (text == NULL)
+			return "";
+
+		fFlatText = text;
+		for (int32 i = 0; i < fChunkCount; i++) {
+			memcpy(fFlatText + fChunks[i].offset, fChunks[i].data,
+				fChunks[i].length);
+		}
+		fFlatText[fItemCount] = '\0';
+		fFlatTextValid = true;
+	}
+
+	return fFlatText;
+}
+
+
+const char*
+TextRope::Segment(int32 offset, int32* _length) const
+{
+	if (offset < 0 || offset >= fItemCount) {
+		*_length = 0;
+		return "";
+	}
+
+	const chunk& target = fChunks[_ChunkAt(offset)];
+	*_length = target.length - (offset - target.offset);
+	return target.data + offset - target.offset;
+}
+
+
+char
+TextRope::RealCharAt(int32 index) const
+{
+	if (index < 0 || index >= fItemCount) {
+		if (index != fItemCount)
+			debugger("RealCharAt: invalid index supplied");
+		return 0;
+	}
+
+	const chunk& target = fChunks[_ChunkAt(index)];
+	return target.data[index - target.offset];
+}
+
+
+//!	Returns the chunk containing \a offset, or the last one past the end.
+int32
+TextRope::_ChunkAt(int32 offset) const
+{
+	if (fChunkCount == 0)
+		return 0;
+
+	// lookups tend to come in order, so try the last chunk, and its
+	// successor first
+	for (int32 i = fLastChunk; i < fLastChunk + 2 && i < fChunkCount; i++) {
+		const chunk& candidate = fChunks[i];
+		if (offset >= candidate.offset
+			&& offset < candidate.offset + candidate.length)
+			return fLastChunk = i;
+	}
+
+	int32 lower = 0;
+	int32 upper = fChunkCount - 1;
+	while (lower < upper) {
+		int32 middle = (lower + upper + 1) / 2;
+		if (fChunks[middle].offset <= offset)
+			lower = middle;
+		else
+			upper = middle - 1;
+	}
+
+	return fLastChunk = lower;
+}
+
+
+//!	Makes room for \a count new empty chunks at \a index.
+bool
+TextRope::_InsertChunks(int32 index, int32 count)
+{
+	if (fChunkCount + count > fChunkCapacity) {
+		int32 capacity = std::max(fChunkCapacity * 2, fChunkCount + count);
+		chunk* chunks = (chunk*)realloc(fChunks, capacity * sizeof(chunk));
+		if (chunks == NULL)
+			return false;
+
+		fChunks = chunks;
+		fChunkCapacity = capacity;
+	}
+
+	memmove(fChunks + index + count, fChunks + index,
+		(fChunkCount - index) * sizeof(chunk));
+	fChunkCount += count;
+
+	for (int32 i = index; i < index + count; i++) {
+		fChunks[i].data = NULL;
+		fChunks[i].length = 0;
+		fChunks[i].offset = 0;
+	}
+	for (int32 i = index; i < index + count; i++) {
+		fChunks[i].data = (char*)malloc(kChunkSize);
+		if (fChunks[i].data == NULL) {
+			_RemoveEmptyChunks(index, index + count - 1);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+void
+TextRope::_RemoveEmptyChunks(int32 first, int32 last)
+{
+	int32 target = first;
+	for (int32 i = first; i <= last && i < fChunkCount; i++) {
+		if (fChunks[i].length == 0) {
+			free(fChunks[i].data);
+			continue;
+		}
+		fChunks[target++] = fChunks[i];
+	}
+
+	int32 removed = std::min(last, fChunkCount - 1) + 1 - target;
+	if (removed > 0) {
+		memmove(fChunks + target, fChunks + target + removed,
+			(fChunkCount - target - removed) * sizeof(chunk));
+		fChunkCount -= removed;
+	}
+
+	fLastChunk = 0;
+}
+
+
+//!	Merges the chunks at \a index and behind it, if they are small enough.
+void
+TextRope::_MergeChunks(int32 index)
+{
+	for (int32 i = index; i < index + 2 && i + 1 < fChunkCount; i++) {
+		chunk& target = fChunks[i];
+		chunk& next = fChunks[i + 1];
+		if (target.length + next.length > kChunkFill)
+			continue;
+
+		memcpy(target.data + target.length, next.data, next.length);
+		target.length += next.length;
+		next.length = 0;
+		_RemoveEmptyChunks(i + 1, i + 1);
+		break;
+	}
+}
+
+
+void
+TextRope::_UpdateOffsets(int32 fromIndex)
+{
+	int32 offset = 0;
+	if (fromIndex > 0) {
+		offset = fChunks[fromIndex - 1].offset
+			+ fChunks[fromIndex - 1].length;
+	}
+
+	for (int32 i = fromIndex; i < fChunkCount; i++) {
+		fChunks[i].offset = offset;
+		offset += fChunks[i].length;
+	}
+}
+
+
+} // namespace BPrivate
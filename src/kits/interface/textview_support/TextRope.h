@@ -0,0 +1,64 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef __TEXTROPE_H
+#define __TEXTROPE_H
+
+
+#include <OS.h>
+
+#include "TextBuffer.h"
+
+
+namespace BPrivate {
+
+
+// Stores the text in a sequence of chunks of at most 64 KB each, so
+// that an edit only ever moves the bytes of a single chunk, no matter where
+// in the text it happens.
+class TextRope : public TextBuffer {
+public:
+								TextRope();
+	virtual						~TextRope();
+
+	virtual	void				InsertText(const char* inText, int32 inNumItems,
+									int32 inAtIndex);
+	virtual	bool				InsertText(BFile* file, int32 fileOffset,
+									int32 amount, int32 atIndex);
+	virtual	void				RemoveRange(int32 start, int32 end);
+
+	virtual	const char*			RealText();
+									// flattens the text into a copy, which
+									// stays valid until the next change
+	virtual	const char*			Segment(int32 offset, int32* _length) const;
+	virtual	char				RealCharAt(int32 offset) const;
+
+private:
+			struct chunk {
+				char*			data;
+				int32			length;
+				int32			offset;
+			};
+
+			int32				_ChunkAt(int32 offset) const;
+			bool				_InsertChunks(int32 index, int32 count);
+			void				_RemoveEmptyChunks(int32 first, int32 last);
+			void				_MergeChunks(int32 index);
+			void				_UpdateOffsets(int32 fromIndex);
+
+			chunk*				fChunks;
+			int32				fChunkCount;
+			int32				fChunkCapacity;
+	mutable	int32				fLastChunk;
+									// where the last lookup ended up
+
+			char*				fFlatText;
+			bool				fFlatTextValid;
+};
+
+
+} // namespace BPrivate
+
+
+#endif //__TEXTROPE_H
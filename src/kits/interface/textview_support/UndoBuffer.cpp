@@ -10,7 +10,6 @@
 
 
 #include "UndoBuffer.h"
-#include "utf8_functions.h"
 
 #include <Clipboard.h>
 
@@ -37,8 +36,8 @@ BTextView::UndoBuffer::UndoBuffer(BTextView* textView, undo_state state)
 	fTextView->GetSelection(&fStart, &fEnd);
 	fTextLength = fEnd - fStart;
 	
-	fTextData = (char*)malloc(fTextLength);
-	memcpy(fTextData, fTextView->Text() + fStart, fTextLength);
+	fTextData = (char*)malloc(fTextLength + 1);
+	fTextView->GetText(fStart, fTextLength, fTextData);
 
 	if (fTextView->IsStylable())
 		fRunArray = fTextView->RunArray(fStart, fEnd, &fRunArrayLength);
@@ -125,8 +124,8 @@ BTextView::CutUndoBuffer::RedoSelf(BClipboard* clipboard)
 
 BTextView::PasteUndoBuffer::PasteUndoBuffer(BTextView* textView,
 		const char* text, int32 textLen, text_run_array* runArray,
-		int32 runArrayLen)
-	: BTextView::UndoBuffer(textView, B_UNDO_PASTE),
+		int32 runArrayLen, undo_state state)
+	: BTextView::UndoBuffer(textView, state),
 	fPasteText(NULL),
 	fPasteTextLength(textLen),
 	fPasteRunArray(NULL)
@@ -271,8 +270,8 @@ BTextView::TypingUndoBuffer::UndoSelf(BClipboard* clipboard)
 	int32 len = fTypedEnd - fTypedStart;
 	
 	free(fTypedText);
-	fTypedText = (char*)malloc(len);
-	memcpy(fTypedText, fTextView->Text() + fTypedStart, len);
+	fTypedText = (char*)malloc(len + 1);
+	fTextView->GetText(fTypedStart, len, fTypedText);
 	
 	fTextView->Select(fTypedStart, fTypedStart);
 	fTextView->Delete(fTypedStart, fTypedEnd);
@@ -314,8 +313,8 @@ BTextView::TypingUndoBuffer::_Reset()
 	fTypedStart = fStart;
 	fTypedEnd = fStart;
 	
-	fTextData = (char*)malloc(fTextLength);
-	memcpy(fTextData, fTextView->Text() + fStart, fTextLength);
+	fTextData = (char*)malloc(fTextLength + 1);
+	fTextView->GetText(fStart, fTextLength, fTextData);
 	
 	free(fTypedText);
 	fTypedText = NULL;
@@ -330,8 +329,7 @@ BTextView::TypingUndoBuffer::BackwardErase()
 	int32 start, end;
 	fTextView->GetSelection(&start, &end);
 	
-	const char* text = fTextView->Text();
-	int32 charLen = UTF8PreviousCharLen(text + start, text);
+	int32 charLen = start - fTextView->_PreviousInitialByte(start);
 	
 	if (start != fTypedEnd || end != fTypedEnd) {
 		_Reset();
@@ -363,7 +361,7 @@ BTextView::TypingUndoBuffer::ForwardErase()
 
 	fTextView->GetSelection(&start, &end);
 	
-	int32 charLen = UTF8NextCharLen(fTextView->Text() + start);	
+	int32 charLen = fTextView->_NextInitialByte(start) - start;
 	
 	if (start != fTypedEnd || end != fTypedEnd || fUndone > 0) {
 		_Reset();
@@ -61,7 +61,8 @@ public:
 								PasteUndoBuffer(BTextView* textView,
 									const char* text, int32 textLength,
 									text_run_array* runArray,
-									int32 runArrayLen);
+									int32 runArrayLen,
+									undo_state state = B_UNDO_PASTE);
 	virtual						~PasteUndoBuffer();
 
 protected:
@@ -10,7 +10,7 @@
 
 
 #include "utf8_functions.h"
-#include "TextGapBuffer.h"
+#include "TextBuffer.h"
 #include "WidthBuffer.h"
 
 #include <Autolock.h>
@@ -157,15 +157,15 @@ WidthBuffer::StringWidth(const char* inText, int32 fromOffset, int32 length,
 
 
 /*! \brief Returns how much room is required to draw a string in the font.
-	\param inBuffer The TextGapBuffer to be examined.
-	\param fromOffset The offset in the TextGapBuffer where to begin the
+	\param inBuffer The TextBuffer to be examined.
+	\param fromOffset The offset in the TextBuffer where to begin the
 	examination.
 	\param lenght The amount of bytes to be examined.
 	\param inStyle The font.
 	\return The space (in pixels) required to draw the given string.
 */
 float
-WidthBuffer::StringWidth(TextGapBuffer &inBuffer, int32 fromOffset,
+WidthBuffer::StringWidth(TextBuffer &inBuffer, int32 fromOffset,
 	int32 length, const BFont* inStyle)
 {
 	const char* text = inBuffer.GetString(fromOffset, &length);
@@ -38,10 +38,97 @@ public:
 		fWriteMode(false),
 		fEOS(false),
 		fFrameStride(0),
-		fNextPts(0)
+		fNextPts(0),
+		fPending(NULL),
+		fPendingBuffer(NULL),
+		fPendingOffset(0),
+		fBorrowedFrames(0)
 	{
 	}
 
+	~Impl()
+	{
+		DropPending();
+	}
+
+	// The decoded buffer the next frames are read from is kept mapped until
+	// all of its frames have been consumed, so that nothing a short read
+	// leaves behind is lost, and BorrowFrames() can hand it out directly.
+	status_t PullPending()
+	{
+		while (fPending == NULL || PendingFrames() == 0) {
+			DropPending();
+			if (fEOS)
+				return B_LAST_BUFFER_ERROR;
+
+			GstAppSink* sink = GST_APP_SINK(fAppSink);
+			GstSample* sample = gst_app_sink_pull_sample(sink);
+			if (sample == NULL) {
+				if (gst_app_sink_is_eos(sink)) {
+					fEOS = true;
+					return B_LAST_BUFFER_ERROR;
+				}
+				return B_ERROR;
+			}
+
+			GstBuffer* gb = gst_sample_get_buffer(sample);
+			if (gb == NULL || !gst_buffer_map(gb, &fPendingMap, GST_MAP_READ)) {
+				gst_sample_unref(sample);
+				return B_ERROR;
+			}
+			fPending = sample;
+			fPendingBuffer = gb;
+			fPendingOffset = 0;
+		}
+		return B_OK;
+	}
+
+	void DropPending()
+	{
+		if (fPending == NULL)
+			return;
+		gst_buffer_unmap(fPendingBuffer, &fPendingMap);
+		gst_sample_unref(fPending);
+		fPending = NULL;
+		fPendingBuffer = NULL;
+		fPendingOffset = 0;
+	}
+
+	int64 PendingFrames() const
+	{
+		if (fPending == NULL || fFrameStride == 0)
+			return 0;
+		return (int64)((fPendingMap.size - fPendingOffset) / fFrameStride);
+	}
+
+	const uint8* PendingData() const
+	{
+		return fPendingMap.data + fPendingOffset;
+	}
+
+	void ConsumePending(int64 frames)
+	{
+		fPendingOffset += (size_t)frames * fFrameStride;
+		if (PendingFrames() == 0)
+			DropPending();
+	}
+
+	void FillHeader(media_header* mh, int64 frames) const
+	{
+		if (mh == NULL)
+			return;
+		memset(mh, 0, sizeof(*mh));
+		if (GST_BUFFER_PTS_IS_VALID(fPendingBuffer)) {
+			mh->start_time = (bigtime_t)(GST_BUFFER_PTS(fPendingBuffer) / 1000);
+			const float rate = fFormat.format.u.raw_audio.frame_rate;
+			if (rate > 0.0f && fFrameStride > 0) {
+				mh->start_time += (bigtime_t)(fPendingOffset / fFrameStride
+					* 1000000LL / (int64)rate);
+			}
+		}
+		mh->size_used = (uint32)(frames * fFrameStride);
+	}
+
 	GstElement*		fAppSink;	// read mode  (borrowed; owned by pipeline)
 	GstElement*		fAppSrc;	// write mode (borrowed)
 	GstElement*		fPipeline;	// borrowed
@@ -51,6 +138,12 @@ public:
 	bool			fEOS;
 	uint32			fFrameStride;
 	uint64			fNextPts;	// nanoseconds since stream start
+
+	GstSample*		fPending;	// read mode, partially consumed sample
+	GstBuffer*		fPendingBuffer;
+	GstMapInfo		fPendingMap;
+	size_t			fPendingOffset;	// bytes already consumed
+	int64			fBorrowedFrames;
 };
 
 
@@ -178,6 +271,10 @@ public:
 		fTrack->fImpl->fPipeline = fPipeline;
 		fTrack->fImpl->fFormat   = fmt;
 		fTrack->fImpl->fInitErr  = B_OK;
+		fTrack->fImpl->fFrameStride
+			= (fmt.format.u.raw_audio.format
+				& media_raw_audio_format::B_AUDIO_SIZE_MASK)
+			* fmt.format.u.raw_audio.channel_count;
 
 		// Transition to PLAYING so the pipeline pulls data on demand.
 		gst_element_set_state(fPipeline, GST_STATE_PLAYING);
@@ -590,46 +687,104 @@ BMediaTrack::ReadFrames(void* buffer, int64* outFrameCount, media_header* mh)
 	*outFrameCount = 0;
 	if (requested <= 0)
 		return B_BAD_VALUE;
+	if (fImpl->fBorrowedFrames > 0)
+		return B_NOT_ALLOWED;
+
+	// Fill the whole request, across decoded buffers if need be; whatever is
+	// left of the last one is kept for the next call.
+	uint8* out = (uint8*)buffer;
+	int64 framesRead = 0;
+	status_t status = B_OK;
+	while (framesRead < requested) {
+		status = fImpl->PullPending();
+		if (status != B_OK)
+			break;
+
+		if (framesRead == 0)
+			fImpl->FillHeader(mh, 0);
+
+		int64 frames = fImpl->PendingFrames();
+		if (frames > requested - framesRead)
+			frames = requested - framesRead;
+		const size_t bytes = (size_t)frames * fImpl->fFrameStride;
+		memcpy(out, fImpl->PendingData(), bytes);
+		out += bytes;
+		framesRead += frames;
+		fImpl->ConsumePending(frames);
+	}
 
-	if (fImpl->fEOS)
-		return B_LAST_BUFFER_ERROR;
+	if (framesRead == 0)
+		return status;
 
-	GstAppSink* sink = GST_APP_SINK(fImpl->fAppSink);
-	GstSample* sample = gst_app_sink_pull_sample(sink);
-	if (sample == NULL) {
-		if (gst_app_sink_is_eos(sink)) {
-			fImpl->fEOS = true;
-			return B_LAST_BUFFER_ERROR;
-		}
-		return B_ERROR;
-	}
+	*outFrameCount = framesRead;
+	if (mh != NULL)
+		mh->size_used = (uint32)(framesRead * fImpl->fFrameStride);
+	return B_OK;
+}
 
-	GstBuffer* gb = gst_sample_get_buffer(sample);
-	GstMapInfo map;
-	if (gb == NULL || !gst_buffer_map(gb, &map, GST_MAP_READ)) {
-		gst_sample_unref(sample);
-		return B_ERROR;
+
+/*!	Hands out decoded frames without copying them: \a _buffer points into
+	the decoder's buffer, and stays valid until ReleaseFrames() is called.
+	If \a _frameCount is positive on entry, no more frames than that are
+	returned; otherwise, all frames left in the current buffer are.
+*/
+status_t
+BMediaTrack::BorrowFrames(const void** _buffer, int64* _frameCount,
+	media_header* mh)
+{
+	if (_buffer == NULL || _frameCount == NULL
+			|| fImpl == NULL || fImpl->fAppSink == NULL) {
+		return B_BAD_VALUE;
 	}
+	const int64 limit = *_frameCount;
+	*_frameCount = 0;
+	if (fImpl->fBorrowedFrames > 0)
+		return B_NOT_ALLOWED;
 
-	const media_raw_audio_format& raw = fImpl->fFormat.format.u.raw_audio;
-	const uint32 stride = (raw.format & media_raw_audio_format::B_AUDIO_SIZE_MASK)
-		* raw.channel_count;
-	int64 framesAvail = stride > 0 ? (int64)(map.size / stride) : 0;
-	int64 framesToCopy = framesAvail < requested ? framesAvail : requested;
-	const size_t bytes = framesToCopy * stride;
+	status_t status = fImpl->PullPending();
+	if (status != B_OK)
+		return status;
 
-	memcpy(buffer, map.data, bytes);
-	*outFrameCount = framesToCopy;
+	int64 frames = fImpl->PendingFrames();
+	if (limit > 0 && frames > limit)
+		frames = limit;
 
-	if (mh != NULL) {
-		memset(mh, 0, sizeof(*mh));
-		if (GST_BUFFER_PTS_IS_VALID(gb))
-			mh->start_time = (bigtime_t)(GST_BUFFER_PTS(gb) / 1000);
-		mh->size_used = (uint32)bytes;
-	}
+	fImpl->FillHeader(mh, frames);
+	*_buffer = fImpl->PendingData();
+	*_frameCount = frames;
+	fImpl->fBorrowedFrames = frames;
+	return B_OK;
+}
 
-	gst_buffer_unmap(gb, &map);
-	gst_sample_unref(sample);
+
+/*!	Gives back the frames of the last BorrowFrames() call. Only the first
+	\a framesUsed of them are consumed, the rest will be returned again.
+	A negative \a framesUsed consumes all of them.
+*/
+status_t
+BMediaTrack::ReleaseFrames(int64 framesUsed)
+{
+	if (fImpl == NULL || fImpl->fBorrowedFrames == 0)
+		return B_BAD_VALUE;
+
+	if (framesUsed < 0 || framesUsed > fImpl->fBorrowedFrames)
+		framesUsed = fImpl->fBorrowedFrames;
+	fImpl->fBorrowedFrames = 0;
+	fImpl->ConsumePending(framesUsed);
+	return B_OK;
+}
+
+
+/*!	Sets how many decoded buffers may be queued ahead of the reader. */
+status_t
+BMediaTrack::SetReadAhead(int32 bufferCount)
+{
+	if (fImpl == NULL || fImpl->fAppSink == NULL)
+		return B_NO_INIT;
+	if (bufferCount <= 0)
+		return B_BAD_VALUE;
+
+	g_object_set(fImpl->fAppSink, "max-buffers", (guint)bufferCount, NULL);
 	return B_OK;
 }
 
@@ -639,11 +794,14 @@ BMediaTrack::SeekToTime(bigtime_t* inOutTime, int32 /*flags*/)
 {
 	if (inOutTime == NULL || fImpl == NULL || fImpl->fPipeline == NULL)
 		return B_BAD_VALUE;
+	if (fImpl->fBorrowedFrames > 0)
+		return B_NOT_ALLOWED;
 	const gint64 ns = (gint64)*inOutTime * 1000;
 	if (!gst_element_seek_simple(fImpl->fPipeline, GST_FORMAT_TIME,
 			(GstSeekFlags)(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT), ns)) {
 		return B_ERROR;
 	}
+	fImpl->DropPending();
 	fImpl->fEOS = false;
 	return B_OK;
 }
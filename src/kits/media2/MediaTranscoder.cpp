@@ -0,0 +1,407 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+// Runs decode (and optionally encode) jobs on a bounded pool of worker
+// threads. Every job gets its own pair of GStreamer pipelines; the workers
+// only move borrowed decoder buffers into the hook and the writer track.
+
+
+#include <media2/MediaTranscoder.h>
+
+#include <new>
+#include <string.h>
+
+#include <atomic>
+#include <vector>
+
+#include <OS.h>
+
+#include <media2/MediaFile.h>
+#include <media2/MediaTrack.h>
+
+
+static const int32 kMaxWorkers = 64;
+static const int32 kReadAheadBuffers = 16;
+
+
+class BMediaTranscoder::Impl {
+public:
+	struct job {
+		entry_ref				source;
+		entry_ref				destination;
+		bool					hasDestination;
+		media_file_format		fileFormat;
+		media_transcode_hook	hook;
+		void*					cookie;
+		std::atomic<status_t>	status;
+		std::atomic<int64>		frames;
+	};
+
+	Impl(int32 workerCount)
+		:
+		fWorkerCount(workerCount),
+		fStarted(false),
+		fDoneSem(-1),
+		fNextJob(0),
+		fCancelled(false),
+		fRunningWorkers(0),
+		fJobsDone(0),
+		fJobsFailed(0),
+		fFrames(0),
+		fMediaTime(0),
+		fStartTime(0),
+		fEndTime(0)
+	{
+		if (fWorkerCount <= 0) {
+			system_info info;
+			get_system_info(&info);
+			fWorkerCount = info.cpu_count;
+		}
+		if (fWorkerCount < 1)
+			fWorkerCount = 1;
+		else if (fWorkerCount > kMaxWorkers)
+			fWorkerCount = kMaxWorkers;
+
+		fDoneSem = create_sem(0, "media transcoder done");
+	}
+
+	~Impl()
+	{
+		fCancelled = true;
+		_JoinWorkers();
+		delete_sem(fDoneSem);
+
+		for (size_t i = 0; i < fJobs.size(); i++)
+			delete fJobs[i];
+	}
+
+	status_t Start()
+	{
+		if (fStarted)
+			return B_NOT_ALLOWED;
+		fStarted = true;
+		fStartTime = system_time();
+
+		int32 workerCount = fWorkerCount;
+		if (workerCount > (int32)fJobs.size())
+			workerCount = (int32)fJobs.size();
+		if (workerCount == 0) {
+			fEndTime = fStartTime;
+			return B_OK;
+		}
+
+		for (int32 i = 0; i < workerCount; i++) {
+			thread_id thread = spawn_thread(&_Worker, "media transcoder",
+				B_NORMAL_PRIORITY, this);
+			if (thread < 0) {
+				// run with the workers we have, if any
+				if (i == 0) {
+					fEndTime = system_time();
+					return thread;
+				}
+				break;
+			}
+			fWorkers.push_back(thread);
+			fRunningWorkers++;
+			resume_thread(thread);
+		}
+		return B_OK;
+	}
+
+	status_t Wait(bigtime_t timeout)
+	{
+		if (!fStarted)
+			return B_NOT_ALLOWED;
+		if (fWorkers.empty())
+			return B_OK;
+
+		status_t status = acquire_sem_etc(fDoneSem, (int32)fWorkers.size(),
+			timeout == B_INFINITE_TIMEOUT ? 0 : B_RELATIVE_TIMEOUT, timeout);
+		if (status != B_OK)
+			return status;
+
+		_JoinWorkers();
+		return B_OK;
+	}
+
+	static status_t _Worker(void* data)
+	{
+		Impl* self = (Impl*)data;
+		const int32 count = (int32)self->fJobs.size();
+
+		while (!self->fCancelled) {
+			int32 index = self->fNextJob.fetch_add(1);
+			if (index >= count)
+				break;
+
+			status_t status = self->_Run(index);
+			self->fJobs[index]->status = status;
+			if (status == B_OK)
+				self->fJobsDone++;
+			else
+				self->fJobsFailed++;
+		}
+
+		if (self->fRunningWorkers.fetch_sub(1) == 1)
+			self->fEndTime = system_time();
+		release_sem(self->fDoneSem);
+		return B_OK;
+	}
+
+	status_t _Run(int32 index)
+	{
+		job& job = *fJobs[index];
+		BMediaFile input(&job.source);
+		status_t status = input.InitCheck();
+		if (status != B_OK)
+			return status;
+
+		BMediaTrack* track = input.TrackAt(0);
+		if (track == NULL)
+			return B_MEDIA_NO_HANDLER;
+
+		BMediaFormat format;
+		status = track->DecodedFormat(&format);
+		if (status != B_OK)
+			return status;
+		if (!format.IsRawAudio())
+			return B_MEDIA_BAD_FORMAT;
+		const media_raw_audio_format& raw = format.format.u.raw_audio;
+
+		track->SetReadAhead(kReadAheadBuffers);
+
+		BMediaFile* output = NULL;
+		BMediaTrack* outputTrack = NULL;
+		if (job.hasDestination) {
+			output = new(std::nothrow) BMediaFile(&job.destination,
+				&job.fileFormat);
+			if (output == NULL)
+				return B_NO_MEMORY;
+			status = output->InitCheck();
+			if (status == B_OK) {
+				outputTrack = output->CreateTrack(format);
+				if (outputTrack == NULL)
+					status = B_MEDIA_BAD_FORMAT;
+				else
+					status = output->CommitHeader();
+			}
+		}
+
+		int64 frames = 0;
+		while (status == B_OK) {
+			if (fCancelled) {
+				status = B_CANCELED;
+				break;
+			}
+
+			const void* buffer;
+			int64 count = 0;
+			status = track->BorrowFrames(&buffer, &count);
+			if (status == B_LAST_BUFFER_ERROR) {
+				status = B_OK;
+				break;
+			}
+			if (status != B_OK)
+				break;
+
+			if (job.hook != NULL
+				&& !job.hook(job.cookie, index, buffer, count, raw)) {
+				status = B_CANCELED;
+			}
+			if (status == B_OK && outputTrack != NULL)
+				status = outputTrack->WriteFrames(buffer, count);
+			track->ReleaseFrames();
+
+			frames += count;
+			job.frames = frames;
+			fFrames += count;
+		}
+
+		if (raw.frame_rate > 0.0f)
+			fMediaTime += frames * 1000000LL / (int64)raw.frame_rate;
+
+		if (output != NULL) {
+			output->CloseFile();
+			delete output;
+		}
+		return status;
+	}
+
+	void _JoinWorkers()
+	{
+		for (size_t i = 0; i < fWorkers.size(); i++) {
+			status_t result;
+			wait_for_thread(fWorkers[i], &result);
+		}
+		fWorkers.clear();
+	}
+
+	int32					fWorkerCount;
+	bool					fStarted;
+	sem_id					fDoneSem;
+	std::vector<job*>		fJobs;
+	std::vector<thread_id>	fWorkers;
+
+	std::atomic<int32>		fNextJob;
+	std::atomic<bool>		fCancelled;
+	std::atomic<int32>		fRunningWorkers;
+
+	std::atomic<int32>		fJobsDone;
+	std::atomic<int32>		fJobsFailed;
+	std::atomic<int64>		fFrames;
+	std::atomic<bigtime_t>	fMediaTime;
+	bigtime_t				fStartTime;
+	std::atomic<bigtime_t>	fEndTime;
+};
+
+
+// #pragma mark - BMediaTranscoder
+
+
+BMediaTranscoder::BMediaTranscoder(int32 workerCount)
+	:
+	fImpl(new(std::nothrow) Impl(workerCount))
+{
+}
+
+
+BMediaTranscoder::~BMediaTranscoder()
+{
+	delete fImpl;
+}
+
+
+status_t
+BMediaTranscoder::InitCheck() const
+{
+	if (fImpl == NULL)
+		return B_NO_MEMORY;
+	return fImpl->fDoneSem >= 0 ? B_OK : fImpl->fDoneSem;
+}
+
+
+/*!	Adds a job that decodes \a source, passes every decoded buffer to
+	\a hook, if any, and writes it to \a destination, if any, in
+	\a fileFormat (WAV if \c NULL). Jobs can only be added before Start().
+	Returns the index of the job, or an error code.
+*/
+int32
+BMediaTranscoder::AddJob(const entry_ref& source,
+	const entry_ref* destination, const media_file_format* fileFormat,
+	media_transcode_hook hook, void* cookie)
+{
+	status_t status = InitCheck();
+	if (status != B_OK)
+		return status;
+	if (fImpl->fStarted)
+		return B_NOT_ALLOWED;
+
+	Impl::job* job = new(std::nothrow) Impl::job;
+	if (job == NULL)
+		return B_NO_MEMORY;
+
+	job->source = source;
+	job->hasDestination = destination != NULL;
+	if (destination != NULL)
+		job->destination = *destination;
+	if (fileFormat != NULL)
+		job->fileFormat = *fileFormat;
+	else {
+		memset(&job->fileFormat, 0, sizeof(job->fileFormat));
+		strcpy(job->fileFormat.mime_type, "audio/x-wav");
+		strcpy(job->fileFormat.short_name, "wav");
+		strcpy(job->fileFormat.file_extension, "wav");
+	}
+	job->hook = hook;
+	job->cookie = cookie;
+	job->status = B_BUSY;
+	job->frames = 0;
+
+	try {
+		fImpl->fJobs.push_back(job);
+	} catch (...) {
+		delete job;
+		return B_NO_MEMORY;
+	}
+	return (int32)fImpl->fJobs.size() - 1;
+}
+
+
+status_t
+BMediaTranscoder::Start()
+{
+	status_t status = InitCheck();
+	if (status != B_OK)
+		return status;
+	return fImpl->Start();
+}
+
+
+status_t
+BMediaTranscoder::Wait(bigtime_t timeout)
+{
+	status_t status = InitCheck();
+	if (status != B_OK)
+		return status;
+	return fImpl->Wait(timeout);
+}
+
+
+/*!	Stops all jobs as soon as possible; the ones that did not finish fail
+	with \c B_CANCELED, or stay \c B_BUSY if they never started.
+*/
+void
+BMediaTranscoder::Cancel()
+{
+	if (fImpl != NULL)
+		fImpl->fCancelled = true;
+}
+
+
+int32
+BMediaTranscoder::CountJobs() const
+{
+	return fImpl != NULL ? (int32)fImpl->fJobs.size() : 0;
+}
+
+
+/*!	Returns \c B_BUSY while the job is still queued or running. */
+status_t
+BMediaTranscoder::JobStatus(int32 job) const
+{
+	if (fImpl == NULL || job < 0 || job >= (int32)fImpl->fJobs.size())
+		return B_BAD_INDEX;
+	return fImpl->fJobs[job]->status;
+}
+
+
+int64
+BMediaTranscoder::JobFrames(int32 job) const
+{
+	if (fImpl == NULL || job < 0 || job >= (int32)fImpl->fJobs.size())
+		return 0;
+	return fImpl->fJobs[job]->frames;
+}
+
+
+void
+BMediaTranscoder::GetStatistics(media_transcode_statistics* stats) const
+{
+	if (stats == NULL)
+		return;
+	memset(stats, 0, sizeof(*stats));
+	if (fImpl == NULL || !fImpl->fStarted)
+		return;
+
+	stats->jobs_done = fImpl->fJobsDone;
+	stats->jobs_failed = fImpl->fJobsFailed;
+	stats->frames = fImpl->fFrames;
+	stats->media_time = fImpl->fMediaTime;
+
+	bigtime_t end = fImpl->fEndTime;
+	if (end == 0)
+		end = system_time();
+	stats->elapsed = end - fImpl->fStartTime;
+}
@@ -0,0 +1,517 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "SoundMixer.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#	include <emmintrin.h>
+#endif
+
+#include <media2/MediaFormat.h>
+#include <media2/Sound.h>
+
+
+namespace BPrivate { namespace media {
+
+
+enum {
+	kStartVoice,
+	kSetVoiceGain,
+	kStopVoice
+};
+
+
+static inline float to_float(float sample)  { return sample; }
+static inline float to_float(double sample) { return (float)sample; }
+static inline float to_float(int32 sample)  { return sample * (1.0f / 2147483648.0f); }
+static inline float to_float(int16 sample)  { return sample * (1.0f / 32768.0f); }
+static inline float to_float(int8 sample)   { return sample * (1.0f / 128.0f); }
+static inline float to_float(uint8 sample)  { return (sample - 128) * (1.0f / 128.0f); }
+
+
+/*!	Converts \a frames frames of the voice to float samples with \a channels
+	channels, resampling them with linear interpolation.
+	Returns true if the voice ran out of data.
+*/
+template<typename Sample>
+static bool
+render_voice(const uint8* data, int64 frameCount, int32 sourceChannels,
+	double& position, double step, float* output, int32 frames,
+	int32 channels)
+{
+	const Sample* samples = (const Sample*)data;
+	const int64 last = frameCount - 1;
+
+	int32 frame = 0;
+	for (; frame < frames; frame++) {
+		int64 index = (int64)position;
+		if (index > last)
+			break;
+
+		const float fraction = (float)(position - index);
+		const Sample* current = samples + index * sourceChannels;
+		const Sample* next = index < last ? current + sourceChannels : current;
+		float* out = output + frame * channels;
+
+		if (channels == 1 && sourceChannels > 1) {
+			// down mix to mono
+			float sum = 0.0f;
+			for (int32 channel = 0; channel < sourceChannels; channel++) {
+				float a = to_float(current[channel]);
+				sum += a + (to_float(next[channel]) - a) * fraction;
+			}
+			out[0] = sum / sourceChannels;
+		} else {
+			for (int32 channel = 0; channel < channels; channel++) {
+				int32 source = channel % sourceChannels;
+				float a = to_float(current[source]);
+				out[channel] = a + (to_float(next[source]) - a) * fraction;
+			}
+		}
+
+		position += step;
+	}
+
+	if (frame < frames) {
+		memset(output + frame * channels, 0,
+			(frames - frame) * channels * sizeof(float));
+		return true;
+	}
+
+	return false;
+}
+
+
+static inline void
+mix_add(float* mix, const float* samples, float gain, int32 count)
+{
+	int32 i = 0;
+#if defined(__SSE2__)
+	const __m128 factor = _mm_set1_ps(gain);
+	for (; i + 4 <= count; i += 4) {
+		__m128 sum = _mm_add_ps(_mm_loadu_ps(mix + i),
+			_mm_mul_ps(_mm_loadu_ps(samples + i), factor));
+		_mm_storeu_ps(mix + i, sum);
+	}
+#endif
+	for (; i < count; i++)
+		mix[i] += samples[i] * gain;
+}
+
+
+static inline float
+clip(float sample)
+{
+	return sample > 1.0f ? 1.0f : (sample < -1.0f ? -1.0f : sample);
+}
+
+
+/*!	Converts the mixed samples to the output format, and clips them. */
+static void
+write_samples(uint8* output, const float* mix, int32 count, uint32 format)
+{
+	int32 i = 0;
+
+	switch (format) {
+		case media_raw_audio_format::B_AUDIO_FLOAT:
+		{
+			float* out = (float*)output;
+#if defined(__SSE2__)
+			const __m128 low = _mm_set1_ps(-1.0f);
+			const __m128 high = _mm_set1_ps(1.0f);
+			for (; i + 4 <= count; i += 4) {
+				__m128 samples = _mm_loadu_ps(mix + i);
+				_mm_storeu_ps(out + i,
+					_mm_min_ps(_mm_max_ps(samples, low), high));
+			}
+#endif
+			for (; i < count; i++)
+				out[i] = clip(mix[i]);
+			break;
+		}
+
+		case media_raw_audio_format::B_AUDIO_SHORT:
+		{
+			int16* out = (int16*)output;
+#if defined(__SSE2__)
+			const __m128 scale = _mm_set1_ps(32767.0f);
+			for (; i + 8 <= count; i += 8) {
+				// packs saturates, so there is no need to clip first
+				__m128i first = _mm_cvtps_epi32(
+					_mm_mul_ps(_mm_loadu_ps(mix + i), scale));
+				__m128i second = _mm_cvtps_epi32(
+					_mm_mul_ps(_mm_loadu_ps(mix + i + 4), scale));
+				_mm_storeu_si128((__m128i*)(out + i),
+					_mm_packs_epi32(first, second));
+			}
+#endif
+			for (; i < count; i++)
+				out[i] = (int16)lrintf(clip(mix[i]) * 32767.0f);
+			break;
+		}
+
+		case media_raw_audio_format::B_AUDIO_INT:
+		{
+			int32* out = (int32*)output;
+			for (; i < count; i++)
+				out[i] = (int32)lrint(clip(mix[i]) * 2147483647.0);
+			break;
+		}
+
+		case media_raw_audio_format::B_AUDIO_DOUBLE:
+		{
+			double* out = (double*)output;
+			for (; i < count; i++)
+				out[i] = clip(mix[i]);
+			break;
+		}
+
+		case media_raw_audio_format::B_AUDIO_UCHAR:
+			for (; i < count; i++)
+				output[i] = (uint8)(lrintf(clip(mix[i]) * 127.0f) + 128);
+			break;
+
+		case media_raw_audio_format::B_AUDIO_CHAR:
+		{
+			int8* out = (int8*)output;
+			for (; i < count; i++)
+				out[i] = (int8)lrintf(clip(mix[i]) * 127.0f);
+			break;
+		}
+	}
+}
+
+
+SoundMixer::SoundMixer()
+	:
+	fVoiceCount(0)
+{
+}
+
+
+SoundMixer::~SoundMixer()
+{
+}
+
+
+bool
+SoundMixer::StartVoice(int32 id, BSound* sound, bigtime_t startTime,
+	float gain)
+{
+	command command = { kStartVoice, id, sound, startTime, gain };
+	return fCommands.Push(command);
+}
+
+
+bool
+SoundMixer::SetVoiceGain(int32 id, float gain)
+{
+	command command = { kSetVoiceGain, id, NULL, 0, gain };
+	return fCommands.Push(command);
+}
+
+
+bool
+SoundMixer::StopVoice(int32 id)
+{
+	command command = { kStopVoice, id, NULL, 0, 0.0f };
+	return fCommands.Push(command);
+}
+
+
+bool
+SoundMixer::GetFinishedVoice(int32& id, BSound*& sound)
+{
+	const finished_voice* finished = fFinished.Peek();
+	if (finished == NULL)
+		return false;
+
+	id = finished->id;
+	sound = finished->sound;
+	fFinished.Pop();
+	return true;
+}
+
+
+int32
+SoundMixer::Mix(void* buffer, size_t size,
+	const media_raw_audio_format& format, bigtime_t now)
+{
+	const int32 channels = format.channel_count;
+	const uint32 sampleSize
+		= format.format & media_raw_audio_format::B_AUDIO_SIZE_MASK;
+	const float frameRate = format.frame_rate;
+
+	_ProcessCommands(now, frameRate);
+
+	if (fVoiceCount == 0 || channels <= 0 || channels > kMaxChannels
+		|| sampleSize == 0 || frameRate <= 0.0f) {
+		memset(buffer, 0, size);
+		return _RetireFinishedVoices();
+	}
+
+	const size_t frameSize = sampleSize * channels;
+	const int32 frameCount = size / frameSize;
+	uint8* output = (uint8*)buffer;
+
+	for (int32 done = 0; done < frameCount;) {
+		const int32 frames = min_c(frameCount - done, (int32)kMixFrames);
+		const int32 samples = frames * channels;
+
+		memset(fMixBuffer, 0, samples * sizeof(float));
+		for (int32 i = 0; i < fVoiceCount; i++) {
+			if (!fVoices[i].finished)
+				_MixVoice(fVoices[i], frames, channels, frameRate);
+		}
+
+		write_samples(output, fMixBuffer, samples, format.format);
+		output += frames * frameSize;
+		done += frames;
+	}
+
+	if (frameCount * frameSize < size)
+		memset(output, 0, size - frameCount * frameSize);
+
+	return _RetireFinishedVoices();
+}
+
+
+bool
+SoundMixer::IsIdle() const
+{
+	return fVoiceCount == 0 && fCommands.IsEmpty();
+}
+
+
+bool
+SoundMixer::Flush()
+{
+	while (true) {
+		_ProcessCommands(system_time(), 0.0f);
+
+		for (int32 i = 0; i < fVoiceCount; i++)
+			fVoices[i].finished = true;
+
+		_RetireFinishedVoices();
+		if (fVoiceCount > 0)
+			return true;
+		if (fCommands.IsEmpty())
+			return false;
+	}
+}
+
+
+/*!	Applies the queued commands. Stops early if a voice can neither be started
+	nor handed back, the remaining commands stay queued.
+*/
+bool
+SoundMixer::_ProcessCommands(bigtime_t now, float frameRate)
+{
+	while (const command* command = fCommands.Peek()) {
+		switch (command->what) {
+			case kStartVoice:
+				if (fVoiceCount == kMaxVoices) {
+					// no room for another voice, give the sound right back
+					finished_voice finished = { command->id, command->sound };
+					if (!fFinished.Push(finished))
+						return false;
+					break;
+				}
+
+				_InitVoice(fVoices[fVoiceCount++], *command);
+				if (command->startTime > now && frameRate > 0.0f) {
+					fVoices[fVoiceCount - 1].delay = (int64)(
+						(command->startTime - now) * frameRate / 1000000);
+				}
+				break;
+
+			case kSetVoiceGain:
+			{
+				voice* voice = _FindVoice(command->id);
+				if (voice == NULL || voice->stopping)
+					break;
+
+				voice->targetGain = command->gain;
+				voice->gainStep = fabsf(voice->targetGain - voice->gain)
+					/ kRampFrames;
+				if (voice->delay > 0)
+					voice->gain = command->gain;
+				break;
+			}
+
+			case kStopVoice:
+			{
+				voice* voice = _FindVoice(command->id);
+				if (voice == NULL)
+					break;
+
+				// fade out to avoid a click, unless it didn't start yet
+				voice->stopping = true;
+				voice->targetGain = 0.0f;
+				voice->gainStep = fabsf(voice->gain) / kRampFrames;
+				if (voice->delay > 0)
+					voice->finished = true;
+				break;
+			}
+		}
+
+		fCommands.Pop();
+	}
+
+	return true;
+}
+
+
+void
+SoundMixer::_InitVoice(voice& voice, const command& command)
+{
+	BSound* sound = command.sound;
+	const BMediaFormat& format = sound->Format();
+	const media_raw_audio_format& raw = format.format.u.raw_audio;
+	const uint32 sampleSize
+		= raw.format & media_raw_audio_format::B_AUDIO_SIZE_MASK;
+
+	voice.sound = sound;
+	voice.id = command.id;
+	voice.data = (const uint8*)sound->Data();
+	voice.frameCount = 0;
+	voice.sampleFormat = raw.format;
+	voice.channelCount = raw.channel_count;
+	voice.frameRate = raw.frame_rate;
+	voice.position = 0.0;
+	voice.delay = 0;
+	voice.gain = command.gain;
+	voice.targetGain = command.gain;
+	voice.gainStep = 0.0f;
+	voice.stopping = false;
+	voice.finished = true;
+
+	if (!format.IsRawAudio() || voice.data == NULL || sampleSize == 0
+		|| raw.channel_count == 0 || raw.frame_rate <= 0.0f) {
+		return;
+	}
+
+	voice.frameCount = sound->Size() / (sampleSize * raw.channel_count);
+	voice.finished = voice.frameCount == 0;
+}
+
+
+SoundMixer::voice*
+SoundMixer::_FindVoice(int32 id)
+{
+	for (int32 i = 0; i < fVoiceCount; i++) {
+		if (fVoices[i].id == id && !fVoices[i].finished)
+			return &fVoices[i];
+	}
+
+	return NULL;
+}
+
+
+/*!	Hands the finished voices back to the API side. The ones that don't fit
+	into the queue stay around until the next time.
+*/
+int32
+SoundMixer::_RetireFinishedVoices()
+{
+	int32 count = 0;
+	for (int32 i = 0; i < fVoiceCount;) {
+		voice& voice = fVoices[i];
+		if (!voice.finished) {
+			i++;
+			continue;
+		}
+
+		finished_voice finished = { voice.id, voice.sound };
+		if (!fFinished.Push(finished))
+			break;
+
+		fVoices[i] = fVoices[--fVoiceCount];
+		count++;
+	}
+
+	return count;
+}
+
+
+void
+SoundMixer::_MixVoice(voice& voice, int32 frames, int32 channels,
+	float frameRate)
+{
+	if (voice.delay >= frames) {
+		voice.delay -= frames;
+		return;
+	}
+
+	const int32 offset = voice.delay;
+	const int32 count = frames - offset;
+	const double step = voice.frameRate / frameRate;
+	voice.delay = 0;
+
+	bool ended = true;
+	switch (voice.sampleFormat) {
+		case media_raw_audio_format::B_AUDIO_FLOAT:
+			ended = render_voice<float>(voice.data, voice.frameCount,
+				voice.channelCount, voice.position, step, fVoiceBuffer, count,
+				channels);
+			break;
+		case media_raw_audio_format::B_AUDIO_DOUBLE:
+			ended = render_voice<double>(voice.data, voice.frameCount,
+				voice.channelCount, voice.position, step, fVoiceBuffer, count,
+				channels);
+			break;
+		case media_raw_audio_format::B_AUDIO_INT:
+			ended = render_voice<int32>(voice.data, voice.frameCount,
+				voice.channelCount, voice.position, step, fVoiceBuffer, count,
+				channels);
+			break;
+		case media_raw_audio_format::B_AUDIO_SHORT:
+			ended = render_voice<int16>(voice.data, voice.frameCount,
+				voice.channelCount, voice.position, step, fVoiceBuffer, count,
+				channels);
+			break;
+		case media_raw_audio_format::B_AUDIO_UCHAR:
+			ended = render_voice<uint8>(voice.data, voice.frameCount,
+				voice.channelCount, voice.position, step, fVoiceBuffer, count,
+				channels);
+			break;
+		case media_raw_audio_format::B_AUDIO_CHAR:
+			ended = render_voice<int8>(voice.data, voice.frameCount,
+				voice.channelCount, voice.position, step, fVoiceBuffer, count,
+				channels);
+			break;
+	}
+
+	float* mix = fMixBuffer + offset * channels;
+	if (voice.gain == voice.targetGain) {
+		mix_add(mix, fVoiceBuffer, voice.gain, count * channels);
+	} else {
+		// ramp towards the new gain
+		const float rampStep = voice.gainStep;
+		const float target = voice.targetGain;
+		float gain = voice.gain;
+		for (int32 frame = 0; frame < count; frame++) {
+			if (gain < target)
+				gain = min_c(gain + rampStep, target);
+			else
+				gain = max_c(gain - rampStep, target);
+
+			const float* samples = fVoiceBuffer + frame * channels;
+			float* out = mix + frame * channels;
+			for (int32 channel = 0; channel < channels; channel++)
+				out[channel] += samples[channel] * gain;
+		}
+		voice.gain = gain;
+	}
+
+	if (ended || (voice.stopping && voice.gain == 0.0f))
+		voice.finished = true;
+}
+
+
+} }
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+// Mixes the BSounds played by a BSoundPlayer into its output buffers.
+// Voices are started, changed and stopped through a lock-free command
+// queue, finished voices are handed back through another one; Mix() runs
+// on the PipeWire thread, and neither allocates nor locks.
+
+#ifndef _VITRUVIAN_MEDIA2_SOUND_MIXER_H
+#define _VITRUVIAN_MEDIA2_SOUND_MIXER_H
+
+
+#include <OS.h>
+
+#include <atomic>
+
+#include <media2/MediaDefs.h>
+
+
+class BSound;
+
+
+namespace BPrivate { namespace media {
+
+
+// A queue with exactly one thread pushing, and one thread popping items.
+template<typename Type, uint32 kCapacity>
+class SingleProducerQueue {
+public:
+	SingleProducerQueue()
+		:
+		fHead(0),
+		fTail(0)
+	{
+	}
+
+	bool Push(const Type& item)
+	{
+		uint32 tail = fTail.load(std::memory_order_relaxed);
+		if (tail - fHead.load(std::memory_order_acquire) == kCapacity)
+			return false;
+
+		fItems[tail % kCapacity] = item;
+		fTail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	const Type* Peek() const
+	{
+		uint32 head = fHead.load(std::memory_order_relaxed);
+		if (head == fTail.load(std::memory_order_acquire))
+			return NULL;
+
+		return &fItems[head % kCapacity];
+	}
+
+	void Pop()
+	{
+		fHead.store(fHead.load(std::memory_order_relaxed) + 1,
+			std::memory_order_release);
+	}
+
+	bool IsEmpty() const
+	{
+		return fHead.load(std::memory_order_acquire)
+			== fTail.load(std::memory_order_acquire);
+	}
+
+private:
+	Type				fItems[kCapacity];
+	std::atomic<uint32>	fHead;
+	std::atomic<uint32>	fTail;
+};
+
+
+class SoundMixer {
+public:
+	static const int32	kMaxVoices = 64;
+
+						SoundMixer();
+						~SoundMixer();
+
+	// Called by the API threads, which have to serialize among themselves.
+	// They fail only when the command queue is full.
+			bool		StartVoice(int32 id, BSound* sound,
+							bigtime_t startTime, float gain);
+			bool		SetVoiceGain(int32 id, float gain);
+			bool		StopVoice(int32 id);
+
+			bool		GetFinishedVoice(int32& id, BSound*& sound);
+							// the mixer is done with the sound, its
+							// reference can be released
+
+	// Called by the PipeWire thread
+			int32		Mix(void* buffer, size_t size,
+							const media_raw_audio_format& format,
+							bigtime_t now);
+							// returns the number of voices that finished
+			bool		IsIdle() const;
+
+			bool		Flush();
+							// finishes all voices, only to be called while
+							// Mix() can't run; returns true if there are
+							// more than fit into the finished queue
+
+private:
+	enum {
+		kMixFrames = 256,
+		kMaxChannels = 8,
+		kRampFrames = 256
+			// frames a gain change is spread over
+	};
+
+	struct command {
+		uint32			what;
+		int32			id;
+		BSound*			sound;
+		bigtime_t		startTime;
+		float			gain;
+	};
+
+	struct finished_voice {
+		int32			id;
+		BSound*			sound;
+	};
+
+	struct voice {
+		BSound*			sound;
+		int32			id;
+		const uint8*	data;
+		int64			frameCount;
+		uint32			sampleFormat;
+		uint32			channelCount;
+		float			frameRate;
+		double			position;
+			// in source frames
+		int64			delay;
+			// output frames until the voice starts
+		float			gain;
+		float			targetGain;
+		float			gainStep;
+			// per frame, to reach the target gain in kRampFrames frames
+		bool			stopping;
+		bool			finished;
+	};
+
+			bool		_ProcessCommands(bigtime_t now, float frameRate);
+			void		_InitVoice(voice& voice, const command& command);
+			voice*		_FindVoice(int32 id);
+			int32		_RetireFinishedVoices();
+			void		_MixVoice(voice& voice, int32 frames,
+							int32 channels, float frameRate);
+
+	SingleProducerQueue<command, 128>			fCommands;
+	SingleProducerQueue<finished_voice, 256>	fFinished;
+
+			voice		fVoices[kMaxVoices];
+			int32		fVoiceCount;
+
+			float		fMixBuffer[kMixFrames * kMaxChannels];
+			float		fVoiceBuffer[kMixFrames * kMaxChannels];
+};
+
+
+} }
+
+
+#endif
@@ -16,6 +16,11 @@
 #include <media2/MediaPlayer.h>
 #include <media2/Sound.h>
 
+#include "SoundMixer.h"
+
+
+using namespace BPrivate::media;
+
 
 static int32 sNextPlayID = 1;
 
@@ -30,7 +35,7 @@ public:
 	void* Cookie() const        { return fCookie; }
 	void  SetCookie(void* c)    { fCookie = c; }
 
-	status_t InitCheck() const { return fPlayer.InitCheck(); }
+	status_t InitCheck() const;
 
 	const BMediaFormat& Format() const { return fPlayer.Format(); }
 	status_t SetFormat(const BMediaFormat& fmt) { return fPlayer.SetFormat(fmt); }
@@ -74,26 +79,19 @@ private:
 	static void _FillFunc(void* cookie, void* buffer, size_t size,
 		const media_raw_audio_format& format);
 	static void _NotifyFunc(void* cookie, BMediaPlayer::sound_player_notification what, ...);
+	static status_t _ReaperEntry(void* cookie);
 
+	// The sounds as the API sees them; the mixer keeps its own voices, and
+	// hands them back to the reaper thread once they are done.
 	struct playing_sound {
 		playing_sound*	next;
-		off_t			current_offset;
-		BSound*			sound;
 		BSoundPlayer::play_id	id;
-		float			volume;
 		sem_id			wait_sem;
+		bool			stopping;
 	};
 
-	struct waiting_sound {
-		waiting_sound*	next;
-		bigtime_t		start_time;
-		BSound*			sound;
-		BSoundPlayer::play_id	id;
-		float			volume;
-	};
-
-	void _PromoteWaitingSounds_Locked();
-	status_t _StopPlayingLocked(playing_sound** link, bool notify);
+	playing_sound* _FindSound(BSoundPlayer::play_id id) const;
+	void _ReapFinishedSounds(bool notify);
 
 	BSoundPlayer*		fOwner;
 	BMediaPlayer		fPlayer;
@@ -102,8 +100,14 @@ private:
 	void*				fCookie;
 
 	BLocker				fSoundLock;
+		// guards fPlayingSounds, and serializes the commands sent to the
+		// mixer; the PipeWire thread never takes it
 	playing_sound*		fPlayingSounds;
-	waiting_sound*		fWaitingSounds;
+	SoundMixer			fMixer;
+
+	sem_id				fFinishedSem;
+	thread_id			fReaper;
+	bool				fQuitting;
 
 	bigtime_t			fPlayStartWall;
 	bigtime_t			fFrozenCurrentTime;
@@ -121,25 +125,57 @@ BSoundPlayer::Impl::Impl(BSoundPlayer* owner, const BMediaFormat& format,
 	fCookie(cookie),
 	fSoundLock("BSoundPlayer sounds"),
 	fPlayingSounds(NULL),
-	fWaitingSounds(NULL),
+	fFinishedSem(-1),
+	fReaper(-1),
+	fQuitting(false),
 	fPlayStartWall(-1),
 	fFrozenCurrentTime(0)
 {
 	fPlayer.SetFormat(format);
 	fPlayer.SetHooks(&Impl::_FillFunc, &Impl::_NotifyFunc, this);
+
+	fFinishedSem = create_sem(0, "BSoundPlayer finished sounds");
+	if (fFinishedSem < 0)
+		return;
+
+	fReaper = spawn_thread(&Impl::_ReaperEntry, "BSoundPlayer reaper",
+		B_NORMAL_PRIORITY, this);
+	if (fReaper >= 0)
+		resume_thread(fReaper);
 }
 
 
 BSoundPlayer::Impl::~Impl()
 {
-	while (fPlayingSounds != NULL)
-		_StopPlayingLocked(&fPlayingSounds, false);
-	while (fWaitingSounds != NULL) {
-		waiting_sound* w = fWaitingSounds;
-		fWaitingSounds = w->next;
-		w->sound->Release();
-		free(w);
+	// make sure the mixer is no longer used before taking it apart
+	fPlayer.SetHooks(NULL, NULL, NULL);
+	fPlayer.Stop();
+
+	if (fReaper >= 0) {
+		fQuitting = true;
+		release_sem(fFinishedSem);
+		status_t result;
+		wait_for_thread(fReaper, &result);
 	}
+	delete_sem(fFinishedSem);
+
+	bool more;
+	do {
+		more = fMixer.Flush();
+		_ReapFinishedSounds(false);
+	} while (more);
+}
+
+
+status_t
+BSoundPlayer::Impl::InitCheck() const
+{
+	if (fFinishedSem < 0)
+		return fFinishedSem;
+	if (fReaper < 0)
+		return fReaper;
+
+	return fPlayer.InitCheck();
 }
 
 
@@ -224,33 +260,69 @@ BSoundPlayer::Impl::_NotifyFunc(void* cookie,
 }
 
 
-void
-BSoundPlayer::Impl::_PromoteWaitingSounds_Locked()
-{
-	const bigtime_t now = PerformanceTime();
-	waiting_sound** link = &fWaitingSounds;
-	while (*link != NULL) {
-		waiting_sound* w = *link;
-		if (w->start_time > now) {
-			link = &w->next;
+/*static*/ status_t
+BSoundPlayer::Impl::_ReaperEntry(void* cookie)
+{
+	Impl* self = (Impl*)cookie;
+	while (true) {
+		status_t status = acquire_sem(self->fFinishedSem);
+		if (status == B_INTERRUPTED)
 			continue;
-		}
-		*link = w->next;
+		if (status != B_OK || self->fQuitting)
+			break;
 
-		playing_sound* p = (playing_sound*)malloc(sizeof(playing_sound));
-		if (p == NULL) {
-			w->sound->Release();
-			free(w);
-			continue;
+		self->_ReapFinishedSounds(true);
+	}
+
+	return B_OK;
+}
+
+
+BSoundPlayer::Impl::playing_sound*
+BSoundPlayer::Impl::_FindSound(BSoundPlayer::play_id id) const
+{
+	for (playing_sound* p = fPlayingSounds; p != NULL; p = p->next) {
+		if (p->id == id)
+			return p;
+	}
+
+	return NULL;
+}
+
+
+/*!	Releases the sounds the mixer is done with, and wakes up everyone waiting
+	for them.
+*/
+void
+BSoundPlayer::Impl::_ReapFinishedSounds(bool notify)
+{
+	BSoundPlayer::play_id id;
+	BSound* sound;
+	while (fMixer.GetFinishedVoice(id, sound)) {
+		sound->Release();
+
+		sem_id waitSem = -1;
+		if (fSoundLock.Lock()) {
+			for (playing_sound** link = &fPlayingSounds; *link != NULL;
+					link = &(*link)->next) {
+				playing_sound* item = *link;
+				if (item->id != id)
+					continue;
+
+				*link = item->next;
+				waitSem = item->wait_sem;
+				free(item);
+				break;
+			}
+			fSoundLock.Unlock();
 		}
-		p->current_offset = 0;
-		p->sound = w->sound;
-		p->id = w->id;
-		p->volume = w->volume;
-		p->wait_sem = -1;
-		p->next = fPlayingSounds;
-		fPlayingSounds = p;
-		free(w);
+
+		if (notify && fOwner != NULL)
+			fOwner->Notify(BSoundPlayer::B_SOUND_DONE, id, true);
+
+		// wakes up all waiters at once
+		if (waitSem >= 0)
+			delete_sem(waitSem);
 	}
 }
 
@@ -261,42 +333,30 @@ BSoundPlayer::Impl::StartPlaying(BSound* sound, bigtime_t atTime, float volume)
 	if (sound == NULL)
 		return B_BAD_VALUE;
 
+	playing_sound* p = (playing_sound*)malloc(sizeof(playing_sound));
+	if (p == NULL)
+		return B_NO_MEMORY;
+
 	const BSoundPlayer::play_id id = atomic_add(&sNextPlayID, 1);
-	sound->Acquire();
+	p->id = id;
+	p->wait_sem = -1;
+	p->stopping = false;
 
 	if (!fSoundLock.Lock()) {
-		sound->Release();
+		free(p);
 		return B_ERROR;
 	}
 
-	if (atTime <= PerformanceTime()) {
-		playing_sound* p = (playing_sound*)malloc(sizeof(playing_sound));
-		if (p == NULL) {
-			fSoundLock.Unlock();
-			sound->Release();
-			return B_NO_MEMORY;
-		}
-		p->current_offset = 0;
-		p->sound = sound;
-		p->id = id;
-		p->volume = volume;
-		p->wait_sem = -1;
-		p->next = fPlayingSounds;
-		fPlayingSounds = p;
-	} else {
-		waiting_sound* w = (waiting_sound*)malloc(sizeof(waiting_sound));
-		if (w == NULL) {
-			fSoundLock.Unlock();
-			sound->Release();
-			return B_NO_MEMORY;
-		}
-		w->start_time = atTime;
-		w->sound = sound;
-		w->id = id;
-		w->volume = volume;
-		w->next = fWaitingSounds;
-		fWaitingSounds = w;
+	sound->Acquire();
+	if (!fMixer.StartVoice(id, sound, atTime, volume)) {
+		fSoundLock.Unlock();
+		sound->Release();
+		free(p);
+		return B_BUSY;
 	}
+
+	p->next = fPlayingSounds;
+	fPlayingSounds = p;
 	fSoundLock.Unlock();
 
 	fPlayer.SetHasData(true);
@@ -309,22 +369,14 @@ BSoundPlayer::Impl::SetSoundVolume(BSoundPlayer::play_id id, float volume)
 {
 	if (!fSoundLock.Lock())
 		return B_ERROR;
-	for (playing_sound* p = fPlayingSounds; p != NULL; p = p->next) {
-		if (p->id == id) {
-			p->volume = volume;
-			fSoundLock.Unlock();
-			return B_OK;
-		}
-	}
-	for (waiting_sound* w = fWaitingSounds; w != NULL; w = w->next) {
-		if (w->id == id) {
-			w->volume = volume;
-			fSoundLock.Unlock();
-			return B_OK;
-		}
-	}
+
+	status_t status = B_ENTRY_NOT_FOUND;
+	playing_sound* p = _FindSound(id);
+	if (p != NULL && !p->stopping)
+		status = fMixer.SetVoiceGain(id, volume) ? B_OK : B_BUSY;
+
 	fSoundLock.Unlock();
-	return B_ENTRY_NOT_FOUND;
+	return status;
 }
 
 
@@ -333,33 +385,12 @@ BSoundPlayer::Impl::IsSoundPlaying(BSoundPlayer::play_id id)
 {
 	if (!fSoundLock.Lock())
 		return false;
-	for (playing_sound* p = fPlayingSounds; p != NULL; p = p->next) {
-		if (p->id == id) {
-			fSoundLock.Unlock();
-			return true;
-		}
-	}
-	fSoundLock.Unlock();
-	return false;
-}
 
+	playing_sound* p = _FindSound(id);
+	bool playing = p != NULL && !p->stopping;
 
-status_t
-BSoundPlayer::Impl::_StopPlayingLocked(playing_sound** link, bool notify)
-{
-	playing_sound* item = *link;
-	*link = item->next;
-	const BSoundPlayer::play_id id = item->id;
-	const sem_id waitSem = item->wait_sem;
-	item->sound->Release();
-	free(item);
 	fSoundLock.Unlock();
-
-	if (notify && fOwner != NULL)
-		fOwner->Notify(BSoundPlayer::B_SOUND_DONE, id, true);
-	if (waitSem >= 0)
-		release_sem(waitSem);
-	return B_OK;
+	return playing;
 }
 
 
@@ -368,13 +399,18 @@ BSoundPlayer::Impl::StopPlaying(BSoundPlayer::play_id id)
 {
 	if (!fSoundLock.Lock())
 		return B_ERROR;
-	for (playing_sound** link = &fPlayingSounds; *link != NULL;
-			link = &(*link)->next) {
-		if ((*link)->id == id)
-			return _StopPlayingLocked(link, true);
+
+	status_t status = B_ENTRY_NOT_FOUND;
+	playing_sound* p = _FindSound(id);
+	if (p != NULL && !p->stopping) {
+		// the mixer fades the sound out, B_SOUND_DONE follows once it did
+		status = fMixer.StopVoice(id) ? B_OK : B_BUSY;
+		if (status == B_OK)
+			p->stopping = true;
 	}
+
 	fSoundLock.Unlock();
-	return B_ENTRY_NOT_FOUND;
+	return status;
 }
 
 
@@ -383,17 +419,28 @@ BSoundPlayer::Impl::WaitForSound(BSoundPlayer::play_id id)
 {
 	if (!fSoundLock.Lock())
 		return B_ERROR;
-	for (playing_sound* p = fPlayingSounds; p != NULL; p = p->next) {
-		if (p->id == id) {
-			if (p->wait_sem < 0)
-				p->wait_sem = create_sem(0, "wait for sound");
-			sem_id waitSem = p->wait_sem;
-			fSoundLock.Unlock();
-			return acquire_sem(waitSem);
-		}
+
+	playing_sound* p = _FindSound(id);
+	if (p == NULL) {
+		fSoundLock.Unlock();
+		return B_ENTRY_NOT_FOUND;
 	}
+
+	if (p->wait_sem < 0)
+		p->wait_sem = create_sem(0, "wait for sound");
+	sem_id waitSem = p->wait_sem;
 	fSoundLock.Unlock();
-	return B_ENTRY_NOT_FOUND;
+
+	if (waitSem < 0)
+		return waitSem;
+
+	// the semaphore is deleted once the sound is done
+	status_t status;
+	do {
+		status = acquire_sem(waitSem);
+	} while (status == B_INTERRUPTED);
+
+	return status == B_BAD_SEM_ID ? B_OK : status;
 }
 
 
@@ -404,37 +451,16 @@ BSoundPlayer::Impl::GetVolumeInfo(int32*, float*, float*)
 }
 
 
+/*!	Runs on the PipeWire thread: must neither lock nor allocate. */
 void
 BSoundPlayer::Impl::DeliverSoundBuffer(void* buffer, size_t size,
-	const media_raw_audio_format&)
+	const media_raw_audio_format& format)
 {
-	if (!fSoundLock.Lock()) {
-		memset(buffer, 0, size);
-		return;
-	}
+	if (fMixer.Mix(buffer, size, format, PerformanceTime()) > 0)
+		release_sem_etc(fFinishedSem, 1, B_DO_NOT_RESCHEDULE);
 
-	_PromoteWaitingSounds_Locked();
-
-	playing_sound* item = fPlayingSounds;
-	if (item == NULL) {
-		fSoundLock.Unlock();
+	if (fMixer.IsIdle())
 		fPlayer.SetHasData(false);
-		memset(buffer, 0, size);
-		return;
-	}
-
-	size_t used = 0;
-	if (!item->sound->GetDataAt(item->current_offset, buffer, size, &used)) {
-		playing_sound** link = &fPlayingSounds;
-		_StopPlayingLocked(link, true);
-		memset(buffer, 0, size);
-		return;
-	}
-	item->current_offset += used;
-	fSoundLock.Unlock();
-
-	if (used < size)
-		memset((uint8_t*)buffer + used, 0, size - used);
 }
 
 
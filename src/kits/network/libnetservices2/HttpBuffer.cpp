@@ -8,6 +8,9 @@
 
 #include "HttpBuffer.h"
 
+#include <algorithm>
+#include <string.h>
+
 #include <DataIO.h>
 #include <NetServicesDefs.h>
 #include <String.h>
@@ -15,14 +18,6 @@
 using namespace BPrivate::Network;
 
 
-/*!
-	\brief Newline sequence
-
-	As per the RFC, defined as \r\n
-*/
-static constexpr std::array<std::byte, 2> kNewLine = {std::byte('\r'), std::byte('\n')};
-
-
 /*!
 	\brief Create a new HTTP buffer with \a capacity.
 */
@@ -116,15 +111,51 @@ HttpBuffer::WriteTo(HttpTransferFunction func, std::optional<size_t> maxSize)
 std::optional<BString>
 HttpBuffer::GetNextLine()
 {
-	auto offset = fBuffer.cbegin() + fCurrentOffset;
-	auto result = std::search(offset, fBuffer.cend(), kNewLine.cbegin(), kNewLine.cend());
-	if (result == fBuffer.cend())
+	auto line = GetNextLineView();
+	if (!line)
 		return std::nullopt;
+	return BString(line->data(), line->size());
+}
+
+
+/*!
+	\brief Get the next line from this buffer, without copying it.
+
+	Lines end with \r\n, as per the RFC. The search is done with memchr(), which the C library
+	implements with vector instructions. Data that was searched before without finding the end of
+	a line is not searched again when more data has been read.
+
+	The view is valid until the buffer is modified.
+
+	\retval std::nullopt There are no more lines in the buffer.
+	\retval std::string_view The next line, without the line end.
+*/
+std::optional<std::string_view>
+HttpBuffer::GetNextLineView()
+{
+	const char* data = reinterpret_cast<const char*>(fBuffer.data());
+	auto scanOffset = std::max(fScanOffset, fCurrentOffset);
+
+	while (scanOffset < fBuffer.size()) {
+		auto newLine = static_cast<const char*>(
+			memchr(data + scanOffset, '\n', fBuffer.size() - scanOffset));
+		if (newLine == nullptr)
+			break;
+
+		size_t newLineOffset = newLine - data;
+		if (newLineOffset > fCurrentOffset && data[newLineOffset - 1] == '\r') {
+			std::string_view line(data + fCurrentOffset, newLineOffset - 1 - fCurrentOffset);
+			fCurrentOffset = newLineOffset + 1;
+			fScanOffset = fCurrentOffset;
+			return line;
+		}
+
+		// A bare \n is not a line end
+		scanOffset = newLineOffset + 1;
+	}
 
-	BString line(
-		reinterpret_cast<const char*>(std::addressof(*offset)), std::distance(offset, result));
-	fCurrentOffset = std::distance(fBuffer.cbegin(), result) + 2;
-	return line;
+	fScanOffset = fBuffer.size();
+	return std::nullopt;
 }
 
 
@@ -151,6 +182,7 @@ HttpBuffer::Flush() noexcept
 	if (fCurrentOffset > 0) {
 		auto end = fBuffer.cbegin() + fCurrentOffset;
 		fBuffer.erase(fBuffer.cbegin(), end);
+		fScanOffset -= std::min(fScanOffset, fCurrentOffset);
 		fCurrentOffset = 0;
 	}
 }
@@ -164,6 +196,7 @@ HttpBuffer::Clear() noexcept
 {
 	fBuffer.clear();
 	fCurrentOffset = 0;
+	fScanOffset = 0;
 }
 
 
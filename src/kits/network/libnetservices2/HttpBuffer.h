@@ -34,6 +34,7 @@ public:
 			void				WriteExactlyTo(HttpTransferFunction func,
 									std::optional<size_t> maxSize = std::nullopt);
 			std::optional<BString> GetNextLine();
+			std::optional<std::string_view> GetNextLineView();
 
 			size_t				RemainingBytes() const noexcept;
 
@@ -48,6 +49,8 @@ public:
 private:
 			std::vector<std::byte> fBuffer;
 			size_t				fCurrentOffset = 0;
+			size_t				fScanOffset = 0;
+				// no line ends before this offset, from fCurrentOffset on
 };
 
 
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "HttpFieldArena.h"
+
+#include <strings.h>
+
+#include <HttpFields.h>
+#include <NetServicesDefs.h>
+
+#include "HttpBuffer.h"
+#include "HttpPrivate.h"
+
+using namespace BPrivate::Network;
+
+
+static inline bool
+iequals(std::string_view a, std::string_view b) noexcept
+{
+	return a.size() == b.size() && strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+
+
+/*!
+	\brief Create an arena with room for \a capacity bytes of field lines before it has to grow.
+*/
+HttpFieldArena::HttpFieldArena(size_t capacity)
+{
+	fData.reserve(capacity);
+	fFields.reserve(16);
+}
+
+
+/*!
+	\brief Parse all complete field lines in the \a buffer.
+
+	The fields are parsed incrementally; this can be called again when more data has been read.
+
+	\exception BNetworkRequestError A field line does not conform to the HTTP spec.
+
+	\retval true The empty line that ends the header section was reached.
+	\retval false More data is needed.
+*/
+bool
+HttpFieldArena::ParseFields(HttpBuffer& buffer)
+{
+	while (auto line = buffer.GetNextLineView()) {
+		if (line->empty())
+			return true;
+
+		// RFC 7230 section 3.2.4: there is no whitespace between the name and the colon, and
+		// obsolete line folding does not need to be supported
+		auto separator = line->find(':');
+		if (separator == std::string_view::npos || separator == 0
+			|| !validate_http_token_string(line->substr(0, separator))) {
+			throw BNetworkRequestError(__PRETTY_FUNCTION__, BNetworkRequestError::ProtocolError,
+				"Invalid header field");
+		}
+
+		auto valueStart = separator + 1;
+		auto valueEnd = line->size();
+		while (valueStart < valueEnd && ((*line)[valueStart] == ' ' || (*line)[valueStart] == '\t'))
+			valueStart++;
+		while (valueEnd > valueStart
+			&& ((*line)[valueEnd - 1] == ' ' || (*line)[valueEnd - 1] == '\t')) {
+			valueEnd--;
+		}
+
+		auto offset = static_cast<uint32>(fData.size());
+		fData.append(line->data(), line->size());
+		fFields.push_back({offset, static_cast<uint32>(separator),
+			offset + static_cast<uint32>(valueStart), static_cast<uint32>(valueEnd - valueStart)});
+	}
+	return false;
+}
+
+
+/*!
+	\brief Get the value of the first field with \a name, ignoring the case of the name.
+
+	The view stays valid until more fields are parsed.
+*/
+std::optional<std::string_view>
+HttpFieldArena::FindField(std::string_view name) const noexcept
+{
+	for (size_t i = 0; i < fFields.size(); i++) {
+		if (iequals(NameAt(i), name))
+			return ValueAt(i);
+	}
+	return std::nullopt;
+}
+
+
+size_t
+HttpFieldArena::CountFields(std::string_view name) const noexcept
+{
+	size_t count = 0;
+	for (size_t i = 0; i < fFields.size(); i++) {
+		if (iequals(NameAt(i), name))
+			count++;
+	}
+	return count;
+}
+
+
+std::string_view
+HttpFieldArena::NameAt(size_t index) const noexcept
+{
+	const auto& field = fFields[index];
+	return std::string_view(fData.data() + field.nameOffset, field.nameLength);
+}
+
+
+std::string_view
+HttpFieldArena::ValueAt(size_t index) const noexcept
+{
+	const auto& field = fFields[index];
+	return std::string_view(fData.data() + field.valueOffset, field.valueLength);
+}
+
+
+/*!
+	\brief Copy the fields into a BHttpFields object.
+
+	Fields without a value cannot be stored in BHttpFields, and are left out.
+
+	\exception BHttpFields::InvalidInput A value contains characters that are not allowed.
+*/
+BHttpFields
+HttpFieldArena::ToFields() const
+{
+	BHttpFields fields;
+	for (size_t i = 0; i < fFields.size(); i++) {
+		if (fFields[i].valueLength > 0)
+			fields.AddField(NameAt(i), ValueAt(i));
+	}
+	return fields;
+}
+
+
+void
+HttpFieldArena::MakeEmpty() noexcept
+{
+	fData.clear();
+	fFields.clear();
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#ifndef _B_HTTP_FIELD_ARENA_H_
+#define _B_HTTP_FIELD_ARENA_H_
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <SupportDefs.h>
+
+
+namespace BPrivate {
+
+namespace Network {
+
+class BHttpFields;
+class HttpBuffer;
+
+
+/*!
+	\brief Stores the header fields of a response, without creating an object per field.
+
+	The field lines are copied into a single block of memory, and the fields are views into it.
+	Lookups are done on the views; a BHttpFields is only built when one is asked for.
+*/
+class HttpFieldArena
+{
+public:
+								HttpFieldArena(size_t capacity = 2 * 1024);
+
+	// Parse data from the response
+			bool				ParseFields(HttpBuffer& buffer);
+
+	// Querying
+			std::optional<std::string_view> FindField(std::string_view name) const noexcept;
+			size_t				CountFields() const noexcept { return fFields.size(); }
+			size_t				CountFields(std::string_view name) const noexcept;
+			std::string_view	NameAt(size_t index) const noexcept;
+			std::string_view	ValueAt(size_t index) const noexcept;
+
+	// Conversion
+			BHttpFields			ToFields() const;
+
+			void				MakeEmpty() noexcept;
+
+private:
+	struct FieldEntry {
+		uint32					nameOffset;
+		uint32					nameLength;
+		uint32					valueOffset;
+		uint32					valueLength;
+	};
+
+			std::string			fData;
+			std::vector<FieldEntry> fFields;
+};
+
+
+} // namespace Network
+
+} // namespace BPrivate
+
+#endif // _B_HTTP_FIELD_ARENA_H_
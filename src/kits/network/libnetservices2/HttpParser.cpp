@@ -10,18 +10,78 @@
 
 #include <stdexcept>
 #include <string>
+#include <strings.h>
 
+#include <BrotliCompressionAlgorithm.h>
 #include <HttpFields.h>
 #include <NetServicesDefs.h>
 #include <ZlibCompressionAlgorithm.h>
+#include <ZstdCompressionAlgorithm.h>
 
 using namespace std::literals;
 using namespace BPrivate::Network;
 
 
+static inline bool
+iequals(std::string_view a, std::string_view b) noexcept
+{
+	return a.size() == b.size() && strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+
+
+/*!
+	\brief Get the algorithm that decodes the Content-Encoding \a encoding, if it is supported.
+*/
+static std::unique_ptr<BCompressionAlgorithm>
+decompression_algorithm(std::string_view encoding)
+{
+	if (iequals(encoding, "gzip"sv) || iequals(encoding, "x-gzip"sv)
+		|| iequals(encoding, "deflate"sv)) {
+		return std::make_unique<BZlibCompressionAlgorithm>();
+	}
+	if (iequals(encoding, "zstd"sv))
+		return std::make_unique<BZstdCompressionAlgorithm>();
+	if (iequals(encoding, "br"sv))
+		return std::make_unique<BBrotliCompressionAlgorithm>();
+	return nullptr;
+}
+
+
 // #pragma mark -- HttpParser
 
 
+/*!
+	\brief Get the list of content encodings for the Accept-Encoding field of a request.
+
+	Only the encodings that the support kit was built with are listed, with the ones that
+	compress best first. "deflate" is never listed, because there are two interpretations of what
+	it means (the RFC and Microsoft products). Very few websites support only deflate, and most of
+	them will send gzip, or at worst, uncompressed data.
+*/
+/*static*/ std::string_view
+HttpParser::AcceptedEncodings()
+{
+	static const std::string encodings = [] {
+		std::string list;
+		for (auto encoding: {"zstd"sv, "br"sv, "gzip"sv}) {
+			BDataIO* stream = nullptr;
+			if (decompression_algorithm(encoding)->CreateDecompressingOutputStream(
+					nullptr, nullptr, stream)
+				!= B_OK) {
+				continue;
+			}
+			delete stream;
+
+			if (!list.empty())
+				list += ", ";
+			list += encoding;
+		}
+		return list;
+	}();
+	return encodings;
+}
+
+
 /*!
 	\brief Explicitly mark the response as having no content.
 
@@ -51,29 +111,30 @@ HttpParser::ParseStatus(HttpBuffer& buffer, BHttpStatus& status)
 	if (fStreamState != HttpInputStreamState::StatusLine)
 		debugger("The Status line has already been parsed");
 
-	auto statusLine = buffer.GetNextLine();
+	auto statusLine = buffer.GetNextLineView();
 	if (!statusLine)
 		return false;
 
-	auto codeStart = statusLine->FindFirst(' ') + 1;
-	if (codeStart < 0)
+	auto codeStart = statusLine->find(' ');
+	if (codeStart == std::string_view::npos)
 		throw BNetworkRequestError(__PRETTY_FUNCTION__, BNetworkRequestError::ProtocolError);
+	codeStart++;
 
-	auto codeEnd = statusLine->FindFirst(' ', codeStart);
+	auto codeEnd = statusLine->find(' ', codeStart);
 
-	if (codeEnd < 0 || (codeEnd - codeStart) != 3)
+	if (codeEnd == std::string_view::npos || (codeEnd - codeStart) != 3)
 		throw BNetworkRequestError(__PRETTY_FUNCTION__, BNetworkRequestError::ProtocolError);
 
-	std::string statusCodeString(statusLine->String() + codeStart, 3);
-
 	// build the output
-	try {
-		status.code = std::stol(statusCodeString);
-	} catch (...) {
-		throw BNetworkRequestError(__PRETTY_FUNCTION__, BNetworkRequestError::ProtocolError);
+	int16 code = 0;
+	for (auto digit: statusLine->substr(codeStart, 3)) {
+		if (digit < '0' || digit > '9')
+			throw BNetworkRequestError(__PRETTY_FUNCTION__, BNetworkRequestError::ProtocolError);
+		code = code * 10 + (digit - '0');
 	}
+	status.code = code;
 
-	status.text = std::move(statusLine.value());
+	status.text.SetTo(statusLine->data(), statusLine->size());
 	fStatus.code = status.code; // cache the status code
 	fStreamState = HttpInputStreamState::Fields;
 	return true;
@@ -84,7 +145,8 @@ HttpParser::ParseStatus(HttpBuffer& buffer, BHttpStatus& status)
 	\brief Parse the fields from the \a buffer and store it in \a fields.
 
 	The fields are parsed incrementally, meaning that even if the full header is not yet in the
-	\a buffer, it will still parse all complete fields and store them in the \a fields.
+	\a buffer, it will still parse all complete fields and store them in the \a fields. The
+	fields that determine the properties of the body are looked up in place.
 
 	After all fields have been parsed, it will determine the properties of the request body.
 	This means it will determine whether there is any content compression, if there is a body,
@@ -96,20 +158,12 @@ HttpParser::ParseStatus(HttpBuffer& buffer, BHttpStatus& status)
 	\exception BNetworkRequestException The fields not conform to the HTTP spec.
 */
 bool
-HttpParser::ParseFields(HttpBuffer& buffer, BHttpFields& fields)
+HttpParser::ParseFields(HttpBuffer& buffer, HttpFieldArena& fields)
 {
 	if (fStreamState != HttpInputStreamState::Fields)
 		debugger("The parser is not expecting header fields at this point");
 
-	auto fieldLine = buffer.GetNextLine();
-
-	while (fieldLine && !fieldLine.value().IsEmpty()) {
-		// Parse next header line
-		fields.AddField(fieldLine.value());
-		fieldLine = buffer.GetNextLine();
-	}
-
-	if (!fieldLine || (fieldLine && !fieldLine.value().IsEmpty())) {
+	if (!fields.ParseFields(buffer)) {
 		// there is more to parse
 		return false;
 	}
@@ -124,7 +178,7 @@ HttpParser::ParseFields(HttpBuffer& buffer, BHttpFields& fields)
 		fBodyType = HttpBodyType::NoContent;
 		fStreamState = HttpInputStreamState::Done;
 	} else if (auto header = fields.FindField("Transfer-Encoding"sv);
-			   header != fields.end() && header->Value() == "chunked"sv) {
+			   header && *header == "chunked"sv) {
 		// [3] If there is a Transfer-Encoding heading set to 'chunked'
 		// TODO: support the more advanced rules in the RFC around the meaning of this field
 		fBodyType = HttpBodyType::Chunked;
@@ -136,11 +190,11 @@ HttpParser::ParseFields(HttpBuffer& buffer, BHttpFields& fields)
 		// [5] If there is a valid value, then that is the expected size of the body
 		try {
 			auto contentLength = std::string();
-			for (const auto& field: fields) {
-				if (field.Name() == "Content-Length"sv) {
+			for (size_t i = 0; i < fields.CountFields(); i++) {
+				if (iequals(fields.NameAt(i), "Content-Length"sv)) {
 					if (contentLength.size() == 0)
-						contentLength = field.Value();
-					else if (contentLength != field.Value()) {
+						contentLength = fields.ValueAt(i);
+					else if (contentLength != fields.ValueAt(i)) {
 						throw BNetworkRequestError(__PRETTY_FUNCTION__,
 							BNetworkRequestError::ProtocolError,
 							"Multiple Content-Length fields with differing values");
@@ -183,9 +237,11 @@ HttpParser::ParseFields(HttpBuffer& buffer, BHttpFields& fields)
 	}
 
 	// Check Content-Encoding for compression
-	auto header = fields.FindField("Content-Encoding"sv);
-	if (header != fields.end() && (header->Value() == "gzip" || header->Value() == "deflate")) {
-		fBodyParser = std::make_unique<HttpBodyDecompression>(std::move(fBodyParser));
+	if (auto header = fields.FindField("Content-Encoding"sv)) {
+		if (auto algorithm = decompression_algorithm(*header)) {
+			fBodyParser
+				= std::make_unique<HttpBodyDecompression>(std::move(fBodyParser), *algorithm);
+		}
 	}
 
 	return true;
@@ -394,10 +450,10 @@ HttpChunkedBodyParser::ParseBody(HttpBuffer& buffer, HttpTransferFunction writeT
 			case ChunkSize:
 			{
 				// Read the next chunk size from the buffer; if unsuccesful wait for more data
-				auto chunkSizeString = buffer.GetNextLine();
+				auto chunkSizeString = buffer.GetNextLineView();
 				if (!chunkSizeString)
 					return {totalBytesRead, totalBytesRead, false};
-				auto chunkSizeStr = std::string(chunkSizeString.value().String());
+				auto chunkSizeStr = std::string(*chunkSizeString);
 				try {
 					size_t pos = 0;
 					fRemainingChunkSize = std::stoll(chunkSizeStr, &pos, 16);
@@ -450,8 +506,8 @@ HttpChunkedBodyParser::ParseBody(HttpBuffer& buffer, HttpTransferFunction writeT
 					// not enough data in the buffer to finish the chunk
 					return {totalBytesRead, totalBytesRead, false};
 				}
-				auto chunkEndString = buffer.GetNextLine();
-				if (!chunkEndString || chunkEndString.value().Length() != 0) {
+				auto chunkEndString = buffer.GetNextLineView();
+				if (!chunkEndString || !chunkEndString->empty()) {
 					// There should have been an empty chunk
 					throw BNetworkRequestError(
 						__PRETTY_FUNCTION__, BNetworkRequestError::ProtocolError);
@@ -463,13 +519,13 @@ HttpChunkedBodyParser::ParseBody(HttpBuffer& buffer, HttpTransferFunction writeT
 
 			case Trailers:
 			{
-				auto trailerString = buffer.GetNextLine();
+				auto trailerString = buffer.GetNextLineView();
 				if (!trailerString) {
 					// More data to come
 					return {totalBytesRead, totalBytesRead, false};
 				}
 
-				if (trailerString.value().Length() > 0) {
+				if (!trailerString->empty()) {
 					// Ignore empty trailers for now
 					// TODO: review if the API should support trailing headers
 				} else {
@@ -488,32 +544,74 @@ HttpChunkedBodyParser::ParseBody(HttpBuffer& buffer, HttpTransferFunction writeT
 
 
 // #pragma mark -- HttpBodyDecompression
+
+
 /*!
-	\brief Set up a decompression stream that decompresses the data read by \a bodyParser.
+	\brief Adapter that passes the output of the decompressing stream on to the body target.
 */
-HttpBodyDecompression::HttpBodyDecompression(std::unique_ptr<HttpBodyParser> bodyParser)
+class HttpBodyDecompression::BodyWriter : public BDataIO
 {
-	fDecompressorStorage = std::make_unique<BMallocIO>();
+public:
+	void SetTarget(HttpTransferFunction* writeToBody) noexcept
+	{
+		fWriteToBody = writeToBody;
+		fBytesWritten = 0;
+	}
+
+	size_t BytesWritten() const noexcept { return fBytesWritten; }
+
+	virtual ssize_t Write(const void* buffer, size_t size) override
+	{
+		if (fWriteToBody == nullptr)
+			return B_NOT_ALLOWED;
+
+		auto bytesWritten = (*fWriteToBody)(static_cast<const std::byte*>(buffer), size);
+		if (bytesWritten != size) {
+			throw BNetworkRequestError(
+				__PRETTY_FUNCTION__, BNetworkRequestError::SystemError, B_PARTIAL_WRITE);
+		}
+		fBytesWritten += bytesWritten;
+		return bytesWritten;
+	}
+
+private:
+	HttpTransferFunction* fWriteToBody = nullptr;
+	size_t fBytesWritten = 0;
+};
 
+
+/*!
+	\brief Set up a stream that decompresses the data read by \a bodyParser using \a algorithm.
+
+	The decompressed data is written straight to the body target, without storing it in between.
+*/
+HttpBodyDecompression::HttpBodyDecompression(
+	std::unique_ptr<HttpBodyParser> bodyParser, BCompressionAlgorithm& algorithm)
+	:
+	fBodyParser(std::move(bodyParser)),
+	fBodyWriter(std::make_unique<BodyWriter>())
+{
 	BDataIO* stream = nullptr;
-	auto result = BZlibCompressionAlgorithm().CreateDecompressingOutputStream(
-		fDecompressorStorage.get(), nullptr, stream);
+	auto result
+		= algorithm.CreateDecompressingOutputStream(fBodyWriter.get(), nullptr, stream);
 
 	if (result != B_OK) {
-		throw BNetworkRequestError("BZlibCompressionAlgorithm().CreateCompressingOutputStream",
+		throw BNetworkRequestError("BCompressionAlgorithm::CreateDecompressingOutputStream()",
 			BNetworkRequestError::SystemError, result);
 	}
 
 	fDecompressingStream = std::unique_ptr<BDataIO>(stream);
-	fBodyParser = std::move(bodyParser);
 }
 
 
+HttpBodyDecompression::~HttpBodyDecompression() = default;
+
+
 /*!
 	\brief Read a compressed body into a target..
 
-	The stream captures chunked or raw data, and decompresses it. The decompressed data is then
-	copied into a target using the \a writeToBody function.
+	The stream captures chunked or raw data, and decompresses it. The decompressed data is written
+	to the target using the \a writeToBody function as it becomes available.
 
 	The \a readEnd argument indicates whether the current \a buffer contains all the expected data.
 	It is up for the underlying parser to determine if more data was expected, and therefore, if
@@ -530,6 +628,8 @@ HttpBodyDecompression::HttpBodyDecompression(std::unique_ptr<HttpBodyParser> bod
 BodyParseResult
 HttpBodyDecompression::ParseBody(HttpBuffer& buffer, HttpTransferFunction writeToBody, bool readEnd)
 {
+	fBodyWriter->SetTarget(&writeToBody);
+
 	// Get the underlying raw or chunked parser to write data to our decompressionstream
 	auto parseResults = fBodyParser->ParseBody(
 		buffer,
@@ -548,20 +648,12 @@ HttpBodyDecompression::ParseBody(HttpBuffer& buffer, HttpTransferFunction writeT
 		// No more bytes expected so flush out the final bytes
 		if (auto status = fDecompressingStream->Flush(); status != B_OK) {
 			throw BNetworkRequestError(
-				"BZlibDecompressionStream::Flush()", BNetworkRequestError::SystemError, status);
+				"BDataIO::Flush()", BNetworkRequestError::SystemError, status);
 		}
 	}
 
-	size_t bytesWritten = 0;
-	if (auto bodySize = fDecompressorStorage->Position(); bodySize > 0) {
-		bytesWritten
-			= writeToBody(static_cast<const std::byte*>(fDecompressorStorage->Buffer()), bodySize);
-		if (static_cast<off_t>(bytesWritten) != bodySize) {
-			throw BNetworkRequestError(
-				__PRETTY_FUNCTION__, BNetworkRequestError::SystemError, B_PARTIAL_WRITE);
-		}
-		fDecompressorStorage->Seek(0, SEEK_SET);
-	}
+	auto bytesWritten = fBodyWriter->BytesWritten();
+	fBodyWriter->SetTarget(nullptr);
 	return {parseResults.bytesParsed, bytesWritten, parseResults.complete};
 }
 
@@ -9,13 +9,15 @@
 
 #include <functional>
 #include <optional>
+#include <string_view>
 
 // Quoted+relative: avoid colliding with libnetservices' HttpResult.h
 #include "../../../../headers/private/netservices2/HttpResult.h"
 
 #include "HttpBuffer.h"
+#include "HttpFieldArena.h"
 
-class BMallocIO;
+class BCompressionAlgorithm;
 
 namespace BPrivate {
 
@@ -48,9 +50,12 @@ public:
 	// Explicitly mark request as having no content
 			void				SetNoContent() noexcept;
 
+	// Content encodings that can be decoded, for the Accept-Encoding field
+	static	std::string_view	AcceptedEncodings();
+
 	// Parse data from response
 			bool				ParseStatus(HttpBuffer& buffer, BHttpStatus& status);
-			bool				ParseFields(HttpBuffer& buffer, BHttpFields& fields);
+			bool				ParseFields(HttpBuffer& buffer, HttpFieldArena& fields);
 			size_t				ParseBody(HttpBuffer& buffer, HttpTransferFunction writeToBody,
 									bool readEnd);
 			HttpInputStreamState State() const noexcept { return fStreamState; }
@@ -117,15 +122,19 @@ private:
 class HttpBodyDecompression : public HttpBodyParser
 {
 public:
-								HttpBodyDecompression(std::unique_ptr<HttpBodyParser> bodyParser);
+								HttpBodyDecompression(std::unique_ptr<HttpBodyParser> bodyParser,
+									BCompressionAlgorithm& algorithm);
+								~HttpBodyDecompression();
 	virtual	BodyParseResult		ParseBody(HttpBuffer& buffer, HttpTransferFunction writeToBody,
 									bool readEnd) override;
 
 	virtual	std::optional<off_t> TotalBodySize() const noexcept;
 
 private:
+			class BodyWriter;
+
 			std::unique_ptr<HttpBodyParser> fBodyParser;
-			std::unique_ptr<BMallocIO> fDecompressorStorage;
+			std::unique_ptr<BodyWriter> fBodyWriter;
 			std::unique_ptr<BDataIO> fDecompressingStream;
 };
 
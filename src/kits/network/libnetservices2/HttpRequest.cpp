@@ -21,6 +21,7 @@
 #include <Url.h>
 
 #include "HttpBuffer.h"
+#include "HttpParser.h"
 #include "HttpPrivate.h"
 
 using namespace std::literals;
@@ -462,9 +463,11 @@ BHttpRequest::RewindBody() noexcept
 /*!
 	\brief Private method used by HttpSerializer::SetTo() to serialize the header data into a
 		buffer.
+
+	When \a keepAlive is \c false, the server is asked to close the connection after the response.
 */
 void
-BHttpRequest::SerializeHeaderTo(HttpBuffer& buffer) const
+BHttpRequest::SerializeHeaderTo(HttpBuffer& buffer, bool keepAlive) const
 {
 	// Method & URL
 	//	TODO: proxy
@@ -488,15 +491,12 @@ BHttpRequest::SerializeHeaderTo(HttpBuffer& buffer) const
 			host << ':' << fData->url.Port();
 
 		outputFields.AddFields({
-			{"Host"sv, std::string_view(host.String())}, {"Accept-Encoding"sv, "gzip"sv},
-			// Allows the server to compress data using the "gzip" format.
-			// "deflate" is not supported, because there are two interpretations
-			// of what it means (the RFC and Microsoft products), and we don't
-			// want to handle this. Very few websites support only deflate,
-			// and most of them will send gzip, or at worst, uncompressed data.
-			{"Connection"sv, "close"sv}
-			// Let the remote server close the connection after response since
-			// we don't handle multiple request on a single connection
+			{"Host"sv, std::string_view(host.String())},
+			{"Accept-Encoding"sv, HttpParser::AcceptedEncodings()},
+			// Allows the server to compress data in any of the formats the parser can decode
+			{"Connection"sv, keepAlive ? "keep-alive"sv : "close"sv}
+			// Unless the session keeps the connection for further requests,
+			// let the remote server close it after the response
 		});
 	}
 
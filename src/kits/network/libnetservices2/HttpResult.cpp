@@ -199,7 +199,7 @@ BHttpResult::Fields() const
 			std::rethrow_exception(*(fData->error));
 
 		if (dataStatus >= HttpResultPrivate::kHeadersReady)
-			return *(fData->fields);
+			return fData->Fields();
 
 		status = acquire_sem(fData->data_wait);
 	}
@@ -11,6 +11,7 @@
 
 
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 
@@ -19,6 +20,8 @@
 #include <OS.h>
 #include <String.h>
 
+#include "HttpFieldArena.h"
+
 
 namespace BPrivate {
 
@@ -37,6 +40,8 @@ struct HttpResultPrivate {
 	// Data
 			std::optional<BHttpStatus> status;
 			std::optional<BHttpFields> fields;
+			HttpFieldArena		fieldArena;
+			std::once_flag		fieldsConverted;
 			std::optional<BHttpBody> body;
 			std::optional<std::exception_ptr> error;
 
@@ -52,6 +57,8 @@ struct HttpResultPrivate {
 			void				SetError(std::exception_ptr e);
 			void				SetStatus(BHttpStatus&& s);
 			void				SetFields(BHttpFields&& f);
+			void				SetFields(HttpFieldArena&& f);
+			const BHttpFields&	Fields();
 			void				SetBody();
 			size_t				WriteToBody(const void* buffer, size_t size);
 };
@@ -119,6 +126,31 @@ HttpResultPrivate::SetFields(BHttpFields&& f)
 }
 
 
+inline void
+HttpResultPrivate::SetFields(HttpFieldArena&& f)
+{
+	fieldArena = std::move(f);
+	atomic_set(&requestStatus, kHeadersReady);
+	release_sem(data_wait);
+}
+
+
+/*!
+	\brief Get the fields, converting them from the arena on first use.
+
+	Only call this when the headers are ready.
+*/
+inline const BHttpFields&
+HttpResultPrivate::Fields()
+{
+	std::call_once(fieldsConverted, [this] {
+		if (!fields)
+			fields = fieldArena.ToFields();
+	});
+	return *fields;
+}
+
+
 inline void
 HttpResultPrivate::SetBody()
 {
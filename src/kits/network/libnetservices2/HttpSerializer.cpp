@@ -21,12 +21,14 @@ using namespace BPrivate::Network;
 
 /*!
 	\brief Set the \a request to serialize, and load the initial data into the \a buffer.
+
+	\a keepAlive tells the server whether the connection may stay open after the response.
 */
 void
-HttpSerializer::SetTo(HttpBuffer& buffer, const BHttpRequest& request)
+HttpSerializer::SetTo(HttpBuffer& buffer, const BHttpRequest& request, bool keepAlive)
 {
 	buffer.Clear();
-	request.SerializeHeaderTo(buffer);
+	request.SerializeHeaderTo(buffer, keepAlive);
 	fState = HttpSerializerState::Header;
 
 	if (auto requestBody = request.RequestBody()) {
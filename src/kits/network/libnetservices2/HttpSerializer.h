@@ -30,7 +30,8 @@ class HttpSerializer
 public:
 								HttpSerializer(){};
 
-			void				SetTo(HttpBuffer& buffer, const BHttpRequest& request);
+			void				SetTo(HttpBuffer& buffer, const BHttpRequest& request,
+									bool keepAlive = false);
 			bool				IsInitialized() const noexcept;
 
 			size_t				Serialize(HttpBuffer& buffer, BDataIO* target);
@@ -12,6 +12,8 @@
 #include <list>
 #include <map>
 #include <optional>
+#include <string>
+#include <tuple>
 #include <vector>
 
 #include <AutoLocker.h>
@@ -56,12 +58,32 @@ struct CounterDeleter {
 };
 
 
+/*!
+	\brief Connections can be reused for requests with the same host, port and protocol.
+*/
+using ConnectionKey = std::tuple<BString, int, bool>;
+
+
+/*!
+	\brief Tag to move a request into a new request that is sent again on another connection.
+
+	This happens when a reused or shared connection turns out to be closed by the server before
+	any part of the response was received, or when a request that was queued behind another one
+	on a connection cannot be answered on it anymore.
+*/
+struct RetryOnNewConnection {
+	bool afterFailure;
+		// the request itself failed, and may not be retried again
+};
+
+
 class BHttpSession::Request
 {
 public:
 	Request(BHttpRequest&& request, BBorrow<BDataIO> target, BMessenger observer);
 
 	Request(Request& original, const Redirect& redirect);
+	Request(Request& original, const RetryOnNewConnection& retry);
 
 	// States
 	enum RequestState { InitialState, Connected, RequestSent, ContentReceived };
@@ -82,6 +104,26 @@ public:
 	bool ReceiveResult();
 	void Disconnect() noexcept;
 
+	// Connection reuse
+	ConnectionKey Key() const;
+	void SetKeepAlive(bool keepAlive) noexcept { fKeepAlive = keepAlive; }
+	void ReuseConnection(std::shared_ptr<BSocket> socket, bool pipelined);
+	std::shared_ptr<BSocket> ConnectionSocket() const noexcept { return fSocket; }
+	bool CanReuseConnection() const noexcept;
+	bool CanRetry() noexcept;
+	std::string_view PendingInput() const noexcept { return fBuffer.Data(); }
+	void SetPendingInput(std::string_view data);
+	bool HasPendingInput() const noexcept { return fPendingInput; }
+	bool HasSentData() const noexcept { return fSerializer.IsInitialized(); }
+	bool KeepAlive() const noexcept { return fKeepAlive; }
+
+	// Pipelining
+	bool CanPipeline() const noexcept;
+	bool IsPipelined() const noexcept { return fPipelined; }
+	void SetPipelined(bool pipelined) noexcept { fPipelined = pipelined; }
+	bool PipelineRejected() const noexcept { return fPipelineRejected; }
+	void SetPipelineRejected() noexcept { fPipelineRejected = true; }
+
 	// Object information
 	int Socket() const noexcept { return fSocket->Socket(); }
 	int32 Id() const noexcept { return fResult->id; }
@@ -102,7 +144,8 @@ private:
 
 	// Connection
 	BNetworkAddress fRemoteAddress;
-	std::unique_ptr<BSocket> fSocket;
+	std::shared_ptr<BSocket> fSocket;
+		// shared by the requests pipelined on one connection
 
 	// Sending and receiving
 	HttpBuffer fBuffer;
@@ -111,12 +154,21 @@ private:
 
 	// Receive state
 	BHttpStatus fStatus;
-	BHttpFields fFields;
+	HttpFieldArena fFields;
+	bool fResponseStarted = false;
+	bool fPendingInput = false;
 
 	// Redirection
 	bool fMightRedirect = false;
 	int8 fRemainingRedirects;
 
+	// Connection reuse
+	bool fKeepAlive = false;
+	bool fReusedConnection = false;
+	bool fPipelined = false;
+	bool fPipelineRejected = false;
+	bool fRetried = false;
+
 	// Connection counter
 	std::unique_ptr<int32, CounterDeleter> fConnectionCounter;
 };
@@ -132,8 +184,24 @@ public:
 	void Cancel(int32 identifier);
 	void SetMaxConnectionsPerHost(size_t maxConnections);
 	void SetMaxHosts(size_t maxConnections);
+	void SetMaxIdleConnectionsPerHost(size_t maxConnections);
+	void SetIdleTimeout(bigtime_t timeout);
+	void SetPipelining(bool enabled, size_t maxDepth);
+	std::vector<BHttpHostStatistics> HostStatistics() const;
 
 private:
+	// Requests sharing a connection, in the order they were sent; the first one is receiving
+	struct Connection {
+		std::shared_ptr<BSocket> socket;
+		std::deque<BHttpSession::Request> requests;
+	};
+	using ConnectionMap = std::map<int, Connection>;
+
+	struct IdleConnection {
+		std::shared_ptr<BSocket> socket;
+		bigtime_t idleSince;
+	};
+
 		// Thread functions
 	static status_t ControlThreadFunc(void* arg);
 	static status_t DataThreadFunc(void* arg);
@@ -141,6 +209,23 @@ private:
 	// Helper functions
 	std::vector<BHttpSession::Request> GetRequestsForControlThread();
 
+	// Connection pool (called with fLock held)
+	void Connect(BHttpSession::Request& request);
+	std::shared_ptr<BSocket> TakeIdleConnection(const ConnectionKey& key);
+	void ReturnIdleConnection(const ConnectionKey& key, std::shared_ptr<BSocket> socket);
+	void PruneIdleConnections();
+	BHttpHostStatistics& StatisticsFor(const ConnectionKey& key);
+
+	// Connection handling in the data thread
+	bool AddToPipeline(BHttpSession::Request& request);
+	bool SendRequests(ConnectionMap::iterator it);
+	void ReceiveResponses(ConnectionMap::iterator it);
+	bool FinishRequest(ConnectionMap::iterator it);
+	void CancelRequest(ConnectionMap::iterator it, int32 identifier);
+	void TruncatePipeline(Connection& connection, size_t index);
+	void CloseConnection(ConnectionMap::iterator it, std::exception_ptr error = nullptr);
+	void RetryRequest(BHttpSession::Request& request, bool afterFailure);
+
 private:
 		// constants (can be accessed unlocked)
 	const sem_id fControlQueueSem;
@@ -149,7 +234,7 @@ private:
 	const thread_id fDataThread;
 
 	// locking mechanism
-	BLocker fLock;
+	mutable BLocker fLock;
 	std::atomic<bool> fQuitting = false;
 
 	// queues & shared data
@@ -157,6 +242,10 @@ private:
 	std::deque<BHttpSession::Request> fDataQueue;
 	std::vector<int32> fCancelList;
 
+	// connection pool & statistics (protected by fLock)
+	std::map<ConnectionKey, std::vector<IdleConnection>> fIdleConnections;
+	std::map<ConnectionKey, BHttpHostStatistics> fHostStatistics;
+
 	// data owned by the controlThread
 	using Host = std::pair<BString, int>;
 	std::map<Host, int32> fConnectionCount;
@@ -164,9 +253,13 @@ private:
 	// data that can only be accessed atomically
 	std::atomic<size_t> fMaxConnectionsPerHost = 2;
 	std::atomic<size_t> fMaxHosts = 10;
+	std::atomic<size_t> fMaxIdleConnectionsPerHost = 2;
+	std::atomic<bigtime_t> fIdleTimeout = 15000000;
+	std::atomic<bool> fPipelining = false;
+	std::atomic<size_t> fMaxPipelineDepth = 4;
 
 	// data owned by the dataThread
-	std::map<int, BHttpSession::Request> connectionMap;
+	ConnectionMap connectionMap;
 	std::vector<object_wait_info> objectList;
 };
 
@@ -273,6 +366,52 @@ BHttpSession::Impl::SetMaxHosts(size_t maxConnections)
 }
 
 
+void
+BHttpSession::Impl::SetMaxIdleConnectionsPerHost(size_t maxConnections)
+{
+	fMaxIdleConnectionsPerHost.store(maxConnections, std::memory_order_relaxed);
+
+	auto lock = AutoLocker<BLocker>(fLock);
+	for (auto& [key, idle]: fIdleConnections) {
+		while (idle.size() > maxConnections) {
+			idle.front().socket->Disconnect();
+			idle.erase(idle.begin());
+		}
+	}
+}
+
+
+void
+BHttpSession::Impl::SetIdleTimeout(bigtime_t timeout)
+{
+	if (timeout <= 0)
+		throw BRuntimeError(__PRETTY_FUNCTION__, "IdleTimeout must be larger than 0");
+	fIdleTimeout.store(timeout, std::memory_order_relaxed);
+}
+
+
+void
+BHttpSession::Impl::SetPipelining(bool enabled, size_t maxDepth)
+{
+	if (maxDepth < 2)
+		throw BRuntimeError(__PRETTY_FUNCTION__, "The pipeline depth must be 2 or more");
+	fMaxPipelineDepth.store(maxDepth, std::memory_order_relaxed);
+	fPipelining.store(enabled, std::memory_order_relaxed);
+}
+
+
+std::vector<BHttpHostStatistics>
+BHttpSession::Impl::HostStatistics() const
+{
+	auto lock = AutoLocker<BLocker>(fLock);
+	std::vector<BHttpHostStatistics> statistics;
+	statistics.reserve(fHostStatistics.size());
+	for (const auto& [key, hostStatistics]: fHostStatistics)
+		statistics.push_back(hostStatistics);
+	return statistics;
+}
+
+
 /*static*/ status_t
 BHttpSession::Impl::ControlThreadFunc(void* arg)
 {
@@ -280,9 +419,16 @@ BHttpSession::Impl::ControlThreadFunc(void* arg)
 
 	// Outer loop to use the fControlQueueSem when new items have entered the queue
 	while (true) {
-		if (auto status = acquire_sem(impl->fControlQueueSem); status == B_INTERRUPTED)
+		if (auto status = acquire_sem_etc(
+				impl->fControlQueueSem, 1, B_RELATIVE_TIMEOUT, impl->fIdleTimeout.load());
+			status == B_INTERRUPTED)
+			continue;
+		else if (status == B_TIMED_OUT) {
+			// Nothing happened for a while; close the connections that have been idle for too long
+			auto lock = AutoLocker<BLocker>(impl->fLock);
+			impl->PruneIdleConnections();
 			continue;
-		else if (status != B_OK) {
+		} else if (status != B_OK) {
 			// Most likely B_BAD_SEM_ID indicating that the sem was deleted; go to cleanup
 			break;
 		}
@@ -299,8 +445,9 @@ BHttpSession::Impl::ControlThreadFunc(void* arg)
 		for (auto& request: requests) {
 			bool hasError = false;
 			try {
-				request.ResolveHostName();
-				request.OpenConnection();
+				// Pipelined requests are sent on a connection the data thread already has
+				if (!request.IsPipelined())
+					impl->Connect(request);
 			} catch (...) {
 				request.SetError(std::current_exception());
 				hasError = true;
@@ -344,9 +491,6 @@ BHttpSession::Impl::ControlThreadFunc(void* arg)
 }
 
 
-static constexpr uint16 EVENT_CANCELLED = 0x4000;
-
-
 /*static*/ status_t
 BHttpSession::Impl::DataThreadFunc(void* arg)
 {
@@ -382,9 +526,23 @@ BHttpSession::Impl::DataThreadFunc(void* arg)
 			while (!data->fDataQueue.empty()) {
 				auto request = std::move(data->fDataQueue.front());
 				data->fDataQueue.pop_front();
-				auto socket = request.Socket();
 
-				data->connectionMap.insert(std::make_pair(socket, std::move(request)));
+				if (request.IsPipelined()) {
+					if (!data->AddToPipeline(request)) {
+						// The connections to the host are gone or busy; wait for a connection of
+						// its own instead
+						request.SetPipelined(false);
+						request.SetPipelineRejected();
+						data->fControlQueue.push_back(std::move(request));
+						release_sem(data->fControlQueueSem);
+					}
+					continue;
+				}
+
+				auto socket = request.Socket();
+				auto& connection = data->connectionMap[socket];
+				connection.socket = request.ConnectionSocket();
+				connection.requests.push_back(std::move(request));
 
 				// Add to objectList
 				data->objectList.push_back(
@@ -392,16 +550,11 @@ BHttpSession::Impl::DataThreadFunc(void* arg)
 			}
 
 			for (auto id: data->fCancelList) {
-				// To cancel, we set a special event status on the
-				// object_wait_info list so that we can handle it below.
-				// Also: the first item in the waitlist is always the semaphore
-				// so the fun starts at offset 1.
-				size_t offset = 0;
-				for (auto it = data->connectionMap.cbegin(); it != data->connectionMap.cend();
-					it++) {
-					offset++;
-					if (it->second.Id() == id) {
-						data->objectList[offset].events = EVENT_CANCELLED;
+				for (auto it = data->connectionMap.begin(); it != data->connectionMap.end(); it++) {
+					const auto& requests = it->second.requests;
+					if (std::any_of(requests.begin(), requests.end(),
+							[id](const auto& request) { return request.Id() == id; })) {
+						data->CancelRequest(it, id);
 						break;
 					}
 				}
@@ -414,119 +567,77 @@ BHttpSession::Impl::DataThreadFunc(void* arg)
 		}
 
 		// Process all objects that are ready
-		bool resizeObjectList = false;
 		for (auto& item: data->objectList) {
-			if (item.type != B_OBJECT_TYPE_FD)
+			if (item.type != B_OBJECT_TYPE_FD || item.events == 0)
 				continue;
-			if ((item.events & B_EVENT_WRITE) == B_EVENT_WRITE) {
-				auto& request = data->connectionMap.find(item.object)->second;
-				auto error = false;
-				try {
-					request.TransferRequest();
-				} catch (...) {
-					request.SetError(std::current_exception());
-					error = true;
-				}
-
-				// End failed writes
-				if (error) {
-					request.Disconnect();
-					data->connectionMap.erase(item.object);
-					release_sem(data->fControlQueueSem);
-						// wake up control thread; there may queued requests unblocked.
-					resizeObjectList = true;
-				}
-			} else if ((item.events & B_EVENT_READ) == B_EVENT_READ) {
-				auto& request = data->connectionMap.find(item.object)->second;
-				auto finished = false;
-				try {
-					if (request.CanCancel())
-						finished = true;
-					else
-						finished = request.ReceiveResult();
-				} catch (const Redirect& r) {
-					// Request is redirected, send back to the controlThread
-					// Move existing request into a new request and hand over to the control queue
-					auto lock = AutoLocker<BLocker>(data->fLock);
-					data->fControlQueue.emplace_back(request, r);
-					release_sem(data->fControlQueueSem);
-
-					finished = true;
-				} catch (...) {
-					request.SetError(std::current_exception());
-					finished = true;
-				}
 
-				if (finished) {
-					// Clean up finished requests; including redirected requests
-					request.Disconnect();
-					data->connectionMap.erase(item.object);
-					release_sem(data->fControlQueueSem);
-						// wake up control thread; there may queued requests unblocked.
-					resizeObjectList = true;
-				}
-			} else if ((item.events & B_EVENT_DISCONNECTED) == B_EVENT_DISCONNECTED) {
-				auto& request = data->connectionMap.find(item.object)->second;
-				try {
-					throw BNetworkRequestError(
-						__PRETTY_FUNCTION__, BNetworkRequestError::NetworkError);
-				} catch (...) {
-					request.SetError(std::current_exception());
-				}
-				data->connectionMap.erase(item.object);
-				resizeObjectList = true;
-			} else if ((item.events & EVENT_CANCELLED) == EVENT_CANCELLED) {
-				auto& request = data->connectionMap.find(item.object)->second;
-				request.Disconnect();
-				try {
-					throw BNetworkRequestError(__PRETTY_FUNCTION__, BNetworkRequestError::Canceled);
-				} catch (...) {
-					request.SetError(std::current_exception());
-				}
-				data->connectionMap.erase(item.object);
-				release_sem(data->fControlQueueSem);
-					// wake up control thread; there may queued requests unblocked.
-				resizeObjectList = true;
-			} else if (item.events == 0) {
-				// No events for this item, skip
+			auto it = data->connectionMap.find(item.object);
+			if (it == data->connectionMap.end()) {
+				// The connection was closed when a request on it was cancelled
 				continue;
-			} else {
+			}
+
+			if ((item.events & (B_EVENT_WRITE | B_EVENT_READ | B_EVENT_DISCONNECTED)) == 0) {
 				// Likely to be B_EVENT_INVALID. This should not happen
-				auto& request = data->connectionMap.find(item.object)->second;
-				request.SendMessage(UrlEvent::DebugMessage, [](BMessage& msg) {
+				it->second.requests.front().SendMessage(UrlEvent::DebugMessage, [](BMessage& msg) {
 					msg.AddUInt32(UrlEventData::DebugType, UrlEventData::DebugError);
 					msg.AddString(UrlEventData::DebugMessage, "Unexpected event; socket deleted?");
 				});
 				throw BRuntimeError(
 					__PRETTY_FUNCTION__, "Socket was deleted at an unexpected time");
 			}
+
+			// With pipelining, a connection may be sending one request and receiving another
+			bool open = true;
+			if ((item.events & B_EVENT_WRITE) == B_EVENT_WRITE)
+				open = data->SendRequests(it);
+
+			if (open && (item.events & B_EVENT_READ) == B_EVENT_READ)
+				data->ReceiveResponses(it);
+			else if (open && (item.events & B_EVENT_DISCONNECTED) == B_EVENT_DISCONNECTED) {
+				try {
+					throw BNetworkRequestError(
+						__PRETTY_FUNCTION__, BNetworkRequestError::NetworkError);
+				} catch (...) {
+					data->CloseConnection(it, std::current_exception());
+				}
+			}
 		}
 
 		// Reset objectList
 		data->objectList[0].events = B_EVENT_ACQUIRE_SEMAPHORE;
-		if (resizeObjectList)
-			data->objectList.resize(data->connectionMap.size() + 1);
+		data->objectList.resize(data->connectionMap.size() + 1);
 
 		auto i = 1;
-		for (auto it = data->connectionMap.cbegin(); it != data->connectionMap.cend(); it++) {
-			data->objectList[i].object = it->first;
-			if (it->second.State() == Request::InitialState)
-				throw BRuntimeError(__PRETTY_FUNCTION__, "Invalid state of request");
-			else if (it->second.State() == Request::Connected)
-				data->objectList[i].events = B_EVENT_WRITE | B_EVENT_DISCONNECTED;
-			else
-				data->objectList[i].events = B_EVENT_READ | B_EVENT_DISCONNECTED;
+		for (const auto& [socket, connection]: data->connectionMap) {
+			uint16 events = B_EVENT_DISCONNECTED;
+			for (const auto& request: connection.requests) {
+				if (request.State() == Request::InitialState)
+					throw BRuntimeError(__PRETTY_FUNCTION__, "Invalid state of request");
+				else if (request.State() == Request::Connected) {
+					events |= B_EVENT_WRITE;
+					break;
+				}
+			}
+			if (connection.requests.front().State() == Request::RequestSent)
+				events |= B_EVENT_READ;
+
+			data->objectList[i].object = socket;
+			data->objectList[i].type = B_OBJECT_TYPE_FD;
+			data->objectList[i].events = events;
 			i++;
 		}
 	}
 	// Clean up and make sure we are quitting
 	if (data->fQuitting.load()) {
 		// Cancel all requests
-		for (auto it = data->connectionMap.begin(); it != data->connectionMap.end(); it++) {
-			try {
-				throw BNetworkRequestError(__PRETTY_FUNCTION__, BNetworkRequestError::Canceled);
-			} catch (...) {
-				it->second.SetError(std::current_exception());
+		for (auto& [socket, connection]: data->connectionMap) {
+			for (auto& request: connection.requests) {
+				try {
+					throw BNetworkRequestError(__PRETTY_FUNCTION__, BNetworkRequestError::Canceled);
+				} catch (...) {
+					request.SetError(std::current_exception());
+				}
 			}
 		}
 	} else {
@@ -541,6 +652,9 @@ BHttpSession::Impl::DataThreadFunc(void* arg)
 	\brief Internal helper that filters the lists of requests to guard against the concurrent
 		requests limit.
 
+	When pipelining is enabled, requests for a host that is at its limit are passed on to be sent
+	on one of its existing connections.
+
 	This method will do the locking of the internal structure.
 */
 std::vector<BHttpSession::Request>
@@ -567,6 +681,12 @@ BHttpSession::Impl::GetRequestsForControlThread()
 		if (it != fConnectionCount.end()) {
 			if (static_cast<size_t>(atomic_get(std::addressof(it->second)))
 				>= fMaxConnectionsPerHost.load(std::memory_order_relaxed)) {
+				if (fPipelining.load(std::memory_order_relaxed) && request.CanPipeline()
+					&& !request.PipelineRejected()) {
+					request.SetPipelined(true);
+					requests.emplace_back(std::move(request));
+					return true;
+				}
 				request.SendMessage(UrlEvent::DebugMessage, [](BMessage& msg) {
 					msg.AddUInt32(UrlEventData::DebugType, UrlEventData::DebugWarning);
 					msg.AddString(UrlEventData::DebugMessage,
@@ -599,6 +719,412 @@ BHttpSession::Impl::GetRequestsForControlThread()
 }
 
 
+/*!
+	\brief Give the \a request a connection, either an idle one from the pool or a new one.
+
+	Called from the control thread, without holding the lock.
+*/
+void
+BHttpSession::Impl::Connect(BHttpSession::Request& request)
+{
+	auto key = request.Key();
+	request.SetKeepAlive(fMaxIdleConnectionsPerHost.load(std::memory_order_relaxed) > 0);
+
+	std::shared_ptr<BSocket> socket;
+	{
+		auto lock = AutoLocker<BLocker>(fLock);
+		socket = TakeIdleConnection(key);
+
+		auto& statistics = StatisticsFor(key);
+		statistics.requests++;
+		if (socket)
+			statistics.connectionsReused++;
+	}
+
+	if (socket) {
+		request.ReuseConnection(std::move(socket), false);
+		return;
+	}
+
+	request.ResolveHostName();
+	bigtime_t start = system_time();
+	request.OpenConnection();
+	bigtime_t handshakeTime = system_time() - start;
+
+	auto lock = AutoLocker<BLocker>(fLock);
+	auto& statistics = StatisticsFor(key);
+	statistics.connectionsOpened++;
+	statistics.handshakeTime += handshakeTime;
+}
+
+
+/*!
+	\brief Take the most recently used idle connection for \a key out of the pool.
+
+	Connections that have been idle for too long, or that were closed by the server in the
+	meantime, are closed instead. Must be called with fLock held.
+*/
+std::shared_ptr<BSocket>
+BHttpSession::Impl::TakeIdleConnection(const ConnectionKey& key)
+{
+	auto it = fIdleConnections.find(key);
+	if (it == fIdleConnections.end())
+		return nullptr;
+
+	auto& idle = it->second;
+	bigtime_t now = system_time();
+	std::shared_ptr<BSocket> socket;
+	while (!idle.empty() && !socket) {
+		auto connection = std::move(idle.back());
+		idle.pop_back();
+
+		// An idle connection only becomes readable when the server closes it
+		if (now - connection.idleSince >= fIdleTimeout.load()
+			|| connection.socket->WaitForReadable(0) == B_OK) {
+			connection.socket->Disconnect();
+			continue;
+		}
+		socket = std::move(connection.socket);
+	}
+
+	if (idle.empty())
+		fIdleConnections.erase(it);
+	return socket;
+}
+
+
+/*!
+	\brief Put the connection for \a key into the pool, unless it is full.
+
+	Must be called with fLock held.
+*/
+void
+BHttpSession::Impl::ReturnIdleConnection(const ConnectionKey& key, std::shared_ptr<BSocket> socket)
+{
+	auto& idle = fIdleConnections[key];
+	if (idle.size() >= fMaxIdleConnectionsPerHost.load(std::memory_order_relaxed)) {
+		socket->Disconnect();
+		if (idle.empty())
+			fIdleConnections.erase(key);
+		return;
+	}
+	idle.push_back(IdleConnection{std::move(socket), system_time()});
+}
+
+
+/*!
+	\brief Close the idle connections that have reached the idle timeout.
+
+	Must be called with fLock held.
+*/
+void
+BHttpSession::Impl::PruneIdleConnections()
+{
+	bigtime_t now = system_time();
+	bigtime_t timeout = fIdleTimeout.load();
+	for (auto it = fIdleConnections.begin(); it != fIdleConnections.end();) {
+		auto& idle = it->second;
+		idle.erase(std::remove_if(idle.begin(), idle.end(),
+			[now, timeout](auto& connection) {
+				if (now - connection.idleSince < timeout)
+					return false;
+				connection.socket->Disconnect();
+				return true;
+			}),
+			idle.end());
+
+		if (idle.empty())
+			it = fIdleConnections.erase(it);
+		else
+			it++;
+	}
+}
+
+
+/*!
+	\brief Get the statistics for \a key, must be called with fLock held.
+*/
+BHttpHostStatistics&
+BHttpSession::Impl::StatisticsFor(const ConnectionKey& key)
+{
+	auto [it, inserted] = fHostStatistics.try_emplace(key);
+	if (inserted) {
+		it->second.host = std::get<0>(key);
+		it->second.port = std::get<1>(key);
+		it->second.secure = std::get<2>(key);
+	}
+	return it->second;
+}
+
+
+/*!
+	\brief Queue a \a request on the least busy connection to its host that allows it.
+
+	Called from the data thread with fLock held.
+
+	\returns \c false if there is no such connection.
+*/
+bool
+BHttpSession::Impl::AddToPipeline(BHttpSession::Request& request)
+{
+	auto key = request.Key();
+	size_t maxDepth = fMaxPipelineDepth.load(std::memory_order_relaxed);
+
+	Connection* target = nullptr;
+	for (auto& [socket, connection]: connectionMap) {
+		const auto& requests = connection.requests;
+		if (requests.size() >= maxDepth || !requests.front().KeepAlive()
+			|| requests.front().Key() != key) {
+			continue;
+		}
+		if (!std::all_of(requests.begin(), requests.end(),
+				[](const auto& request) { return request.CanPipeline(); })) {
+			continue;
+		}
+		if (target == nullptr || requests.size() < target->requests.size())
+			target = &connection;
+	}
+
+	if (target == nullptr)
+		return false;
+
+	request.ReuseConnection(target->socket, true);
+	target->requests.push_back(std::move(request));
+
+	auto& statistics = StatisticsFor(key);
+	statistics.requests++;
+	statistics.requestsPipelined++;
+	return true;
+}
+
+
+/*!
+	\brief Continue sending the first request on the connection that is not fully sent yet.
+
+	\returns \c false if the connection was closed.
+*/
+bool
+BHttpSession::Impl::SendRequests(ConnectionMap::iterator it)
+{
+	auto& requests = it->second.requests;
+	for (size_t index = 0; index < requests.size(); index++) {
+		auto& request = requests[index];
+		if (request.State() != Request::Connected)
+			continue;
+
+		try {
+			request.TransferRequest();
+		} catch (...) {
+			if (index == 0) {
+				CloseConnection(it, std::current_exception());
+				return false;
+			}
+			// The connection is broken; the requests before this one find out when receiving
+			TruncatePipeline(it->second, index);
+		}
+		break;
+	}
+	return true;
+}
+
+
+/*!
+	\brief Receive the response of the first request on the connection.
+
+	When it is complete, the response to the next pipelined request may already have been
+	received along with it, so that one is processed right away.
+*/
+void
+BHttpSession::Impl::ReceiveResponses(ConnectionMap::iterator it)
+{
+	while (true) {
+		auto& request = it->second.requests.front();
+		auto finished = false;
+		try {
+			if (request.CanCancel()) {
+				// The rest of the response is not read, so the connection cannot be reused
+				request.SetKeepAlive(false);
+				finished = true;
+			} else
+				finished = request.ReceiveResult();
+		} catch (const Redirect& r) {
+			// Request is redirected, send back to the controlThread
+			// Move existing request into a new request and hand over to the control queue
+			{
+				auto lock = AutoLocker<BLocker>(fLock);
+				fControlQueue.emplace_back(request, r);
+			}
+			release_sem(fControlQueueSem);
+
+			// The body of the redirect is not read, so the connection cannot be reused
+			it->second.requests.pop_front();
+			CloseConnection(it);
+			return;
+		} catch (...) {
+			CloseConnection(it, std::current_exception());
+			return;
+		}
+
+		if (!finished || !FinishRequest(it))
+			return;
+
+		if (!it->second.requests.front().HasPendingInput())
+			return;
+	}
+}
+
+
+/*!
+	\brief Remove the completed first request from the connection.
+
+	If no other requests are waiting for the connection, it is returned to the pool if possible.
+	Any data that was received beyond the end of the response is handed to the next request.
+
+	\returns \c true if the connection stays open with more requests on it.
+*/
+bool
+BHttpSession::Impl::FinishRequest(ConnectionMap::iterator it)
+{
+	auto& connection = it->second;
+	auto& request = connection.requests.front();
+	auto key = request.Key();
+	auto reusable = request.CanReuseConnection();
+	auto pendingInput = std::string(request.PendingInput());
+	connection.requests.pop_front();
+	release_sem(fControlQueueSem);
+		// wake up control thread; there may queued requests unblocked.
+
+	if (!reusable) {
+		CloseConnection(it);
+		return false;
+	}
+
+	if (connection.requests.empty()) {
+		if (!pendingInput.empty()) {
+			// The server sent data that does not belong to any request
+			CloseConnection(it);
+			return false;
+		}
+		auto socket = std::move(connection.socket);
+		connectionMap.erase(it);
+
+		auto lock = AutoLocker<BLocker>(fLock);
+		ReturnIdleConnection(key, std::move(socket));
+		return false;
+	}
+
+	if (!pendingInput.empty()) {
+		auto& next = connection.requests.front();
+		if (next.State() != Request::RequestSent) {
+			// The server cannot answer a request that was not fully sent yet
+			CloseConnection(it);
+			return false;
+		}
+		next.SetPendingInput(pendingInput);
+	}
+	return true;
+}
+
+
+/*!
+	\brief Cancel the request with \a identifier on the connection.
+
+	Since the responses arrive in order, a request that was already sent cannot be removed from
+	the connection, and the connection will be closed after the requests before it are done.
+*/
+void
+BHttpSession::Impl::CancelRequest(ConnectionMap::iterator it, int32 identifier)
+{
+	auto& requests = it->second.requests;
+	auto requestIt = std::find_if(requests.begin(), requests.end(),
+		[identifier](const auto& request) { return request.Id() == identifier; });
+	if (requestIt == requests.end())
+		return;
+
+	try {
+		throw BNetworkRequestError(__PRETTY_FUNCTION__, BNetworkRequestError::Canceled);
+	} catch (...) {
+		requestIt->SetError(std::current_exception());
+	}
+
+	size_t index = std::distance(requests.begin(), requestIt);
+	if (index == 0) {
+		requests.pop_front();
+		CloseConnection(it);
+	} else if (!requestIt->HasSentData()) {
+		// Nothing after it has been sent either
+		requests.erase(requestIt);
+	} else {
+		TruncatePipeline(it->second, index + 1);
+		requests.erase(requests.begin() + index);
+	}
+}
+
+
+/*!
+	\brief Move the requests from \a index on to new connections, and close the connection after
+		the requests before them.
+*/
+void
+BHttpSession::Impl::TruncatePipeline(Connection& connection, size_t index)
+{
+	auto& requests = connection.requests;
+	for (size_t i = index; i < requests.size(); i++)
+		RetryRequest(requests[i], false);
+	requests.erase(requests.begin() + index, requests.end());
+
+	requests.front().SetKeepAlive(false);
+}
+
+
+/*!
+	\brief Close the connection, and send the requests on it again on new connections.
+
+	If there is an \a error, it applies to the first request; that one is only sent again if it
+	is safe to do so.
+*/
+void
+BHttpSession::Impl::CloseConnection(ConnectionMap::iterator it, std::exception_ptr error)
+{
+	auto connection = std::move(it->second);
+	connectionMap.erase(it);
+	connection.socket->Disconnect();
+
+	size_t index = 0;
+	if (error && !connection.requests.empty()) {
+		auto& request = connection.requests.front();
+		if (request.CanRetry())
+			RetryRequest(request, true);
+		else
+			request.SetError(error);
+		index = 1;
+	}
+
+	for (; index < connection.requests.size(); index++)
+		RetryRequest(connection.requests[index], false);
+
+	release_sem(fControlQueueSem);
+		// wake up control thread; there may queued requests unblocked.
+}
+
+
+/*!
+	\brief Hand the \a request back to the control thread to send it on another connection.
+*/
+void
+BHttpSession::Impl::RetryRequest(BHttpSession::Request& request, bool afterFailure)
+{
+	request.SendMessage(UrlEvent::DebugMessage, [](BMessage& msg) {
+		msg.AddUInt32(UrlEventData::DebugType, UrlEventData::DebugWarning);
+		msg.AddString(UrlEventData::DebugMessage, "Connection lost: request is sent again");
+	});
+
+	auto lock = AutoLocker<BLocker>(fLock);
+	fControlQueue.emplace_back(request, RetryOnNewConnection{afterFailure});
+	release_sem(fControlQueueSem);
+}
+
+
 // #pragma mark -- BHttpSession (public interface)
 
 
@@ -652,6 +1178,58 @@ BHttpSession::SetMaxHosts(size_t maxConnections)
 }
 
 
+void
+BHttpSession::SetMaxIdleConnectionsPerHost(size_t maxConnections)
+{
+	fImpl->SetMaxIdleConnectionsPerHost(maxConnections);
+}
+
+
+void
+BHttpSession::SetIdleTimeout(bigtime_t timeout)
+{
+	fImpl->SetIdleTimeout(timeout);
+}
+
+
+void
+BHttpSession::SetPipelining(bool enabled, size_t maxDepth)
+{
+	fImpl->SetPipelining(enabled, maxDepth);
+}
+
+
+std::vector<BHttpHostStatistics>
+BHttpSession::HostStatistics() const
+{
+	return fImpl->HostStatistics();
+}
+
+
+// #pragma mark -- BHttpHostStatistics
+
+
+/*!
+	\brief The share of the requests that did not have to wait for a new connection.
+*/
+float
+BHttpHostStatistics::ReuseRate() const noexcept
+{
+	if (requests == 0)
+		return 0.0f;
+	return static_cast<float>(connectionsReused + requestsPipelined) / requests;
+}
+
+
+bigtime_t
+BHttpHostStatistics::AverageHandshakeTime() const noexcept
+{
+	if (connectionsOpened == 0)
+		return 0;
+	return handshakeTime / connectionsOpened;
+}
+
+
 // #pragma mark -- BHttpSession::Request (helpers)
 BHttpSession::Request::Request(BHttpRequest&& request, BBorrow<BDataIO> target, BMessenger observer)
 	:
@@ -699,6 +1277,21 @@ BHttpSession::Request::Request(Request& original, const BHttpSession::Redirect&
 }
 
 
+BHttpSession::Request::Request(Request& original, const RetryOnNewConnection& retry)
+	:
+	fRequest(std::move(original.fRequest)),
+	fObserver(original.fObserver),
+	fResult(original.fResult),
+	fRemainingRedirects(original.fRemainingRedirects),
+	fPipelineRejected(original.fPipelineRejected),
+	fRetried(original.fRetried || retry.afterFailure)
+{
+	// inform the parser when we do a HEAD request, so not to expect content
+	if (fRequest.Method() == BHttpMethod::Head)
+		fParser.SetNoContent();
+}
+
+
 /*!
 	\brief Helper that sets the error in the result to \a e and notifies the listeners.
 */
@@ -771,9 +1364,9 @@ BHttpSession::Request::OpenConnection()
 	// Set up the socket
 	if (fRequest.Url().Protocol() == "https") {
 		// To do: secure socket with callbacks to check certificates
-		fSocket = std::make_unique<BSecureSocket>();
+		fSocket = std::make_shared<BSecureSocket>();
 	} else {
-		fSocket = std::make_unique<BSocket>();
+		fSocket = std::make_shared<BSocket>();
 	}
 
 	// Set timeout
@@ -813,7 +1406,7 @@ BHttpSession::Request::TransferRequest()
 			__PRETTY_FUNCTION__, "Write request for object that is not in the Connected state");
 
 	if (!fSerializer.IsInitialized())
-		fSerializer.SetTo(fBuffer, fRequest);
+		fSerializer.SetTo(fBuffer, fRequest, fKeepAlive);
 
 	auto currentBytesWritten = fSerializer.Serialize(fBuffer, fSocket.get());
 
@@ -840,25 +1433,35 @@ BHttpSession::Request::ReceiveResult()
 {
 	// First: stream data from the socket
 	auto bytesRead = fBuffer.ReadFrom(fSocket.get());
+	auto readEnd = bytesRead == 0;
 
-	if (bytesRead == B_WOULD_BLOCK || bytesRead == B_INTERRUPTED)
-		return false;
+	if (bytesRead == B_WOULD_BLOCK || bytesRead == B_INTERRUPTED) {
+		// A pipelined request may already have its response in the buffer
+		if (!fPendingInput)
+			return false;
+		bytesRead = 0;
+	}
+	fPendingInput = false;
 
-	auto readEnd = bytesRead == 0;
+	if (readEnd)
+		fKeepAlive = false;
 
 	// Parse the content in the buffer
 	switch (fParser.State()) {
 		case HttpInputStreamState::StatusLine:
 		{
-			if (fBuffer.RemainingBytes() == static_cast<size_t>(bytesRead)) {
-				// In the initial run, the bytes in the buffer will match the bytes read to indicate
-				// the response has started.
+			if (!fResponseStarted) {
+				fResponseStarted = true;
 				SendMessage(UrlEvent::ResponseStarted);
 			}
 
 			if (fParser.ParseStatus(fBuffer, fStatus)) {
 				// the status headers are now received, decide what to do next
 
+				// Only HTTP/1.1 servers keep the connection open by default
+				if (!fStatus.text.StartsWith("HTTP/1.1"))
+					fKeepAlive = false;
+
 				// Determine if we can handle redirects; else notify of receiving status
 				if (fRemainingRedirects > 0) {
 					switch (fStatus.StatusCode()) {
@@ -926,6 +1529,13 @@ BHttpSession::Request::ReceiveResult()
 
 			// The headers have been received, now set up the rest of the response handling
 
+			// The server may close the connection after the response
+			if (auto connectionField = fFields.FindField("Connection"sv)) {
+				auto value = BString(connectionField->data(), connectionField->size());
+				if (value.IFindFirst("close") >= 0)
+					fKeepAlive = false;
+			}
+
 			// Handle redirects
 			if (fMightRedirect) {
 				auto redirectToGet = false;
@@ -940,14 +1550,14 @@ BHttpSession::Request::ReceiveResult()
 					case BHttpStatusCode::TemporaryRedirect:
 					case BHttpStatusCode::PermanentRedirect:
 					{
-						auto locationField = fFields.FindField("Location");
-						if (locationField == fFields.end()) {
+						auto locationField = fFields.FindField("Location"sv);
+						if (!locationField) {
 							throw BNetworkRequestError(__PRETTY_FUNCTION__,
 								BNetworkRequestError::ProtocolError,
 								"Redirect; the Location field must be present and cannot be found");
 						}
-						auto locationString = BString(
-							(*locationField).Value().data(), (*locationField).Value().size());
+						auto locationString
+							= BString(locationField->data(), locationField->size());
 						auto redirect = BHttpSession::Redirect{
 							BUrl(fRequest.Url(), locationString), redirectToGet};
 						if (!redirect.url.IsValid()) {
@@ -974,7 +1584,8 @@ BHttpSession::Request::ReceiveResult()
 
 			// TODO: Parse received cookies
 
-			// Move headers to the result and inform listener
+			// Move headers to the result and inform listener; the BHttpFields object is only
+			// created when the result is asked for it
 			fResult->SetFields(std::move(fFields));
 			SendMessage(UrlEvent::HttpFields);
 
@@ -1036,6 +1647,105 @@ BHttpSession::Request::ReceiveResult()
 }
 
 
+/*!
+	\brief The key of the connection pool this request can take its connection from.
+*/
+ConnectionKey
+BHttpSession::Request::Key() const
+{
+	const auto& url = fRequest.Url();
+	auto secure = url.Protocol() == "https";
+	int port;
+	if (url.HasPort())
+		port = url.Port();
+	else
+		port = secure ? 443 : 80;
+	return {url.Host(), port, secure};
+}
+
+
+/*!
+	\brief Use the connection of an earlier request on the same host.
+
+	When \a pipelined is \c true, the connection is still in use by other requests, and this
+	request is queued behind them.
+*/
+void
+BHttpSession::Request::ReuseConnection(std::shared_ptr<BSocket> socket, bool pipelined)
+{
+	fSocket = std::move(socket);
+	fSocket->SetTimeout(fRequest.Timeout());
+	fReusedConnection = true;
+	fPipelined = pipelined;
+	if (pipelined)
+		fKeepAlive = true;
+
+	SendMessage(UrlEvent::ConnectionOpened);
+
+	fRequestStatus = Connected;
+}
+
+
+/*!
+	\brief Check if the connection can be used by another request after this one completed.
+*/
+bool
+BHttpSession::Request::CanReuseConnection() const noexcept
+{
+	return fKeepAlive && fRequestStatus == ContentReceived && fParser.Complete();
+}
+
+
+/*!
+	\brief Check if the request can be sent again after its connection failed.
+
+	This is only done when the connection was reused, since the server may have closed it just
+	before the request was sent, and only for idempotent requests that did not get any part of a
+	response yet. A request is retried after a failure only once.
+*/
+bool
+BHttpSession::Request::CanRetry() noexcept
+{
+	if (fRetried || fResponseStarted || !fReusedConnection)
+		return false;
+
+	const auto& method = fRequest.Method();
+	if (method != BHttpMethod::Get && method != BHttpMethod::Head && method != BHttpMethod::Put
+		&& method != BHttpMethod::Delete && method != BHttpMethod::Options
+		&& method != BHttpMethod::Trace) {
+		return false;
+	}
+	return fRequest.RewindBody();
+}
+
+
+/*!
+	\brief Hand over the \a data that was received after the response of the previous request on
+		the connection.
+*/
+void
+BHttpSession::Request::SetPendingInput(std::string_view data)
+{
+	fBuffer.Clear();
+	fBuffer << data;
+	fPendingInput = true;
+}
+
+
+/*!
+	\brief Check if the request can be queued behind other requests on a connection.
+
+	Only requests that are safe to send again, and that do not have a body, are pipelined.
+*/
+bool
+BHttpSession::Request::CanPipeline() const noexcept
+{
+	const auto& method = fRequest.Method();
+	return (method == BHttpMethod::Get || method == BHttpMethod::Head)
+		&& fRequest.RequestBody() == nullptr;
+}
+
+
 /*!
 	\brief Disconnect the socket. Does not validate if it actually succeeded.
 */
@@ -12,8 +12,10 @@
 #include "MimeType.h"
 
 #include <Bitmap.h>
+#include <Node.h>
 #include <mime/database_support.h>
 #include <mime/DatabaseLocation.h>
+#include <mime/DatabaseSnapshot.h>
 #include <sniffer/Rule.h>
 #include <sniffer/Parser.h>
 
@@ -30,6 +32,7 @@ using namespace BPrivate;
 
 // Private helper functions
 static bool isValidMimeChar(const char ch);
+static status_t openTypeIconNode(const char* type, BNode& node);
 
 using namespace BPrivate::Storage::Mime;
 using namespace std;
@@ -68,6 +71,21 @@ isValidMimeChar(const char ch)
 }
 
 
+// Opens the node holding the icons of the given type, preferably at the
+// location the database snapshot knows, saving the directory lookups.
+static status_t
+openTypeIconNode(const char* type, BNode& node)
+{
+	BString path;
+	if (default_database_snapshot()->GetIconLocation(type, path) == B_OK
+		&& node.SetTo(path.String()) == B_OK) {
+		return B_OK;
+	}
+
+	return default_database_location()->OpenType(type, node);
+}
+
+
 //	#pragma mark -
 
 
@@ -323,9 +341,12 @@ BMimeType::GetIcon(BBitmap* icon, icon_size size) const
 	if (icon == NULL)
 		return B_BAD_VALUE;
 
+	BNode node;
 	status_t err = InitCheck();
 	if (err == B_OK)
-		err = default_database_location()->GetIcon(Type(), *icon, size);
+		err = openTypeIconNode(Type(), node);
+	if (err == B_OK)
+		err = DatabaseLocation::GetIconForType(node, NULL, *icon, size);
 
 	return err;
 }
@@ -338,9 +359,12 @@ BMimeType::GetIcon(uint8** data, size_t* size) const
 	if (data == NULL || size == NULL)
 		return B_BAD_VALUE;
 
+	BNode node;
 	status_t err = InitCheck();
 	if (err == B_OK)
-		err = default_database_location()->GetIcon(Type(), *data, *size);
+		err = openTypeIconNode(Type(), node);
+	if (err == B_OK)
+		err = DatabaseLocation::GetIconForType(node, NULL, *data, *size);
 
 	return err;
 }
@@ -353,8 +377,14 @@ BMimeType::GetPreferredApp(char* signature, app_verb verb) const
 {
 	status_t err = InitCheck();
 	if (err == B_OK) {
-		err = default_database_location()->GetPreferredApp(Type(), signature,
-			verb);
+		// the snapshot only knows about the B_OPEN verb
+		err = verb == B_OPEN
+			? default_database_snapshot()->GetPreferredApp(Type(), signature)
+			: B_NO_INIT;
+		if (err == B_NO_INIT) {
+			err = default_database_location()->GetPreferredApp(Type(),
+				signature, verb);
+		}
 	}
 
 	return err;
@@ -387,8 +417,12 @@ BMimeType::GetFileExtensions(BMessage* extensions) const
 
 	status_t err = InitCheck();
 	if (err == B_OK) {
-		err = default_database_location()->GetFileExtensions(Type(),
-			*extensions);
+		err = default_database_snapshot()->GetFileExtensions(Type(),
+			extensions);
+		if (err == B_NO_INIT) {
+			err = default_database_location()->GetFileExtensions(Type(),
+				*extensions);
+		}
 	}
 
 	return err;
@@ -401,8 +435,12 @@ BMimeType::GetShortDescription(char* description) const
 {
 	status_t err = InitCheck();
 	if (err == B_OK) {
-		err = default_database_location()->GetShortDescription(Type(),
+		err = default_database_snapshot()->GetShortDescription(Type(),
 			description);
+		if (err == B_NO_INIT) {
+			err = default_database_location()->GetShortDescription(Type(),
+				description);
+		}
 	}
 
 	return err;
@@ -431,12 +469,18 @@ BMimeType::GetSupportingApps(BMessage* signatures) const
 	if (signatures == NULL)
 		return B_BAD_VALUE;
 
+	status_t err = InitCheck();
+	if (err != B_OK)
+		return err;
+
+	err = default_database_snapshot()->GetSupportingApps(Type(), signatures);
+	if (err != B_NO_INIT)
+		return err;
+
 	BMessage message(B_REG_MIME_GET_SUPPORTING_APPS);
 	status_t result;
 
-	status_t err = InitCheck();
-	if (err == B_OK)
-		err = message.AddString("type", Type());
+	err = message.AddString("type", Type());
 	if (err == B_OK)
 		err = BRoster::Private().SendTo(&message, signatures, true);
 	if (err == B_OK) {
@@ -663,10 +707,15 @@ BMimeType::GetInstalledSupertypes(BMessage* supertypes)
 	if (supertypes == NULL)
 		return B_BAD_VALUE;
 
+	status_t err
+		= default_database_snapshot()->GetInstalledSupertypes(supertypes);
+	if (err != B_NO_INIT)
+		return err;
+
 	BMessage message(B_REG_MIME_GET_INSTALLED_SUPERTYPES);
 	status_t result;
 
-	status_t err = BRoster::Private().SendTo(&message, supertypes, true);
+	err = BRoster::Private().SendTo(&message, supertypes, true);
 	if (err == B_OK) {
 		err = (status_t)(supertypes->what == B_REG_RESULT ? B_OK
 			: B_BAD_REPLY);
@@ -697,11 +746,16 @@ BMimeType::GetInstalledTypes(const char* supertype, BMessage* types)
 	if (types == NULL)
 		return B_BAD_VALUE;
 
+	status_t err
+		= default_database_snapshot()->GetInstalledTypes(supertype, types);
+	if (err != B_NO_INIT)
+		return err;
+
 	status_t result;
 
 	// Build and send the message, read the reply
 	BMessage message(B_REG_MIME_GET_INSTALLED_TYPES);
-	status_t err = B_OK;
+	err = B_OK;
 
 	if (supertype != NULL)
 		err = message.AddString("supertype", supertype);
@@ -821,11 +875,12 @@ BMimeType::GetIconForType(const char* type, BBitmap* icon, icon_size which) cons
 	// we need to make sure the give type is valid.
 	status_t err;
 	if (type) {
+		BNode node;
 		err = BMimeType::IsValid(type) ? B_OK : B_BAD_VALUE;
-		if (err == B_OK) {
-			err = default_database_location()->GetIconForType(Type(), type,
-				*icon, which);
-		}
+		if (err == B_OK)
+			err = openTypeIconNode(Type(), node);
+		if (err == B_OK)
+			err = DatabaseLocation::GetIconForType(node, type, *icon, which);
 	} else
 		err = GetIcon(icon, which);
 
@@ -849,8 +904,12 @@ BMimeType::GetIconForType(const char* type, uint8** _data, size_t* _size) const
 	if (!BMimeType::IsValid(type))
 		return B_BAD_VALUE;
 
-	return default_database_location()->GetIconForType(Type(), type, *_data,
-		*_size);
+	BNode node;
+	status_t err = openTypeIconNode(Type(), node);
+	if (err != B_OK)
+		return err;
+
+	return DatabaseLocation::GetIconForType(node, type, *_data, *_size);
 }
 
 
@@ -964,8 +1023,11 @@ BMimeType::GetSnifferRule(BString* result) const
 		return B_BAD_VALUE;
 
 	status_t err = InitCheck();
-	if (err == B_OK)
-		err = default_database_location()->GetSnifferRule(Type(), *result);
+	if (err == B_OK) {
+		err = default_database_snapshot()->GetSnifferRule(Type(), *result);
+		if (err == B_NO_INIT)
+			err = default_database_location()->GetSnifferRule(Type(), *result);
+	}
 
 	return err;
 }
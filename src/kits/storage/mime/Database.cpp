@@ -51,6 +51,15 @@ Database::NotificationListener::~NotificationListener()
 }
 
 
+/*!	Invoked whenever the database has been modified, before the watchers
+	are notified. The default implementation does nothing.
+*/
+void
+Database::NotificationListener::DatabaseChanged()
+{
+}
+
+
 /*!
 	\class Database
 	\brief Mime::Database is the master of the MIME data base.
@@ -1371,6 +1380,55 @@ Database::UndeferInstallNotification(const char* type)
 }
 
 
+// WriteSnapshot
+/*! \brief Writes a DatabaseSnapshot of the installed types and supporting
+	apps to \a path.
+*/
+status_t
+Database::WriteSnapshot(const char *path)
+{
+	DatabaseSnapshot::TypeMap types;
+
+	BMessage supertypes;
+	status_t err = GetInstalledSupertypes(&supertypes);
+
+	const char *supertype;
+	for (int32 i = 0; !err
+			&& supertypes.FindString(kSupertypesField, i, &supertype) == B_OK;
+			i++) {
+		err = _GetSnapshotTypeInfo(supertype, types[BString(supertype)
+			.ToLower().String()]);
+
+		BMessage subtypes;
+		if (!err)
+			err = GetInstalledTypes(supertype, &subtypes);
+
+		const char *type;
+		for (int32 j = 0; !err
+				&& subtypes.FindString(kTypesField, j, &type) == B_OK; j++) {
+			err = _GetSnapshotTypeInfo(type,
+				types[BString(type).ToLower().String()]);
+		}
+	}
+
+	std::map<std::string, std::set<std::string> > supportingApps;
+	if (!err)
+		err = fSupportingApps.GetAllSupportingApps(supportingApps);
+
+	std::map<std::string, std::set<std::string> >::const_iterator i;
+	for (i = supportingApps.begin(); !err && i != supportingApps.end(); i++) {
+		if (i->second.empty())
+			continue;
+		DatabaseSnapshot::TypeInfo &info = types[i->first];
+		info.supportingApps.assign(i->second.begin(), i->second.end());
+	}
+
+	if (!err)
+		err = DatabaseSnapshot::Write(path, types);
+	return err;
+}
+
+
 //! \brief Sends a \c B_MIME_TYPE_CREATED notification to the mime monitor service
 status_t
 Database::_SendInstallNotification(const char *type)
@@ -1511,6 +1569,8 @@ Database::_SendMonitorUpdate(BMessage &msg)
 	if (fNotificationListener == NULL)
 		return B_OK;
 
+	fNotificationListener->DatabaseChanged();
+
 	status_t err;
 	std::set<BMessenger>::const_iterator i;
 	for (i = fMonitorMessengers.begin(); i != fMonitorMessengers.end(); i++) {
@@ -1524,6 +1584,44 @@ Database::_SendMonitorUpdate(BMessage &msg)
 }
 
 
+status_t
+Database::_GetSnapshotTypeInfo(const char *type,
+	DatabaseSnapshot::TypeInfo &info)
+{
+	info.name = type;
+	info.installed = true;
+
+	// Get the change time before reading the attributes, so that a
+	// concurrent change makes the entry look outdated, not the other way
+	// around.
+	BString string;
+	if (fLocation->GetPathForType(type, string) == B_OK
+		&& DatabaseSnapshot::GetChangeTime(string, info.changeTime) == B_OK) {
+		info.path = string.String();
+	}
+
+	char buffer[B_MIME_TYPE_LENGTH];
+	if (fLocation->GetShortDescription(type, buffer) == B_OK)
+		info.shortDescription = buffer;
+	if (fLocation->GetPreferredApp(type, buffer, B_OPEN) == B_OK)
+		info.preferredApp = buffer;
+
+	if (fLocation->GetSnifferRule(type, string) == B_OK)
+		info.snifferRule = string.String();
+
+	BMessage extensions;
+	if (fLocation->GetFileExtensions(type, extensions) == B_OK) {
+		const char *extension;
+		for (int32 i = 0; extensions.FindString(kExtensionsField, i,
+				&extension) == B_OK; i++) {
+			info.extensions.push_back(extension);
+		}
+	}
+
+	return B_OK;
+}
+
+
 Database::DeferredInstallNotification*
 Database::_FindDeferredInstallNotification(const char* type, bool remove)
 {
@@ -53,6 +53,29 @@ DatabaseLocation::AddDirectory(const BString& directory)
 }
 
 
+/*!	Returns the path of the file holding the given type, i.e. the one
+	in the first database directory the type is found in.
+
+	\param type The MIME type.
+	\param _path The path of the type's file.
+
+	\return A status code, \c B_ENTRY_NOT_FOUND if the type isn't installed.
+*/
+status_t
+DatabaseLocation::GetPathForType(const char* type, BString& _path) const
+{
+	if (type == NULL)
+		return B_BAD_VALUE;
+
+	BNode node;
+	int32 index;
+	status_t result = _OpenType(type, node, index);
+	if (result == B_OK)
+		_path = _TypeToFilename(type, index);
+	return result;
+}
+
+
 /*!	Opens a BNode on the given type, failing if the type has no
 	corresponding file in the database.
 
@@ -561,6 +584,19 @@ DatabaseLocation::GetIconForType(const char* type, const char* fileType,
 	if (result != B_OK)
 		return result;
 
+	return GetIconForType(node, fileType, _icon, which);
+}
+
+
+/*!	Fetches the large or mini icon used by an application for files of the
+	given type from the already opened node of the application's type.
+
+	\see GetIconForType(const char*, const char*, BBitmap&, icon_size)
+*/
+/*static*/ status_t
+DatabaseLocation::GetIconForType(BNode& typeNode, const char* fileType,
+	BBitmap& _icon, icon_size which)
+{
 	// construct our attribute name
 	BString vectorIconAttrName;
 	BString smallIconAttrName;
@@ -579,8 +615,8 @@ DatabaseLocation::GetIconForType(const char* type, const char* fileType,
 		largeIconAttrName = kLargeIconAttr;
 	}
 
-	return BIconUtils::GetIcon(&node, vectorIconAttrName, smallIconAttrName,
-		largeIconAttrName, which, &_icon);
+	return BIconUtils::GetIcon(&typeNode, vectorIconAttrName,
+		smallIconAttrName, largeIconAttrName, which, &_icon);
 }
 
 
@@ -618,6 +654,19 @@ DatabaseLocation::GetIconForType(const char* type, const char* fileType,
 	if (result != B_OK)
 		return result;
 
+	return GetIconForType(node, fileType, _data, _size);
+}
+
+
+/*!	Fetches the vector icon used by an application for files of the given
+	type from the already opened node of the application's type.
+
+	\see GetIconForType(const char*, const char*, uint8*&, size_t&)
+*/
+/*static*/ status_t
+DatabaseLocation::GetIconForType(BNode& typeNode, const char* fileType,
+	uint8*& _data, size_t& _size)
+{
 	// construct our attribute name
 	BString iconAttrName;
 
@@ -628,8 +677,7 @@ DatabaseLocation::GetIconForType(const char* type, const char* fileType,
 
 	// get info about attribute for that name
 	attr_info info;
-	if (result == B_OK)
-		result = node.GetAttrInfo(iconAttrName, &info);
+	status_t result = typeNode.GetAttrInfo(iconAttrName, &info);
 
 	// validate attribute type
 	if (result == B_OK)
@@ -643,8 +691,8 @@ DatabaseLocation::GetIconForType(const char* type, const char* fileType,
 
 		ssize_t bytesRead = -1;
 		if (result == B_OK) {
-			bytesRead = node.ReadAttr(iconAttrName, B_VECTOR_ICON_TYPE, 0, buffer,
-				info.size);
+			bytesRead = typeNode.ReadAttr(iconAttrName, B_VECTOR_ICON_TYPE, 0,
+				buffer, info.size);
 		}
 
 		if (bytesRead >= 0)
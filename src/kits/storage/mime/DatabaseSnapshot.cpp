@@ -0,0 +1,778 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <mime/DatabaseSnapshot.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <new>
+
+#include <AutoLocker.h>
+#include <Message.h>
+#include <MimeType.h>
+
+#include <mime/database_support.h>
+#include <mime/DatabaseLocation.h>
+
+
+namespace BPrivate {
+namespace Storage {
+namespace Mime {
+
+
+static const uint32 kSnapshotMagic = 'MDBs';
+static const uint32 kSnapshotVersion = 2;
+static const char* kSnapshotSuffix = ".snapshot";
+
+enum {
+	kTypeInstalled	= 0x01,
+	kTypeSupertype	= 0x02,
+};
+
+
+/*!	On disk layout: the header, the type entries sorted by their (lower
+	case) key, a pool of string offsets referenced by the entries' lists and
+	the string pool itself. String offset 0 is the empty string and denotes
+	an absent value.
+
+	An entry's path is the file in the first database directory holding the
+	type; its attributes are the type's icons. The change time is the one of
+	that file (in nanoseconds) when the snapshot was written.
+*/
+struct DatabaseSnapshot::Header {
+	uint32	magic;
+	uint32	version;
+	uint32	size;
+	uint32	typeCount;
+	uint32	typesOffset;
+	uint32	listCount;
+	uint32	listsOffset;
+	uint32	stringsSize;
+	uint32	stringsOffset;
+	uint32	padding;		// keeps the type entries 8 byte aligned
+};
+
+
+struct DatabaseSnapshot::TypeEntry {
+	int64	changeTime;
+	uint32	key;
+	uint32	name;
+	uint32	flags;
+	uint32	shortDescription;
+	uint32	preferredApp;
+	uint32	snifferRule;
+	uint32	path;
+	uint32	extensions;
+	uint32	extensionCount;
+	uint32	supportingApps;
+	uint32	supportingAppCount;
+	uint32	padding;
+};
+
+
+namespace {
+
+
+class StringPool {
+public:
+	StringPool()
+	{
+		fData.push_back('\0');
+	}
+
+	uint32 Add(const std::string& string)
+	{
+		if (string.empty())
+			return 0;
+
+		std::map<std::string, uint32>::iterator it = fOffsets.find(string);
+		if (it != fOffsets.end())
+			return it->second;
+
+		uint32 offset = fData.size();
+		fData.insert(fData.end(), string.begin(), string.end());
+		fData.push_back('\0');
+		fOffsets[string] = offset;
+		return offset;
+	}
+
+	const std::vector<char>& Data() const
+	{
+		return fData;
+	}
+
+private:
+	std::vector<char>				fData;
+	std::map<std::string, uint32>	fOffsets;
+};
+
+
+uint32
+add_list(std::vector<uint32>& lists, StringPool& strings,
+	const std::vector<std::string>& list)
+{
+	uint32 index = lists.size();
+	for (size_t i = 0; i < list.size(); i++)
+		lists.push_back(strings.Add(list[i]));
+	return index;
+}
+
+
+status_t
+write_fully(int fd, const void* buffer, size_t size)
+{
+	const uint8* data = (const uint8*)buffer;
+	while (size > 0) {
+		ssize_t written = write(fd, data, size);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			return errno;
+		}
+		data += written;
+		size -= written;
+	}
+	return B_OK;
+}
+
+
+}	// unnamed namespace
+
+
+DatabaseSnapshot::DatabaseSnapshot(const char* path,
+	const DatabaseLocation* location)
+	:
+	fLock("mime db snapshot"),
+	fPath(path),
+	fLocation(location),
+	fData(NULL),
+	fSize(0),
+	fDevice(-1),
+	fNode(-1),
+	fHeader(NULL),
+	fTypes(NULL),
+	fLists(NULL),
+	fStrings(NULL)
+{
+}
+
+
+DatabaseSnapshot::~DatabaseSnapshot()
+{
+	_Unset();
+}
+
+
+/*!	Writes a snapshot of \a types to \a path.
+
+	The snapshot is written to a temporary file first and renamed into
+	place, so readers never see a partially written one.
+*/
+/*static*/ status_t
+DatabaseSnapshot::Write(const char* path, const TypeMap& types)
+{
+	if (path == NULL)
+		return B_BAD_VALUE;
+
+	StringPool strings;
+	std::vector<uint32> lists;
+	std::vector<TypeEntry> entries;
+	entries.reserve(types.size());
+
+	for (TypeMap::const_iterator it = types.begin(); it != types.end(); it++) {
+		const TypeInfo& info = it->second;
+
+		TypeEntry entry;
+		memset(&entry, 0, sizeof(entry));
+		entry.changeTime = info.changeTime;
+		entry.key = strings.Add(it->first);
+		entry.name = strings.Add(info.name.empty() ? it->first : info.name);
+		entry.flags = 0;
+		if (info.installed)
+			entry.flags |= kTypeInstalled;
+		if (it->first.find('/') == std::string::npos)
+			entry.flags |= kTypeSupertype;
+		entry.shortDescription = strings.Add(info.shortDescription);
+		entry.preferredApp = strings.Add(info.preferredApp);
+		entry.snifferRule = strings.Add(info.snifferRule);
+		entry.path = strings.Add(info.path);
+		entry.extensions = add_list(lists, strings, info.extensions);
+		entry.extensionCount = info.extensions.size();
+		entry.supportingApps = add_list(lists, strings, info.supportingApps);
+		entry.supportingAppCount = info.supportingApps.size();
+		entries.push_back(entry);
+	}
+
+	const std::vector<char>& stringData = strings.Data();
+
+	Header header;
+	memset(&header, 0, sizeof(header));
+	header.magic = kSnapshotMagic;
+	header.version = kSnapshotVersion;
+	header.typeCount = entries.size();
+	header.typesOffset = sizeof(Header);
+	header.listCount = lists.size();
+	header.listsOffset = header.typesOffset
+		+ entries.size() * sizeof(TypeEntry);
+	header.stringsSize = stringData.size();
+	header.stringsOffset = header.listsOffset + lists.size() * sizeof(uint32);
+	header.size = header.stringsOffset + header.stringsSize;
+
+	BString tempPath(path);
+	tempPath << ".tmp";
+
+	int fd = open(tempPath.String(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return errno;
+
+	status_t status = write_fully(fd, &header, sizeof(header));
+	if (status == B_OK && !entries.empty()) {
+		status = write_fully(fd, &entries[0],
+			entries.size() * sizeof(TypeEntry));
+	}
+	if (status == B_OK && !lists.empty())
+		status = write_fully(fd, &lists[0], lists.size() * sizeof(uint32));
+	if (status == B_OK)
+		status = write_fully(fd, &stringData[0], stringData.size());
+	close(fd);
+
+	if (status == B_OK && rename(tempPath.String(), path) != 0)
+		status = errno;
+	if (status != B_OK)
+		unlink(tempPath.String());
+
+	return status;
+}
+
+
+/*static*/ BString
+DatabaseSnapshot::DefaultPath(const DatabaseLocation* location)
+{
+	BString path = location->WritableDirectory();
+	path << kSnapshotSuffix;
+	return path;
+}
+
+
+/*!	Returns the change time of the file at \a path, as stored in the
+	snapshot. Unlike the modification time, it is also updated when an
+	attribute is written.
+*/
+/*static*/ status_t
+DatabaseSnapshot::GetChangeTime(const char* path, int64& _changeTime)
+{
+	struct stat st;
+	if (stat(path, &st) != 0)
+		return errno;
+
+	_changeTime = (int64)st.st_ctim.tv_sec * 1000000000LL
+		+ st.st_ctim.tv_nsec;
+	return B_OK;
+}
+
+
+/*!	Returns the installed types, or the installed subtypes of \a supertype,
+	like InstalledTypes does. Returns \c B_NO_INIT, if there is no current
+	snapshot.
+*/
+status_t
+DatabaseSnapshot::GetInstalledTypes(const char* supertype, BMessage* types)
+{
+	if (types == NULL)
+		return B_BAD_VALUE;
+
+	BString prefix;
+	if (supertype != NULL) {
+		BMimeType mime;
+		if (mime.SetTo(supertype) != B_OK || !mime.IsSupertypeOnly())
+			return B_BAD_VALUE;
+		prefix = supertype;
+		prefix.ToLower();
+	}
+
+	AutoLocker<BLocker> locker(fLock);
+	status_t status = _Update();
+	if (status != B_OK)
+		return status;
+
+	types->MakeEmpty();
+
+	uint32 first = 0;
+	if (supertype != NULL) {
+		const TypeEntry* super = _FindType(prefix.String());
+		if (super == NULL || (super->flags & kTypeInstalled) == 0)
+			return B_NAME_NOT_FOUND;
+		prefix << '/';
+		first = _LowerBound(prefix.String());
+	}
+
+	for (uint32 i = first; i < fHeader->typeCount && status == B_OK; i++) {
+		const TypeEntry& entry = fTypes[i];
+		if (supertype != NULL && strncmp(_StringAt(entry.key),
+				prefix.String(), prefix.Length()) != 0) {
+			break;
+		}
+		if ((entry.flags & kTypeInstalled) != 0)
+			status = types->AddString(kTypesField, _StringAt(entry.name));
+	}
+	return status;
+}
+
+
+status_t
+DatabaseSnapshot::GetInstalledSupertypes(BMessage* types)
+{
+	if (types == NULL)
+		return B_BAD_VALUE;
+
+	AutoLocker<BLocker> locker(fLock);
+	status_t status = _Update();
+	if (status != B_OK)
+		return status;
+
+	types->MakeEmpty();
+
+	for (uint32 i = 0; i < fHeader->typeCount && status == B_OK; i++) {
+		const TypeEntry& entry = fTypes[i];
+		if ((entry.flags & (kTypeInstalled | kTypeSupertype))
+				== (kTypeInstalled | kTypeSupertype)) {
+			status = types->AddString(kSupertypesField, _StringAt(entry.name));
+		}
+	}
+	return status;
+}
+
+
+/*!	Returns the supporting apps of \a type in the format used by
+	SupportingApps::GetSupportingApps().
+*/
+status_t
+DatabaseSnapshot::GetSupportingApps(const char* type, BMessage* signatures)
+{
+	if (type == NULL || signatures == NULL)
+		return B_BAD_VALUE;
+
+	BMimeType mime(type);
+	status_t status = mime.InitCheck();
+	if (status != B_OK)
+		return status;
+
+	BString key(type);
+	key.ToLower();
+
+	AutoLocker<BLocker> locker(fLock);
+	status = _Update();
+	if (status != B_OK)
+		return status;
+
+	signatures->MakeEmpty();
+
+	const TypeEntry* entry = _FindType(key.String());
+	uint32 count = entry != NULL ? entry->supportingAppCount : 0;
+	if (entry != NULL) {
+		status = _AddStrings(signatures, kApplicationsField,
+			entry->supportingApps, count);
+	}
+
+	if (mime.IsSupertypeOnly()) {
+		if (status == B_OK)
+			status = signatures->AddInt32(kSupportingAppsSuperCountField, count);
+		return status;
+	}
+
+	if (status == B_OK)
+		status = signatures->AddInt32(kSupportingAppsSubCountField, count);
+
+	// add the apps supporting the supertype, but not the subtype
+	key.Truncate(key.FindFirst('/'));
+	const TypeEntry* superEntry = _FindType(key.String());
+	int32 superCount = 0;
+	for (uint32 i = 0; superEntry != NULL
+			&& i < superEntry->supportingAppCount && status == B_OK; i++) {
+		const char* app = _StringAt(fLists[superEntry->supportingApps + i]);
+
+		bool supportsSubtype = false;
+		for (uint32 j = 0; j < count; j++) {
+			if (strcmp(app, _StringAt(fLists[entry->supportingApps + j]))
+					== 0) {
+				supportsSubtype = true;
+				break;
+			}
+		}
+		if (!supportsSubtype) {
+			status = signatures->AddString(kApplicationsField, app);
+			superCount++;
+		}
+	}
+	if (status == B_OK)
+		status = signatures->AddInt32(kSupportingAppsSuperCountField, superCount);
+
+	return status;
+}
+
+
+status_t
+DatabaseSnapshot::GetShortDescription(const char* type, char* description)
+{
+	if (type == NULL || description == NULL)
+		return B_BAD_VALUE;
+
+	BString key(type);
+	key.ToLower();
+
+	AutoLocker<BLocker> locker(fLock);
+	status_t status = _Update();
+	if (status != B_OK)
+		return status;
+
+	const TypeEntry* entry = _FindCurrentType(key.String());
+	if (entry == NULL)
+		return B_NO_INIT;
+	if (entry->shortDescription == 0)
+		return B_ENTRY_NOT_FOUND;
+
+	strlcpy(description, _StringAt(entry->shortDescription),
+		B_MIME_TYPE_LENGTH);
+	return B_OK;
+}
+
+
+status_t
+DatabaseSnapshot::GetPreferredApp(const char* type, char* signature)
+{
+	if (type == NULL || signature == NULL)
+		return B_BAD_VALUE;
+
+	BString key(type);
+	key.ToLower();
+
+	AutoLocker<BLocker> locker(fLock);
+	status_t status = _Update();
+	if (status != B_OK)
+		return status;
+
+	const TypeEntry* entry = _FindCurrentType(key.String());
+	if (entry == NULL)
+		return B_NO_INIT;
+	if (entry->preferredApp == 0)
+		return B_ENTRY_NOT_FOUND;
+
+	strlcpy(signature, _StringAt(entry->preferredApp), B_MIME_TYPE_LENGTH);
+	return B_OK;
+}
+
+
+/*!	Returns the file extensions of \a type in the format used by
+	DatabaseLocation::GetFileExtensions().
+*/
+status_t
+DatabaseSnapshot::GetFileExtensions(const char* type, BMessage* extensions)
+{
+	if (type == NULL || extensions == NULL)
+		return B_BAD_VALUE;
+
+	BString key(type);
+	key.ToLower();
+
+	AutoLocker<BLocker> locker(fLock);
+	status_t status = _Update();
+	if (status != B_OK)
+		return status;
+
+	const TypeEntry* entry = _FindCurrentType(key.String());
+	if (entry == NULL)
+		return B_NO_INIT;
+
+	extensions->MakeEmpty();
+	extensions->what = 234;
+		// see DatabaseLocation::GetFileExtensions()
+	status = _AddStrings(extensions, kExtensionsField, entry->extensions,
+		entry->extensionCount);
+	if (status == B_OK)
+		status = extensions->AddString("type", type);
+	return status;
+}
+
+
+status_t
+DatabaseSnapshot::GetSnifferRule(const char* type, BString& rule)
+{
+	if (type == NULL)
+		return B_BAD_VALUE;
+
+	BString key(type);
+	key.ToLower();
+
+	AutoLocker<BLocker> locker(fLock);
+	status_t status = _Update();
+	if (status != B_OK)
+		return status;
+
+	const TypeEntry* entry = _FindCurrentType(key.String());
+	if (entry == NULL)
+		return B_NO_INIT;
+	if (entry->snifferRule == 0)
+		return B_ENTRY_NOT_FOUND;
+
+	rule = _StringAt(entry->snifferRule);
+	return B_OK;
+}
+
+
+/*!	Returns the path of the file holding the icons of \a type, so that they
+	can be read without searching the database directories.
+*/
+status_t
+DatabaseSnapshot::GetIconLocation(const char* type, BString& path)
+{
+	if (type == NULL)
+		return B_BAD_VALUE;
+
+	BString key(type);
+	key.ToLower();
+
+	AutoLocker<BLocker> locker(fLock);
+	status_t status = _Update();
+	if (status != B_OK)
+		return status;
+
+	const TypeEntry* entry = _FindCurrentType(key.String());
+	if (entry == NULL)
+		return B_NO_INIT;
+
+	path = _StringAt(entry->path);
+	return B_OK;
+}
+
+
+/*!	Makes sure the current snapshot file is mapped. The registrar replaces
+	the file on every update, so comparing the node is sufficient.
+	Returns \c B_NO_INIT, if there is no (valid) snapshot.
+*/
+status_t
+DatabaseSnapshot::_Update()
+{
+	struct stat st;
+	if (stat(fPath.String(), &st) != 0) {
+		_Unset();
+		return B_NO_INIT;
+	}
+
+	if (fData != NULL && st.st_dev == fDevice && st.st_ino == fNode)
+		return B_OK;
+
+	_Unset();
+
+	int fd = open(fPath.String(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return B_NO_INIT;
+
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Header)) {
+		close(fd);
+		return B_NO_INIT;
+	}
+
+	void* data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return B_NO_INIT;
+
+	const Header* header = (const Header*)data;
+	const uint8* base = (const uint8*)data;
+	size_t size = st.st_size;
+
+	// validate, so that lookups don't need to check bounds
+	bool valid = header->magic == kSnapshotMagic
+		&& header->version == kSnapshotVersion
+		&& header->size == size
+		&& header->typesOffset >= sizeof(Header)
+		&& header->typesOffset % sizeof(int64) == 0
+		&& header->typesOffset + (uint64)header->typeCount * sizeof(TypeEntry)
+			<= header->listsOffset
+		&& header->listsOffset + (uint64)header->listCount * sizeof(uint32)
+			<= header->stringsOffset
+		&& (uint64)header->stringsOffset + header->stringsSize <= size
+		&& header->stringsSize > 0
+		&& base[header->stringsOffset + header->stringsSize - 1] == '\0';
+
+	const TypeEntry* types = (const TypeEntry*)(base + header->typesOffset);
+	const uint32* lists = (const uint32*)(base + header->listsOffset);
+	for (uint32 i = 0; valid && i < header->typeCount; i++) {
+		const TypeEntry& entry = types[i];
+		valid = (uint64)entry.extensions + entry.extensionCount
+				<= header->listCount
+			&& (uint64)entry.supportingApps + entry.supportingAppCount
+				<= header->listCount;
+	}
+	for (uint32 i = 0; valid && i < header->listCount; i++)
+		valid = lists[i] < header->stringsSize;
+
+	if (!valid) {
+		munmap(data, size);
+		return B_NO_INIT;
+	}
+
+	fData = data;
+	fSize = size;
+	fDevice = st.st_dev;
+	fNode = st.st_ino;
+	fHeader = header;
+	fTypes = types;
+	fLists = lists;
+	fStrings = (const char*)(base + header->stringsOffset);
+	return B_OK;
+}
+
+
+void
+DatabaseSnapshot::_Unset()
+{
+	if (fData != NULL)
+		munmap(fData, fSize);
+
+	fData = NULL;
+	fSize = 0;
+	fDevice = -1;
+	fNode = -1;
+	fHeader = NULL;
+	fTypes = NULL;
+	fLists = NULL;
+	fStrings = NULL;
+}
+
+
+//! Returns the index of the first entry whose key is not less than \a key.
+uint32
+DatabaseSnapshot::_LowerBound(const char* key) const
+{
+	uint32 lower = 0;
+	uint32 upper = fHeader->typeCount;
+	while (lower < upper) {
+		uint32 mid = (lower + upper) / 2;
+		if (strcmp(_StringAt(fTypes[mid].key), key) < 0)
+			lower = mid + 1;
+		else
+			upper = mid;
+	}
+	return lower;
+}
+
+
+const DatabaseSnapshot::TypeEntry*
+DatabaseSnapshot::_FindType(const char* type) const
+{
+	uint32 index = _LowerBound(type);
+	if (index < fHeader->typeCount
+		&& strcmp(_StringAt(fTypes[index].key), type) == 0) {
+		return &fTypes[index];
+	}
+	return NULL;
+}
+
+
+/*!	Returns the entry of the installed \a type (in lower case), if it is
+	still current, \c NULL otherwise.
+*/
+const DatabaseSnapshot::TypeEntry*
+DatabaseSnapshot::_FindCurrentType(const char* type) const
+{
+	const TypeEntry* entry = _FindType(type);
+	if (entry == NULL || (entry->flags & kTypeInstalled) == 0
+		|| !_IsCurrent(entry)) {
+		return NULL;
+	}
+	return entry;
+}
+
+
+/*!	Returns whether \a entry still describes its type: the type's file must
+	not have changed since the snapshot was written, and none of the
+	database directories searched before it may have got a file for the
+	type in the meantime.
+*/
+bool
+DatabaseSnapshot::_IsCurrent(const TypeEntry* entry) const
+{
+	const char* path = _StringAt(entry->path);
+	int64 changeTime;
+	if (path[0] == '\0' || GetChangeTime(path, changeTime) != B_OK
+		|| changeTime != entry->changeTime) {
+		return false;
+	}
+
+	const BStringList& directories = fLocation->Directories();
+	for (int32 i = 0; i < directories.CountStrings(); i++) {
+		BString typePath = directories.StringAt(i);
+		typePath << '/' << _StringAt(entry->key);
+		if (typePath == path)
+			return true;
+
+		struct stat st;
+		if (stat(typePath.String(), &st) == 0)
+			return false;
+	}
+
+	// not in any of the directories
+	return false;
+}
+
+
+const char*
+DatabaseSnapshot::_StringAt(uint32 offset) const
+{
+	if (offset >= fHeader->stringsSize)
+		return "";
+	return fStrings + offset;
+}
+
+
+status_t
+DatabaseSnapshot::_AddStrings(BMessage* message, const char* field,
+	uint32 list, uint32 count) const
+{
+	status_t status = B_OK;
+	for (uint32 i = 0; i < count && status == B_OK; i++)
+		status = message->AddString(field, _StringAt(fLists[list + i]));
+	return status;
+}
+
+
+// #pragma mark -
+
+
+static pthread_once_t sDefaultDatabaseSnapshotInitOnce = PTHREAD_ONCE_INIT;
+static DatabaseSnapshot* sDefaultDatabaseSnapshot = NULL;
+
+
+static void
+init_default_database_snapshot()
+{
+	static DatabaseSnapshot snapshot(
+		DatabaseSnapshot::DefaultPath(default_database_location()).String(),
+		default_database_location());
+	sDefaultDatabaseSnapshot = &snapshot;
+}
+
+
+DatabaseSnapshot*
+default_database_snapshot()
+{
+	pthread_once(&sDefaultDatabaseSnapshotInitOnce,
+		&init_default_database_snapshot);
+	return sDefaultDatabaseSnapshot;
+}
+
+
+} // namespace Mime
+} // namespace Storage
+} // namespace BPrivate
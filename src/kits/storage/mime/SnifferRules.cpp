@@ -36,6 +36,9 @@
 //#define DBG(x)
 #define OUT printf
 
+// Sniffing buffers up to this size are kept on the stack.
+static const ssize_t kStackBufferSize = 1024;
+
 namespace BPrivate {
 namespace Storage {
 namespace Mime {
@@ -119,7 +122,8 @@ SnifferRules::SnifferRules(DatabaseLocation* databaseLocation,
 	fDatabaseLocation(databaseLocation),
 	fMimeSniffer(mimeSniffer),
 	fMaxBytesNeeded(0),
-	fHaveDoneFullBuild(false)
+	fHaveDoneFullBuild(false),
+	fRuleIndexValid(false)
 {
 }
 
@@ -157,6 +161,7 @@ SnifferRules::GuessMimeType(const entry_ref *ref, BString *type)
 {
 	status_t err = ref && type ? B_OK : B_BAD_VALUE;
 	ssize_t bytes = 0;
+	char stackBuffer[kStackBufferSize];
 	char *buffer = NULL;
 	BFile file;
 
@@ -172,9 +177,13 @@ SnifferRules::GuessMimeType(const entry_ref *ref, BString *type)
 	// Next read that many bytes (or fewer, if the file isn't
 	// that long) into a buffer
 	if (!err) {
-		buffer = new(std::nothrow) char[bytes];
-		if (!buffer)
-			err = B_NO_MEMORY;
+		if (bytes <= kStackBufferSize)
+			buffer = stackBuffer;
+		else {
+			buffer = new(std::nothrow) char[bytes];
+			if (!buffer)
+				err = B_NO_MEMORY;
+		}
 	}
 
 	if (!err)
@@ -189,7 +198,8 @@ SnifferRules::GuessMimeType(const entry_ref *ref, BString *type)
 	if (!err)
 		err = GuessMimeType(&file, buffer, bytes, type);
 
-	delete[] buffer;
+	if (buffer != stackBuffer)
+		delete[] buffer;
 
 	return err;
 }
@@ -268,6 +278,7 @@ SnifferRules::SetSnifferRule(const char *type, const char *rule)
 		}
 		if (i == fRuleList.end())
 			fRuleList.push_back(item);
+		fRuleIndexValid = false;
 	}
 
 	return err;
@@ -292,6 +303,7 @@ SnifferRules::DeleteSnifferRule(const char *type)
 		   i != fRuleList.end(); i++) {
 		if (i->type == type) {
 			fRuleList.erase(i);
+			fRuleIndexValid = false;
 			break;
 		}
 	}
@@ -405,6 +417,7 @@ SnifferRules::BuildRuleList()
 		fRuleList.sort();
 		fMaxBytesNeeded = maxBytesNeeded;
 		fHaveDoneFullBuild = true;
+		fRuleIndexValid = false;
 //		PrintToStream();
 	} else {
 		DBG(OUT("Mime::SnifferRules::BuildRuleList() failed, error code == 0x%"
@@ -418,6 +431,8 @@ SnifferRules::BuildRuleList()
 
 	This is accomplished by searching through the currently installed
 	list of sniffer rules for a rule that matches on the given data buffer.
+	The compiled rule index is consulted first, so that only rules that can
+	possibly match are run.
 	Rules are searched in order of priority (higher priority first). Rules
 	of equal priority are searched in reverse-alphabetical order (that way
 	"supertype/subtype" form rules are checked before "supertype-only" form
@@ -456,29 +471,35 @@ SnifferRules::GuessMimeType(BFile* file, const void *buffer, int32 length,
 	}
 
 	if (!err) {
+		if (!fRuleIndexValid)
+			BuildRuleIndex();
+
+		std::vector<bool> candidates;
+		fRuleIndex.GetCandidates(buffer, length, candidates);
+
 		// Run through our rule list, which is sorted in order of
-		// descreasing priority, and see if one of the rules sniffs
-		// out a match
-		for (std::list<sniffer_rule>::const_iterator i = fRuleList.begin();
-			   i != fRuleList.end(); i++) {
-			if (i->rule) {
+		// descreasing priority, and see if one of the candidate rules
+		// sniffs out a match
+		for (size_t slot = 0; slot < fIndexedRules.size(); slot++) {
+			const sniffer_rule* rule = fIndexedRules[slot];
+			if (rule->rule) {
 				// If an add-on identified the type with a priority at least
 				// as great as the remaining rules, we can stop further
 				// processing and return the type found by the add-on.
-				if (i->rule->Priority() <= addonPriority) {
+				if (rule->rule->Priority() <= addonPriority) {
 					*type = mimeType.Type();
 					return B_OK;
 				}
 
-				if (i->rule->Sniff(&data)) {
-					type->SetTo(i->type.c_str());
+				if (candidates[slot] && rule->rule->Sniff(&data)) {
+					type->SetTo(rule->type.c_str());
 					return B_OK;
 				}
 			} else {
 				DBG(OUT("WARNING: Mime::SnifferRules::GuessMimeType(BPositionIO*,BString*): "
 					"NULL sniffer_rule::rule member found in rule list for type == '%s', "
 					"rule_string == '%s'\n",
-					i->type.c_str(), i->rule_string.c_str()));
+					rule->type.c_str(), rule->rule_string.c_str()));
 			}
 		}
 
@@ -577,6 +598,27 @@ SnifferRules::ProcessType(const char *type, ssize_t *bytesNeeded)
 	return err;
 }
 
+// BuildRuleIndex
+/*! \brief Compiles the rule list into the rule index.
+
+	The index slots correspond to the positions in the (sorted) rule list,
+	so GuessMimeType() can resolve the candidates by priority.
+*/
+void
+SnifferRules::BuildRuleIndex()
+{
+	fRuleIndex.MakeEmpty();
+	fIndexedRules.clear();
+	fIndexedRules.reserve(fRuleList.size());
+
+	for (std::list<sniffer_rule>::const_iterator i = fRuleList.begin();
+		   i != fRuleList.end(); i++) {
+		fRuleIndex.Add(i->rule);
+		fIndexedRules.push_back(&*i);
+	}
+	fRuleIndexValid = true;
+}
+
 } // namespace Mime
 } // namespace Storage
 } // namespace BPrivate
@@ -131,6 +131,26 @@ SupportingApps::GetSupportingApps(const char *type, BMessage *apps)
 }
 
 
+/*! \brief Returns the complete mime type => supporting apps mapping.
+
+	Unlike GetSupportingApps(), apps supporting the supertype only are not
+	merged into the subtypes' sets.
+*/
+status_t
+SupportingApps::GetAllSupportingApps(
+	std::map<std::string, std::set<std::string> > &apps)
+{
+	if (!fHaveDoneFullBuild) {
+		status_t status = BuildSupportingAppsTable();
+		if (status != B_OK)
+			return status;
+	}
+
+	apps = fSupportingApps;
+	return B_OK;
+}
+
+
 /*! \brief Sets the list of supported types for the given application and
 	updates the supporting apps mappings.
 
@@ -19,6 +19,18 @@ DisjList::DisjList()
 DisjList::~DisjList() {
 }
 
+/*! \brief Adds to \a anchors the alternative bytes one of which must be
+	found in the data stream for the list to match.
+
+	Returns false if the list can't be described that way (e.g. because
+	its patterns are searched over a range of offsets), in which case
+	\a anchors is left untouched.
+*/
+bool
+DisjList::GetAnchors(AnchorList& anchors) const {
+	return false;
+}
+
 void
 DisjList::SetCaseInsensitive(bool how) {
 	fCaseInsensitive = how;
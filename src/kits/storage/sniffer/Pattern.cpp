@@ -110,6 +110,37 @@ Pattern::BytesNeeded() const
 	return result;
 }
 
+/*! \brief Adds the anchor(s) for this pattern matched at \a offset to
+	\a anchors.
+
+	The anchor is the first byte of the pattern that is compared unmasked.
+	For case insensitive matching of a letter both cases are added. Returns
+	false if every byte of the pattern is (partially) masked.
+*/
+bool
+Pattern::GetAnchors(int32 offset, bool caseInsensitive,
+	AnchorList& anchors) const
+{
+	if (InitCheck() != B_OK)
+		return false;
+
+	for (size_t i = 0; i < fString.length(); i++) {
+		if ((uint8)fMask[i] != 0xff)
+			continue;
+
+		uint8 byte = (uint8)fString[i];
+		anchors.push_back(Anchor(offset + i, byte));
+		if (caseInsensitive) {
+			if ('A' <= byte && byte <= 'Z')
+				anchors.push_back(Anchor(offset + i, 'a' + (byte - 'A')));
+			else if ('a' <= byte && byte <= 'z')
+				anchors.push_back(Anchor(offset + i, 'A' + (byte - 'a')));
+		}
+		return true;
+	}
+	return false;
+}
+
 //#define OPTIMIZATION_IS_FOR_CHUMPS
 #if OPTIMIZATION_IS_FOR_CHUMPS
 bool
@@ -91,6 +91,30 @@ PatternList::BytesNeeded() const
 	return result;	
 }
 
+/*! \brief Collects the anchors of all patterns. Only possible if the list's
+	range is a single offset.
+*/
+bool
+PatternList::GetAnchors(AnchorList& anchors) const
+{
+	if (InitCheck() != B_OK || fRange.Start() != fRange.End())
+		return false;
+
+	AnchorList listAnchors;
+	std::vector<Pattern*>::const_iterator i;
+	for (i = fList.begin(); i != fList.end(); i++) {
+		if (*i == NULL || !(*i)->GetAnchors(fRange.Start(), fCaseInsensitive,
+				listAnchors)) {
+			return false;
+		}
+	}
+	if (listAnchors.empty())
+		return false;
+
+	anchors.insert(anchors.end(), listAnchors.begin(), listAnchors.end());
+	return true;
+}
+
 void
 PatternList::Add(Pattern *pattern) {
 	if (pattern)
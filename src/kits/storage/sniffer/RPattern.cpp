@@ -72,3 +72,14 @@ RPattern::BytesNeeded() const
 }
 
 
+
+/*! \brief Adds the anchors of the object's pattern to \a anchors. Only
+	possible if the object's range is a single offset.
+*/
+bool
+RPattern::GetAnchors(bool caseInsensitive, AnchorList& anchors) const
+{
+	if (InitCheck() != B_OK || fRange.Start() != fRange.End())
+		return false;
+	return fPattern->GetAnchors(fRange.Start(), caseInsensitive, anchors);
+}
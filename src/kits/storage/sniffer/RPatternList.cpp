@@ -84,6 +84,25 @@ RPatternList::BytesNeeded() const
 	return result;
 }
 	
+/*! \brief Collects the anchors of all rpatterns. Only possible if each
+	rpattern is matched at a single offset.
+*/
+bool
+RPatternList::GetAnchors(AnchorList& anchors) const
+{
+	AnchorList listAnchors;
+	std::vector<RPattern*>::const_iterator i;
+	for (i = fList.begin(); i != fList.end(); i++) {
+		if (*i == NULL || !(*i)->GetAnchors(fCaseInsensitive, listAnchors))
+			return false;
+	}
+	if (listAnchors.empty())
+		return false;
+
+	anchors.insert(anchors.end(), listAnchors.begin(), listAnchors.end());
+	return true;
+}
+
 void
 RPatternList::Add(RPattern *rpattern) {
 	if (rpattern)
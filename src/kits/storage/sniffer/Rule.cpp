@@ -83,6 +83,31 @@ Rule::BytesNeeded() const
 	return result;
 }
 
+/*! \brief Returns the anchors of the most selective of the rule's
+	conjunctions in \a anchors.
+
+	Since all conjunctions have to match, any of them may serve to rule out
+	a data stream. Returns false if none of them can be anchored.
+*/
+bool
+Rule::GetAnchors(AnchorList& anchors) const
+{
+	if (InitCheck() != B_OK)
+		return false;
+
+	bool found = false;
+	std::vector<DisjList*>::const_iterator i;
+	for (i = fConjList->begin(); i != fConjList->end(); i++) {
+		AnchorList listAnchors;
+		if (*i == NULL || !(*i)->GetAnchors(listAnchors))
+			continue;
+		if (!found || listAnchors.size() < anchors.size()) {
+			anchors.swap(listAnchors);
+			found = true;
+		}
+	}
+	return found;
+}
 
 void
 Rule::Unset() {
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <sniffer/RuleIndex.h>
+
+#include <sniffer/DisjList.h>
+#include <sniffer/Rule.h>
+
+
+using namespace BPrivate::Storage::Sniffer;
+
+
+struct RuleIndex::OffsetBuckets {
+	int32				offset;
+	std::vector<int32>	slots[256];
+
+	OffsetBuckets(int32 offset) : offset(offset) {}
+};
+
+
+RuleIndex::RuleIndex()
+	:
+	fRuleCount(0)
+{
+}
+
+
+RuleIndex::~RuleIndex()
+{
+	MakeEmpty();
+}
+
+
+void
+RuleIndex::MakeEmpty()
+{
+	for (size_t i = 0; i < fOffsets.size(); i++)
+		delete fOffsets[i];
+	fOffsets.clear();
+	fResidual.clear();
+	fRuleCount = 0;
+}
+
+
+/*!	Adds \a rule to the index and returns the slot it has been assigned.
+	A \c NULL or unparsed rule is never reported as a candidate.
+*/
+int32
+RuleIndex::Add(const Rule* rule)
+{
+	int32 slot = fRuleCount++;
+	if (rule == NULL || rule->InitCheck() != B_OK)
+		return slot;
+
+	AnchorList anchors;
+	if (!rule->GetAnchors(anchors)) {
+		fResidual.push_back(slot);
+		return slot;
+	}
+
+	for (size_t i = 0; i < anchors.size(); i++) {
+		OffsetBuckets* buckets = _BucketsFor(anchors[i].offset);
+		std::vector<int32>& slots = buckets->slots[anchors[i].byte];
+		// anchors of one rule are added consecutively
+		if (slots.empty() || slots.back() != slot)
+			slots.push_back(slot);
+	}
+	return slot;
+}
+
+
+/*!	Sets \a candidates to the slots of the rules that may match \a buffer.
+	Other rules are guaranteed not to match.
+*/
+void
+RuleIndex::GetCandidates(const void* buffer, size_t length,
+	std::vector<bool>& candidates) const
+{
+	candidates.assign(fRuleCount, false);
+
+	for (size_t i = 0; i < fResidual.size(); i++)
+		candidates[fResidual[i]] = true;
+
+	const uint8* data = (const uint8*)buffer;
+	for (size_t i = 0; i < fOffsets.size(); i++) {
+		const OffsetBuckets* buckets = fOffsets[i];
+		if ((size_t)buckets->offset >= length)
+			break;
+
+		const std::vector<int32>& slots = buckets->slots[data[buckets->offset]];
+		for (size_t j = 0; j < slots.size(); j++)
+			candidates[slots[j]] = true;
+	}
+}
+
+
+RuleIndex::OffsetBuckets*
+RuleIndex::_BucketsFor(int32 offset)
+{
+	// keep the buckets sorted by offset, so that GetCandidates() can stop
+	// at the end of the buffer
+	std::vector<OffsetBuckets*>::iterator it = fOffsets.begin();
+	for (; it != fOffsets.end(); it++) {
+		if ((*it)->offset == offset)
+			return *it;
+		if ((*it)->offset > offset)
+			break;
+	}
+
+	OffsetBuckets* buckets = new OffsetBuckets(offset);
+	fOffsets.insert(it, buckets);
+	return buckets;
+}
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <BrotliCompressionAlgorithm.h>
+
+#include <algorithm>
+#include <new>
+
+#ifdef BROTLI_ENABLED
+  #include <brotli/decode.h>
+#endif
+
+#include <DataIO.h>
+
+
+// build decompression support only for userland
+#if defined(BROTLI_ENABLED) && !defined(_KERNEL_MODE) && !defined(_BOOT_MODE)
+#	define B_BROTLI_DECOMPRESSION_SUPPORT 1
+#endif
+
+
+static const size_t kMinBufferSize		= 1024;
+static const size_t kMaxBufferSize		= 1024 * 1024;
+static const size_t kDefaultBufferSize	= 4 * 1024;
+
+
+static size_t
+sanitize_buffer_size(size_t size)
+{
+	if (size < kMinBufferSize)
+		return kMinBufferSize;
+	return std::min(size, kMaxBufferSize);
+}
+
+
+// #pragma mark - BBrotliDecompressionParameters
+
+
+BBrotliDecompressionParameters::BBrotliDecompressionParameters()
+	:
+	BDecompressionParameters(),
+	fBufferSize(kDefaultBufferSize)
+{
+}
+
+
+BBrotliDecompressionParameters::~BBrotliDecompressionParameters()
+{
+}
+
+
+size_t
+BBrotliDecompressionParameters::BufferSize() const
+{
+	return fBufferSize;
+}
+
+
+void
+BBrotliDecompressionParameters::SetBufferSize(size_t size)
+{
+	fBufferSize = sanitize_buffer_size(size);
+}
+
+
+// #pragma mark - Stream
+
+
+#ifdef B_BROTLI_DECOMPRESSION_SUPPORT
+
+
+template<typename BaseClass>
+struct BBrotliCompressionAlgorithm::Stream : BaseClass {
+	Stream(BDataIO* io)
+		:
+		BaseClass(io),
+		fState(NULL),
+		fFinished(false)
+	{
+	}
+
+	~Stream()
+	{
+		if (fState != NULL)
+			BrotliDecoderDestroyInstance(fState);
+	}
+
+	status_t Init(const BBrotliDecompressionParameters* parameters)
+	{
+		status_t error = this->BaseClass::Init(
+			parameters != NULL ? parameters->BufferSize() : kDefaultBufferSize);
+		if (error != B_OK)
+			return error;
+
+		fState = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+		if (fState == NULL)
+			return B_NO_MEMORY;
+
+		return B_OK;
+	}
+
+	virtual status_t ProcessData(const void* input, size_t inputSize,
+		void* output, size_t outputSize, size_t& bytesConsumed,
+		size_t& bytesProduced)
+	{
+		return _ProcessData(input, inputSize, output, outputSize,
+			bytesConsumed, bytesProduced);
+	}
+
+	virtual status_t FlushPendingData(void* output, size_t outputSize,
+		size_t& bytesProduced)
+	{
+		size_t bytesConsumed;
+		return _ProcessData(NULL, 0, output, outputSize,
+			bytesConsumed, bytesProduced);
+	}
+
+	static status_t Create(BDataIO* io,
+		const BDecompressionParameters* _parameters, BDataIO*& _stream)
+	{
+		const BBrotliDecompressionParameters* parameters
+			= dynamic_cast<const BBrotliDecompressionParameters*>(_parameters);
+		Stream* stream = new(std::nothrow) Stream(io);
+		if (stream == NULL)
+			return B_NO_MEMORY;
+
+		status_t error = stream->Init(parameters);
+		if (error != B_OK) {
+			delete stream;
+			return error;
+		}
+
+		_stream = stream;
+		return B_OK;
+	}
+
+private:
+	status_t _ProcessData(const void* input, size_t inputSize,
+		void* output, size_t outputSize, size_t& bytesConsumed,
+		size_t& bytesProduced)
+	{
+		const uint8_t* nextIn = (const uint8_t*)input;
+		size_t availableIn = inputSize;
+		uint8_t* nextOut = (uint8_t*)output;
+		size_t availableOut = outputSize;
+
+		if (fFinished) {
+			// nothing may follow the end of the stream
+			if (inputSize != 0)
+				return B_BAD_DATA;
+			bytesConsumed = 0;
+			bytesProduced = 0;
+			return B_OK;
+		}
+
+		BrotliDecoderResult result = BrotliDecoderDecompressStream(fState,
+			&availableIn, &nextIn, &availableOut, &nextOut, NULL);
+		if (result == BROTLI_DECODER_RESULT_ERROR)
+			return B_BAD_DATA;
+		if (result == BROTLI_DECODER_RESULT_SUCCESS) {
+			fFinished = true;
+			if (availableIn != 0)
+				return B_BAD_DATA;
+		}
+
+		bytesConsumed = inputSize - availableIn;
+		bytesProduced = outputSize - availableOut;
+		return B_OK;
+	}
+
+private:
+	BrotliDecoderState*	fState;
+	bool				fFinished;
+};
+
+
+#endif	// B_BROTLI_DECOMPRESSION_SUPPORT
+
+
+// #pragma mark - BBrotliCompressionAlgorithm
+
+
+BBrotliCompressionAlgorithm::BBrotliCompressionAlgorithm()
+	:
+	BCompressionAlgorithm()
+{
+}
+
+
+BBrotliCompressionAlgorithm::~BBrotliCompressionAlgorithm()
+{
+}
+
+
+status_t
+BBrotliCompressionAlgorithm::CreateDecompressingInputStream(BDataIO* input,
+	const BDecompressionParameters* parameters, BDataIO*& _stream)
+{
+#ifdef B_BROTLI_DECOMPRESSION_SUPPORT
+	return Stream<BAbstractInputStream>::Create(input, parameters, _stream);
+#else
+	return B_NOT_SUPPORTED;
+#endif
+}
+
+
+status_t
+BBrotliCompressionAlgorithm::CreateDecompressingOutputStream(BDataIO* output,
+	const BDecompressionParameters* parameters, BDataIO*& _stream)
+{
+#ifdef B_BROTLI_DECOMPRESSION_SUPPORT
+	return Stream<BAbstractOutputStream>::Create(output, parameters, _stream);
+#else
+	return B_NOT_SUPPORTED;
+#endif
+}
+
+
+status_t
+BBrotliCompressionAlgorithm::DecompressBuffer(const iovec& input,
+	iovec& output, const BDecompressionParameters* parameters, iovec* scratch)
+{
+#ifdef B_BROTLI_DECOMPRESSION_SUPPORT
+	size_t decodedSize = output.iov_len;
+	BrotliDecoderResult result = BrotliDecoderDecompress(input.iov_len,
+		(const uint8_t*)input.iov_base, &decodedSize, (uint8_t*)output.iov_base);
+	if (result != BROTLI_DECODER_RESULT_SUCCESS)
+		return B_BAD_DATA;
+			// also when the output buffer is too small
+
+	output.iov_len = decodedSize;
+	return B_OK;
+#else
+	return B_NOT_SUPPORTED;
+#endif
+}
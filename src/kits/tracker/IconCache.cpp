@@ -63,10 +63,12 @@ All rights reserved.
 //			generic icon
 
 
+#include <Application.h>
 #include <ControlLook.h>
 #include <Debug.h>
 #include <Screen.h>
 #include <Volume.h>
+#include <Window.h>
 
 #include <fs_info.h>
 
@@ -103,6 +105,11 @@ All rights reserved.
 #undef NODE_CACHE_ASYNC_DRAWS
 
 
+static const size_t kSharedCacheBudget = 8 * 1024 * 1024;
+static const size_t kNodeCacheBudget = 24 * 1024 * 1024;
+	// bytes of bitmaps each cache keeps before evicting entries
+
+
 BSize IconCache::sMiniIconSize;
 
 
@@ -120,7 +127,12 @@ IconCacheEntry::IconCacheEntry()
 	fHighlightedLargeIcon(NULL),
 	fMiniIcon(NULL),
 	fHighlightedMiniIcon(NULL),
-	fAliasTo(NULL)
+	fAliasTo(NULL),
+	fAliasCount(0),
+	fCache(NULL),
+	fUsedPrevious(NULL),
+	fUsedNext(NULL),
+	fAccountedBytes(0)
 {
 }
 
@@ -144,7 +156,7 @@ IconCacheEntry::~IconCacheEntry()
 
 
 void
-IconCacheEntry::SetAliasFor(const SharedIconCache* sharedCache,
+IconCacheEntry::SetAliasFor(SharedIconCache* sharedCache,
 	const SharedCacheEntry* entry)
 {
 	sharedCache->SetAliasFor(this, entry);
@@ -152,6 +164,17 @@ IconCacheEntry::SetAliasFor(const SharedIconCache* sharedCache,
 }
 
 
+void
+IconCacheEntry::DropAlias()
+{
+	if (fAliasTo == NULL)
+		return;
+
+	const_cast<IconCacheEntry*>(fAliasTo)->fAliasCount--;
+	fAliasTo = NULL;
+}
+
+
 IconCacheEntry*
 IconCacheEntry::ResolveIfAlias(const SharedIconCache* sharedCache)
 {
@@ -324,10 +347,11 @@ IconCacheEntry::SetIcon(BBitmap* bitmap, IconDrawMode mode, BSize size)
 }
 
 
-IconCache::IconCache()
+IconCache::IconCache(bool ownsTypeIconStore)
 	:
 	fInitHighlightTable(true)
 {
+	fTypeIconStore.Init(ownsTypeIconStore);
 	InitHighlightTable();
 
 	sMiniIconSize = be_control_look->ComposeIconSize(B_MINI_ICON);
@@ -371,11 +395,8 @@ IconCache::GetIconForPreferredApp(const char* fileTypeSignature,
 			("File %s; Line %d # hitting disk for preferredApp %s, type %s\n",
 			__FILE__, __LINE__, preferredApp, fileTypeSignature));
 
-		BMimeType preferredAppType(preferredApp);
-		BString signature(fileTypeSignature);
-		signature.ToLower();
-		if (preferredAppType.GetIconForType(signature.String(),
-				lazyBitmap->Get(), icon_size_for(size)) != B_OK) {
+		if (LoadTypeIcon(fileTypeSignature, preferredApp, lazyBitmap->Get(),
+				size) != B_OK) {
 			return NULL;
 		}
 
@@ -420,10 +441,10 @@ IconCache::GetIconFromMetaMime(const char* fileType, IconDrawMode mode,
 		PRINT_DISK_HITS(("File %s; Line %d # hitting disk for metamime %s\n",
 			__FILE__, __LINE__, fileType));
 
-		BMimeType mime(fileType);
 		// try getting the icon directly from the metamime
-		if (mime.GetIcon(lazyBitmap->Get(), icon_size_for(size)) != B_OK) {
+		if (LoadTypeIcon(fileType, NULL, lazyBitmap->Get(), size) != B_OK) {
 			// try getting it from the preferred app of this type
+			BMimeType mime(fileType);
 			char preferredAppSig[B_MIME_TYPE_LENGTH];
 			if (mime.GetPreferredApp(preferredAppSig) != B_OK)
 				return NULL;
@@ -776,7 +797,8 @@ IconCache::GetWellKnownIcon(AutoLock<SimpleIconCache>*,
 				return NULL;
 		}
 
-		entry = fSharedCache.AddItem(type.String());
+		if (entry == NULL)
+			entry = fSharedCache.AddItem(type.String());
 
 		BBitmap* bitmap = lazyBitmap->Get();
 		GetTrackerResources()->GetIconResource(resourceId,
@@ -836,7 +858,8 @@ IconCache::GetNodeIcon(ModelNodeLazyOpener* modelOpener,
 			BBitmap* bitmap = lazyBitmap->Adopt();
 			PRINT_ADD_ITEM(("File %s; Line %d # adding entry for model %s\n",
 				__FILE__, __LINE__, model->Name()));
-			entry = fNodeCache.AddItem(model->NodeRef(), permanent);
+			if (entry == NULL)
+				entry = fNodeCache.AddItem(model->NodeRef(), permanent);
 			ASSERT(entry != NULL);
 			entry->SetIcon(bitmap, kNormalIcon, size);
 			if (mode != kNormalIcon) {
@@ -1111,6 +1134,9 @@ IconCache::Preload(AutoLock<SimpleIconCache>* nodeCacheLocker,
 
 	ASSERT(entry != NULL && entry->HaveIconBitmap(mode, size));
 
+	if (entry != NULL && resultingOpenCache != NULL)
+		resultingOpenCache->LockedItem()->EntryUsed(entry);
+
 	if (resultingCache != NULL)
 		*resultingCache = resultingOpenCache;
 
@@ -1199,11 +1225,13 @@ IconCache::Preload(const char* fileType, IconDrawMode mode, BSize size)
 	// try getting the icon from the preferred app for the signature
 	IconCacheEntry* entry = GetIconForPreferredApp(fileType, preferredAppSig,
 		mode, size, &lazyBitmap, 0);
-	if (entry != NULL)
+	if (entry != NULL) {
+		fSharedCache.EntryUsed(entry);
 		return B_OK;
+	}
 
 	// try getting the icon directly from the metamime
-	result = mime.GetIcon(lazyBitmap.Get(), icon_size_for(size));
+	result = LoadTypeIcon(fileType, NULL, lazyBitmap.Get(), size);
 
 	if (result != B_OK)
 		return result;
@@ -1215,6 +1243,7 @@ IconCache::Preload(const char* fileType, IconDrawMode mode, BSize size)
 		entry->ConstructBitmap(mode, size, &lazyBitmap);
 		entry->SetIcon(lazyBitmap.Adopt(), mode, size);
 	}
+	fSharedCache.EntryUsed(entry);
 
 	return B_OK;
 }
@@ -1250,6 +1279,74 @@ IconCache::Deleting(const BView* view)
 }
 
 
+void
+IconCache::FreeRetiredIcons()
+{
+	BObjectList<BBitmap, true> retiredBitmaps;
+	{
+		AutoLock<SimpleIconCache> lock(&fSharedCache);
+		fSharedCache.TakeRetiredIcons(retiredBitmaps);
+	}
+	if (retiredBitmaps.IsEmpty())
+		return;
+
+	// The icons were retired before this, so once every window has synced,
+	// all asynchronous draws of them are done. Don't wait for windows that
+	// are busy, a window that is drawing right now may be using them anyway.
+	BObjectList<BWindow> syncedWindows;
+	bool synced = true;
+	BWindow* window;
+	for (int32 index = 0; synced && (window = be_app->WindowAt(index)) != NULL;
+			index++) {
+		status_t status = window->LockWithTimeout(0);
+		if (status == B_BAD_VALUE) {
+			// the window is gone
+			continue;
+		}
+		if (status != B_OK) {
+			synced = false;
+			break;
+		}
+
+		window->Sync();
+		window->Unlock();
+		syncedWindows.AddItem(window);
+	}
+
+	// windows that went away while we were at it may have made us skip
+	// others, and new windows can't be told apart from those
+	for (int32 index = 0; synced && (window = be_app->WindowAt(index)) != NULL;
+			index++) {
+		if (!syncedWindows.HasItem(window))
+			synced = false;
+	}
+
+	if (!synced) {
+		// try again on the next call
+		AutoLock<SimpleIconCache> lock(&fSharedCache);
+		fSharedCache.ReturnRetiredIcons(retiredBitmaps);
+		return;
+	}
+
+	retiredBitmaps.MakeEmpty();
+}
+
+
+void
+IconCache::GetStatistics(icon_cache_statistics& shared,
+	icon_cache_statistics& node)
+{
+	{
+		AutoLock<SimpleIconCache> lock(&fSharedCache);
+		fSharedCache.GetStatistics(shared);
+		shared.storeHits = fTypeIconStore.Hits();
+	}
+
+	AutoLock<SimpleIconCache> lock(&fNodeCache);
+	fNodeCache.GetStatistics(node);
+}
+
+
 void
 IconCache::IconChanged(Model* model)
 {
@@ -1266,6 +1363,8 @@ void
 IconCache::IconChanged(const char* mimeType, const char* appSignature)
 {
 	AutoLock<SimpleIconCache> sharedLock(&fSharedCache);
+	fTypeIconStore.IconChanged(mimeType, appSignature);
+
 	SharedCacheEntry* entry = fSharedCache.FindItem(mimeType, appSignature);
 	if (entry == NULL)
 		return;
@@ -1282,6 +1381,40 @@ IconCache::IconChanged(const char* mimeType, const char* appSignature)
 }
 
 
+/*!	Loads the icon of \a fileType from the MIME database into \a bitmap, or
+	the icon \a preferredApp defines for it, if that is given. Icons that
+	were already loaded by any team are copied from the type icon store.
+	The shared cache must be locked, as it also protects the store.
+*/
+status_t
+IconCache::LoadTypeIcon(const char* fileType, const char* preferredApp,
+	BBitmap* bitmap, BSize size)
+{
+	ASSERT(fSharedCache.IsLocked());
+
+	if (bitmap == NULL)
+		return B_NO_MEMORY;
+
+	if (fTypeIconStore.GetIcon(fileType, preferredApp, bitmap))
+		return B_OK;
+
+	status_t result;
+	if (preferredApp != NULL && preferredApp[0] != '\0') {
+		BMimeType preferredAppType(preferredApp);
+		BString type(fileType);
+		type.ToLower();
+		result = preferredAppType.GetIconForType(type.String(), bitmap,
+			icon_size_for(size));
+	} else
+		result = BMimeType(fileType).GetIcon(bitmap, icon_size_for(size));
+
+	if (result == B_OK)
+		fTypeIconStore.AddIcon(fileType, preferredApp, bitmap);
+
+	return result;
+}
+
+
 BBitmap*
 IconCache::MakeSelectedIcon(const BBitmap* normal, BSize size,
 	LazyBitmapAllocator* lazyBitmap)
@@ -1421,6 +1554,26 @@ IconCache::IconHitTest(BPoint where, const Model* model, IconDrawMode mode,
 }
 
 
+size_t
+IconCacheEntry::MemoryUsage() const
+{
+	if (fAliasTo != NULL)
+		return 0;
+
+	size_t bytes = 0;
+	if (fLargeIcon != NULL)
+		bytes += fLargeIcon->BitsLength();
+	if (fHighlightedLargeIcon != NULL)
+		bytes += fHighlightedLargeIcon->BitsLength();
+	if (fMiniIcon != NULL)
+		bytes += fMiniIcon->BitsLength();
+	if (fHighlightedMiniIcon != NULL)
+		bytes += fHighlightedMiniIcon->BitsLength();
+
+	return bytes;
+}
+
+
 void
 IconCacheEntry::RetireIcons(BObjectList<BBitmap, true>* retiredBitmapList)
 {
@@ -1455,7 +1608,7 @@ IconCacheEntry::RetireIcons(BObjectList<BBitmap, true>* retiredBitmapList)
 
 SharedIconCache::SharedIconCache()
 	:
-	SimpleIconCache("Tracker shared icon cache"),
+	SimpleIconCache("Tracker shared icon cache", kSharedCacheBudget),
 	fHashTable(),
 	fRetiredBitmaps(256)
 {
@@ -1516,6 +1669,7 @@ SharedIconCache::IconChanged(SharedCacheEntry* entry)
 	// by now there should be no aliases to entry, just remove entry
 	// itself
 	ASSERT(entry->fAliasTo == NULL);
+	RemoveEntry(entry);
 	entry->RetireIcons(&fRetiredBitmaps);
 	fHashTable.Remove(entry);
 }
@@ -1527,17 +1681,68 @@ SharedIconCache::RemoveAliasesTo(SharedCacheEntry* alias)
 	EntryHashTable::Iterator it = fHashTable.GetIterator();
 	while (it.HasNext()) {
 		SharedCacheEntry* entry = it.Next();
-		if (entry->fAliasTo == alias)
+		if (entry->fAliasTo == alias) {
+			RemoveEntry(entry);
+			entry->DropAlias();
 			fHashTable.RemoveUnchecked(entry);
+		}
 	}
 }
 
 
 void
 SharedIconCache::SetAliasFor(IconCacheEntry* entry,
-	const SharedCacheEntry* original) const
+	const SharedCacheEntry* original)
 {
+	entry->DropAlias();
 	entry->fAliasTo = original;
+	const_cast<SharedCacheEntry*>(original)->fAliasCount++;
+
+	// the alias has to be evictable, or the original never would be
+	EntryUsed(entry);
+}
+
+
+void
+SharedIconCache::TakeRetiredIcons(BObjectList<BBitmap, true>& retiredBitmaps)
+{
+	ASSERT(IsLocked());
+
+	// the list is owning, hand the bitmaps over without deleting them
+	retiredBitmaps.AddList(&fRetiredBitmaps);
+	fRetiredBitmaps.MakeEmpty(false);
+}
+
+
+void
+SharedIconCache::ReturnRetiredIcons(BObjectList<BBitmap, true>& retiredBitmaps)
+{
+	ASSERT(IsLocked());
+
+	fRetiredBitmaps.AddList(&retiredBitmaps);
+	retiredBitmaps.MakeEmpty(false);
+}
+
+
+bool
+SharedIconCache::Evict(IconCacheEntry* entry)
+{
+	// aliases point directly to their original entry, keep it around as
+	// long as there are any
+	if (entry->fAliasCount > 0)
+		return false;
+
+	RemoveEntry(entry);
+	fHashTable.Remove((SharedCacheEntry*)entry);
+
+	if (entry->fAliasTo != NULL) {
+		// an alias doesn't own any icons
+		entry->DropAlias();
+	} else
+		entry->RetireIcons(&fRetiredBitmaps);
+
+	delete (SharedCacheEntry*)entry;
+	return true;
 }
 
 
@@ -1735,7 +1940,7 @@ NodeCacheEntry::Permanent() const
 
 NodeIconCache::NodeIconCache()
 	:
-	SimpleIconCache("Tracker node icon cache")
+	SimpleIconCache("Tracker node icon cache", kNodeCacheBudget)
 {
 	fHashTable.Init(100);
 }
@@ -1785,6 +1990,8 @@ NodeIconCache::Deleting(const node_ref* node)
 	if (entry == NULL || entry->Permanent())
 		return;
 
+	RemoveEntry(entry);
+	entry->DropAlias();
 	fHashTable.Remove(entry);
 }
 
@@ -1797,6 +2004,8 @@ NodeIconCache::Removing(const node_ref* node)
 	if (entry == NULL)
 		return;
 
+	RemoveEntry(entry);
+	entry->DropAlias();
 	fHashTable.Remove(entry);
 }
 
@@ -1823,18 +2032,45 @@ NodeIconCache::RemoveAliasesTo(SharedCacheEntry* alias)
 	EntryHashTable::Iterator it = fHashTable.GetIterator();
 	while (it.HasNext()) {
 		NodeCacheEntry* entry = it.Next();
-		if (entry->fAliasTo == alias)
+		if (entry->fAliasTo == alias) {
+			RemoveEntry(entry);
+			entry->DropAlias();
 			fHashTable.RemoveUnchecked(entry);
+		}
 	}
 }
 
 
+bool
+NodeIconCache::Evict(IconCacheEntry* entry)
+{
+	NodeCacheEntry* nodeEntry = (NodeCacheEntry*)entry;
+	if (nodeEntry->Permanent())
+		return false;
+
+	// node icons are always drawn synchronously, they can go right away
+	RemoveEntry(nodeEntry);
+	nodeEntry->DropAlias();
+	fHashTable.Remove(nodeEntry);
+	delete nodeEntry;
+	return true;
+}
+
+
 //	#pragma mark - SimpleIconCache
 
 
-SimpleIconCache::SimpleIconCache(const char* name)
+SimpleIconCache::SimpleIconCache(const char* name, size_t budget)
 	:
-	fLock(name)
+	fLock(name),
+	fMostRecentlyUsed(NULL),
+	fLeastRecentlyUsed(NULL),
+	fEntryCount(0),
+	fBytes(0),
+	fBudget(budget),
+	fLookups(0),
+	fMisses(0),
+	fEvictions(0)
 {
 }
 
@@ -1878,6 +2114,90 @@ SimpleIconCache::IsLocked() const
 }
 
 
+void
+SimpleIconCache::EntryUsed(IconCacheEntry* entry)
+{
+	ASSERT(IsLocked());
+
+	if (entry->fCache != NULL && entry->fCache != this)
+		return;
+
+	fLookups++;
+
+	size_t bytes = entry->MemoryUsage();
+	if (bytes > entry->fAccountedBytes)
+		fMisses++;
+
+	if (entry->fCache == this) {
+		if (entry == fMostRecentlyUsed) {
+			fBytes += bytes - entry->fAccountedBytes;
+			entry->fAccountedBytes = bytes;
+			return;
+		}
+		RemoveEntry(entry);
+	}
+
+	entry->fCache = this;
+	entry->fUsedPrevious = NULL;
+	entry->fUsedNext = fMostRecentlyUsed;
+	if (fMostRecentlyUsed != NULL)
+		fMostRecentlyUsed->fUsedPrevious = entry;
+	else
+		fLeastRecentlyUsed = entry;
+	fMostRecentlyUsed = entry;
+
+	entry->fAccountedBytes = bytes;
+	fBytes += bytes;
+	fEntryCount++;
+
+	IconCacheEntry* candidate = fLeastRecentlyUsed;
+	while (fBytes > fBudget && candidate != NULL && candidate != entry) {
+		IconCacheEntry* previous = candidate->fUsedPrevious;
+		if (Evict(candidate))
+			fEvictions++;
+		candidate = previous;
+	}
+}
+
+
+void
+SimpleIconCache::RemoveEntry(IconCacheEntry* entry)
+{
+	if (entry->fCache != this)
+		return;
+
+	if (entry->fUsedPrevious != NULL)
+		entry->fUsedPrevious->fUsedNext = entry->fUsedNext;
+	else
+		fMostRecentlyUsed = entry->fUsedNext;
+	if (entry->fUsedNext != NULL)
+		entry->fUsedNext->fUsedPrevious = entry->fUsedPrevious;
+	else
+		fLeastRecentlyUsed = entry->fUsedPrevious;
+
+	fBytes -= entry->fAccountedBytes;
+	fEntryCount--;
+
+	entry->fCache = NULL;
+	entry->fUsedPrevious = NULL;
+	entry->fUsedNext = NULL;
+	entry->fAccountedBytes = 0;
+}
+
+
+void
+SimpleIconCache::GetStatistics(icon_cache_statistics& statistics) const
+{
+	statistics.entries = fEntryCount;
+	statistics.bytes = fBytes;
+	statistics.budget = fBudget;
+	statistics.lookups = fLookups;
+	statistics.misses = fMisses;
+	statistics.evictions = fEvictions;
+	statistics.storeHits = 0;
+}
+
+
 //	#pragma mark - LazyBitmapAllocator
 
 
@@ -46,6 +46,7 @@ All rights reserved.
 
 #include "AutoLock.h"
 #include "HashSet.h"
+#include "TypeIconStore.h"
 #include "Utilities.h"
 
 
@@ -56,6 +57,10 @@ All rights reserved.
 // Entries are only deleted from the shared cache if an icon for a mime type
 // changes, this makes async icon drawing easier. Node cache deletes it's
 // entries whenever a file gets deleted.
+// Both caches keep the bitmaps of their entries within a byte budget, and
+// evict the least recently used entries when they grow beyond it.
+// The icons of MIME types are also kept in a TypeIconStore that all teams
+// share, so that they are only loaded from the MIME database once.
 
 // if a view ever uses the cache to draw in async mode, it needs to call
 // it when it is being destroyed
@@ -65,6 +70,7 @@ namespace BPrivate {
 class Model;
 class ModelNodeLazyOpener;
 class LazyBitmapAllocator;
+class SimpleIconCache;
 class SharedIconCache;
 class SharedCacheEntry;
 class GenerateThumbnailJob;
@@ -155,7 +161,7 @@ public:
 	IconCacheEntry();
 	~IconCacheEntry();
 
-	void SetAliasFor(const SharedIconCache* sharedCache,
+	void SetAliasFor(SharedIconCache* sharedCache,
 		const SharedCacheEntry* entry);
 	static IconCacheEntry* ResolveIfAlias(const SharedIconCache* sharedCache,
 		IconCacheEntry* entry);
@@ -177,18 +183,20 @@ public:
 	bool IconHitTest(BPoint, IconDrawMode, BSize) const;
 		// given a point, returns true if a non-transparent pixel was hit
 
+	size_t MemoryUsage() const;
+		// bytes used by the bitmaps the entry owns
+
 	void RetireIcons(BObjectList<BBitmap, true>* retiredBitmapList);
 		// can't just delete icons, they may be still drawing
 		// async; instead, put them on the retired list and
-		// only delete the list if it grows too much, way after
-		// the icon finishes drawing
-		//
-		// This could fail if we retire a lot of icons (10 * 1024)
-		// while we are drawing them, shouldn't be a practical problem
+		// only delete them after the next sync, see
+		// IconCache::FreeRetiredIcons()
 
 protected:
 	BBitmap* IconForMode(IconDrawMode mode, BSize size) const;
 	void SetIconForMode(BBitmap* bitmap, IconDrawMode mode, BSize size);
+	void DropAlias();
+		// releases the entry this one is an alias for
 
 	// list of most common icons
 	BBitmap* fLargeIcon;
@@ -197,17 +205,41 @@ protected:
 	BBitmap* fHighlightedMiniIcon;
 
 	const IconCacheEntry* fAliasTo;
+	int32 fAliasCount;
+		// number of entries that are an alias for this one, it can't be
+		// evicted while there are any
 
 	// list of other icon kinds would be added here
 
+	// least recently used list of the cache the entry is accounted in
+	SimpleIconCache* fCache;
+	IconCacheEntry* fUsedPrevious;
+	IconCacheEntry* fUsedNext;
+	size_t fAccountedBytes;
+
+	friend class SimpleIconCache;
 	friend class SharedIconCache;
 	friend class NodeIconCache;
 };
 
 
+struct icon_cache_statistics {
+	int32 entries;
+		// entries in the least recently used list
+	size_t bytes;
+	size_t budget;
+	int64 lookups;
+	int64 misses;
+		// lookups that had to load a bitmap
+	int64 evictions;
+	int64 storeHits;
+		// icons copied from the shared type icon store
+};
+
+
 class SimpleIconCache {
 public:
-	SimpleIconCache(const char*);
+	SimpleIconCache(const char*, size_t budget);
 	virtual ~SimpleIconCache() {}
 
 	virtual void Draw(IconCacheEntry*, BView*, BPoint, IconDrawMode mode,
@@ -220,8 +252,28 @@ public:
 	void Unlock();
 	bool IsLocked() const;
 
+	void EntryUsed(IconCacheEntry*);
+		// makes the entry the most recently used one, and evicts the least
+		// recently used ones if the cache grew beyond its budget
+	void RemoveEntry(IconCacheEntry*);
+		// called when an entry leaves the cache
+	void GetStatistics(icon_cache_statistics&) const;
+
+protected:
+	virtual bool Evict(IconCacheEntry*) = 0;
+		// returns false if the entry has to stay
+
 private:
 	Benaphore fLock;
+
+	IconCacheEntry* fMostRecentlyUsed;
+	IconCacheEntry* fLeastRecentlyUsed;
+	int32 fEntryCount;
+	size_t fBytes;
+	size_t fBudget;
+	int64 fLookups;
+	int64 fMisses;
+	int64 fEvictions;
 };
 
 
@@ -280,11 +332,19 @@ public:
 	void IconChanged(SharedCacheEntry*);
 
 	void SetAliasFor(IconCacheEntry* entry,
-		const SharedCacheEntry* original) const;
+		const SharedCacheEntry* original);
 	IconCacheEntry* ResolveIfAlias(IconCacheEntry* entry) const;
 
 	void RemoveAliasesTo(SharedCacheEntry* alias);
 
+	void TakeRetiredIcons(BObjectList<BBitmap, true>& retiredBitmaps);
+		// moves the retired icons over, for deleting them after a sync
+	void ReturnRetiredIcons(BObjectList<BBitmap, true>& retiredBitmaps);
+		// puts them back if the sync has to be retried later
+
+protected:
+	virtual bool Evict(IconCacheEntry*);
+
 private:
 	typedef BOpenHashTable<SelfHashing<SharedCacheEntry> > EntryHashTable;
 	EntryHashTable fHashTable;
@@ -355,6 +415,9 @@ public:
 
 	void RemoveAliasesTo(SharedCacheEntry* alias);
 
+protected:
+	virtual bool Evict(IconCacheEntry*);
+
 private:
 	typedef BOpenHashTable<SelfHashing<NodeCacheEntry> > EntryHashTable;
 	EntryHashTable fHashTable;
@@ -366,7 +429,9 @@ const int32 kColorTransformTableSize = 256;
 
 class IconCache {
 public:
-	IconCache();
+	IconCache(bool ownsTypeIconStore = false);
+		// only Tracker owns the type icon store, everybody else just
+		// reads from it
 
 	void Draw(Model*, BView*, BPoint where, IconDrawMode mode,
 		BSize size, bool async = false);
@@ -409,6 +474,15 @@ public:
 
 	bool IconHitTest(BPoint, const Model*, IconDrawMode, BSize);
 
+	void FreeRetiredIcons();
+		// deletes the icons evicted from the shared cache; if there are
+		// any, syncs all windows of the application first, and keeps them
+		// for the next call if one of them is busy. Views that draw
+		// asynchronously should call this once in a while
+
+	void GetStatistics(icon_cache_statistics& shared,
+		icon_cache_statistics& node);
+
 	// utility calls for building specialized icons
 	BBitmap* MakeSelectedIcon(const BBitmap* normal, BSize,
 		LazyBitmapAllocator*);
@@ -474,12 +548,18 @@ private:
 		Model* model, IconDrawMode mode, BSize size,
 		LazyBitmapAllocator* lazyBitmap, IconCacheEntry* entry);
 
+	status_t LoadTypeIcon(const char* fileType, const char* preferredApp,
+		BBitmap* bitmap, BSize size);
+		// loads the icon of a MIME type, or the one the preferred app
+		// defines for it, going through the type icon store
+
 	BBitmap* MakeTransformedIcon(const BBitmap*, BSize,
 		int32 colorTransformTable [], LazyBitmapAllocator*);
 
 private:
 	NodeIconCache fNodeCache;
 	SharedIconCache fSharedCache;
+	TypeIconStore fTypeIconStore;
 
 	void InitHighlightTable();
 
@@ -133,13 +133,13 @@ BPose::~BPose()
 void
 BPose::CreateWidgets(BPoseView* poseView)
 {
-	for (int32 index = 0; ; index++) {
-		BColumn* column = poseView->ColumnAt(index);
-		if (column == NULL)
-			break;
-
+	// Only the first column (the name) is needed right away, for icon mode
+	// labels, editing and type ahead. The widgets of the other columns are
+	// added on demand when the pose is drawn or sorted (see WidgetFor()), so
+	// poses that never get scrolled into view don't pay for them.
+	BColumn* column = poseView->FirstColumn();
+	if (column != NULL)
 		fWidgetList.AddItem(new BTextWidget(fModel, column, poseView));
-	}
 }
 
 
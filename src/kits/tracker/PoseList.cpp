@@ -35,25 +35,82 @@ All rights reserved.
 //	Icon cache is used for drawing node icons; it caches icons
 //	and reuses them for successive draws
 
+#include <string.h>
+
 #include <Debug.h>
 
 #include "Model.h"
 #include "PoseList.h"
 
 
+static inline const char*
+pose_name(const BPose* pose)
+{
+	const char* name = pose->TargetModel()->EntryRef()->name;
+	return name != NULL ? name : "";
+}
+
+
+void
+PoseList::PoseRenamed(BPose* pose, const char* oldName)
+{
+	if (pose == NULL || pose->TargetModel() == NULL)
+		return;
+
+	if (!_NameIndexRemove(pose, oldName != NULL ? oldName : ""))
+		return;
+
+	fNameIndex.emplace(pose_name(pose), pose);
+}
+
+
 void
 PoseList::_IndexAdd(BPose* p)
 {
-	if (p != NULL && p->TargetModel() != NULL)
-		fNodeIndex[MakePoseNodeKey(*p->TargetModel()->NodeRef())] = p;
+	if (p == NULL || p->TargetModel() == NULL)
+		return;
+
+	fNodeIndex[MakePoseNodeKey(*p->TargetModel()->NodeRef())] = p;
+	fNameIndex.emplace(pose_name(p), p);
 }
 
 
 void
 PoseList::_IndexRemove(BPose* p)
 {
-	if (p != NULL && p->TargetModel() != NULL)
-		fNodeIndex.erase(MakePoseNodeKey(*p->TargetModel()->NodeRef()));
+	if (p == NULL || p->TargetModel() == NULL)
+		return;
+
+	fNodeIndex.erase(MakePoseNodeKey(*p->TargetModel()->NodeRef()));
+
+	if (_NameIndexRemove(p, pose_name(p)))
+		return;
+
+	// The model was renamed without PoseRenamed() being called for this
+	// list, don't leave a dangling pointer behind.
+	for (NameIndex::iterator it = fNameIndex.begin(); it != fNameIndex.end();
+			++it) {
+		if (it->second == p) {
+			fNameIndex.erase(it);
+			break;
+		}
+	}
+}
+
+
+//!	Removes \a p from the name index, if it is filed under \a name.
+bool
+PoseList::_NameIndexRemove(BPose* p, const char* name)
+{
+	auto range = fNameIndex.equal_range(name);
+	for (auto it = range.first; it != range.second; ++it) {
+		if (it->second == p) {
+			fNameIndex.erase(it);
+			return true;
+		}
+	}
+
+	return false;
 }
 
 
@@ -61,12 +118,17 @@ void
 PoseList::_RebuildIndex()
 {
 	fNodeIndex.clear();
+	fNameIndex.clear();
+
 	int32 count = CountItems();
 	fNodeIndex.reserve(count);
+	fNameIndex.reserve(count);
 	for (int32 i = 0; i < count; i++) {
 		BPose* p = ItemAt(i);
-		if (p != NULL && p->TargetModel() != NULL)
+		if (p != NULL && p->TargetModel() != NULL) {
 			fNodeIndex[MakePoseNodeKey(*p->TargetModel()->NodeRef())] = p;
+			fNameIndex.emplace(pose_name(p), p);
+		}
 	}
 }
 
@@ -88,13 +150,16 @@ PoseList::FindPose(const node_ref* node, int32* resultingIndex) const
 BPose*
 PoseList::FindPose(const entry_ref* entry, int32* resultingIndex) const
 {
-	int32 count = CountItems();
-	for (int32 index = 0; index < count; index++) {
-		BPose* pose = ItemAt(index);
+	if (entry->name == NULL)
+		return NULL;
+
+	auto range = fNameIndex.equal_range(entry->name);
+	for (auto it = range.first; it != range.second; ++it) {
+		BPose* pose = it->second;
 		ASSERT(pose->TargetModel());
 		if (*pose->TargetModel()->EntryRef() == *entry) {
 			if (resultingIndex != NULL)
-				*resultingIndex = index;
+				*resultingIndex = IndexOf(pose);
 
 			return pose;
 		}
@@ -176,16 +241,18 @@ PoseList::FindAllPoses(const node_ref* node) const
 BPose*
 PoseList::FindPoseByFileName(const char* name, int32* _index) const
 {
-	int32 count = CountItems();
-	for (int32 index = 0; index < count; index++) {
-		BPose* pose = ItemAt(index);
-		ASSERT(pose->TargetModel());
-		if (strcmp(pose->TargetModel()->EntryRef()->name, name) == 0) {
-			if (_index != NULL)
-				*_index = index;
+	// queries may contain several entries of the same name, any of them
+	// will do
+	auto range = fNameIndex.equal_range(name);
+	for (auto it = range.first; it != range.second; ++it) {
+		BPose* pose = it->second;
+		if (strcmp(pose_name(pose), name) != 0)
+			continue;
 
-			return pose;
-		}
+		if (_index != NULL)
+			*_index = IndexOf(pose);
+
+		return pose;
 	}
 
 	return NULL;
@@ -39,6 +39,7 @@ All rights reserved.
 
 
 #include <functional>
+#include <string>
 #include <unordered_map>
 
 #include <ObjectList.h>
@@ -155,13 +156,23 @@ public:
 
 	BPose* FindPoseByFileName(const char* name, int32* _index = NULL) const;
 
+	void PoseRenamed(BPose* pose, const char* oldName);
+		// must be called after the entry_ref of a pose in the list changed
+		// its name, so that it can be found under the new one
+
 private:
+	typedef std::unordered_multimap<std::string, BPose*> NameIndex;
+
 	void _IndexAdd(BPose* p);
 	void _IndexRemove(BPose* p);
+	bool _NameIndexRemove(BPose* p, const char* name);
 	void _RebuildIndex();
 
 	bool fOwning;
 	std::unordered_map<PoseNodeKey, BPose*, PoseNodeKeyHash> fNodeIndex;
+
+	// keyed by the entry names, see PoseRenamed()
+	NameIndex fNameIndex;
 };
 
 
@@ -180,6 +191,7 @@ inline void
 PoseList::MakeEmpty(bool deleteIfOwning)
 {
 	fNodeIndex.clear();
+	fNameIndex.clear();
 	if (fOwning && deleteIfOwning) {
 		int32 count = CountItems();
 		for (int32 index = 0; index < count; index++)
@@ -5875,8 +5875,15 @@ BPoseView::EntryMoved(const BMessage* message)
 		if (pose != NULL) {
 			Model* poseModel = pose->TargetModel();
 			ASSERT(poseModel != NULL);
+			BString oldName(poseModel->EntryRef()->name);
 			poseModel->UpdateEntryRef(&dirNode, name);
 
+			// re-key the pose in the name indexes of the lists holding it
+			fPoseList->PoseRenamed(pose, oldName.String());
+			fFilteredPoseList->PoseRenamed(pose, oldName.String());
+			fVSPoseList->PoseRenamed(pose, oldName.String());
+			fSelectionList->PoseRenamed(pose, oldName.String());
+
 			BPoint loc(0, index * fListElemHeight);
 			// if we get a rename then we need to assume that we might
 			// have missed some other attr changed notifications so we
@@ -9340,6 +9347,10 @@ BPoseView::Draw(BRect updateRect)
 		DrawAfterChildren(updateRect);
 
 	_inherited::Draw(updateRect);
+
+	// icons evicted from the cache may only go once all asynchronous draws
+	// of them are through
+	IconCache::sIconCache->FreeRetiredIcons();
 }
 
 
@@ -9785,7 +9796,15 @@ BPoseView::SortPoses()
 
 	PoseList* poseList = CurrentPoseList();
 	BPose** poses = reinterpret_cast<BPose**>(poseList->AsBList()->Items());
-	std::stable_sort(poses, &poses[poseList->CountItems()], PoseComparator(this));
+	BPose** end = &poses[poseList->CountItems()];
+
+	// In list mode poses are inserted at their sorted position as they
+	// arrive, so the list is usually in order already; a linear check is
+	// much cheaper than re-sorting a large directory.
+	if (std::is_sorted(poses, end, PoseComparator(this)))
+		return;
+
+	std::stable_sort(poses, end, PoseComparator(this));
 }
 
 
@@ -9815,7 +9834,11 @@ BPoseView::ResizeColumnToWidest(BColumn* column)
 	PoseList* poseList = CurrentPoseList();
 	int32 poseCount = poseList->CountItems();
 	for (int32 i = 0; i < poseCount; ++i) {
-		BTextWidget* widget = poseList->ItemAt(i)->WidgetFor(column->AttrHash());
+		// widgets are created lazily, so poses that have not been
+		// scrolled into view might not have one for this column yet
+		BPose* pose = poseList->ItemAt(i);
+		ModelNodeLazyOpener modelOpener(pose->TargetModel());
+		BTextWidget* widget = pose->WidgetFor(column, this, modelOpener);
 		if (widget != NULL) {
 			float width = widget->PreferredWidth(this);
 			if (width > maxWidth)
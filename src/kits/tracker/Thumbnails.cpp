@@ -8,6 +8,7 @@
  */
 #include "Thumbnails.h"
 
+#include <algorithm>
 #include <list>
 #include <fs_attr.h>
 
@@ -165,9 +166,18 @@ private:
 status_t
 GenerateThumbnailJob::Execute()
 {
+	// We only need the image at thumbnail size (and at the size of the
+	// thumbnail attribute), translators that can will decode it at a
+	// reduced resolution.
+	BSize attributeSize(B_XXL_ICON - 1, B_XXL_ICON - 1);
+	BMessage ioExtension;
+	ioExtension.AddSize(B_TRANSLATOR_EXT_BITMAP_TARGET_SIZE,
+		BSize(std::max(fRequestedSize.width, attributeSize.width),
+			std::max(fRequestedSize.height, attributeSize.height)));
+
 	BBitmapStream imageStream;
-	status_t status = BTranslatorRoster::Default()->Translate(fFile, NULL, NULL,
-		&imageStream, B_TRANSLATOR_BITMAP, 0, fMimeType);
+	status_t status = BTranslatorRoster::Default()->Translate(fFile, NULL,
+		&ioExtension, &imageStream, B_TRANSLATOR_BITMAP, 0, fMimeType);
 	if (status != B_OK)
 		return status;
 
@@ -196,16 +206,23 @@ GenerateThumbnailJob::Execute()
 	}
 
 	entry->SetIcon(cacheThumb, kNormalIcon, fRequestedSize);
+	nodeIconCache->EntryUsed(entry);
 	cacheLocker.Unlock();
 
 	// write values to attributes
+	BSize imageSize;
+	if (ioExtension.FindSize(B_TRANSLATOR_EXT_BITMAP_SOURCE_SIZE,
+			&imageSize) != B_OK) {
+		imageSize = image->Bounds().Size();
+	}
+
 	bool thumbnailWritten = false;
-	const int32 width = image->Bounds().IntegerWidth() + 1;
+	const int32 width = (int32)imageSize.width + 1;
 	const size_t written = fFile->WriteAttr("Media:Width", B_INT32_TYPE,
 		0, &width, sizeof(int32));
 	if (written == sizeof(int32)) {
 		// first attribute succeeded, write the rest
-		const int32 height = image->Bounds().IntegerHeight() + 1;
+		const int32 height = (int32)imageSize.height + 1;
 		fFile->WriteAttr("Media:Height", B_INT32_TYPE, 0, &height, sizeof(int32));
 
 		// convert image into a 128x128 WebP image and stash it
@@ -191,7 +191,8 @@ InitIconPreloader()
 	// only start the node preloader if its Tracker or the Deskbar itself,
 	// don't start it for file panels
 
-	bool preload = dynamic_cast<TTracker*>(be_app) != NULL;
+	bool isTracker = dynamic_cast<TTracker*>(be_app) != NULL;
+	bool preload = isTracker;
 	if (!preload) {
 		// check for deskbar
 		app_info info;
@@ -205,7 +206,7 @@ InitIconPreloader()
 			be_app);
 	}
 
-	IconCache::sIconCache = new IconCache();
+	IconCache::sIconCache = new IconCache(isTracker);
 
 	atomic_add(&lock, -1);
 }
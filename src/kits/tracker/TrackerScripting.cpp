@@ -38,12 +38,14 @@ All rights reserved.
 
 #include "ContainerWindow.h"
 #include "FSUtils.h"
+#include "IconCache.h"
 #include "Tracker.h"
 
 
 #define kPropertyTrash "Trash"
 #define kPropertyFolder "Folder"
 #define kPropertyPreferences "Preferences"
+#define kPropertyIconCacheStatistics "IconCacheStatistics"
 
 
 /*
@@ -53,6 +55,7 @@ doo Tracker delete Trash
 doo Tracker create Folder to '/boot/home/Desktop/hello'		# mkdir
 doo Tracker get Folder to '/boot/home/Desktop/hello'		# get window for path
 doo Tracker execute Folder to '/boot/home/Desktop/hello'	# open window
+doo Tracker get IconCacheStatistics					# icon cache counters
 
 ToDo:
 Create file: on a "Tracker" "File" "B_CREATE_PROPERTY" "name"
@@ -93,11 +96,39 @@ const property_info kTrackerPropertyList[] = {
 		{},
 		{}
 	},
+	{
+		kPropertyIconCacheStatistics,
+		{ B_GET_PROPERTY },
+		{ B_DIRECT_SPECIFIER },
+		"get IconCacheStatistics # get counters of the shared and node "
+		"icon caches",
+		0,
+		{ B_MESSAGE_TYPE },
+		{},
+		{}
+	},
 
 	{ 0 }
 };
 
 
+static void
+AddIconCacheStatistics(BMessage& message, const char* name,
+	const icon_cache_statistics& statistics)
+{
+	BMessage cache;
+	cache.AddInt32("entries", statistics.entries);
+	cache.AddInt64("bytes", statistics.bytes);
+	cache.AddInt64("budget", statistics.budget);
+	cache.AddInt64("lookups", statistics.lookups);
+	cache.AddInt64("misses", statistics.misses);
+	cache.AddInt64("evictions", statistics.evictions);
+	cache.AddInt64("store hits", statistics.storeHits);
+
+	message.AddMessage(name, &cache);
+}
+
+
 status_t
 TTracker::GetSupportedSuites(BMessage* data)
 {
@@ -325,6 +356,22 @@ TTracker::GetProperty(BMessage* message, int32 form, const char* property,
 		return true;
 	}
 
+	if (strcmp(property, kPropertyIconCacheStatistics) == 0) {
+		if (form != B_DIRECT_SPECIFIER)
+			return false;
+
+		icon_cache_statistics shared;
+		icon_cache_statistics node;
+		IconCache::sIconCache->GetStatistics(shared, node);
+
+		BMessage result;
+		AddIconCacheStatistics(result, "shared", shared);
+		AddIconCacheStatistics(result, "node", node);
+		reply->AddMessage("result", &result);
+
+		return true;
+	}
+
 	return false;
 }
 
@@ -0,0 +1,332 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "TypeIconStore.h"
+
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+
+#include <Bitmap.h>
+#include <Mime.h>
+
+
+static const char* kAreaName = "tracker type icons";
+static const uint32 kMagic = 'TIcS';
+static const uint32 kVersion = 1;
+static const size_t kAreaSize = 8 * 1024 * 1024;
+static const int32 kBucketCount = 1024;
+static const bigtime_t kAttachRetryInterval = 1000000;
+
+
+struct TypeIconStore::Header {
+	uint32 magic;
+	uint32 version;
+	int32 size;
+	int32 used;
+		// bytes in use, including the header; only Tracker changes it
+	int32 buckets[kBucketCount];
+		// offset of the newest entry of each hash chain, 0 if empty
+};
+
+
+// An entry is followed by the type and the signature, both null terminated,
+// and then by the bits of the icon, 8 byte aligned.
+struct TypeIconStore::Entry {
+	int32 next;
+		// offset of the next older entry in the chain, 0 if none
+	int32 stale;
+	uint32 hash;
+	uint32 colorSpace;
+	int32 width;
+	int32 height;
+	int32 bytesPerRow;
+	int32 bitsLength;
+	uint16 typeLength;
+	uint16 signatureLength;
+
+	const char* Type() const
+	{
+		return (const char*)(this + 1);
+	}
+
+	const char* Signature() const
+	{
+		return Type() + typeLength;
+	}
+
+	const uint8* Bits() const
+	{
+		return (const uint8*)this + BitsOffset(typeLength, signatureLength);
+	}
+
+	static int32 BitsOffset(int32 typeLength, int32 signatureLength)
+	{
+		return (sizeof(Entry) + typeLength + signatureLength + 7) & ~7;
+	}
+};
+
+
+TypeIconStore::TypeIconStore()
+	:
+	fArea(-1),
+	fHeader(NULL),
+	fSize(0),
+	fWritable(false),
+	fLastAttachAttempt(0),
+	fHits(0)
+{
+}
+
+
+TypeIconStore::~TypeIconStore()
+{
+	_Detach();
+}
+
+
+/*!	Tracker creates the store, everybody else maps it once it is needed. */
+void
+TypeIconStore::Init(bool writable)
+{
+	_Detach();
+
+	fWritable = writable;
+	if (!writable)
+		return;
+
+	void* address;
+	area_id area = create_area(kAreaName, &address, B_ANY_ADDRESS, kAreaSize,
+		B_NO_LOCK, B_READ_AREA | B_WRITE_AREA | B_CLONEABLE_AREA);
+	if (area < 0)
+		return;
+
+	Header* header = (Header*)address;
+	memset(header, 0, sizeof(Header));
+	header->magic = kMagic;
+	header->version = kVersion;
+	header->size = kAreaSize;
+	header->used = sizeof(Header);
+
+	fArea = area;
+	fHeader = header;
+	fSize = kAreaSize;
+}
+
+
+bool
+TypeIconStore::GetIcon(const char* fileType, const char* appSignature,
+	BBitmap* bitmap)
+{
+	if (bitmap == NULL || fileType == NULL || !_Attach())
+		return false;
+
+	if (appSignature == NULL)
+		appSignature = "";
+
+	BRect bounds = bitmap->Bounds();
+	uint32 hash = _Hash(fileType, appSignature);
+	int32 offset = atomic_get(&fHeader->buckets[hash % kBucketCount]);
+
+	while (const Entry* entry = _EntryAt(offset)) {
+		if (entry->hash == hash
+			&& atomic_get(const_cast<int32*>(&entry->stale)) == 0
+			&& entry->colorSpace == (uint32)bitmap->ColorSpace()
+			&& entry->width == bounds.IntegerWidth() + 1
+			&& entry->height == bounds.IntegerHeight() + 1
+			&& entry->bytesPerRow == bitmap->BytesPerRow()
+			&& entry->bitsLength == bitmap->BitsLength()
+			&& strcasecmp(entry->Type(), fileType) == 0
+			&& strcasecmp(entry->Signature(), appSignature) == 0) {
+			memcpy(bitmap->Bits(), entry->Bits(), entry->bitsLength);
+			fHits++;
+			return true;
+		}
+
+		// older entries come first in the area, this also makes sure that
+		// a damaged chain cannot loop
+		if (entry->next >= offset)
+			break;
+		offset = entry->next;
+	}
+
+	return false;
+}
+
+
+void
+TypeIconStore::AddIcon(const char* fileType, const char* appSignature,
+	const BBitmap* bitmap)
+{
+	if (!fWritable || fHeader == NULL || bitmap == NULL || fileType == NULL)
+		return;
+
+	if (appSignature == NULL)
+		appSignature = "";
+
+	int32 typeLength = strlen(fileType) + 1;
+	int32 signatureLength = strlen(appSignature) + 1;
+	if (typeLength > B_MIME_TYPE_LENGTH
+		|| signatureLength > B_MIME_TYPE_LENGTH) {
+		return;
+	}
+
+	int32 bitsOffset = Entry::BitsOffset(typeLength, signatureLength);
+	int32 entrySize = (bitsOffset + bitmap->BitsLength() + 7) & ~7;
+	if (entrySize > fHeader->size - fHeader->used) {
+		// the store is full
+		return;
+	}
+
+	int32 offset = fHeader->used;
+	Entry* entry = (Entry*)((uint8*)fHeader + offset);
+	BRect bounds = bitmap->Bounds();
+
+	entry->stale = 0;
+	entry->hash = _Hash(fileType, appSignature);
+	entry->colorSpace = bitmap->ColorSpace();
+	entry->width = bounds.IntegerWidth() + 1;
+	entry->height = bounds.IntegerHeight() + 1;
+	entry->bytesPerRow = bitmap->BytesPerRow();
+	entry->bitsLength = bitmap->BitsLength();
+	entry->typeLength = typeLength;
+	entry->signatureLength = signatureLength;
+	memcpy((char*)entry->Type(), fileType, typeLength);
+	memcpy((char*)entry->Signature(), appSignature, signatureLength);
+	memcpy((uint8*)entry->Bits(), bitmap->Bits(), entry->bitsLength);
+
+	int32 index = entry->hash % kBucketCount;
+	entry->next = fHeader->buckets[index];
+	fHeader->used += entrySize;
+
+	// publish the entry only after it is complete
+	atomic_set(&fHeader->buckets[index], offset);
+}
+
+
+/*!	Marks all icons for \a fileType, and the ones \a appSignature defines for
+	any type, as stale.
+*/
+void
+TypeIconStore::IconChanged(const char* fileType, const char* appSignature)
+{
+	if (!fWritable || fHeader == NULL || fileType == NULL)
+		return;
+
+	bool checkSignature = appSignature != NULL && appSignature[0] != '\0';
+
+	for (int32 index = 0; index < kBucketCount; index++) {
+		int32 offset = fHeader->buckets[index];
+		while (Entry* entry = const_cast<Entry*>(_EntryAt(offset))) {
+			if (strcasecmp(entry->Type(), fileType) == 0
+				|| (checkSignature
+					&& strcasecmp(entry->Signature(), appSignature) == 0)) {
+				atomic_set(&entry->stale, 1);
+			}
+
+			if (entry->next >= offset)
+				break;
+			offset = entry->next;
+		}
+	}
+}
+
+
+bool
+TypeIconStore::_Attach()
+{
+	if (fHeader != NULL)
+		return true;
+
+	if (fWritable)
+		return false;
+
+	// Tracker may not be running yet -- don't look for it too often
+	bigtime_t now = system_time();
+	if (fLastAttachAttempt != 0
+		&& now - fLastAttachAttempt < kAttachRetryInterval) {
+		return false;
+	}
+	fLastAttachAttempt = now;
+
+	area_id source = find_area(kAreaName);
+	if (source < 0)
+		return false;
+
+	void* address;
+	area_id area = clone_area("tracker type icons clone", &address,
+		B_ANY_ADDRESS, B_READ_AREA, source);
+	if (area < 0)
+		return false;
+
+	Header* header = (Header*)address;
+	area_info info;
+	if (get_area_info(area, &info) != B_OK || info.size < sizeof(Header)
+		|| header->magic != kMagic || header->version != kVersion
+		|| header->size < (int32)sizeof(Header)
+		|| (size_t)header->size > info.size) {
+		delete_area(area);
+		return false;
+	}
+
+	fArea = area;
+	fHeader = header;
+	fSize = header->size;
+	return true;
+}
+
+
+void
+TypeIconStore::_Detach()
+{
+	if (fArea >= 0)
+		delete_area(fArea);
+
+	fArea = -1;
+	fHeader = NULL;
+	fSize = 0;
+}
+
+
+/*!	Returns the entry at \a offset, or \c NULL if there is none, or if it
+	does not fit into the area.
+*/
+const TypeIconStore::Entry*
+TypeIconStore::_EntryAt(int32 offset) const
+{
+	if (offset < (int32)sizeof(Header)
+		|| offset > fSize - (int32)sizeof(Entry)) {
+		return NULL;
+	}
+
+	const Entry* entry = (const Entry*)((const uint8*)fHeader + offset);
+	if (entry->typeLength == 0 || entry->signatureLength == 0
+		|| entry->bitsLength < 0
+		|| entry->bitsLength > fSize - offset
+			- Entry::BitsOffset(entry->typeLength, entry->signatureLength)
+		|| entry->Type()[entry->typeLength - 1] != '\0'
+		|| entry->Signature()[entry->signatureLength - 1] != '\0') {
+		return NULL;
+	}
+
+	return entry;
+}
+
+
+/*static*/ uint32
+TypeIconStore::_Hash(const char* fileType, const char* appSignature)
+{
+	// MIME types are case insensitive
+	uint32 hash = 2166136261U;
+	for (; *fileType != '\0'; fileType++)
+		hash = (hash ^ (uint8)tolower(*fileType)) * 16777619;
+
+	hash = (hash ^ '/') * 16777619;
+	for (; *appSignature != '\0'; appSignature++)
+		hash = (hash ^ (uint8)tolower(*appSignature)) * 16777619;
+
+	return hash;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _TRACKER_TYPE_ICON_STORE_H
+#define _TRACKER_TYPE_ICON_STORE_H
+
+
+#include <OS.h>
+
+
+class BBitmap;
+
+
+namespace BPrivate {
+
+
+// The type icon store holds the decoded icons of MIME types in an area that
+// Tracker fills, and that all other applications (file panels, Deskbar, ...)
+// map read-only, so that each type icon is only decoded once.
+// Entries are never removed; when the icon of a type changes, Tracker marks
+// its entries stale and adds new ones.
+
+class TypeIconStore {
+public:
+	TypeIconStore();
+	~TypeIconStore();
+
+	void Init(bool writable);
+
+	bool GetIcon(const char* fileType, const char* appSignature,
+		BBitmap* bitmap);
+		// copies the icon of the bitmap's size into bitmap, if the store
+		// has it
+	void AddIcon(const char* fileType, const char* appSignature,
+		const BBitmap* bitmap);
+		// only does something in Tracker
+	void IconChanged(const char* fileType, const char* appSignature);
+
+	int64 Hits() const { return fHits; }
+
+private:
+	struct Header;
+	struct Entry;
+
+	bool _Attach();
+	void _Detach();
+
+	const Entry* _EntryAt(int32 offset) const;
+	static uint32 _Hash(const char* fileType, const char* appSignature);
+
+	area_id fArea;
+	Header* fHeader;
+	int32 fSize;
+	bool fWritable;
+	bigtime_t fLastAttachAttempt;
+	int64 fHits;
+};
+
+
+} // namespace BPrivate
+
+using namespace BPrivate;
+
+
+#endif	// _TRACKER_TYPE_ICON_STORE_H
@@ -0,0 +1,368 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!
+	This file contains the BTranslator based object that stands in for a
+	translator of an add-on that has not been loaded yet.
+
+	The BTranslatorRoster describes every translator add-on once, and keeps
+	the descriptions in a cache. Name, version and formats are answered from
+	the description; the add-on is only loaded once the translator is asked
+	to identify or translate something, or for its configuration.
+*/
+
+
+#include "LazyTranslator.h"
+
+#include <new>
+#include <string.h>
+
+#include <Autolock.h>
+
+#include "FuncTranslator.h"
+#include "TranslatorRosterPrivate.h"
+
+
+namespace BPrivate {
+
+
+LazyTranslatorImage::LazyTranslatorImage(const char* path)
+	:
+	fLock("lazy translator image"),
+	fPath(path),
+	fImage(-1)
+{
+}
+
+
+LazyTranslatorImage::~LazyTranslatorImage()
+{
+	if (fImage >= 0)
+		unload_add_on(fImage);
+}
+
+
+status_t
+LazyTranslatorImage::Load(image_id& _image)
+{
+	if (fImage < 0) {
+		fImage = load_add_on(fPath.String());
+		if (fImage < 0)
+			return fImage;
+	}
+
+	_image = fImage;
+	return B_OK;
+}
+
+
+//	#pragma mark -
+
+
+BLazyTranslator::BLazyTranslator(LazyTranslatorImage* image,
+	const BMessage& description)
+	:
+	fImage(image),
+	fTranslator(NULL),
+	fLoadStatus(B_NO_INIT),
+	fIndex(-1),
+	fVersion(0)
+{
+	const char* name;
+	const char* info;
+	fInitStatus = description.FindInt32("index", &fIndex);
+	if (fInitStatus == B_OK)
+		fInitStatus = description.FindString("name", &name);
+	if (fInitStatus == B_OK)
+		fInitStatus = description.FindString("info", &info);
+	if (fInitStatus == B_OK)
+		fInitStatus = description.FindInt32("version", &fVersion);
+	if (fInitStatus != B_OK)
+		return;
+
+	fName = name;
+	fInfo = info;
+
+	try {
+		const void* data;
+		ssize_t size;
+		for (int32 i = 0; description.FindData("input", B_RAW_TYPE, i, &data,
+				&size) == B_OK; i++) {
+			if (size != sizeof(translation_format)) {
+				fInitStatus = B_BAD_DATA;
+				return;
+			}
+			fInputFormats.push_back(*(const translation_format*)data);
+		}
+		for (int32 i = 0; description.FindData("output", B_RAW_TYPE, i,
+				&data, &size) == B_OK; i++) {
+			if (size != sizeof(translation_format)) {
+				fInitStatus = B_BAD_DATA;
+				return;
+			}
+			fOutputFormats.push_back(*(const translation_format*)data);
+		}
+
+		// collect the signature data first, the signatures point into it
+		const char* mime;
+		const void* bytes;
+		const void* mask;
+		ssize_t bytesSize;
+		ssize_t maskSize;
+		int32 count = 0;
+		for (; description.FindString("signature:MIME", count, &mime) == B_OK
+				&& description.FindData("signature:bytes", B_RAW_TYPE, count,
+					&bytes, &bytesSize) == B_OK
+				&& description.FindData("signature:mask", B_RAW_TYPE, count,
+					&mask, &maskSize) == B_OK; count++) {
+			if (bytesSize != maskSize) {
+				fInitStatus = B_BAD_DATA;
+				return;
+			}
+			fSignatureData.push_back(mime);
+			fSignatureData.push_back(std::string((const char*)bytes,
+				bytesSize));
+			fSignatureData.push_back(std::string((const char*)mask,
+				maskSize));
+		}
+
+		for (int32 i = 0; i < count; i++) {
+			translation_signature signature;
+			signature.MIME = fSignatureData[i * 3].c_str();
+			signature.offset = description.GetInt32("signature:offset", i, 0);
+			signature.length = fSignatureData[i * 3 + 1].size();
+			signature.bytes = fSignatureData[i * 3 + 1].data();
+			signature.mask = fSignatureData[i * 3 + 2].data();
+			fSignatures.push_back(signature);
+		}
+		if (count > 0) {
+			translation_signature terminator = {};
+			fSignatures.push_back(terminator);
+		}
+	} catch (...) {
+		fInitStatus = B_NO_MEMORY;
+	}
+}
+
+
+BLazyTranslator::~BLazyTranslator()
+{
+	if (fTranslator != NULL)
+		fTranslator->Release();
+}
+
+
+status_t
+BLazyTranslator::InitCheck() const
+{
+	return fInitStatus;
+}
+
+
+/*!	Stores everything a BLazyTranslator needs to know about the loaded
+	\a translator into \a description. \a index is the one passed to the
+	add-on's make_nth_translator(), or -1 for function based translators.
+*/
+/*static*/ status_t
+BLazyTranslator::Describe(BTranslator* translator, int32 index,
+	const translation_signature* signatures, BMessage& description)
+{
+	const char* name = translator->TranslatorName();
+	const char* info = translator->TranslatorInfo();
+
+	status_t status = description.AddInt32("index", index);
+	if (status == B_OK)
+		status = description.AddString("name", name != NULL ? name : "");
+	if (status == B_OK)
+		status = description.AddString("info", info != NULL ? info : "");
+	if (status == B_OK) {
+		status = description.AddInt32("version",
+			translator->TranslatorVersion());
+	}
+
+	int32 count = 0;
+	const translation_format* formats = translator->InputFormats(&count);
+	for (int32 i = 0; status == B_OK && formats != NULL && i < count; i++) {
+		status = description.AddData("input", B_RAW_TYPE, &formats[i],
+			sizeof(translation_format), true, count);
+	}
+
+	count = 0;
+	formats = translator->OutputFormats(&count);
+	for (int32 i = 0; status == B_OK && formats != NULL && i < count; i++) {
+		status = description.AddData("output", B_RAW_TYPE, &formats[i],
+			sizeof(translation_format), true, count);
+	}
+
+	for (; status == B_OK && signatures != NULL && signatures->MIME != NULL;
+			signatures++) {
+		const char* mask = signatures->mask;
+		std::string allBits;
+		if (mask == NULL) {
+			allBits.assign(signatures->length, '\xff');
+			mask = allBits.data();
+		}
+
+		status = description.AddString("signature:MIME", signatures->MIME);
+		if (status == B_OK) {
+			status = description.AddInt32("signature:offset",
+				signatures->offset);
+		}
+		if (status == B_OK) {
+			status = description.AddData("signature:bytes", B_RAW_TYPE,
+				signatures->bytes, signatures->length, false);
+		}
+		if (status == B_OK) {
+			status = description.AddData("signature:mask", B_RAW_TYPE,
+				mask, signatures->length, false);
+		}
+	}
+
+	return status;
+}
+
+
+const translation_signature*
+BLazyTranslator::Signatures() const
+{
+	if (fSignatures.empty())
+		return NULL;
+
+	return &fSignatures[0];
+}
+
+
+const char*
+BLazyTranslator::TranslatorName() const
+{
+	return fName.String();
+}
+
+
+const char*
+BLazyTranslator::TranslatorInfo() const
+{
+	return fInfo.String();
+}
+
+
+int32
+BLazyTranslator::TranslatorVersion() const
+{
+	return fVersion;
+}
+
+
+const translation_format*
+BLazyTranslator::InputFormats(int32* _count) const
+{
+	if (_count == NULL || fInputFormats.empty())
+		return NULL;
+
+	*_count = fInputFormats.size();
+	return &fInputFormats[0];
+}
+
+
+const translation_format*
+BLazyTranslator::OutputFormats(int32* _count) const
+{
+	if (_count == NULL || fOutputFormats.empty())
+		return NULL;
+
+	*_count = fOutputFormats.size();
+	return &fOutputFormats[0];
+}
+
+
+status_t
+BLazyTranslator::Identify(BPositionIO* source,
+	const translation_format* format, BMessage* ioExtension,
+	translator_info* info, uint32 outType)
+{
+	status_t status = _Load();
+	if (status != B_OK)
+		return B_NO_TRANSLATOR;
+
+	return fTranslator->Identify(source, format, ioExtension, info, outType);
+}
+
+
+status_t
+BLazyTranslator::Translate(BPositionIO* source, const translator_info* info,
+	BMessage* ioExtension, uint32 outType, BPositionIO* destination)
+{
+	status_t status = _Load();
+	if (status != B_OK)
+		return status;
+
+	return fTranslator->Translate(source, info, ioExtension, outType,
+		destination);
+}
+
+
+status_t
+BLazyTranslator::MakeConfigurationView(BMessage* ioExtension,
+	BView** _view, BRect* _extent)
+{
+	status_t status = _Load();
+	if (status != B_OK)
+		return status;
+
+	return fTranslator->MakeConfigurationView(ioExtension, _view, _extent);
+}
+
+
+status_t
+BLazyTranslator::GetConfigurationMessage(BMessage* ioExtension)
+{
+	status_t status = _Load();
+	if (status != B_OK)
+		return status;
+
+	return fTranslator->GetConfigurationMessage(ioExtension);
+}
+
+
+/*!	Loads the add-on and creates the actual translator, unless that has
+	been done (or failed) before.
+*/
+status_t
+BLazyTranslator::_Load()
+{
+	BAutolock locker(fImage->Lock());
+
+	if (fLoadStatus != B_NO_INIT)
+		return fLoadStatus;
+
+	image_id image;
+	status_t status = fImage->Load(image);
+
+	if (status == B_OK && fIndex >= 0) {
+		BTranslator* (*makeNthTranslator)(int32 n, image_id you,
+			uint32 flags, ...);
+		status = get_image_symbol(image, "make_nth_translator",
+			B_SYMBOL_TYPE_TEXT, (void**)&makeNthTranslator);
+		if (status == B_OK) {
+			fTranslator = makeNthTranslator(fIndex, image, 0);
+			if (fTranslator == NULL)
+				status = B_ERROR;
+		}
+	} else if (status == B_OK) {
+		translator_data data;
+		status = BTranslatorRoster::Private::GetTranslatorData(image, data);
+		if (status == B_OK) {
+			fTranslator = new(std::nothrow) BFuncTranslator(data);
+			if (fTranslator == NULL)
+				status = B_NO_MEMORY;
+		}
+	}
+
+	fLoadStatus = status;
+	return status;
+}
+
+
+}	// namespace BPrivate
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _LAZY_TRANSLATOR_H
+#define _LAZY_TRANSLATOR_H
+
+
+#include <string>
+#include <vector>
+
+#include <Locker.h>
+#include <Message.h>
+#include <Referenceable.h>
+#include <String.h>
+#include <Translator.h>
+
+
+namespace BPrivate {
+
+
+// A translator add-on image that is only loaded when one of its
+// translators is actually used.
+class LazyTranslatorImage : public BReferenceable {
+public:
+								LazyTranslatorImage(const char* path);
+	virtual						~LazyTranslatorImage();
+
+			BLocker&			Lock() { return fLock; }
+
+			status_t			Load(image_id& _image);
+				// the image must be locked
+
+private:
+			BLocker				fLock;
+			BString				fPath;
+			image_id			fImage;
+};
+
+
+class BLazyTranslator : public BTranslator {
+public:
+								BLazyTranslator(LazyTranslatorImage* image,
+									const BMessage& description);
+
+			status_t			InitCheck() const;
+
+	static	status_t			Describe(BTranslator* translator, int32 index,
+									const translation_signature* signatures,
+									BMessage& description);
+
+			const translation_signature* Signatures() const;
+
+	virtual	const char*			TranslatorName() const;
+	virtual	const char*			TranslatorInfo() const;
+	virtual	int32				TranslatorVersion() const;
+
+	virtual	const translation_format* InputFormats(int32* _count) const;
+	virtual	const translation_format* OutputFormats(int32* _count) const;
+
+	virtual	status_t			Identify(BPositionIO* source,
+									const translation_format* format,
+									BMessage* ioExtension,
+									translator_info* info, uint32 outType);
+	virtual	status_t			Translate(BPositionIO* source,
+									const translator_info* info,
+									BMessage* ioExtension, uint32 outType,
+									BPositionIO* destination);
+	virtual	status_t			MakeConfigurationView(BMessage* ioExtension,
+									BView** _view, BRect* _extent);
+	virtual	status_t			GetConfigurationMessage(BMessage* ioExtension);
+
+protected:
+	virtual						~BLazyTranslator();
+		// This object is deleted by calling Release(),
+		// it can not be deleted directly.
+
+private:
+			status_t			_Load();
+
+private:
+			BReference<LazyTranslatorImage> fImage;
+			BTranslator*		fTranslator;
+			status_t			fLoadStatus;
+			status_t			fInitStatus;
+
+			int32				fIndex;
+				// for make_nth_translator(), -1 for function based ones
+			BString				fName;
+			BString				fInfo;
+			int32				fVersion;
+			std::vector<translation_format> fInputFormats;
+			std::vector<translation_format> fOutputFormats;
+			std::vector<std::string> fSignatureData;
+			std::vector<translation_signature> fSignatures;
+};
+
+
+}	// namespace BPrivate
+
+
+#endif	// _LAZY_TRANSLATOR_H
@@ -16,14 +16,17 @@
 
 #include <TranslatorRoster.h>
 
+#include <algorithm>
 #include <new>
 #include <strings.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #include <Application.h>
 #include <Autolock.h>
 #include <Directory.h>
+#include <File.h>
 #include <FindDirectory.h>
 #include <NodeMonitor.h>
 #include <Path.h>
@@ -35,6 +38,7 @@
 #include <syscalls.h>
 
 #include "FuncTranslator.h"
+#include "LazyTranslator.h"
 #include "TranslatorRosterPrivate.h"
 
 
@@ -66,6 +70,11 @@ char B_TRANSLATOR_EXT_FRAME[]				= "/frame";
 char B_TRANSLATOR_EXT_BITMAP_RECT[]			= "bits/Rect";
 char B_TRANSLATOR_EXT_BITMAP_COLOR_SPACE[]	= "bits/space";
 char B_TRANSLATOR_EXT_BITMAP_PALETTE[]		= "bits/palette";
+char B_TRANSLATOR_EXT_BITMAP_TARGET_SIZE[]	= "bits/targetSize";
+	// BSize: the caller only needs a bitmap that covers this size, the
+	// translator may decode at any reduced resolution that does
+char B_TRANSLATOR_EXT_BITMAP_SOURCE_SIZE[]	= "bits/sourceSize";
+	// BSize: set by translators that honored the above, the full image size
 char B_TRANSLATOR_EXT_SOUND_CHANNEL[]		= "nois/channel";
 char B_TRANSLATOR_EXT_SOUND_MONO[]			= "nois/mono";
 char B_TRANSLATOR_EXT_SOUND_MARKER[]		= "nois/marker";
@@ -73,6 +82,39 @@ char B_TRANSLATOR_EXT_SOUND_LOOP[]			= "nois/loop";
 
 BTranslatorRoster* BTranslatorRoster::sDefaultRoster = NULL;
 
+// Signatures of the common input formats, for translators that don't
+// declare their own. Every stream in one of these formats must match one of
+// its signatures, so they may only contain what the translators check, too.
+static const translation_signature kKnownSignatures[] = {
+	{ "image/x-be-bitmap", 0, 4, "bits", NULL },
+	{ "image/jpeg", 0, 3, "\xff\xd8\xff", NULL },
+	{ "image/png", 0, 8, "\x89PNG\r\n\x1a\n", NULL },
+	{ "image/x-png", 0, 8, "\x89PNG\r\n\x1a\n", NULL },
+	{ "image/gif", 0, 6, "GIF87a", NULL },
+	{ "image/gif", 0, 6, "GIF89a", NULL },
+	{ "image/bmp", 0, 2, "BM", NULL },
+	{ "image/x-bmp", 0, 2, "BM", NULL },
+	{ "image/tiff", 0, 4, "II*\0", NULL },
+	{ "image/tiff", 0, 4, "MM\0*", NULL },
+	{ "image/tiff", 0, 4, "II+\0", NULL },
+	{ "image/tiff", 0, 4, "MM\0+", NULL },
+	{ "image/webp", 0, 12, "RIFF\0\0\0\0WEBP",
+		"\xff\xff\xff\xff\0\0\0\0\xff\xff\xff\xff" },
+	{ "image/vnd.adobe.photoshop", 0, 4, "8BPS", NULL },
+	{ "image/exr", 0, 4, "\x76\x2f\x31\x01", NULL },
+	{ "text/rtf", 0, 5, "{\\rtf", NULL },
+	{ "text/x-vnd.Be-stxt", 0, 4, "STXT", NULL },
+	{ NULL }
+};
+
+// Signatures reaching further into the stream are ignored.
+static const size_t kMaxSignaturePrefixSize = 64;
+
+// The descriptions of all translator add-ons seen so far are kept in this
+// file in the user's cache directory.
+static const char* kAddOnCacheName = "translator_add-ons";
+static const int32 kAddOnCacheVersion = 1;
+
 
 namespace BPrivate {
 
@@ -127,6 +169,10 @@ BTranslatorRoster::Private::Private()
 	:
 	BHandler("translator roster"),
 	BLocker("translator list"),
+	fSignaturePrefixSize(0),
+	fSignatureIndexValid(false),
+	fAddOnCacheRead(false),
+	fAddOnCacheChanged(false),
 	fABISubDirectory(NULL),
 	fNextID(1),
 	fLazyScanning(true),
@@ -186,28 +232,19 @@ BTranslatorRoster::Private::~Private()
 		looper->Unlock();
 	}
 
-	// Release all translators, so that they can delete themselves
+	// Release all translators, so that they can delete themselves; their
+	// add-ons are unloaded with the last translator of each
 
 	TranslatorMap::iterator iterator = fTranslators.begin();
-	std::set<image_id> images;
 
 	while (iterator != fTranslators.end()) {
 		BTranslator* translator = iterator->second.translator;
 
-		images.insert(iterator->second.image);
+		translator->fOwningRoster = NULL;
 		translator->Release();
 
 		iterator++;
 	}
-
-	// Unload all images
-
-	std::set<image_id>::const_iterator imageIterator = images.begin();
-
-	while (imageIterator != images.end()) {
-		unload_add_on(*imageIterator);
-		imageIterator++;
-	}
 }
 
 
@@ -453,6 +490,9 @@ BTranslatorRoster::Private::AddPath(const char* path, int32* _added)
 		files++;
 	}
 
+	BAutolock locker(this);
+	_WriteAddOnCache();
+
 	if (_added)
 		*_added = count;
 
@@ -465,16 +505,16 @@ BTranslatorRoster::Private::AddPath(const char* path, int32* _added)
 
 status_t
 BTranslatorRoster::Private::AddTranslator(BTranslator* translator,
-	image_id image, const entry_ref* ref, ino_t node)
+	const entry_ref* ref, ino_t node, const translation_signature* signatures)
 {
 	BAutolock locker(this);
 
 	translator_item item;
 	item.translator = translator;
-	item.image = image;
 	item.node = node;
 	if (ref != NULL)
 		item.ref = *ref;
+	item.signatures = signatures;
 
 	try {
 		fTranslators[fNextID] = item;
@@ -482,6 +522,8 @@ BTranslatorRoster::Private::AddTranslator(BTranslator* translator,
 		return B_NO_MEMORY;
 	}
 
+	fSignatureIndexValid = false;
+
 	translator->fOwningRoster = this;
 	translator->fID = fNextID++;
 	return B_OK;
@@ -576,72 +618,56 @@ BTranslatorRoster::Private::CreateTranslators(const entry_ref& ref,
 	if (status < B_OK)
 		return status;
 
-	BPath path(&ref);
-	image_id image = load_add_on(path.Path());
-	if (image < B_OK)
-		return image;
-
-	// Function pointer used to create post R4.5 style translators
-	BTranslator *(*makeNthTranslator)(int32 n, image_id you, uint32 flags, ...);
+	struct stat stat;
+	status = entry.GetStat(&stat);
+	if (status < B_OK)
+		return status;
 
-	status = get_image_symbol(image, "make_nth_translator",
-		B_SYMBOL_TYPE_TEXT, (void**)&makeNthTranslator);
-	if (status == B_OK) {
-		// If the translator add-on supports the post R4.5
-		// translator creation mechanism, keep loading translators
-		// until MakeNthTranslator stops returning them.
-		BTranslator* translator = NULL;
-		int32 created = 0;
-		for (int32 n = 0; (translator = makeNthTranslator(n, image, 0)) != NULL;
-				n++) {
-			if (AddTranslator(translator, image, &ref, nodeRef.vnode()) == B_OK) {
-				if (update)
-					update->AddInt32("translator_id", translator->fID);
-				fImageOrigins.insert(std::make_pair(translator, image));
-				count++;
-				created++;
-			} else {
-				translator->Release();
-					// this will delete the translator
-			}
-		}
+	BPath path(&ref);
+	status = path.InitCheck();
+	if (status < B_OK)
+		return status;
 
-		if (created == 0) {
-			unload_add_on(image);
-		} else {
-			// Initial refcount for the image that was just loaded
-			fKnownImages.insert(std::make_pair(image, created));
-		}
+	// The add-on is only loaded to describe it if it's new or has changed,
+	// the translators created from the description load it when needed.
+	BMessage description;
+	const BMessage* addOn = _CachedAddOn(path.Path(), stat);
+	if (addOn == NULL) {
+		status = _DescribeAddOn(path.Path(), stat, description);
+		if (status != B_OK)
+			return status;
 
-		quarantine.Remove();
-		return B_OK;
+		addOn = &description;
 	}
 
-	// If this is a translator add-on, it is in the C format
-	translator_data translatorData;
-	status = GetTranslatorData(image, translatorData);
+	BReference<BPrivate::LazyTranslatorImage> image(
+		new(std::nothrow) BPrivate::LazyTranslatorImage(path.Path()), true);
+	if (image.Get() == NULL)
+		return B_NO_MEMORY;
 
-	// add this translator to the list
-	BPrivate::BFuncTranslator* translator = NULL;
-	if (status == B_OK) {
-		translator = new (std::nothrow) BPrivate::BFuncTranslator(
-			translatorData);
+	BMessage translatorDescription;
+	for (int32 i = 0; addOn->FindMessage("translator", i,
+			&translatorDescription) == B_OK; i++) {
+		BPrivate::BLazyTranslator* translator
+			= new(std::nothrow) BPrivate::BLazyTranslator(image.Get(),
+				translatorDescription);
 		if (translator == NULL)
-			status = B_NO_MEMORY;
-	}
-
-	if (status == B_OK)
-		status = AddTranslator(translator, image, &ref, nodeRef.vnode());
+			return B_NO_MEMORY;
 
-	if (status == B_OK) {
-		if (update)
-			update->AddInt32("translator_id", translator->fID);
-		quarantine.Remove();
-		count++;
-	} else
-		unload_add_on(image);
+		if (translator->InitCheck() == B_OK
+			&& AddTranslator(translator, &ref, nodeRef.vnode(),
+				translator->Signatures()) == B_OK) {
+			if (update)
+				update->AddInt32("translator_id", translator->fID);
+			count++;
+		} else {
+			translator->Release();
+				// this will delete the translator
+		}
+	}
 
-	return status;
+	quarantine.Remove();
+	return B_OK;
 }
 
 
@@ -716,6 +742,9 @@ BTranslatorRoster::Private::Identify(BPositionIO* source,
 
 	_RescanChanged();
 
+	TranslatorIDList candidates;
+	bool useCandidates = _FindCandidates(source, candidates);
+
 	TranslatorMap::const_iterator iterator = fTranslators.begin();
 	BMessage baseExtension;
 	if (ioExtension != NULL)
@@ -723,7 +752,11 @@ BTranslatorRoster::Private::Identify(BPositionIO* source,
 
 	float bestWeight = 0.0f;
 
-	while (iterator != fTranslators.end()) {
+	for (; iterator != fTranslators.end(); iterator++) {
+		if (useCandidates && !std::binary_search(candidates.begin(),
+				candidates.end(), iterator->first))
+			continue;
+
 		BTranslator& translator = *iterator->second.translator;
 
 		off_t pos = source->Seek(0, SEEK_SET);
@@ -750,8 +783,6 @@ BTranslatorRoster::Private::Identify(BPositionIO* source,
 				memcpy(_info, &info, sizeof(translator_info));
 			}
 		}
-
-		iterator++;
 	}
 
 	if (bestWeight > 0.0f)
@@ -775,10 +806,17 @@ BTranslatorRoster::Private::GetTranslators(BPositionIO* source,
 	if (array == NULL)
 		return B_NO_MEMORY;
 
+	TranslatorIDList candidates;
+	bool useCandidates = _FindCandidates(source, candidates);
+
 	TranslatorMap::const_iterator iterator = fTranslators.begin();
 	int32 count = 0;
 
-	while (iterator != fTranslators.end()) {
+	for (; iterator != fTranslators.end(); iterator++) {
+		if (useCandidates && !std::binary_search(candidates.begin(),
+				candidates.end(), iterator->first))
+			continue;
+
 		BTranslator& translator = *iterator->second.translator;
 
 		off_t pos = source->Seek(0, SEEK_SET);
@@ -799,8 +837,6 @@ BTranslatorRoster::Private::GetTranslators(BPositionIO* source,
 			info.translator = iterator->first;
 			array[count++] = info;
 		}
-
-		iterator++;
 	}
 
 	*_info = array;
@@ -865,19 +901,13 @@ BTranslatorRoster::Private::_TranslatorDeleted(translator_id id, BTranslator* se
 	BAutolock locker(this);
 
 	TranslatorMap::iterator iterator = fTranslators.find(id);
-	if (iterator != fTranslators.end())
+	if (iterator != fTranslators.end()) {
 		fTranslators.erase(iterator);
-
-	image_id image = fImageOrigins[self];
+		fSignatureIndexValid = false;
+	}
 
 	delete self;
-
-	int32 former = atomic_add(&fKnownImages[image], -1);
-	if (former == 1) {
-		unload_add_on(image);
-		fImageOrigins.erase(self);
-		fKnownImages.erase(image);
-	}
+		// unloads the add-on with its last translator
 }
 
 
@@ -918,6 +948,371 @@ BTranslatorRoster::Private::_RescanChanged()
 
 		fRescanEntries.erase(iterator);
 	}
+
+	_WriteAddOnCache();
+}
+
+
+/*!
+	Returns the cached description of the add-on at \a path, if the add-on
+	has not been changed since it was described.
+*/
+const BMessage*
+BTranslatorRoster::Private::_CachedAddOn(const char* path,
+	const struct stat& stat)
+{
+	if (!fAddOnCacheRead)
+		_ReadAddOnCache();
+
+	AddOnCache::const_iterator found = fAddOnCache.find(path);
+	if (found == fAddOnCache.end())
+		return NULL;
+
+	const BMessage& addOn = found->second;
+	if (addOn.GetInt64("modified", -1) != (int64)stat.st_mtim.tv_sec
+				* 1000000000LL + stat.st_mtim.tv_nsec
+		|| addOn.GetInt64("size", -1) != (int64)stat.st_size)
+		return NULL;
+
+	return &addOn;
+}
+
+
+/*!
+	Loads the add-on at \a path, and describes the translators it contains
+	in \a description, which is also put into the add-on cache.
+*/
+status_t
+BTranslatorRoster::Private::_DescribeAddOn(const char* path,
+	const struct stat& stat, BMessage& description)
+{
+	image_id image = load_add_on(path);
+	if (image < B_OK)
+		return image;
+
+	const translation_signature* signatures;
+	if (get_image_symbol(image, "inputSignatures", B_SYMBOL_TYPE_DATA,
+			(void**)&signatures) != B_OK)
+		signatures = NULL;
+
+	status_t status = description.AddString("path", path);
+	if (status == B_OK) {
+		status = description.AddInt64("modified",
+			(int64)stat.st_mtim.tv_sec * 1000000000LL + stat.st_mtim.tv_nsec);
+	}
+	if (status == B_OK)
+		status = description.AddInt64("size", stat.st_size);
+
+	// Function pointer used to create post R4.5 style translators
+	BTranslator *(*makeNthTranslator)(int32 n, image_id you, uint32 flags, ...);
+
+	if (status == B_OK && get_image_symbol(image, "make_nth_translator",
+			B_SYMBOL_TYPE_TEXT, (void**)&makeNthTranslator) == B_OK) {
+		// If the translator add-on supports the post R4.5
+		// translator creation mechanism, describe translators
+		// until MakeNthTranslator stops returning them.
+		BTranslator* translator = NULL;
+		for (int32 n = 0; status == B_OK
+				&& (translator = makeNthTranslator(n, image, 0)) != NULL; n++) {
+			BMessage translatorDescription;
+			status = BPrivate::BLazyTranslator::Describe(translator, n,
+				signatures, translatorDescription);
+			if (status == B_OK) {
+				status = description.AddMessage("translator",
+					&translatorDescription);
+			}
+
+			translator->Release();
+				// this will delete the translator
+		}
+	} else if (status == B_OK) {
+		// If this is a translator add-on, it is in the C format
+		translator_data translatorData;
+		status = GetTranslatorData(image, translatorData);
+
+		BPrivate::BFuncTranslator* translator = NULL;
+		if (status == B_OK) {
+			translator = new (std::nothrow) BPrivate::BFuncTranslator(
+				translatorData);
+			if (translator == NULL)
+				status = B_NO_MEMORY;
+		}
+
+		if (status == B_OK) {
+			BMessage translatorDescription;
+			status = BPrivate::BLazyTranslator::Describe(translator, -1,
+				signatures, translatorDescription);
+			if (status == B_OK) {
+				status = description.AddMessage("translator",
+					&translatorDescription);
+			}
+		}
+
+		if (translator != NULL)
+			translator->Release();
+	}
+
+	unload_add_on(image);
+
+	if (status != B_OK)
+		return status;
+
+	try {
+		fAddOnCache[path] = description;
+		fAddOnCacheChanged = true;
+	} catch (...) {
+		// it will just be described again next time
+	}
+
+	return B_OK;
+}
+
+
+void
+BTranslatorRoster::Private::_ReadAddOnCache()
+{
+	fAddOnCacheRead = true;
+
+	BPath path;
+	if (find_directory(B_USER_CACHE_DIRECTORY, &path) != B_OK
+		|| path.Append(kAddOnCacheName) != B_OK)
+		return;
+
+	BFile file(path.Path(), B_READ_ONLY);
+	BMessage cache;
+	if (file.InitCheck() != B_OK || cache.Unflatten(&file) != B_OK
+		|| cache.GetInt32("version", 0) != kAddOnCacheVersion)
+		return;
+
+	BMessage addOn;
+	for (int32 i = 0; cache.FindMessage("add-on", i, &addOn) == B_OK; i++) {
+		const char* addOnPath;
+		if (addOn.FindString("path", &addOnPath) != B_OK)
+			continue;
+
+		try {
+			fAddOnCache[addOnPath] = addOn;
+		} catch (...) {
+			return;
+		}
+	}
+}
+
+
+//!	Locks the roster, and writes the add-on cache back if it has changed.
+void
+BTranslatorRoster::Private::WriteAddOnCache()
+{
+	BAutolock locker(this);
+	_WriteAddOnCache();
+}
+
+
+/*!
+	Writes the add-on cache back if it has changed. Add-ons that don't exist
+	anymore are dropped from it.
+
+	The file is replaced atomically, as other teams might read it at the same
+	time.
+*/
+void
+BTranslatorRoster::Private::_WriteAddOnCache()
+{
+	if (!fAddOnCacheChanged)
+		return;
+
+	fAddOnCacheChanged = false;
+
+	BMessage cache;
+	cache.AddInt32("version", kAddOnCacheVersion);
+
+	AddOnCache::iterator iterator = fAddOnCache.begin();
+	while (iterator != fAddOnCache.end()) {
+		AddOnCache::iterator next = iterator;
+		next++;
+
+		BEntry entry(iterator->first.String());
+		if (entry.Exists())
+			cache.AddMessage("add-on", &iterator->second);
+		else
+			fAddOnCache.erase(iterator);
+
+		iterator = next;
+	}
+
+	BPath path;
+	if (find_directory(B_USER_CACHE_DIRECTORY, &path, true) != B_OK
+		|| path.Append(kAddOnCacheName) != B_OK)
+		return;
+
+	BString tempPath;
+	tempPath.SetToFormat("%s.%" B_PRId32, path.Path(), (int32)getpid());
+
+	BFile file(tempPath.String(), B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	if (file.InitCheck() != B_OK)
+		return;
+
+	if (cache.Flatten(&file) != B_OK
+		|| rename(tempPath.String(), path.Path()) != 0)
+		unlink(tempPath.String());
+}
+
+
+/*!
+	Rebuilds the signature index from the input formats of all translators.
+
+	A translator can only be skipped for a stream if all of its input formats
+	have signatures, and none of them matches; the other translators are kept
+	in fUnsignedTranslators and are always asked.
+*/
+bool
+BTranslatorRoster::Private::_UpdateSignatureIndex()
+{
+	fSignatures.clear();
+	fUnsignedTranslators.clear();
+	fSignaturePrefixSize = 0;
+
+	try {
+		TranslatorMap::const_iterator iterator = fTranslators.begin();
+
+		for (; iterator != fTranslators.end(); iterator++) {
+			const translator_item& item = iterator->second;
+
+			int32 formatsCount = 0;
+			const translation_format* formats
+				= item.translator->InputFormats(&formatsCount);
+			bool isSigned = formats != NULL && formatsCount > 0;
+
+			for (int32 i = 0; i < formatsCount && formats[i].type; i++) {
+				bool found = false;
+
+				for (const translation_signature* signature
+						= kKnownSignatures; signature->MIME != NULL;
+						signature++) {
+					if (strcasecmp(signature->MIME, formats[i].MIME) != 0
+						|| signature->offset + signature->length
+							> kMaxSignaturePrefixSize)
+						continue;
+
+					_AddSignature(signature, iterator->first);
+					found = true;
+				}
+
+				for (const translation_signature* signature
+						= item.signatures; signature != NULL
+							&& signature->MIME != NULL; signature++) {
+					if (strcasecmp(signature->MIME, formats[i].MIME) != 0
+						|| signature->offset + signature->length
+							> kMaxSignaturePrefixSize)
+						continue;
+
+					_AddSignature(signature, iterator->first);
+					found = true;
+				}
+
+				if (!found)
+					isSigned = false;
+			}
+
+			if (!isSigned)
+				fUnsignedTranslators.push_back(iterator->first);
+		}
+	} catch (...) {
+		fSignatures.clear();
+		fUnsignedTranslators.clear();
+		return false;
+	}
+
+	fSignatureIndexValid = true;
+	return true;
+}
+
+
+void
+BTranslatorRoster::Private::_AddSignature(
+	const translation_signature* signature, translator_id id)
+{
+	SignatureIndex::iterator iterator = fSignatures.begin();
+	while (iterator != fSignatures.end()
+		&& iterator->signature != signature)
+		iterator++;
+
+	if (iterator == fSignatures.end()) {
+		signature_candidates candidates;
+		candidates.signature = signature;
+		iterator = fSignatures.insert(fSignatures.end(), candidates);
+	}
+
+	// the translators are added in ID order
+	if (iterator->translators.empty() || iterator->translators.back() != id)
+		iterator->translators.push_back(id);
+
+	fSignaturePrefixSize = std::max(fSignaturePrefixSize,
+		(size_t)signature->offset + signature->length);
+}
+
+
+/*!
+	Reads the start of the \a source stream, and collects the translators
+	that could identify it into \a candidates, sorted by their ID.
+
+	Returns \c false if all translators have to be asked, ie. if no
+	signature matched.
+*/
+bool
+BTranslatorRoster::Private::_FindCandidates(BPositionIO* source,
+	TranslatorIDList& candidates)
+{
+	if (!fSignatureIndexValid && !_UpdateSignatureIndex())
+		return false;
+	if (fSignatures.empty())
+		return false;
+
+	uint8 prefix[kMaxSignaturePrefixSize];
+	if (source->Seek(0, SEEK_SET) != 0)
+		return false;
+
+	ssize_t bytesRead = source->Read(prefix, fSignaturePrefixSize);
+	if (bytesRead <= 0)
+		return false;
+
+	try {
+		SignatureIndex::const_iterator iterator = fSignatures.begin();
+
+		for (; iterator != fSignatures.end(); iterator++) {
+			const translation_signature& signature = *iterator->signature;
+			if (signature.offset + signature.length > (size_t)bytesRead)
+				continue;
+
+			const uint8* bytes = (const uint8*)signature.bytes;
+			const uint8* mask = (const uint8*)signature.mask;
+			const uint8* data = prefix + signature.offset;
+			uint32 i = 0;
+			for (; i < signature.length; i++) {
+				uint8 bits = mask != NULL ? mask[i] : 0xff;
+				if (((data[i] ^ bytes[i]) & bits) != 0)
+					break;
+			}
+			if (i < signature.length)
+				continue;
+
+			candidates.insert(candidates.end(),
+				iterator->translators.begin(), iterator->translators.end());
+		}
+
+		if (candidates.empty())
+			return false;
+
+		candidates.insert(candidates.end(), fUnsignedTranslators.begin(),
+			fUnsignedTranslators.end());
+	} catch (...) {
+		return false;
+	}
+
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()),
+		candidates.end());
+	return true;
 }
 
 
@@ -1090,6 +1485,7 @@ BTranslatorRoster::Private::_RemoveTranslators(const node_ref* nodeRef,
 			update.AddInt32("translator_id", iterator->first);
 
 			fTranslators.erase(iterator);
+			fSignatureIndexValid = false;
 		}
 
 		iterator = next;
@@ -1132,6 +1528,7 @@ BTranslatorRoster::Private::_EntryAdded(const entry_ref& ref)
 	BMessage update(B_TRANSLATOR_ADDED);
 	int32 count = 0;
 	CreateTranslators(ref, count, &update);
+	_WriteAddOnCache();
 
 	_NotifyListeners(update);
 }
@@ -1192,6 +1589,8 @@ BTranslatorRoster::BTranslatorRoster(BMessage* model)
 				fPrivate->CreateTranslators(ref, count);
 			}
 		}
+
+		fPrivate->WriteAddOnCache();
 	}
 }
 
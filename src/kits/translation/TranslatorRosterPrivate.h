@@ -15,7 +15,9 @@
 #include <Entry.h>
 #include <Handler.h>
 #include <Locker.h>
+#include <Message.h>
 #include <Messenger.h>
+#include <String.h>
 #include <TranslatorRoster.h>
 
 
@@ -26,15 +28,22 @@ struct translator_item {
 	BTranslator*	translator;
 	entry_ref		ref;
 	ino_t			node;
-	image_id		image;
+	const translation_signature* signatures;
+		// optionally exported by the add-on
+};
+
+struct signature_candidates {
+	const translation_signature*	signature;
+	std::vector<translator_id>		translators;
 };
 
 typedef std::map<translator_id, translator_item> TranslatorMap;
 typedef std::vector<BMessenger> MessengerList;
 typedef std::vector<node_ref> NodeRefList;
 typedef std::set<entry_ref> EntryRefSet;
-typedef std::map<image_id, int32> ImageMap;
-typedef std::map<BTranslator*, image_id> TranslatorImageMap;
+typedef std::map<BString, BMessage> AddOnCache;
+typedef std::vector<translator_id> TranslatorIDList;
+typedef std::vector<signature_candidates> SignatureIndex;
 
 
 class BTranslatorRoster::Private : public BHandler, public BLocker {
@@ -48,9 +57,10 @@ public:
 			status_t			AddPaths(const char* paths);
 			status_t			AddPath(const char* path, int32* _added = NULL);
 			status_t			AddTranslator(BTranslator* translator,
-									image_id image = -1,
 									const entry_ref* ref = NULL,
-									ino_t node = 0);
+									ino_t node = 0,
+									const translation_signature* signatures
+										= NULL);
 
 			void				RemoveTranslators(entry_ref& ref);
 
@@ -74,7 +84,8 @@ public:
 
 			status_t			CreateTranslators(const entry_ref& ref,
 									int32& count, BMessage* update = NULL);
-			status_t			GetTranslatorData(image_id image,
+			void				WriteAddOnCache();
+	static	status_t			GetTranslatorData(image_id image,
 									translator_data& data);
 
 			status_t			StartWatching(BMessenger target);
@@ -85,6 +96,21 @@ private:
 
 			void				_RescanChanged();
 
+			const BMessage*		_CachedAddOn(const char* path,
+									const struct stat& stat);
+			status_t			_DescribeAddOn(const char* path,
+									const struct stat& stat,
+									BMessage& description);
+			void				_ReadAddOnCache();
+			void				_WriteAddOnCache();
+
+			bool				_UpdateSignatureIndex();
+			void				_AddSignature(
+									const translation_signature* signature,
+									translator_id id);
+			bool				_FindCandidates(BPositionIO* source,
+									TranslatorIDList& candidates);
+
 			const translation_format* _CheckHints(
 									const translation_format* formats,
 									int32 formatsCount, uint32 hintType,
@@ -114,8 +140,13 @@ private:
 			TranslatorMap		fTranslators;
 			MessengerList		fMessengers;
 			EntryRefSet			fRescanEntries;
-			ImageMap			fKnownImages;
-			TranslatorImageMap	fImageOrigins;
+			SignatureIndex		fSignatures;
+			TranslatorIDList	fUnsignedTranslators;
+			size_t				fSignaturePrefixSize;
+			bool				fSignatureIndexValid;
+			AddOnCache			fAddOnCache;
+			bool				fAddOnCacheRead;
+			bool				fAddOnCacheChanged;
 			const char*			fABISubDirectory;
 			int32				fNextID;
 			bool				fLazyScanning;
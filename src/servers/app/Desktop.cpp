@@ -2404,6 +2404,38 @@ Desktop::WriteWindowList(team_id team, BPrivate::LinkSender& sender)
 }
 
 
+/*!	Writes the input latency histograms of all windows, optionally resetting
+	them afterwards.
+*/
+void
+Desktop::WriteInputLatency(bool reset, BPrivate::LinkSender& sender)
+{
+	AutoReadLocker locker(fWindowLock);
+
+	int32 count = 0;
+	for (Window* window = fAllWindows.FirstWindow(); window != NULL;
+			window = window->NextWindow(kAllWindowList)) {
+		count++;
+	}
+
+	sender.StartMessage(B_OK);
+	sender.Attach<int32>(count);
+
+	for (Window* window = fAllWindows.FirstWindow(); window != NULL;
+			window = window->NextWindow(kAllWindowList)) {
+		InputLatencyHistogram histograms[B_INPUT_LATENCY_STAGE_COUNT];
+		window->EventTarget().GetInputLatency(histograms, reset);
+
+		sender.Attach<int32>(window->ServerWindow()->ServerToken());
+		sender.Attach<team_id>(window->ServerWindow()->ClientTeam());
+		sender.AttachString(window->Title());
+		sender.Attach(histograms, sizeof(histograms));
+	}
+
+	sender.Flush();
+}
+
+
 void
 Desktop::WriteWindowInfo(int32 serverToken, BPrivate::LinkSender& sender)
 {
@@ -259,6 +259,8 @@ public:
 									BPrivate::LinkSender& sender);
 			void				WriteWindowInfo(int32 serverToken,
 									BPrivate::LinkSender& sender);
+			void				WriteInputLatency(bool reset,
+									BPrivate::LinkSender& sender);
 			void				WriteApplicationOrder(int32 workspace,
 									BPrivate::LinkSender& sender);
 			void				WriteWindowOrder(int32 workspace,
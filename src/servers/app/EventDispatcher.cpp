@@ -88,8 +88,11 @@ static const float kListenerImportance = 0.8f;
 
 EventTarget::EventTarget()
 	:
-	fListeners(2)
+	fListeners(2),
+	fLatencyLock("event target latency")
 {
+	for (int32 i = 0; i < B_INPUT_LATENCY_STAGE_COUNT; i++)
+		fLatency[i].Reset();
 }
 
 
@@ -223,6 +226,39 @@ EventTarget::AddListener(int32 token, uint32 eventMask,
 }
 
 
+void
+EventTarget::AddInputLatency(input_latency_stage stage, bigtime_t latency)
+{
+	BAutolock _(fLatencyLock);
+	fLatency[stage].Add(latency);
+}
+
+
+void
+EventTarget::AddInputLatency(input_latency_stage stage,
+	const InputLatencyHistogram& histogram)
+{
+	BAutolock _(fLatencyLock);
+	fLatency[stage].Merge(histogram);
+}
+
+
+/*!	Copies the histograms of all stages into \a histograms, which must have
+	room for B_INPUT_LATENCY_STAGE_COUNT of them.
+*/
+void
+EventTarget::GetInputLatency(InputLatencyHistogram* histograms, bool reset)
+{
+	BAutolock _(fLatencyLock);
+
+	for (int32 i = 0; i < B_INPUT_LATENCY_STAGE_COUNT; i++) {
+		histograms[i] = fLatency[i];
+		if (reset)
+			fLatency[i].Reset();
+	}
+}
+
+
 //	#pragma mark -
 
 
@@ -250,6 +286,7 @@ EventDispatcher::EventDispatcher()
 	fNextLatestMouseMoved(NULL),
 	fLastButtons(0),
 	fLastUpdate(system_time()),
+	fEventTime(0),
 	fDraggingMessage(false),
 	fCursorLock("cursor loop lock"),
 	fHWInterface(NULL),
@@ -701,6 +738,26 @@ EventDispatcher::_SendMessage(BMessenger& messenger, BMessage* message,
 }
 
 
+/*!	Sends \a message to the \a target, and accounts the input latency of
+	the event being dispatched to it.
+*/
+bool
+EventDispatcher::_SendMessage(EventTarget& target, BMessage* message,
+	float importance)
+{
+	bool result = _SendMessage(target.Messenger(), message, importance);
+
+	if (fEventTime > 0) {
+		target.AddInputLatency(B_INPUT_LATENCY_QUEUED,
+			fLastUpdate - fEventTime);
+		target.AddInputLatency(B_INPUT_LATENCY_SENT,
+			system_time() - fEventTime);
+	}
+
+	return result;
+}
+
+
 bool
 EventDispatcher::_AddTokens(BMessage* message, EventTarget* target,
 	uint32 eventMask, BMessage* nextMouseMoved, int32* _viewToken)
@@ -798,6 +855,23 @@ EventDispatcher::_EventLoop()
 		BAutolock _(this);
 		fLastUpdate = system_time();
 
+		switch (event->what) {
+			case B_MOUSE_MOVED:
+			case B_MOUSE_DOWN:
+			case B_MOUSE_UP:
+			case B_MOUSE_WHEEL_CHANGED:
+			case B_KEY_DOWN:
+			case B_KEY_UP:
+			case B_UNMAPPED_KEY_DOWN:
+			case B_UNMAPPED_KEY_UP:
+			case B_MODIFIERS_CHANGED:
+				fEventTime = event->GetInt64("when", 0);
+				break;
+			default:
+				fEventTime = 0;
+				break;
+		}
+
 		EventTarget* current = NULL;
 		EventTarget* previous = NULL;
 		bool pointerEvent = false;
@@ -892,7 +966,7 @@ EventDispatcher::_EventLoop()
 					if (addedTokens)
 						_SetFeedFocus(event);
 
-					_SendMessage(fPreviousMouseTarget->Messenger(), event,
+					_SendMessage(*fPreviousMouseTarget, event,
 						kMouseTransitImportance);
 					previous = fPreviousMouseTarget;
 				}
@@ -917,7 +991,7 @@ EventDispatcher::_EventLoop()
 						break;
 					}
 
-					_SendMessage(current->Messenger(), event,
+					_SendMessage(*current, event,
 						event->what == B_MOUSE_MOVED
 							? kMouseMovedImportance : kStandardImportance);
 				}
@@ -963,7 +1037,7 @@ EventDispatcher::_EventLoop()
 					current = fFocus;
 
 				if (current != NULL && (!fSuspendFocus || addedTokens)) {
-					_SendMessage(current->Messenger(), event,
+					_SendMessage(*current, event,
 						kStandardImportance);
 				}
 				break;
@@ -997,7 +1071,7 @@ EventDispatcher::_EventLoop()
 							? fNextLatestMouseMoved : NULL))
 					continue;
 
-				if (!_SendMessage(target->Messenger(), event,
+				if (!_SendMessage(*target, event,
 						event->what == B_MOUSE_MOVED
 							? kMouseMovedImportance : kListenerImportance)) {
 					// the target doesn't seem to exist anymore, let's remove it
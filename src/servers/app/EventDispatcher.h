@@ -10,6 +10,7 @@
 
 
 #include <AutoDeleter.h>
+#include <InputLatency.h>
 #include <Locker.h>
 #include <Message.h>
 #include <MessageFilter.h>
@@ -51,11 +52,23 @@ class EventTarget {
 		event_listener* ListenerAt(int32 index) const
 				{ return fListeners.ItemAt(index); }
 
+		void AddInputLatency(input_latency_stage stage, bigtime_t latency);
+		void AddInputLatency(input_latency_stage stage,
+				const InputLatencyHistogram& histogram);
+		void GetInputLatency(InputLatencyHistogram* histograms, bool reset);
+
 	private:
 		bool _RemoveTemporaryListener(event_listener* listener, int32 index);
 
 		BObjectList<event_listener, true> fListeners;
 		BMessenger	fMessenger;
+
+		BLocker		fLatencyLock;
+			// The latencies are added from the event dispatcher and the
+			// window's thread, and read from the application's one, which
+			// may hold the window lock; they must not depend on the
+			// dispatcher's lock.
+		InputLatencyHistogram fLatency[B_INPUT_LATENCY_STAGE_COUNT];
 };
 
 class EventFilter {
@@ -112,6 +125,8 @@ class EventDispatcher : public BLocker {
 		void _SendFakeMouseMoved(BMessage* message);
 		bool _SendMessage(BMessenger& messenger, BMessage* message,
 				float importance);
+		bool _SendMessage(EventTarget& target, BMessage* message,
+				float importance);
 
 		bool _AddTokens(BMessage* message, EventTarget* target,
 				uint32 eventMask, BMessage* nextMouseMoved = NULL,
@@ -155,6 +170,8 @@ class EventDispatcher : public BLocker {
 		BPoint			fLastCursorPosition;
 		int32			fLastButtons;
 		bigtime_t		fLastUpdate;
+		bigtime_t		fEventTime;
+			// kernel time stamp of the input event being dispatched, or 0
 
 		BMessage		fDragMessage;
 		std::vector<std::pair<vref_id, BPrivate::vref_ticket>>
@@ -43,6 +43,7 @@
 #include <PrivateScreen.h>
 #include <RosterPrivate.h>
 #include <ServerProtocol.h>
+#include <ServerProtocolStructs.h>
 #include <WindowPrivate.h>
 
 #include "AppFontManager.h"
@@ -603,6 +604,14 @@ ServerApp::_DispatchMessage(int32 code, BPrivate::LinkReceiver& link)
 			break;
 		}
 
+		case AS_GET_INPUT_LATENCY:
+		{
+			bool reset;
+			if (link.Read<bool>(&reset) == B_OK)
+				fDesktop->WriteInputLatency(reset, fLink.Sender());
+			break;
+		}
+
 		case AS_GET_WINDOW_ORDER:
 		{
 			int32 workspace;
@@ -3602,6 +3611,7 @@ ServerApp::_MessageLooper()
 	fLink.Attach<port_id>(fMessagePort);
 	fLink.Attach<area_id>(fDesktop->SharedReadOnlyArea());
 	fLink.Attach<team_id>(threadInfo.team);
+	_AttachBootstrapInfo();
 	fLink.Flush();
 
 	BPrivate::LinkReceiver &receiver = fLink.Receiver();
@@ -3760,6 +3770,43 @@ ServerApp::_CreateWindow(int32 code, BPrivate::LinkReceiver& link,
 }
 
 
+/*!	\brief Attaches everything the client needs to initialize the interface
+	kit, so that it doesn't need to ask for each part separately.
+*/
+void
+ServerApp::_AttachBootstrapInfo()
+{
+	if (!fDesktop->LockSingleWindow()) {
+		fLink.Attach<bool>(false);
+		return;
+	}
+
+	AppBootstrapInfo info;
+	DesktopSettings settings(fDesktop);
+	strlcpy(info.controlLook, settings.ControlLook().String(),
+		sizeof(info.controlLook));
+	settings.GetMenuInfo(info.menuInfo);
+	info.workspace = fDesktop->CurrentWorkspace();
+
+	// the fonts have been recorded on construction already
+	const ServerFont* fonts[] = { &fPlainFont, &fBoldFont, &fFixedFont };
+	AppBootstrapFontInfo* fontInfos[] = { &info.plainFont, &info.boldFont,
+		&info.fixedFont };
+	for (int32 i = 0; i < 3; i++) {
+		fontInfos[i]->familyID = fonts[i]->FamilyID();
+		fontInfos[i]->styleID = fonts[i]->StyleID();
+		fontInfos[i]->size = fonts[i]->Size();
+		fontInfos[i]->face = fonts[i]->Face();
+		fontInfos[i]->flags = fonts[i]->Flags();
+	}
+
+	fDesktop->UnlockSingleWindow();
+
+	fLink.Attach<bool>(true);
+	fLink.Attach<AppBootstrapInfo>(info);
+}
+
+
 bool
 ServerApp::_HasWindowUnderMouse()
 {
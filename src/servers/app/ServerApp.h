@@ -108,6 +108,7 @@ private:
 									port_id& clientReplyPort);
 
 			bool				_HasWindowUnderMouse();
+			void				_AttachBootstrapInfo();
 
 			bool				_AddBitmap(ServerBitmap* bitmap);
 			void				_DeleteBitmap(ServerBitmap* bitmap);
@@ -637,6 +637,17 @@ ServerWindow::_DispatchMessage(int32 code, BPrivate::LinkReceiver& link)
 			break;
 		}
 
+		case AS_REPORT_INPUT_LATENCY:
+		{
+			// the latencies the window measured up to its message loop
+			InputLatencyHistogram histogram;
+			if (link.Read<InputLatencyHistogram>(&histogram) == B_OK) {
+				fEventTarget.AddInputLatency(B_INPUT_LATENCY_DISPATCHED,
+					histogram);
+			}
+			break;
+		}
+
 		case AS_ACTIVATE_WINDOW:
 		{
 			bool activate = true;
@@ -13,10 +13,13 @@
 #include <fcntl.h>
 #include <poll.h>
 #include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <algorithm>
 #include <cstring>
+#include <new>
 #include <InterfaceDefs.h>
 
 
@@ -128,8 +131,11 @@ static uint32 MapMouseButton(uint32 linuxButton)
 
 LibEvdevEventStream::LibEvdevEventStream(uint32 width, uint32 height, struct libseat* seat)
 	:
+	fRingHead(0),
+	fRingTail(0),
 	fEventList(10),
 	fEventListLocker("evdev event list"),
+	fEventListCount(0),
 	fEventNotification(-1),
 	fWaitingOnEvent(false),
 	fLatestMouseMovedEvent(NULL),
@@ -243,6 +249,10 @@ LibEvdevEventStream::_OpenDevice(const char* path)
 		return false;
 	}
 
+	// Have the kernel stamp the events with the clock system_time() uses
+	int clock = CLOCK_MONOTONIC;
+	bool monotonicClock = ioctl(fd, EVIOCSCLOCKID, &clock) == 0;
+
 	// Add to epoll
 	struct epoll_event ev;
 	ev.events = EPOLLIN;
@@ -262,6 +272,7 @@ LibEvdevEventStream::_OpenDevice(const char* path)
 	dev.isKeyboard = isKeyboard;
 	dev.isMouse = isMouse;
 	dev.isPointer = isPointer;
+	dev.monotonicClock = monotonicClock;
 
 	fDevices.push_back(dev);
 
@@ -309,23 +320,54 @@ LibEvdevEventStream::UpdateScreenBounds(BRect bounds)
 bool
 LibEvdevEventStream::GetNextEvent(BMessage** _event)
 {
-	BAutolock lock(fEventListLocker);
-	while (fEventList.CountItems() == 0) {
-		fWaitingOnEvent = true;
-		lock.Unlock();
+	while (true) {
+		// events inserted by the app_server itself come first
+		if (fEventListCount.load(std::memory_order_acquire) > 0) {
+			BAutolock lock(fEventListLocker);
+			if (!lock.IsLocked())
+				return false;
+
+			BMessage* event = fEventList.RemoveItemAt(0);
+			if (event != NULL) {
+				fEventListCount.fetch_sub(1, std::memory_order_relaxed);
+				if (event->what == B_MOUSE_MOVED)
+					fLatestMouseMovedEvent = event;
+
+				*_event = event;
+				return true;
+			}
+		}
+
+		input_record record;
+		if (_PopRecord(record)) {
+			BMessage* event = _MessageFor(record);
+			if (event == NULL)
+				continue;
+
+			if (event->what == B_MOUSE_MOVED)
+				fLatestMouseMovedEvent = event;
+
+			*_event = event;
+			return true;
+		}
+
+		// Nothing there, wait for the next event. The flag has to be set
+		// before checking again, so that no notification can get lost.
+		fWaitingOnEvent.store(true);
+		if (fEventListCount.load() > 0
+			|| fRingTail.load(std::memory_order_relaxed) != fRingHead.load()) {
+			fWaitingOnEvent.store(false);
+			continue;
+		}
 
 		status_t result;
 		do {
 			result = acquire_sem(fEventNotification);
 		} while (result == B_INTERRUPTED);
 
-		lock.Lock();
-		if (!lock.IsLocked())
+		if (result != B_OK)
 			return false;
 	}
-
-	*_event = fEventList.RemoveItemAt(0);
-	return true;
 }
 
 
@@ -336,13 +378,17 @@ LibEvdevEventStream::InsertEvent(BMessage* event)
 	if (!lock.IsLocked() || !fEventList.AddItem(event))
 		return B_ERROR;
 
-	if (event->what == B_MOUSE_MOVED)
-		fLatestMouseMovedEvent = event;
+	fEventListCount.fetch_add(1, std::memory_order_release);
+	lock.Unlock();
 
+	_NotifyEvent();
 	return B_OK;
 }
 
 
+/*!	Consecutive mouse moved events are already coalesced in the ring (see
+	_PopRecord()), so the one handed out last is always the latest one.
+*/
 BMessage*
 LibEvdevEventStream::PeekLatestMouseMoved()
 {
@@ -350,6 +396,134 @@ LibEvdevEventStream::PeekLatestMouseMoved()
 }
 
 
+/*!	Appends \a record to the ring. Only the poll thread may call this.
+
+	If the ring is full, the record is dropped if \a mayDrop is \c true,
+	otherwise this waits until the dispatcher made room.
+*/
+bool
+LibEvdevEventStream::_PushRecord(const input_record& record, bool mayDrop)
+{
+	uint32 head = fRingHead.load(std::memory_order_relaxed);
+	while (head - fRingTail.load(std::memory_order_acquire) >= kRingSize) {
+		if (mayDrop || !fRunning)
+			return false;
+		snooze(1000);
+	}
+
+	fRing[head & (kRingSize - 1)] = record;
+	fRingHead.store(head + 1, std::memory_order_release);
+
+	_NotifyEvent();
+	return true;
+}
+
+
+/*!	Removes the next record from the ring. Only the dispatching thread may
+	call this.
+
+	A mouse moved record that is directly followed by other ones with the
+	same buttons and modifiers is dropped in favor of the last of them; the
+	position is absolute, so nothing is lost but intermediate positions the
+	app_server is too busy to deliver anyway.
+*/
+bool
+LibEvdevEventStream::_PopRecord(input_record& record)
+{
+	uint32 tail = fRingTail.load(std::memory_order_relaxed);
+	uint32 head = fRingHead.load(std::memory_order_acquire);
+	if (tail == head)
+		return false;
+
+	record = fRing[tail & (kRingSize - 1)];
+	tail++;
+
+	if (record.what == B_MOUSE_MOVED) {
+		while (tail != head) {
+			const input_record& next = fRing[tail & (kRingSize - 1)];
+			if (next.what != B_MOUSE_MOVED || next.buttons != record.buttons
+				|| next.modifiers != record.modifiers)
+				break;
+
+			record = next;
+			tail++;
+		}
+	}
+
+	fRingTail.store(tail, std::memory_order_release);
+	return true;
+}
+
+
+void
+LibEvdevEventStream::_NotifyEvent()
+{
+	if (fWaitingOnEvent.exchange(false))
+		release_sem(fEventNotification);
+}
+
+
+BMessage*
+LibEvdevEventStream::_MessageFor(const input_record& record)
+{
+	BMessage* event = new(std::nothrow) BMessage(record.what);
+	if (event == NULL)
+		return NULL;
+
+	switch (record.what) {
+		case B_KEY_DOWN:
+		case B_KEY_UP:
+		{
+			event->AddInt32("key", record.key);
+			event->AddInt32("raw_char", record.key);
+			event->AddInt32("modifiers", record.modifiers);
+
+			char byte = (char)record.key;
+			char bytes[2] = {byte, 0};
+			event->AddInt8("byte", (int8)byte);
+			event->AddString("bytes", bytes);
+			break;
+		}
+
+		case B_MODIFIERS_CHANGED:
+			event->AddInt32("be:old_modifiers", record.oldModifiers);
+			event->AddInt32("modifiers", record.modifiers);
+			break;
+
+		case B_MOUSE_WHEEL_CHANGED:
+			if (record.wheelDeltaX != 0)
+				event->AddFloat("be:wheel_delta_x", record.wheelDeltaX);
+			if (record.wheelDeltaY != 0)
+				event->AddFloat("be:wheel_delta_y", record.wheelDeltaY);
+			break;
+
+		case B_MOUSE_DOWN:
+		case B_MOUSE_UP:
+		case B_MOUSE_MOVED:
+			event->AddPoint("where", record.where);
+			event->AddInt32("buttons", record.buttons);
+			event->AddInt32("modifiers", record.modifiers);
+			if (record.what == B_MOUSE_DOWN)
+				event->AddInt32("clicks", 1);
+			break;
+	}
+
+	event->AddInt64("when", record.when);
+	return event;
+}
+
+
+/*static*/ bigtime_t
+LibEvdevEventStream::_EventTime(const EvdevDevice& dev,
+	const struct input_event& ev)
+{
+	if (!dev.monotonicClock)
+		return system_time();
+
+	return (bigtime_t)ev.input_event_sec * 1000000 + ev.input_event_usec;
+}
+
+
 int32
 LibEvdevEventStream::_PollEventsThread(void* cookie)
 {
@@ -416,7 +590,7 @@ LibEvdevEventStream::_PollEvents()
 
 					case EV_SYN:
 						if (ev.code == SYN_REPORT) {
-							_FlushPendingEvents();
+							_FlushPendingEvents(_EventTime(*dev, ev));
 						}
 						break;
 				}
@@ -465,33 +639,28 @@ LibEvdevEventStream::_ProcessKeyEvent(EvdevDevice& dev, struct input_event& ev)
 	bool pressed = (ev.value != 0);  // 1 = press, 2 = repeat, 0 = release
 
 	int32 bKey = _MapKeyCode(keyCode);
+	bigtime_t when = _EventTime(dev, ev);
 
 	_UpdateModifiers(keyCode, pressed);
 	uint32 modifiers = _GetCurrentModifiers();
 
 	if (ev.value == 1) {  // Key press
 		fKeyStates[keyCode] = true;
-		_SendKeyEvent(B_KEY_DOWN, bKey, modifiers);
+		_SendKeyEvent(B_KEY_DOWN, bKey, modifiers, when);
 	} else if (ev.value == 0) {  // Key release
 		fKeyStates[keyCode] = false;
-		_SendKeyEvent(B_KEY_UP, bKey, modifiers);
+		_SendKeyEvent(B_KEY_UP, bKey, modifiers, when);
 	} else if (ev.value == 2) {  // Key repeat
-		_SendKeyEvent(B_KEY_DOWN, bKey, modifiers);
+		_SendKeyEvent(B_KEY_DOWN, bKey, modifiers, when);
 	}
 
 	if (modifiers != fOldModifiers) {
-		BMessage* event = new BMessage(B_MODIFIERS_CHANGED);
-		event->AddInt32("be:old_modifiers", fOldModifiers);
-		event->AddInt32("modifiers", modifiers);
-		event->AddInt64("when", system_time());
-
-		BAutolock lock(fEventListLocker);
-		fEventList.AddItem(event);
-		if (fWaitingOnEvent) {
-			fWaitingOnEvent = false;
-			lock.Unlock();
-			release_sem(fEventNotification);
-		}
+		input_record record = {};
+		record.what = B_MODIFIERS_CHANGED;
+		record.when = when;
+		record.modifiers = modifiers;
+		record.oldModifiers = fOldModifiers;
+		_PushRecord(record);
 
 		fOldModifiers = modifiers;
 	}
@@ -515,36 +684,26 @@ LibEvdevEventStream::_ProcessRelEvent(EvdevDevice& dev, struct input_event& ev)
 		case REL_WHEEL:
 		case REL_WHEEL_HI_RES:
 		{
-			BMessage* event = new BMessage(B_MOUSE_WHEEL_CHANGED);
 			float delta = ev.code == REL_WHEEL_HI_RES ? ev.value / 120.0f : (float)ev.value;
-			event->AddFloat("be:wheel_delta_y", -delta);
-			event->AddInt64("when", system_time());
 
-			BAutolock lock(fEventListLocker);
-			fEventList.AddItem(event);
-			if (fWaitingOnEvent) {
-				fWaitingOnEvent = false;
-				lock.Unlock();
-				release_sem(fEventNotification);
-			}
+			input_record record = {};
+			record.what = B_MOUSE_WHEEL_CHANGED;
+			record.when = _EventTime(dev, ev);
+			record.wheelDeltaY = -delta;
+			_PushRecord(record);
 			break;
 		}
 
 		case REL_HWHEEL:
 		case REL_HWHEEL_HI_RES:
 		{
-			BMessage* event = new BMessage(B_MOUSE_WHEEL_CHANGED);
 			float delta = ev.code == REL_HWHEEL_HI_RES ? ev.value / 120.0f : (float)ev.value;
-			event->AddFloat("be:wheel_delta_x", delta);
-			event->AddInt64("when", system_time());
 
-			BAutolock lock(fEventListLocker);
-			fEventList.AddItem(event);
-			if (fWaitingOnEvent) {
-				fWaitingOnEvent = false;
-				lock.Unlock();
-				release_sem(fEventNotification);
-			}
+			input_record record = {};
+			record.what = B_MOUSE_WHEEL_CHANGED;
+			record.when = _EventTime(dev, ev);
+			record.wheelDeltaX = delta;
+			_PushRecord(record);
 			break;
 		}
 	}
@@ -597,13 +756,14 @@ LibEvdevEventStream::_ProcessButtonEvent(EvdevDevice& dev, struct input_event& e
 		fMouseButtons &= ~bButton;
 
 	if (fMouseButtons != oldButtons) {
-		_SendMouseEvent(pressed ? B_MOUSE_DOWN : B_MOUSE_UP);
+		_SendMouseEvent(pressed ? B_MOUSE_DOWN : B_MOUSE_UP,
+			_EventTime(dev, ev));
 	}
 }
 
 
 void
-LibEvdevEventStream::_FlushPendingEvents()
+LibEvdevEventStream::_FlushPendingEvents(bigtime_t when)
 {
 	if (fMouseMoved) {
 		// Apply pending delta for relative motion
@@ -617,59 +777,38 @@ LibEvdevEventStream::_FlushPendingEvents()
 			fPendingMouseDelta = BPoint(0, 0);
 		}
 
-		_SendMouseEvent(B_MOUSE_MOVED);
-		fMouseMoved = false;
+		_SendMouseEvent(B_MOUSE_MOVED, when);
 	}
 }
 
 
 void
-LibEvdevEventStream::_SendKeyEvent(uint32 what, int32 key, uint32 modifiers)
+LibEvdevEventStream::_SendKeyEvent(uint32 what, int32 key, uint32 modifiers,
+	bigtime_t when)
 {
-	BMessage* event = new BMessage(what);
-	event->AddInt32("key", key);
-	event->AddInt32("raw_char", key);
-	event->AddInt32("modifiers", modifiers);
-
-	char byte = (char)key;
-	char bytes[2] = {byte, 0};
-	event->AddInt8("byte", (int8)byte);
-	event->AddString("bytes", bytes);
-	event->AddInt64("when", system_time());
-
-	BAutolock lock(fEventListLocker);
-	fEventList.AddItem(event);
-	if (fWaitingOnEvent) {
-		fWaitingOnEvent = false;
-		lock.Unlock();
-		release_sem(fEventNotification);
-	}
+	input_record record = {};
+	record.what = what;
+	record.when = when;
+	record.key = key;
+	record.modifiers = modifiers;
+	_PushRecord(record);
 }
 
 
 void
-LibEvdevEventStream::_SendMouseEvent(uint32 what)
+LibEvdevEventStream::_SendMouseEvent(uint32 what, bigtime_t when)
 {
-	BMessage* event = new BMessage(what);
-	event->AddPoint("where", fMousePosition);
-	event->AddInt32("buttons", fMouseButtons);
-	event->AddInt32("modifiers", fModifiers);
-	event->AddInt64("when", system_time());
-
-	if (what == B_MOUSE_DOWN)
-		event->AddInt32("clicks", 1);
-
-	BAutolock lock(fEventListLocker);
-	fEventList.AddItem(event);
-
-	if (what == B_MOUSE_MOVED)
-		fLatestMouseMovedEvent = event;
-
-	if (fWaitingOnEvent) {
-		fWaitingOnEvent = false;
-		lock.Unlock();
-		release_sem(fEventNotification);
-	}
+	input_record record = {};
+	record.what = what;
+	record.when = when;
+	record.where = fMousePosition;
+	record.buttons = fMouseButtons;
+	record.modifiers = fModifiers;
+
+	// A move that doesn't fit into the ring is sent with the next report
+	bool sent = _PushRecord(record, what == B_MOUSE_MOVED);
+	if (what == B_MOUSE_MOVED && sent)
+		fMouseMoved = false;
 }
 
 
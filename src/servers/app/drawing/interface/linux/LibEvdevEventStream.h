@@ -12,6 +12,7 @@
 
 #include <linux/input.h>
 #include <libevdev/libevdev.h>
+#include <atomic>
 #include <vector>
 #include <map>
 
@@ -28,6 +29,22 @@ struct EvdevDevice {
 	bool				isKeyboard;
 	bool				isMouse;
 	bool				isPointer;  // Touchpad or other pointing device
+	bool				monotonicClock;  // event times use system_time()
+};
+
+
+// Compact record of an input event, the BMessage is only created for the
+// records that are actually dispatched.
+struct input_record {
+	uint32				what;
+	bigtime_t			when;
+	BPoint				where;
+	uint32				buttons;
+	uint32				modifiers;
+	uint32				oldModifiers;
+	int32				key;
+	float				wheelDeltaX;
+	float				wheelDeltaY;
 };
 
 
@@ -63,20 +80,40 @@ private:
 			void				_ProcessRelEvent(EvdevDevice& dev, struct input_event& ev);
 			void				_ProcessAbsEvent(EvdevDevice& dev, struct input_event& ev);
 			void				_ProcessButtonEvent(EvdevDevice& dev, struct input_event& ev);
-			void				_FlushPendingEvents();
+			void				_FlushPendingEvents(bigtime_t when);
+	static	bigtime_t			_EventTime(const EvdevDevice& dev,
+									const struct input_event& ev);
 
 	// Key mapping
 			int32				_MapKeyCode(uint32 linuxKeyCode);
 			void				_UpdateModifiers(uint32 keyCode, bool pressed);
 			uint32				_GetCurrentModifiers() const;
-			void				_SendKeyEvent(uint32 what, int32 key, uint32 modifiers);
-			void				_SendMouseEvent(uint32 what);
-
-	// Event list
+			void				_SendKeyEvent(uint32 what, int32 key, uint32 modifiers,
+									bigtime_t when);
+			void				_SendMouseEvent(uint32 what, bigtime_t when);
+
+	// Event ring
+			bool				_PushRecord(const input_record& record,
+									bool mayDrop = false);
+			bool				_PopRecord(input_record& record);
+			void				_NotifyEvent();
+			BMessage*			_MessageFor(const input_record& record);
+
+			enum { kRingSize = 1024 };	// must be a power of two
+
+			input_record			fRing[kRingSize];
+			std::atomic<uint32>		fRingHead;
+				// written by the poll thread only
+			std::atomic<uint32>		fRingTail;
+				// written by the dispatching thread only
+
+			// events inserted by other threads
 			BObjectList<BMessage>	fEventList;
 			BLocker					fEventListLocker;
+			std::atomic<int32>		fEventListCount;
+
 			sem_id					fEventNotification;
-			bool					fWaitingOnEvent;
+			std::atomic<bool>		fWaitingOnEvent;
 			BMessage*				fLatestMouseMovedEvent;
 
 	// Mouse state
@@ -38,17 +38,43 @@
 	\brief A list of RosterAppInfos.
 
 	Features adding/removing of RosterAppInfos and method for finding
-	infos by signature, team ID, entry_ref or token.
+	infos by signature, team ID, entry_ref, port or token.
 	The method It() returns an iterator, an instance of the basic
 	AppInfoList::Iterator class.
+
+	The lookups are backed by hash indexes. Each index maps a key to one of
+	the infos with that key and the number of such infos, so that duplicate
+	keys (multiple launch apps, pre-registered apps without a team) only
+	require a list scan when the indexed info is removed. Keys that are not
+	set (negative team/port IDs, zero tokens, empty signatures) are not
+	indexed; looking them up falls back to scanning the list.
+
+	The indexes are updated by AddInfo() and RemoveInfo(). While an info is
+	in the list, its signature and port must only be changed via
+	SetSignature() and SetPort(); its team, token and entry_ref must not be
+	changed at all.
 */
 
+enum {
+	kTeamIndex		= 0x01,
+	kPortIndex		= 0x02,
+	kTokenIndex		= 0x04,
+	kSignatureIndex	= 0x08,
+	kRefIndex		= 0x10,
+	kAllIndexes		= 0x1f,
+};
+
 
 // constructor
 /*!	\brief Creates an empty list.
 */
 AppInfoList::AppInfoList()
-		   : fInfos()
+		   : fInfos(),
+			 fTeamIndex(),
+			 fPortIndex(),
+			 fTokenIndex(),
+			 fSignatureIndex(),
+			 fRefIndex()
 {
 }
 
@@ -73,8 +99,11 @@ bool
 AppInfoList::AddInfo(RosterAppInfo *info)
 {
 	bool result = false;
-	if (info)
+	if (info && _AddToIndexes(info, kAllIndexes)) {
 		result = fInfos.AddItem(info);
+		if (!result)
+			_RemoveFromIndexes(info, kAllIndexes);
+	}
 	return result;
 }
 
@@ -86,7 +115,10 @@ AppInfoList::AddInfo(RosterAppInfo *info)
 bool
 AppInfoList::RemoveInfo(RosterAppInfo *info)
 {
-	return fInfos.RemoveItem(info);
+	bool result = fInfos.RemoveItem(info);
+	if (result)
+		_RemoveFromIndexes(info, kAllIndexes);
+	return result;
 }
 
 // MakeEmpty
@@ -101,6 +133,11 @@ AppInfoList::MakeEmpty(bool deleteInfos)
 	}
 
 	fInfos.MakeEmpty();
+	fTeamIndex.Clear();
+	fPortIndex.Clear();
+	fTokenIndex.Clear();
+	fSignatureIndex.Clear();
+	fRefIndex.Clear();
 }
 
 // InfoFor
@@ -117,7 +154,13 @@ AppInfoList::MakeEmpty(bool deleteInfos)
 RosterAppInfo *
 AppInfoList::InfoFor(const char *signature) const
 {
-	return InfoAt(IndexOf(signature));
+	if (signature == NULL || signature[0] == '\0')
+		return InfoAt(IndexOf(signature));
+
+	IndexEntry *entry;
+	if (fSignatureIndex.Get(SignatureKey(signature), entry))
+		return entry->info;
+	return NULL;
 }
 
 // InfoFor
@@ -129,7 +172,13 @@ AppInfoList::InfoFor(const char *signature) const
 RosterAppInfo *
 AppInfoList::InfoFor(team_id team) const
 {
-	return InfoAt(IndexOf(team));
+	if (team < 0)
+		return InfoAt(IndexOf(team));
+
+	IndexEntry *entry;
+	if (fTeamIndex.Get(HashKey32<team_id>(team), entry))
+		return entry->info;
+	return NULL;
 }
 
 // InfoFor
@@ -146,7 +195,18 @@ AppInfoList::InfoFor(team_id team) const
 RosterAppInfo *
 AppInfoList::InfoFor(const entry_ref *ref) const
 {
-	return InfoAt(IndexOf(ref));
+	if (ref == NULL || ref->name == NULL)
+		return InfoAt(IndexOf(ref));
+
+	BEntry entry(ref, true);
+	entry_ref realRef;
+	if (entry.GetRef(&realRef) != B_OK)
+		realRef = *ref;
+
+	IndexEntry *indexEntry;
+	if (fRefIndex.Get(RefKey(realRef), indexEntry))
+		return indexEntry->info;
+	return NULL;
 }
 
 // InfoForToken
@@ -162,7 +222,68 @@ AppInfoList::InfoFor(const entry_ref *ref) const
 RosterAppInfo *
 AppInfoList::InfoForToken(uint32 token) const
 {
-	return InfoAt(IndexOfToken(token));
+	if (token == 0)
+		return InfoAt(IndexOfToken(token));
+
+	IndexEntry *entry;
+	if (fTokenIndex.Get(HashKey32<uint32>(token), entry))
+		return entry->info;
+	return NULL;
+}
+
+// InfoForPort
+/*!	\brief Returns the RosterAppInfo with the supplied looper port.
+
+	If the list contains more than one RosterAppInfo with the given port,
+	it is undefined, which one is returned.
+
+	\param port The port
+	\return A RosterAppInfo with the supplied port, or \c NULL, if the list
+			doesn't contain an info with the port.
+*/
+RosterAppInfo *
+AppInfoList::InfoForPort(port_id port) const
+{
+	if (port < 0)
+		return InfoAt(IndexOfPort(port));
+
+	IndexEntry *entry;
+	if (fPortIndex.Get(HashKey32<port_id>(port), entry))
+		return entry->info;
+	return NULL;
+}
+
+// SetSignature
+/*!	\brief Changes the signature of a RosterAppInfo in the list.
+	\param info The RosterAppInfo, which must be in the list
+	\param signature The new signature, may be \c NULL
+	\return \c true on success, \c false if there's not enough memory to
+			update the index. The signature is changed anyway.
+*/
+bool
+AppInfoList::SetSignature(RosterAppInfo *info, const char *signature)
+{
+	_RemoveFromIndexes(info, kSignatureIndex);
+	if (signature)
+		strlcpy(info->signature, signature, B_MIME_TYPE_LENGTH);
+	else
+		info->signature[0] = '\0';
+	return _AddToIndexes(info, kSignatureIndex);
+}
+
+// SetPort
+/*!	\brief Changes the looper port of a RosterAppInfo in the list.
+	\param info The RosterAppInfo, which must be in the list
+	\param port The new port
+	\return \c true on success, \c false if there's not enough memory to
+			update the index. The port is changed anyway.
+*/
+bool
+AppInfoList::SetPort(RosterAppInfo *info, port_id port)
+{
+	_RemoveFromIndexes(info, kPortIndex);
+	info->port = port;
+	return _AddToIndexes(info, kPortIndex);
 }
 
 // CountInfos
@@ -210,7 +331,10 @@ AppInfoList::Sort(
 RosterAppInfo *
 AppInfoList::RemoveInfo(int32 index)
 {
-	return (RosterAppInfo*)fInfos.RemoveItem(index);
+	RosterAppInfo *info = (RosterAppInfo*)fInfos.RemoveItem(index);
+	if (info)
+		_RemoveFromIndexes(info, kAllIndexes);
+	return info;
 }
 
 // InfoAt
@@ -324,3 +448,167 @@ AppInfoList::IndexOfToken(uint32 token) const
 	return -1;
 }
 
+// IndexOfPort
+/*!	\brief Returns the list index of a RosterAppInfo with the supplied
+		   looper port.
+
+	\param port The port
+	\return The index of the found RosterAppInfo, or -1, if the list doesn't
+			contain an info with this port.
+*/
+int32
+AppInfoList::IndexOfPort(port_id port) const
+{
+	for (int32 i = 0; RosterAppInfo *info = InfoAt(i); i++) {
+		if (info->port == port)
+			return i;
+	}
+	return -1;
+}
+
+// _AddToIndexes
+/*!	\brief Adds a RosterAppInfo to the given indexes.
+
+	Only the keys the info actually has are indexed. On failure the info is
+	removed from the indexes it had already been added to.
+
+	\param info The RosterAppInfo
+	\param indexes A mask of the indexes to add the info to
+	\return \c true on success, \c false if there's not enough memory.
+*/
+bool
+AppInfoList::_AddToIndexes(RosterAppInfo *info, uint32 indexes)
+{
+	uint32 added = 0;
+
+	if ((indexes & kTeamIndex) != 0 && info->team >= 0) {
+		if (!_Index(fTeamIndex, HashKey32<team_id>(info->team), info))
+			goto failed;
+		added |= kTeamIndex;
+	}
+	if ((indexes & kPortIndex) != 0 && info->port >= 0) {
+		if (!_Index(fPortIndex, HashKey32<port_id>(info->port), info))
+			goto failed;
+		added |= kPortIndex;
+	}
+	if ((indexes & kTokenIndex) != 0 && info->token != 0) {
+		if (!_Index(fTokenIndex, HashKey32<uint32>(info->token), info))
+			goto failed;
+		added |= kTokenIndex;
+	}
+	if ((indexes & kSignatureIndex) != 0 && info->signature[0] != '\0') {
+		if (!_Index(fSignatureIndex, SignatureKey(info->signature), info))
+			goto failed;
+		added |= kSignatureIndex;
+	}
+	if ((indexes & kRefIndex) != 0 && info->ref.name != NULL) {
+		if (!_Index(fRefIndex, RefKey(info->ref), info))
+			goto failed;
+		added |= kRefIndex;
+	}
+
+	return true;
+
+failed:
+	_RemoveFromIndexes(info, added);
+	return false;
+}
+
+// _RemoveFromIndexes
+/*!	\brief Removes a RosterAppInfo from the given indexes.
+
+	The info must not be in the list anymore, unless it is removed only from
+	the indexes for keys that are about to be changed.
+
+	\param info The RosterAppInfo
+	\param indexes A mask of the indexes to remove the info from
+*/
+void
+AppInfoList::_RemoveFromIndexes(RosterAppInfo *info, uint32 indexes)
+{
+	if ((indexes & kTeamIndex) != 0 && info->team >= 0)
+		_Unindex(fTeamIndex, HashKey32<team_id>(info->team), kTeamIndex, info);
+	if ((indexes & kPortIndex) != 0 && info->port >= 0)
+		_Unindex(fPortIndex, HashKey32<port_id>(info->port), kPortIndex, info);
+	if ((indexes & kTokenIndex) != 0 && info->token != 0) {
+		_Unindex(fTokenIndex, HashKey32<uint32>(info->token), kTokenIndex,
+			info);
+	}
+	if ((indexes & kSignatureIndex) != 0 && info->signature[0] != '\0') {
+		_Unindex(fSignatureIndex, SignatureKey(info->signature),
+			kSignatureIndex, info);
+	}
+	if ((indexes & kRefIndex) != 0 && info->ref.name != NULL)
+		_Unindex(fRefIndex, RefKey(info->ref), kRefIndex, info);
+}
+
+// _FindOther
+/*!	\brief Returns the first RosterAppInfo in the list other than \a info
+		   that has the same key as \a info for the given index.
+	\param index The index (one of the index flags)
+	\param info The RosterAppInfo
+	\return The found RosterAppInfo, or \c NULL.
+*/
+RosterAppInfo *
+AppInfoList::_FindOther(uint32 index, RosterAppInfo *info) const
+{
+	for (int32 i = 0; RosterAppInfo *other = InfoAt(i); i++) {
+		if (other == info)
+			continue;
+
+		bool same = false;
+		switch (index) {
+			case kTeamIndex:
+				same = other->team == info->team;
+				break;
+			case kPortIndex:
+				same = other->port == info->port;
+				break;
+			case kTokenIndex:
+				same = other->token == info->token;
+				break;
+			case kSignatureIndex:
+				same = !strcasecmp(other->signature, info->signature);
+				break;
+			case kRefIndex:
+				same = other->ref == info->ref;
+				break;
+		}
+		if (same)
+			return other;
+	}
+	return NULL;
+}
+
+// _Index
+template<typename Index, typename Key>
+/*static*/ bool
+AppInfoList::_Index(Index &index, const Key &key, RosterAppInfo *info)
+{
+	IndexEntry *entry;
+	if (index.Get(key, entry)) {
+		entry->count++;
+		return true;
+	}
+
+	IndexEntry newEntry;
+	newEntry.info = info;
+	newEntry.count = 1;
+	return index.Put(key, newEntry) == B_OK;
+}
+
+// _Unindex
+template<typename Index, typename Key>
+void
+AppInfoList::_Unindex(Index &index, const Key &key, uint32 which,
+	RosterAppInfo *info)
+{
+	IndexEntry *entry;
+	if (!index.Get(key, entry))
+		return;
+
+	if (--entry->count == 0)
+		index.Remove(key);
+	else if (entry->info == info)
+		entry->info = _FindOther(which, info);
+}
@@ -27,10 +27,13 @@
 #ifndef APP_INFO_LIST_H
 #define APP_INFO_LIST_H
 
+#include <Entry.h>
+#include <HashMap.h>
 #include <List.h>
 #include <OS.h>
+#include <String.h>
 
-struct entry_ref;
+#include <HashString.h>
 
 struct RosterAppInfo;
 
@@ -51,6 +54,10 @@ public:
 	RosterAppInfo *InfoFor(team_id team) const;
 	RosterAppInfo *InfoFor(const entry_ref *ref) const;
 	RosterAppInfo *InfoForToken(uint32 token) const;
+	RosterAppInfo *InfoForPort(port_id port) const;
+
+	bool SetSignature(RosterAppInfo *info, const char *signature);
+	bool SetPort(RosterAppInfo *info, port_id port);
 
 	bool IsEmpty() const		{ return (CountInfos() == 0); };
 	int32 CountInfos() const;
@@ -69,12 +76,96 @@ private:
 	int32 IndexOf(team_id team) const;
 	int32 IndexOf(const entry_ref *ref) const;
 	int32 IndexOfToken(uint32 token) const;
+	int32 IndexOfPort(port_id port) const;
+
+	bool _AddToIndexes(RosterAppInfo *info, uint32 indexes);
+	void _RemoveFromIndexes(RosterAppInfo *info, uint32 indexes);
+	RosterAppInfo *_FindOther(uint32 index, RosterAppInfo *info) const;
+
+	template<typename Index, typename Key>
+	static bool _Index(Index &index, const Key &key, RosterAppInfo *info);
+	template<typename Index, typename Key>
+	void _Unindex(Index &index, const Key &key, uint32 which,
+		RosterAppInfo *info);
 
 private:
 	friend class Iterator;
 
+	struct IndexEntry {
+		RosterAppInfo	*info;
+		int32			count;
+	};
+	struct SignatureKey;
+	struct RefKey;
+
+	typedef HashMap<HashKey32<team_id>, IndexEntry> TeamIndex;
+	typedef HashMap<HashKey32<port_id>, IndexEntry> PortIndex;
+	typedef HashMap<HashKey32<uint32>, IndexEntry> TokenIndex;
+	typedef HashMap<SignatureKey, IndexEntry> SignatureIndex;
+	typedef HashMap<RefKey, IndexEntry> RefIndex;
+
 private:
-	BList	fInfos;
+	BList			fInfos;
+	TeamIndex		fTeamIndex;
+	PortIndex		fPortIndex;
+	TokenIndex		fTokenIndex;
+	SignatureIndex	fSignatureIndex;
+	RefIndex		fRefIndex;
+};
+
+// AppInfoList::SignatureKey
+struct AppInfoList::SignatureKey {
+	SignatureKey() {}
+	SignatureKey(const char *signature)
+		: value(signature)
+	{
+		value.ToLower();
+	}
+
+	uint32 GetHashCode() const
+	{
+		return string_hash(value.String());
+	}
+
+	bool operator==(const SignatureKey &other) const
+	{
+		return value == other.value;
+	}
+
+	bool operator!=(const SignatureKey &other) const
+	{
+		return value != other.value;
+	}
+
+	BString	value;
+};
+
+// AppInfoList::RefKey
+struct AppInfoList::RefKey {
+	RefKey() {}
+	RefKey(const entry_ref &ref)
+		: value(ref)
+	{
+	}
+
+	uint32 GetHashCode() const
+	{
+		uint64 directory = (uint64)value.directory();
+		return (uint32)value.device() ^ (uint32)(directory >> 32)
+			^ (uint32)directory ^ string_hash(value.name);
+	}
+
+	bool operator==(const RefKey &other) const
+	{
+		return value == other.value;
+	}
+
+	bool operator!=(const RefKey &other) const
+	{
+		return value != other.value;
+	}
+
+	entry_ref	value;
 };
 
 // AppInfoList::Iterator
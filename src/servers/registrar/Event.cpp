@@ -46,6 +46,11 @@
 	\brief The "auto delete" flag.
 */
 
+/*!	\var int32 Event::fQueueSlot
+	\brief Index of the EventQueue slot list the event is linked into, or
+		   \c -1, if the event is not in a queue.
+*/
+
 // constructor
 /*!	\brief Creates a new event.
 
@@ -57,7 +62,8 @@
 */
 Event::Event(bool autoDelete)
 	: fTime(0),
-	  fAutoDelete(autoDelete)
+	  fAutoDelete(autoDelete),
+	  fQueueSlot(-1)
 {
 }
 
@@ -69,7 +75,8 @@ Event::Event(bool autoDelete)
 */
 Event::Event(bigtime_t time, bool autoDelete)
 	: fTime(time),
-	  fAutoDelete(autoDelete)
+	  fAutoDelete(autoDelete),
+	  fQueueSlot(-1)
 {
 }
 
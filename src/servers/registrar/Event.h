@@ -30,9 +30,11 @@
 
 #include <OS.h>
 
+#include <util/DoublyLinkedList.h>
+
 class EventQueue;
 
-class Event {
+class Event : public DoublyLinkedListLinkImpl<Event> {
 public:
 	Event(bool autoDelete = true);
 	Event(bigtime_t time, bool autoDelete = true);
@@ -47,8 +49,11 @@ public:
 	virtual	bool Do(EventQueue *queue);
 
  private:
+	friend class EventQueue;
+
 	bigtime_t		fTime;
 	bool			fAutoDelete;
+	int32			fQueueSlot;
 };
 
 #endif	// EVENT_H
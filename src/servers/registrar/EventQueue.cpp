@@ -9,15 +9,24 @@
 
 #include "EventQueue.h"
 
+#include <errno.h>
+#include <poll.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
-#include <String.h>
+#include <algorithm>
 
-#include "Event.h"
+#include <String.h>
 
 
 static const char *kDefaultEventQueueName = "event looper";
 
+// resolution of the timer wheel ticks
+static const bigtime_t kTickResolution = 1000;
+
 
 /*!	\class EventQueue
 	\brief A class providing a mechanism for executing events at specified
@@ -26,35 +35,67 @@ static const char *kDefaultEventQueueName = "event looper";
 	The class' interface is quite small. It basically features methods to
 	add or remove an event or to modify an event's time. It is derived from
 	BLocker to inherit a locking mechanism needed to serialize the access to
-	its member variables (especially the event list).
+	its member variables (especially the event lists).
 
 	The queue runs an own thread (in _EventLooper()), which executes the
 	events at the right times. The execution of an event consists of invoking
 	its Event::Do() method. If the event's Event::IsAutoDelete() or its Do()
 	method return \c true, the event object is deleted after execution. In
-	any case the event is removed from the list before it is executed. The
+	any case the event is removed from the queue before it is executed. The
 	queue is not locked while an event is executed.
 
-	The event list (\a fEvents) is ordered ascendingly by time. The thread
-	uses a semaphore (\a fLooperControl) to wait (time out) for the next
-	event. This semaphore is released to indicate changes to the event list.
+	The events are kept in a hierarchical timer wheel, so that adding and
+	removing an event are O(1) operations. The wheel has \c kWheelLevels
+	levels of \c kWheelSlots slots each. A slot of level 0 covers one tick
+	(\c kTickResolution microseconds), a slot of level \c n covers
+	\c kWheelSlots^n ticks. An event is put into the lowest level that can
+	hold it with respect to the current tick (\a fCurrentTick); events
+	beyond the range of the wheel go to an overflow slot. Whenever the
+	current tick crosses the boundary of a higher level slot, the events of
+	that slot are redistributed ("cascaded") to the lower levels. Events
+	whose time has come are moved to the due slot, which is ordered by time
+	and from which the thread executes them.
+
+	The thread sleeps on a timerfd armed with the time of the next event.
+	If a slack has been set (SetSlack()), that time is rounded up to a
+	multiple of the slack, so that events with nearby times are executed
+	in one go instead of waking up the thread for each of them. An eventfd
+	is used to wake up the thread when an event earlier than the one it is
+	waiting for is added, or when the queue shall die.
+*/
+
+/*!	\var EventQueue::EventList EventQueue::fSlots[kSlotCount]
+	\brief The timer wheel slots, followed by the overflow and the due slot.
+*/
+
+/*!	\var int32 EventQueue::fLevelCounts[kWheelLevels + 1]
+	\brief Number of events per wheel level, the last element counting the
+		   events in the overflow slot.
 */
 
-/*!	\var BList EventQueue::fEvents
-	\brief List of events (Event*) in ascending order (by time).
+/*!	\var int64 EventQueue::fCurrentTick
+	\brief The tick the wheel is at. All events with an earlier tick have
+		   been moved to the due slot. It never gets ahead of the tick of
+		   the current time.
+*/
+
+/*!	\var bigtime_t EventQueue::fSlack
+	\brief The granularity the thread's wake up times are rounded up to.
 */
 
 /*!	\var thread_id EventQueue::fEventLooper
 	\brief Thread ID of the queue's thread.
 */
 
-/*!	\var sem_id EventQueue::fLooperControl
-	\brief Queue thread control semaphore.
+/*!	\var int EventQueue::fTimerFD
+	\brief timerfd the queue's thread waits on for the next event.
+*/
+
+/*!	\var int EventQueue::fWakeFD
+	\brief eventfd used to wake up the queue's thread.
 
-	The semaphore is initialized with count \c 0 and used by the queue's
-	thread for timing out at the time when the next event has to be executed.
-	If the event list is changed by another thread and that changed the time
-	of the next event the semaphore is released (_Reschedule()).
+	It is signalled when an event earlier than the one the thread is waiting
+	for has been added (_Reschedule()) or when the queue dies.
 */
 
 /*!	\var volatile bigtime_t EventQueue::fNextEventTime
@@ -75,25 +116,35 @@ static const char *kDefaultEventQueueName = "event looper";
 
 	The status of the initialization can and should be check with InitCheck().
 
-	\param name The name used for the queue's thread and semaphore. If \c NULL,
-		   a default name is used.
+	\param name The name used for the queue's thread. If \c NULL, a default
+		   name is used.
 */
 EventQueue::EventQueue(const char *name)
 	:
-	fEvents(100),
+	BLocker(name != NULL ? name : kDefaultEventQueueName),
+	fCurrentTick(system_time() / kTickResolution),
+	fSlack(0),
 	fEventLooper(-1),
-	fLooperControl(-1),
+	fTimerFD(-1),
+	fWakeFD(-1),
 	fNextEventTime(0),
 	fStatus(B_ERROR),
 	fTerminating(false)
 {
 	if (!name)
 		name = kDefaultEventQueueName;
-	fLooperControl = create_sem(0, (BString(name) += " control").String());
-	if (fLooperControl >= B_OK)
-		fStatus = B_OK;
+
+	for (int32 i = 0; i <= kWheelLevels; i++)
+		fLevelCounts[i] = 0;
+
+	fTimerFD = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+	if (fTimerFD >= 0)
+		fWakeFD = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (fTimerFD < 0 || fWakeFD < 0)
+		fStatus = errno;
 	else
-		fStatus = fLooperControl;
+		fStatus = B_OK;
+
 	if (fStatus == B_OK) {
 		fEventLooper = spawn_thread(_EventLooperEntry, name,
 			B_DISPLAY_PRIORITY + 1, this);
@@ -114,10 +165,19 @@ EventQueue::EventQueue(const char *name)
 EventQueue::~EventQueue()
 {
 	Die();
-	while (Event *event = (Event*)fEvents.RemoveItem((int32)0)) {
-		if (event->IsAutoDelete())
-			delete event;
+
+	for (int32 i = 0; i < kSlotCount; i++) {
+		while (Event *event = fSlots[i].RemoveHead()) {
+			event->fQueueSlot = -1;
+			if (event->IsAutoDelete())
+				delete event;
+		}
 	}
+
+	if (fTimerFD >= 0)
+		close(fTimerFD);
+	if (fWakeFD >= 0)
+		close(fWakeFD);
 }
 
 
@@ -142,13 +202,44 @@ void
 EventQueue::Die()
 {
 	fTerminating = true;
-	if (delete_sem(fLooperControl) == B_OK) {
+	if (fEventLooper >= 0) {
+		uint64 value = 1;
+		write(fWakeFD, &value, sizeof(value));
+
 		int32 dummy;
 		wait_for_thread(fEventLooper, &dummy);
+		fEventLooper = -1;
 	}
 }
 
 
+/*!	\brief Sets the slack for the execution of the events.
+
+	Events may be executed up to \a slack microseconds late, which allows the
+	queue to execute events with nearby times together.
+
+	\param slack The slack. \c 0 means that events are executed as close to
+		   their time as possible.
+*/
+void
+EventQueue::SetSlack(bigtime_t slack)
+{
+	Lock();
+	fSlack = std::max(slack, (bigtime_t)0);
+	Unlock();
+}
+
+
+/*!	\brief Returns the slack for the execution of the events.
+	\return The slack.
+*/
+bigtime_t
+EventQueue::Slack() const
+{
+	return fSlack;
+}
+
+
 /*!	\brief Adds a new event to the queue.
 
 	The event's time must be set, before adding it. Afterwards ModifyEvent()
@@ -166,7 +257,7 @@ EventQueue::AddEvent(Event *event)
 	Lock();
 	bool result = (event && _AddEvent(event));
 	if (result)
-		_Reschedule();
+		_Reschedule(event->Time());
 	Unlock();
 	return result;
 }
@@ -180,10 +271,8 @@ EventQueue::AddEvent(Event *event)
 bool
 EventQueue::RemoveEvent(Event *event)
 {
-	bool result = false;
 	Lock();
-	if (event && ((result = _RemoveEvent(event))))
-		_Reschedule();
+	bool result = (event && _RemoveEvent(event));
 	Unlock();
 	return result;
 }
@@ -203,32 +292,39 @@ void
 EventQueue::ModifyEvent(Event *event, bigtime_t newTime)
 {
 	Lock();
-	if (fEvents.RemoveItem(event)) {
+	if (_RemoveEvent(event)) {
 		event->SetTime(newTime);
 		_AddEvent(event);
-		_Reschedule();
+		_Reschedule(newTime);
 	}
 	Unlock();
 }
 
 
-/*!	\brief Adds an event to the event list.
+/*!	\brief Adds an event to the timer wheel.
 
 	\note The object must be locked when this method is invoked.
 
 	\param event The event to be added.
 	\return \c true, if the event has been added successfully, \c false, if
-			an error occured.
+			the event is already in a queue.
 */
 bool
 EventQueue::_AddEvent(Event *event)
 {
-	int32 index = _FindInsertionIndex(event->Time());
-	return fEvents.AddItem(event, index);
+	if (event->fQueueSlot >= 0)
+		return false;
+
+	int64 tick = event->Time() / kTickResolution;
+	if (tick < fCurrentTick)
+		_InsertDueEvent(event);
+	else
+		_InsertEvent(event, tick);
+	return true;
 }
 
 
-/*!	\brief Removes an event from the event list.
+/*!	\brief Removes an event from the queue.
 
 	\note The object must be locked when this method is invoked.
 
@@ -239,78 +335,221 @@ EventQueue::_AddEvent(Event *event)
 bool
 EventQueue::_RemoveEvent(Event *event)
 {
-	int32 index = _IndexOfEvent(event);
-	return (index >= 0 && fEvents.RemoveItem(index));
+	int32 slot = event->fQueueSlot;
+	if (slot < 0)
+		return false;
+
+	fSlots[slot].Remove(event);
+	event->fQueueSlot = -1;
+	if (slot != kDueSlot)
+		fLevelCounts[slot / kWheelSlots]--;
+	return true;
 }
 
 
-/*!	\brief Returns an event from the event list.
+/*!	\brief Puts an event into the wheel slot for the given tick.
 
 	\note The object must be locked when this method is invoked.
 
-	\param index The list index of the event to be returned.
-	\return The event, or \c NULL, if the index is out of range.
+	\param event The event to be inserted.
+	\param tick The event's tick, which must not be less than the current
+		   tick.
 */
-Event*
-EventQueue::_EventAt(int32 index) const
+void
+EventQueue::_InsertEvent(Event *event, int64 tick)
 {
-	return (Event*)fEvents.ItemAt(index);
+	int64 delta = tick - fCurrentTick;
+	int32 level = 0;
+	while (level < kWheelLevels
+		&& delta >= ((int64)1 << ((level + 1) * kWheelBits))) {
+		level++;
+	}
+
+	int32 slot = kOverflowSlot;
+	if (level < kWheelLevels) {
+		slot = level * kWheelSlots
+			+ ((tick >> (level * kWheelBits)) & (kWheelSlots - 1));
+	}
+
+	fSlots[slot].Add(event);
+	event->fQueueSlot = slot;
+	fLevelCounts[level]++;
 }
 
 
-/*!	\brief Returns the event list index of the supplied event.
+/*!	\brief Puts an event into the due slot, keeping it ordered by time.
 
 	\note The object must be locked when this method is invoked.
 
-	\param event The event to be found.
-	\return The event list index of the supplied event or \c -1, if the event
-			is not in the event list.
+	\param event The event to be inserted.
 */
-int32
-EventQueue::_IndexOfEvent(Event *event) const
+void
+EventQueue::_InsertDueEvent(Event *event)
+{
+	EventList &due = fSlots[kDueSlot];
+
+	// Events usually become due in order, so we only rarely have to move
+	// some from the tail.
+	EventList later;
+	while (due.Last() != NULL && due.Last()->Time() > event->Time())
+		later.Insert(due.RemoveTail(), false);
+
+	due.Add(event);
+	due.MoveFrom(&later);
+	event->fQueueSlot = kDueSlot;
+}
+
+
+/*!	\brief Redistributes the events of a slot according to the current tick.
+
+	\note The object must be locked when this method is invoked.
+
+	\param slot The index of the slot to be cascaded.
+*/
+void
+EventQueue::_Cascade(int32 slot)
 {
-	bigtime_t time = event->Time();
-	int32 index = _FindInsertionIndex(time);
-	// The found index is the index succeeding the one of the last event with
-	// the same time.
-	// search backwards for the event
-	Event *listEvent = NULL;
-	while (((listEvent = _EventAt(--index))) && listEvent->Time() == time) {
-		if (listEvent == event)
-			return index;
+	EventList events;
+	events.MoveFrom(&fSlots[slot]);
+
+	while (Event *event = events.RemoveHead()) {
+		fLevelCounts[slot / kWheelSlots]--;
+		event->fQueueSlot = -1;
+		_AddEvent(event);
 	}
-	return -1;
 }
 
 
-/*!	\brief Finds the event list index at which an event with the supplied
-		   has to be added.
+/*!	\brief Advances the wheel to the given time.
 
-	The returned index is the greatest possible index, that is if there are
-	events with the same time in the list, the index is the successor of the
-	index of the last of these events.
+	Cascades the higher level slots whose boundaries are crossed and moves
+	all events whose time is not after \a now to the due slot. Stretches of
+	time in which the lower levels are empty are skipped.
 
 	\note The object must be locked when this method is invoked.
 
-	\param time The event time.
-	\return The index at which an event with the supplied time should be added.
+	\param now The current time.
 */
-int32
-EventQueue::_FindInsertionIndex(bigtime_t time) const
+void
+EventQueue::_Advance(bigtime_t now)
+{
+	int64 nowTick = now / kTickResolution;
+
+	while (fCurrentTick <= nowTick) {
+		// cascade the higher levels from the top down, so that the events
+		// end up in the right level
+		for (int32 level = kWheelLevels; level > 0; level--) {
+			int64 mask = ((int64)1 << (level * kWheelBits)) - 1;
+			if ((fCurrentTick & mask) != 0)
+				continue;
+
+			if (level == kWheelLevels)
+				_Cascade(kOverflowSlot);
+			else {
+				_Cascade(level * kWheelSlots
+					+ ((fCurrentTick >> (level * kWheelBits))
+						& (kWheelSlots - 1)));
+			}
+		}
+
+		if (fLevelCounts[0] == 0) {
+			// skip to the next boundary of the lowest non-empty level
+			int32 level = 1;
+			while (level <= kWheelLevels && fLevelCounts[level] == 0)
+				level++;
+
+			int64 next = nowTick;
+			if (level <= kWheelLevels) {
+				int64 mask = ((int64)1 << (level * kWheelBits)) - 1;
+				next = std::min(next, (fCurrentTick | mask) + 1);
+			}
+			if (next == fCurrentTick)
+				break;
+			fCurrentTick = next;
+			continue;
+		}
+
+		EventList &slot = fSlots[fCurrentTick & (kWheelSlots - 1)];
+		Event *event = slot.First();
+		while (event != NULL) {
+			Event *next = slot.GetNext(event);
+			if (event->Time() <= now) {
+				slot.Remove(event);
+				fLevelCounts[0]--;
+				_InsertDueEvent(event);
+			}
+			event = next;
+		}
+
+		// Don't move past the current tick; events added later might still
+		// belong to it.
+		if (!slot.IsEmpty() || fCurrentTick == nowTick)
+			break;
+
+		fCurrentTick++;
+	}
+}
+
+
+/*!	\brief Returns the time of the next event.
+
+	\note The object must be locked when this method is invoked.
+
+	\return The time of the next event, or \c B_INFINITE_TIMEOUT, if the
+			queue is empty.
+*/
+bigtime_t
+EventQueue::_NextEventTime() const
 {
-	// binary search
-	int32 lower = 0;
-	int32 upper = fEvents.CountItems();
-	// invariant: lower-1:time <= time < upper:time (ignoring invalid indices)
-	while (lower < upper) {
-		int32 mid = (lower + upper) / 2;
-		Event* midEvent = _EventAt(mid);
-		if (time < midEvent->Time())
-			upper = mid;		// time < mid:time  =>  time < upper:time
-		else
-			lower = mid + 1;	// mid:time <= time  =>  lower-1:time <= time
+	if (!fSlots[kDueSlot].IsEmpty())
+		return fSlots[kDueSlot].First()->Time();
+
+	bigtime_t nextTime = B_INFINITE_TIMEOUT;
+
+	// In each level the first non-empty slot in cascading order contains the
+	// earliest events of that level.
+	for (int32 level = 0; level < kWheelLevels; level++) {
+		if (fLevelCounts[level] == 0)
+			continue;
+
+		int64 mask = ((int64)1 << (level * kWheelBits)) - 1;
+		int64 index = ((fCurrentTick + mask) & ~mask) >> (level * kWheelBits);
+		for (int32 i = 0; i < kWheelSlots; i++) {
+			const EventList &slot = fSlots[level * kWheelSlots
+				+ ((index + i) & (kWheelSlots - 1))];
+			if (slot.IsEmpty())
+				continue;
+
+			for (Event *event = slot.First(); event != NULL;
+					event = slot.GetNext(event)) {
+				nextTime = std::min(nextTime, event->Time());
+			}
+			break;
+		}
+	}
+
+	if (fLevelCounts[kWheelLevels] > 0) {
+		const EventList &slot = fSlots[kOverflowSlot];
+		for (Event *event = slot.First(); event != NULL;
+				event = slot.GetNext(event)) {
+			nextTime = std::min(nextTime, event->Time());
+		}
 	}
-	return lower;
+
+	return nextTime;
+}
+
+
+/*!	\brief Rounds the supplied time up to a multiple of the slack.
+	\param time The time.
+	\return The rounded time.
+*/
+bigtime_t
+EventQueue::_ApplySlack(bigtime_t time) const
+{
+	if (fSlack <= 1 || time > B_INFINITE_TIMEOUT - fSlack)
+		return time;
+	return (time + fSlack - 1) / fSlack * fSlack;
 }
 
 
@@ -331,57 +570,80 @@ EventQueue::_EventLooperEntry(void *data)
 int32
 EventQueue::_EventLooper()
 {
-	bool running = true;
-	while (running) {
-		bigtime_t waitUntil = B_INFINITE_TIMEOUT;
-		if (Lock()) {
-			if (!fEvents.IsEmpty())
-				waitUntil = _EventAt(0)->Time();
-			fNextEventTime = waitUntil;
+	while (!fTerminating && Lock()) {
+		_Advance(system_time());
+
+		// do the next event that is supposed to go off
+		Event *event = fSlots[kDueSlot].RemoveHead();
+		if (event != NULL) {
+			event->fQueueSlot = -1;
 			Unlock();
+			bool autoDeleteEvent = event->IsAutoDelete();
+			bool deleteEvent = event->Do(this) || autoDeleteEvent;
+			if (deleteEvent)
+				delete event;
+			continue;
 		}
-		status_t err = acquire_sem_etc(fLooperControl, 1, B_ABSOLUTE_TIMEOUT,
-									   waitUntil);
-		switch (err) {
-			case B_TIMED_OUT:
-				// do events, that are supposed to go off
-				while (!fTerminating && Lock() && !fEvents.IsEmpty()
-					   && system_time() >= _EventAt(0)->Time()) {
-					Event *event = (Event*)fEvents.RemoveItem((int32)0);
-					Unlock();
-					bool autoDeleteEvent = event->IsAutoDelete();
-					bool deleteEvent = event->Do(this) || autoDeleteEvent;
-					if (deleteEvent)
-						delete event;
-				}
-				if (IsLocked())
-					Unlock();
-				break;
-			case B_BAD_SEM_ID:
-				running = false;
-				break;
-			case B_OK:
-			default:
-				break;
-		}
+
+		bigtime_t waitUntil = _ApplySlack(_NextEventTime());
+		fNextEventTime = waitUntil;
+		Unlock();
+
+		_Wait(waitUntil);
 	}
 	return 0;
 }
 
 
-/*!	\brief To be called, when an event has been added or removed.
+/*!	\brief Waits until the given time or until the thread is woken up.
+	\param until The absolute time (system_time() base) to wait until. May be
+		   \c B_INFINITE_TIMEOUT.
+*/
+void
+EventQueue::_Wait(bigtime_t until)
+{
+	struct itimerspec timerSpec;
+	memset(&timerSpec, 0, sizeof(timerSpec));
+	if (until != B_INFINITE_TIMEOUT) {
+		until = std::max(until, (bigtime_t)1);
+			// a zero time would disarm the timer
+		timerSpec.it_value.tv_sec = until / 1000000;
+		timerSpec.it_value.tv_nsec = (until % 1000000) * 1000;
+	}
+	timerfd_settime(fTimerFD, TFD_TIMER_ABSTIME, &timerSpec, NULL);
+
+	struct pollfd fds[2];
+	fds[0].fd = fTimerFD;
+	fds[0].events = POLLIN;
+	fds[1].fd = fWakeFD;
+	fds[1].events = POLLIN;
+
+	if (poll(fds, 2, -1) <= 0)
+		return;
+
+	uint64 value;
+	if ((fds[0].revents & POLLIN) != 0)
+		read(fTimerFD, &value, sizeof(value));
+	if ((fds[1].revents & POLLIN) != 0)
+		read(fWakeFD, &value, sizeof(value));
+}
+
+
+/*!	\brief To be called, when an event has been added.
 
 	Checks whether the queue's thread has to recalculate the time when it
 	needs to wake up to execute the next event, and signals the thread to
 	do so, if necessary.
 
 	\note The object must be locked when this method is invoked.
+
+	\param time The time of the added event.
 */
 void
-EventQueue::_Reschedule()
+EventQueue::_Reschedule(bigtime_t time)
 {
-	if (fStatus == B_OK) {
-		if (!fEvents.IsEmpty() && _EventAt(0)->Time() < fNextEventTime)
-			release_sem(fLooperControl);
+	if (fStatus == B_OK && _ApplySlack(time) < fNextEventTime) {
+		uint64 value = 1;
+		write(fWakeFD, &value, sizeof(value));
 	}
 }
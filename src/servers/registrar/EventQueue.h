@@ -29,11 +29,10 @@
 #ifndef EVENT_QUEUE_H
 #define EVENT_QUEUE_H
 
-#include <List.h>
 #include <Locker.h>
 #include <OS.h>
 
-class Event;
+#include "Event.h"
 
 class EventQueue : public BLocker {
 public:
@@ -44,24 +43,46 @@ public:
 
 	void Die();
 
+	void SetSlack(bigtime_t slack);
+	bigtime_t Slack() const;
+
 	bool AddEvent(Event *event);
 	bool RemoveEvent(Event *event);
 	void ModifyEvent(Event *event, bigtime_t newTime);
 
  private:
+	typedef DoublyLinkedList<Event> EventList;
+
+	enum {
+		kWheelBits		= 6,
+		kWheelSlots		= 1 << kWheelBits,
+		kWheelLevels	= 4,
+		kOverflowSlot	= kWheelLevels * kWheelSlots,
+		kDueSlot		= kOverflowSlot + 1,
+		kSlotCount		= kDueSlot + 1
+	};
+
 	bool _AddEvent(Event *event);
 	bool _RemoveEvent(Event *event);
-	Event *_EventAt(int32 index) const;
-	int32 _IndexOfEvent(Event *event) const;
-	int32 _FindInsertionIndex(bigtime_t time) const;
+	void _InsertEvent(Event *event, int64 tick);
+	void _InsertDueEvent(Event *event);
+	void _Cascade(int32 slot);
+	void _Advance(bigtime_t now);
+	bigtime_t _NextEventTime() const;
+	bigtime_t _ApplySlack(bigtime_t time) const;
 
 	static	int32 _EventLooperEntry(void *data);
 	int32 _EventLooper();
-	void _Reschedule();
+	void _Wait(bigtime_t until);
+	void _Reschedule(bigtime_t time);
 
-	BList				fEvents;
+	EventList			fSlots[kSlotCount];
+	int32				fLevelCounts[kWheelLevels + 1];
+	int64				fCurrentTick;
+	bigtime_t			fSlack;
 	thread_id			fEventLooper;
-	sem_id				fLooperControl;
+	int					fTimerFD;
+	int					fWakeFD;
 	volatile bigtime_t	fNextEventTime;
 	status_t			fStatus;
 	volatile bool		fTerminating;
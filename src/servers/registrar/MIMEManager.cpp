@@ -11,6 +11,9 @@
 #include "MIMEManager.h"
 
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
 #include <string>
 
 #include <Bitmap.h>
@@ -23,16 +26,20 @@
 
 #include <mime/AppMetaMimeCreator.h>
 #include <mime/database_support.h>
+#include <mime/DatabaseSnapshot.h>
 #include <mime/MimeSnifferAddonManager.h>
 #include <mime/TextSnifferAddon.h>
 
 #include "CreateAppMetaMimeThread.h"
+#include "EventQueue.h"
 #include "MessageDeliverer.h"
+#include "MessageEvent.h"
 #include "UpdateMimeInfoThread.h"
 
 
 using namespace std;
 using namespace BPrivate;
+using BPrivate::Storage::Mime::DatabaseSnapshot;
 using BPrivate::Storage::Mime::MimeSnifferAddonManager;
 using BPrivate::Storage::Mime::TextSnifferAddon;
 
@@ -44,6 +51,17 @@ using BPrivate::Storage::Mime::TextSnifferAddon;
 */
 
 
+static const uint32 kMsgWriteSnapshot = 'mWsn';
+
+// Changes tend to come in bursts (installing a package, updating the MIME
+// info of a directory tree), so the snapshot is only rewritten once the
+// database has been quiet for a while -- but a steady stream of changes
+// must not keep it from being written forever.
+static const bigtime_t kSnapshotDelay = 1000000LL;
+static const bigtime_t kMaxSnapshotDelay = 10000000LL;
+static const bigtime_t kInitialSnapshotDelay = 5000000LL;
+
+
 static MimeSnifferAddonManager*
 init_mime_sniffer_add_on_manager()
 {
@@ -57,6 +75,14 @@ init_mime_sniffer_add_on_manager()
 }
 
 
+static BString
+snapshot_path()
+{
+	return DatabaseSnapshot::DefaultPath(
+		BPrivate::Storage::Mime::default_database_location());
+}
+
+
 class MIMEManager::DatabaseLocker
 	: public BPrivate::Storage::Mime::MimeEntryProcessor::DatabaseLocker {
 public:
@@ -83,22 +109,37 @@ private:
 
 /*!	\brief Creates and initializes a MIMEManager.
 */
-MIMEManager::MIMEManager()
+MIMEManager::MIMEManager(EventQueue* eventQueue)
 	:
 	BLooper("main_mime"),
 	fDatabase(BPrivate::Storage::Mime::default_database_location(),
 		init_mime_sniffer_add_on_manager(), this),
 	fDatabaseLocker(new(std::nothrow) DatabaseLocker(this)),
-	fThreadManager()
+	fThreadManager(),
+	fEventQueue(eventQueue),
+	fSnapshotEvent(NULL),
+	fSnapshotPending(false),
+	fSnapshotDeadline(0)
 {
 	AddHandler(&fThreadManager);
+
+	// The database may have been modified while we were not running, so
+	// don't trust a snapshot left over from a previous session.
+	unlink(snapshot_path().String());
+	_ScheduleSnapshot(kInitialSnapshotDelay);
 }
 
 
 /*!	\brief Frees all resources associate with this object.
+
+	The event queue passed to the constructor must still be alive.
 */
 MIMEManager::~MIMEManager()
 {
+	if (fSnapshotEvent != NULL) {
+		fEventQueue->RemoveEvent(fSnapshotEvent);
+		delete fSnapshotEvent;
+	}
 }
 
 
@@ -326,6 +367,10 @@ MIMEManager::MessageReceived(BMessage *message)
 			break;
 		}
 
+		case kMsgWriteSnapshot:
+			_WriteSnapshot();
+			break;
+
 		default:
 			printf("MIMEMan: msg->what == %" B_PRIx32 " (%.4s)\n",
 				message->what, (char*)&(message->what));
@@ -338,7 +383,33 @@ MIMEManager::MessageReceived(BMessage *message)
 status_t
 MIMEManager::Notify(BMessage* message, const BMessenger& target)
 {
-	return MessageDeliverer::Default()->DeliverMessage(message, target);
+	return MessageDeliverer::Default()->DeliverMessage(message, target,
+		B_INFINITE_TIMEOUT, MESSAGE_DELIVERY_PRIORITY_LOW);
+}
+
+
+/*!	\brief Removes the database snapshot and schedules writing a new one.
+
+	Called with the looper locked whenever the database has been modified.
+	The snapshot is removed right away, so that clients fall back to asking
+	us until the new one has been written.
+*/
+void
+MIMEManager::DatabaseChanged()
+{
+	unlink(snapshot_path().String());
+
+	if (!fSnapshotPending) {
+		fSnapshotDeadline = system_time() + kMaxSnapshotDelay;
+		_ScheduleSnapshot(kSnapshotDelay);
+		return;
+	}
+
+	// restart the timer, unless that would postpone it past the deadline
+	bigtime_t time = std::min(system_time() + kSnapshotDelay,
+		fSnapshotDeadline);
+	if (time > fSnapshotEvent->Time())
+		fEventQueue->ModifyEvent(fSnapshotEvent, time);
 }
 
 
@@ -572,3 +643,33 @@ MIMEManager::HandleDeleteParam(BMessage *message)
 	message->SendReply(&reply, this);
 }
 
+
+void
+MIMEManager::_ScheduleSnapshot(bigtime_t delay)
+{
+	if (fEventQueue == NULL)
+		return;
+
+	if (fSnapshotEvent == NULL) {
+		fSnapshotEvent = new(nothrow) MessageEvent(0, this, kMsgWriteSnapshot);
+		if (fSnapshotEvent == NULL)
+			return;
+		fSnapshotEvent->SetAutoDelete(false);
+	}
+
+	fSnapshotEvent->SetTime(system_time() + delay);
+	fSnapshotPending = fEventQueue->AddEvent(fSnapshotEvent);
+}
+
+
+void
+MIMEManager::_WriteSnapshot()
+{
+	fSnapshotPending = false;
+
+	status_t error = fDatabase.WriteSnapshot(snapshot_path().String());
+	if (error != B_OK) {
+		fprintf(stderr, "MIMEManager: failed to write the database snapshot: "
+			"%s\n", strerror(error));
+	}
+}
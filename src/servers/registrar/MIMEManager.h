@@ -10,10 +10,13 @@
 #include "RegistrarThreadManager.h"
 
 
+class EventQueue;
+class MessageEvent;
+
 class MIMEManager : public BLooper,
 	private BPrivate::Storage::Mime::Database::NotificationListener {
 public:
-	MIMEManager();
+	MIMEManager(EventQueue* eventQueue);
 	virtual ~MIMEManager();
 
 	virtual void MessageReceived(BMessage *message);
@@ -21,6 +24,7 @@ public:
 private:
 	// Database::NotificationListener
 	virtual status_t Notify(BMessage* message, const BMessenger& target);
+	virtual void DatabaseChanged();
 
 private:
 	class DatabaseLocker;
@@ -29,11 +33,18 @@ private:
 	void HandleSetParam(BMessage *message);
 	void HandleDeleteParam(BMessage *message);
 
+	void _ScheduleSnapshot(bigtime_t delay);
+	void _WriteSnapshot();
+
 private:
 	BPrivate::Storage::Mime::Database fDatabase;
 	DatabaseLocker* fDatabaseLocker;
 	RegistrarThreadManager fThreadManager;
 	BMessenger fManagerMessenger;
+	EventQueue* fEventQueue;
+	MessageEvent* fSnapshotEvent;
+	bool fSnapshotPending;
+	bigtime_t fSnapshotDeadline;
 };
 
 #endif	// MIME_MANAGER_H
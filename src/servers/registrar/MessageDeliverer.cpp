@@ -9,7 +9,6 @@
 #include <string.h>
 
 #include <AutoDeleter.h>
-#include <Autolock.h>
 #include <MessagePrivate.h>
 #include <MessengerPrivate.h>
 #include <OS.h>
@@ -32,6 +31,9 @@ MessageDeliverer *MessageDeliverer::sDeliverer = NULL;
 
 static const bigtime_t	kRetryDelay			= 100000;			// 100 ms
 
+// messages waiting longer than this are reported as starving
+static const bigtime_t	kStarvationDelay	= 5000000;			// 5 s
+
 // per port sanity limits
 static const int32		kMaxMessagesPerPort	= 10000;
 static const int32		kMaxDataPerPort		= 50 * 1024 * 1024;	// 50 MB
@@ -223,20 +225,26 @@ private:
 
 /*!	\brief Encapsulates a Message to be sent to a specific handler.
 
-	A TargetMessage is always associated with (i.e. queued in) a TargetPort.
-	While a Message stores only the message data and some timing info, this
-	object adds the token of a the target BHandler.
+	A TargetMessage is first pushed onto the deliverer's stack of incoming
+	messages and then queued in the TargetPort for its port. While a Message
+	stores only the message data and some timing info, this object adds the
+	target port, the token of a the target BHandler and the delivery
+	priority.
 
 	A Message can be referred to by more than one TargetMessage (when
 	broadcasting), but a TargetMessage is referred to exactly once, by
-	the TargetPort.
+	the incoming stack or the TargetPort.
 */
 class MessageDeliverer::TargetMessage
 	: public DoublyLinkedListLinkImpl<MessageDeliverer::TargetMessage> {
 public:
-	TargetMessage(Message *message, int32 token)
+	TargetMessage(Message *message, port_id port, int32 token,
+			int32 priority)
 		: fMessage(message),
-		  fToken(token)
+		  fPort(port),
+		  fToken(token),
+		  fPriority(priority),
+		  fNextIncoming(NULL)
 	{
 		if (fMessage)
 			fMessage->AcquireReference();
@@ -253,14 +261,37 @@ public:
 		return fMessage;
 	}
 
+	port_id Port() const
+	{
+		return fPort;
+	}
+
 	int32 Token() const
 	{
 		return fToken;
 	}
 
+	int32 Priority() const
+	{
+		return fPriority;
+	}
+
+	TargetMessage *NextIncoming() const
+	{
+		return fNextIncoming;
+	}
+
+	void SetNextIncoming(TargetMessage *message)
+	{
+		fNextIncoming = message;
+	}
+
 private:
 	Message				*fMessage;
+	port_id				fPort;
 	int32				fToken;
+	int32				fPriority;
+	TargetMessage		*fNextIncoming;
 };
 
 
@@ -324,16 +355,18 @@ private:
 /*!	\brief Represents a full target port, queuing the not yet delivered
 		   messages.
 
-	A TargetPort internally queues TargetMessages in the order the are to be
-	delivered. Furthermore the object maintains an ordered set of
-	TargetMessages that can timeout (in ascending order of timeout time), so
-	that timed out messages can be dropped easily.
+	A TargetPort internally queues TargetMessages in one FIFO per delivery
+	priority; messages are delivered from the highest priority non-empty
+	queue first, so pushing and popping take constant time. Furthermore the
+	object maintains an ordered set of TargetMessages that can timeout (in
+	ascending order of timeout time), so that timed out messages can be
+	dropped easily.
 */
 class MessageDeliverer::TargetPort {
 public:
-	TargetPort(port_id portID)
-		: fPortID(portID),
-		  fMessages(),
+	TargetPort(MessageDeliverer &deliverer, port_id portID)
+		: fDeliverer(deliverer),
+		  fPortID(portID),
 		  fMessageCount(0),
 		  fMessageSize(0)
 	{
@@ -341,8 +374,8 @@ public:
 
 	~TargetPort()
 	{
-		while (!fMessages.IsEmpty())
-			PopMessage();
+		while (TargetMessage *message = _Head())
+			_RemoveMessage(message, false);
 	}
 
 	port_id PortID() const
@@ -350,45 +383,38 @@ public:
 		return fPortID;
 	}
 
-	status_t PushMessage(Message *message, int32 token)
+	void PushMessage(TargetMessage *targetMessage)
 	{
 PRINT("MessageDeliverer::TargetPort::PushMessage(port: %" B_PRId32 ", %p, %"
-B_PRId32 ")\n", fPortID, message, token);
-		// create a target message
-		TargetMessage *targetMessage
-			= new(nothrow) TargetMessage(message, token);
-		if (!targetMessage)
-			return B_NO_MEMORY;
-
+B_PRId32 ")\n", fPortID, targetMessage->GetMessage(), targetMessage->Token());
 		// push it
-		fMessages.Insert(targetMessage);
+		fMessages[targetMessage->Priority()].Insert(targetMessage);
 		fMessageCount++;
 		fMessageSize += targetMessage->GetMessage()->DataSize();
 
 		// add it to the timeoutable messages, if it has a timeout
-		if (message->HasTimeout())
+		if (targetMessage->GetMessage()->HasTimeout())
 			fTimeoutableMessages.insert(targetMessage);
 
 		_EnforceLimits();
-
-		return B_OK;
 	}
 
 	Message *PeekMessage(int32 &token) const
 	{
-		if (!fMessages.Head())
+		TargetMessage *head = _Head();
+		if (!head)
 			return NULL;
 
-		token = fMessages.Head()->Token();
-		return fMessages.Head()->GetMessage();
+		token = head->Token();
+		return head->GetMessage();
 	}
 
 	void PopMessage()
 	{
-		if (fMessages.Head()) {
+		if (TargetMessage *head = _Head()) {
 PRINT("MessageDeliverer::TargetPort::PopMessage(): port: %" B_PRId32 ", %p\n",
-fPortID, fMessages.Head()->GetMessage());
-			_RemoveMessage(fMessages.Head());
+fPortID, head->GetMessage());
+			_RemoveMessage(head, true);
 		}
 	}
 
@@ -403,49 +429,70 @@ fPortID, fMessages.Head()->GetMessage());
 
 PRINT("MessageDeliverer::TargetPort::DropTimedOutMessages(): port: %" B_PRId32
 ": message %p timed out\n", fPortID, message->GetMessage());
-			_RemoveMessage(message);
+			_RemoveMessage(message, false);
 		}
 	}
 
 	bool IsEmpty() const
 	{
-		return fMessages.IsEmpty();
+		return fMessageCount == 0;
 	}
 
 private:
-	void _RemoveMessage(TargetMessage *message)
+	TargetMessage *_Head() const
+	{
+		for (int32 i = MESSAGE_DELIVERY_PRIORITY_COUNT - 1; i >= 0; i--) {
+			if (TargetMessage *message = fMessages[i].Head())
+				return message;
+		}
+		return NULL;
+	}
+
+	void _RemoveMessage(TargetMessage *message, bool delivered)
 	{
-		fMessages.Remove(message);
+		fMessages[message->Priority()].Remove(message);
 		fMessageCount--;
 		fMessageSize -= message->GetMessage()->DataSize();
 
 		if (message->GetMessage()->HasTimeout())
 			fTimeoutableMessages.erase(message);
 
+		fDeliverer._MessageDone(message, delivered);
 		delete message;
 	}
 
+	void _DropLowestPriorityMessage()
+	{
+		for (int32 i = 0; i < MESSAGE_DELIVERY_PRIORITY_COUNT; i++) {
+			if (TargetMessage *message = fMessages[i].Head()) {
+				_RemoveMessage(message, false);
+				return;
+			}
+		}
+	}
+
 	void _EnforceLimits()
 	{
 		// message count
 		while (fMessageCount > kMaxMessagesPerPort) {
 PRINT("MessageDeliverer::TargetPort::_EnforceLimits(): port: %" B_PRId32
 ": hit maximum message count limit.\n", fPortID);
-			PopMessage();
+			_DropLowestPriorityMessage();
 		}
 
 		// message size
 		while (fMessageSize > kMaxDataPerPort) {
 PRINT("MessageDeliverer::TargetPort::_EnforceLimits(): port: %" B_PRId32
 ": hit maximum message size limit.\n", fPortID);
-			PopMessage();
+			_DropLowestPriorityMessage();
 		}
 	}
 
 	typedef DoublyLinkedList<TargetMessage>	MessageList;
 
+	MessageDeliverer			&fDeliverer;
 	port_id						fPortID;
-	MessageList					fMessages;
+	MessageList					fMessages[MESSAGE_DELIVERY_PRIORITY_COUNT];
 	int32						fMessageCount;
 	int32						fMessageSize;
 	set<TargetMessageHandle>	fTimeoutableMessages;
@@ -467,19 +514,35 @@ struct MessageDeliverer::TargetPortMap : public map<port_id, TargetPort*> {
 	will be of interest. Some of them allow broadcasting a message to several
 	recepients.
 
-	The class maintains a TargetPort for each target port which was full at the
+	As long as no messages are queued, DeliverMessage() sends the message
+	right away. Otherwise, or if the target port is full, it pushes the
+	message onto a lock-free stack of incoming messages and wakes up the
+	deliverer thread, so that any number of threads can deliver messages
+	without waiting for each other or for the deliverer thread.
+
+	The deliverer thread is the only one touching the TargetPorts. It moves
+	the incoming messages (in the order they were pushed) to the TargetPort
+	for their port -- there is one for each target port which was full at the
 	time a message was to be delivered to it. A TargetPort has a queue of
-	undelivered messages. A separate worker thread retries periodically to send
-	the yet undelivered messages to the respective target ports.
+	undelivered messages per delivery priority. The thread retries
+	periodically to send the yet undelivered messages to the respective target
+	ports, those of higher priority first.
+
+	For each priority the deliverer counts the delivered and dropped messages
+	and how long they waited. When a message waited longer than ever before
+	and longer than kStarvationDelay, the statistics are reported.
 */
 
 
 MessageDeliverer::MessageDeliverer()
-	: fLock("message deliverer"),
-	  fTargetPorts(NULL),
+	: fTargetPorts(NULL),
+	  fIncomingMessages(NULL),
+	  fQueuedMessages(0),
+	  fWakeUpSemaphore(-1),
 	  fDelivererThread(-1),
 	  fTerminating(false)
 {
+	memset(fStatistics, 0, sizeof(fStatistics));
 }
 
 
@@ -488,11 +551,24 @@ MessageDeliverer::~MessageDeliverer()
 	fTerminating = true;
 
 	if (fDelivererThread >= 0) {
+		release_sem(fWakeUpSemaphore);
+
 		int32 result;
 		wait_for_thread(fDelivererThread, &result);
 	}
 
-	delete fTargetPorts;
+	if (fWakeUpSemaphore >= 0)
+		delete_sem(fWakeUpSemaphore);
+
+	if (fTargetPorts != NULL) {
+		// drop the messages that haven't been delivered yet
+		_CollectIncomingMessages();
+		for (TargetPortMap::iterator it = fTargetPorts->begin();
+			 it != fTargetPorts->end(); ++it) {
+			delete it->second;
+		}
+		delete fTargetPorts;
+	}
 }
 
 
@@ -504,6 +580,10 @@ MessageDeliverer::Init()
 	if (!fTargetPorts)
 		return B_NO_MEMORY;
 
+	fWakeUpSemaphore = create_sem(0, "message deliverer wake up");
+	if (fWakeUpSemaphore < 0)
+		return fWakeUpSemaphore;
+
 	// spawn the deliverer thread
 	fDelivererThread = spawn_thread(MessageDeliverer::_DelivererThreadEntry,
 		"message deliverer", B_NORMAL_PRIORITY + 1, this);
@@ -567,6 +647,9 @@ MessageDeliverer::Default()
 	\param target A BMessenger identifying the delivery target.
 	\param timeout If given, the message will be dropped, when it couldn't be
 		   delivered after this amount of microseconds.
+	\param priority One of the \c MESSAGE_DELIVERY_PRIORITY_* constants. If
+		   the message has to be queued, it is delivered before queued
+		   messages of lower priority.
 	\return
 	- \c B_OK, if sending the message succeeded or if the target port was
 	  full and the message has been queued,
@@ -574,10 +657,10 @@ MessageDeliverer::Default()
 */
 status_t
 MessageDeliverer::DeliverMessage(BMessage *message, BMessenger target,
-	bigtime_t timeout)
+	bigtime_t timeout, int32 priority)
 {
 	SingleMessagingTargetSet set(target);
-	return DeliverMessage(message, set, timeout);
+	return DeliverMessage(message, set, timeout, priority);
 }
 
 
@@ -591,6 +674,9 @@ MessageDeliverer::DeliverMessage(BMessage *message, BMessenger target,
 	\param targets MessagingTargetSet providing the the delivery targets.
 	\param timeout If given, the message will be dropped, when it couldn't be
 		   delivered after this amount of microseconds.
+	\param priority One of the \c MESSAGE_DELIVERY_PRIORITY_* constants. If
+		   the message has to be queued, it is delivered before queued
+		   messages of lower priority.
 	\return
 	- \c B_OK, if for each of the given targets sending the message succeeded
 	  or if the target port was full and the message has been queued,
@@ -598,7 +684,7 @@ MessageDeliverer::DeliverMessage(BMessage *message, BMessenger target,
 */
 status_t
 MessageDeliverer::DeliverMessage(BMessage *message, MessagingTargetSet &targets,
-	bigtime_t timeout)
+	bigtime_t timeout, int32 priority)
 {
 	if (message == NULL)
 		return B_BAD_VALUE;
@@ -612,7 +698,7 @@ MessageDeliverer::DeliverMessage(BMessage *message, MessagingTargetSet &targets,
 	if (error < B_OK)
 		return error;
 
-	return DeliverMessage(buffer, size, targets, timeout);
+	return DeliverMessage(buffer, size, targets, timeout, priority);
 }
 
 
@@ -628,6 +714,9 @@ MessageDeliverer::DeliverMessage(BMessage *message, MessagingTargetSet &targets,
 	\param targets MessagingTargetSet providing the the delivery targets.
 	\param timeout If given, the message will be dropped, when it couldn't be
 		   delivered after this amount of microseconds.
+	\param priority One of the \c MESSAGE_DELIVERY_PRIORITY_* constants. If
+		   the message has to be queued, it is delivered before queued
+		   messages of lower priority.
 	\return
 	- \c B_OK, if for each of the given targets sending the message succeeded
 	  or if the target port was full and the message has been queued,
@@ -635,42 +724,42 @@ MessageDeliverer::DeliverMessage(BMessage *message, MessagingTargetSet &targets,
 */
 status_t
 MessageDeliverer::DeliverMessage(const void *messageData, int32 messageSize,
-	MessagingTargetSet &targets, bigtime_t timeout)
+	MessagingTargetSet &targets, bigtime_t timeout, int32 priority)
 {
-	if (!messageData || messageSize <= 0)
+	if (!messageData || messageSize <= 0 || priority < 0
+		|| priority >= MESSAGE_DELIVERY_PRIORITY_COUNT) {
 		return B_BAD_VALUE;
+	}
 
 	BReference<Message> messageRef;
 
-	// add the message to the respective target ports
-	BAutolock locker(fLock);
 	for (int32 targetIndex = 0; targets.HasNext(); targetIndex++) {
 		port_id portID;
 		int32 token;
 		targets.Next(portID, token);
-
-		// get the target port
-		TargetPort *port = _GetTargetPort(portID, true);
-		if (!port)
-			return B_NO_MEMORY;
+		bool singleTarget = (targetIndex == 0 && !targets.HasNext());
 
 		// try sending the message, if there are no queued messages yet
-		if (port->IsEmpty()) {
-			status_t error = BMessage::Private::SendFlattenedMessage((void*)messageData,
-				messageSize, portID, token, 0);
+		if (fQueuedMessages.load(std::memory_order_acquire) == 0) {
+			status_t error = BMessage::Private::SendFlattenedMessage(
+				(void*)messageData, messageSize, portID, token, 0);
 			// if the message was delivered OK, we're done with the target
-			if (error == B_OK) {
-				_PutTargetPort(port);
+			if (error == B_OK)
 				continue;
-			}
 
 			// if the port is not full, but an error occurred, we skip this target
 			if (error != B_WOULD_BLOCK) {
-				_PutTargetPort(port);
-				if (targetIndex == 0 && !targets.HasNext())
+				if (singleTarget)
 					return error;
 				continue;
 			}
+		} else if (singleTarget) {
+			// The message is queued without trying to send it, so at least
+			// report, if the target is gone.
+			port_info info;
+			status_t error = get_port_info(portID, &info);
+			if (error != B_OK)
+				return error;
 		}
 
 		if (!messageRef.IsSet()) {
@@ -689,17 +778,115 @@ MessageDeliverer::DeliverMessage(const void *messageData, int32 messageSize,
 			messageRef.SetTo(message, true);
 		}
 
-		// add the message
-		status_t error = port->PushMessage(messageRef, token);
-		_PutTargetPort(port);
-		if (error != B_OK)
-			return error;
+		// queue the message
+		TargetMessage *targetMessage = new(nothrow) TargetMessage(messageRef,
+			portID, token, priority);
+		if (!targetMessage)
+			return B_NO_MEMORY;
+
+		_PushIncomingMessage(targetMessage);
 	}
 
 	return B_OK;
 }
 
 
+/*!	\brief Pushes a message onto the stack of incoming messages.
+
+	Can be called by any thread without locking. Wakes up the deliverer
+	thread, if the stack was empty.
+*/
+void
+MessageDeliverer::_PushIncomingMessage(TargetMessage *message)
+{
+	// Count the message before publishing it, so that no one sends a message
+	// directly, before this one has been delivered.
+	fQueuedMessages.fetch_add(1, std::memory_order_release);
+
+	TargetMessage *head = fIncomingMessages.load(std::memory_order_relaxed);
+	do {
+		message->SetNextIncoming(head);
+	} while (!fIncomingMessages.compare_exchange_weak(head, message,
+		std::memory_order_release, std::memory_order_relaxed));
+
+	if (head == NULL)
+		release_sem(fWakeUpSemaphore);
+}
+
+
+/*!	\brief Moves the incoming messages to their TargetPorts, and tries to send
+		   them to ports that had no messages queued.
+
+	Must only be called by the deliverer thread (or when it is gone).
+*/
+void
+MessageDeliverer::_CollectIncomingMessages()
+{
+	TargetMessage *message = fIncomingMessages.exchange(NULL,
+		std::memory_order_acquire);
+
+	// the stack is in reverse push order
+	TargetMessage *pushOrder = NULL;
+	while (message != NULL) {
+		TargetMessage *next = message->NextIncoming();
+		message->SetNextIncoming(pushOrder);
+		pushOrder = message;
+		message = next;
+	}
+
+	while (pushOrder != NULL) {
+		message = pushOrder;
+		pushOrder = message->NextIncoming();
+		message->SetNextIncoming(NULL);
+
+		TargetPort *port = _GetTargetPort(message->Port(), true);
+		if (!port) {
+			_MessageDone(message, false);
+			delete message;
+			continue;
+		}
+
+		bool wasEmpty = port->IsEmpty();
+		port->PushMessage(message);
+
+		// If messages were already queued, the port was full a moment ago,
+		// and will be retried anyway.
+		if (wasEmpty && !fTerminating && !_SendMessages(port))
+			_RemoveTargetPort(port);
+	}
+}
+
+
+/*!	\brief Accounts for a message that has been delivered or dropped.
+*/
+void
+MessageDeliverer::_MessageDone(TargetMessage *message, bool delivered)
+{
+	fQueuedMessages.fetch_sub(1, std::memory_order_release);
+
+	delivery_statistics &statistics = fStatistics[message->Priority()];
+	if (!delivered) {
+		statistics.dropped++;
+		return;
+	}
+
+	bigtime_t wait = system_time() - message->GetMessage()->CreationTime();
+	statistics.delivered++;
+	statistics.total_wait += wait;
+	if (wait > statistics.max_wait) {
+		statistics.max_wait = wait;
+		if (wait >= kStarvationDelay) {
+			WARNING("MessageDeliverer: priority %" B_PRId32 " message waited "
+				"%" B_PRIdBIGTIME " ms (delivered: %" B_PRId64 ", dropped: %"
+				B_PRId64 ", average wait: %" B_PRIdBIGTIME " ms)\n",
+				message->Priority(), wait / 1000, statistics.delivered,
+				statistics.dropped,
+				statistics.total_wait / statistics.delivered / 1000);
+		}
+	}
+}
+
+
 MessageDeliverer::TargetPort *
 MessageDeliverer::_GetTargetPort(port_id portID, bool create)
 {
@@ -712,7 +899,7 @@ MessageDeliverer::_GetTargetPort(port_id portID, bool create)
 		return NULL;
 
 	// create a port
-	TargetPort *port = new(nothrow) TargetPort(portID);
+	TargetPort *port = new(nothrow) TargetPort(*this, portID);
 	if (!port)
 		return NULL;
 	(*fTargetPorts)[portID] = port;
@@ -722,15 +909,37 @@ MessageDeliverer::_GetTargetPort(port_id portID, bool create)
 
 
 void
-MessageDeliverer::_PutTargetPort(TargetPort *port)
+MessageDeliverer::_RemoveTargetPort(TargetPort *port)
 {
-	if (!port)
-		return;
+	fTargetPorts->erase(port->PortID());
+	delete port;
+}
+
 
-	if (port->IsEmpty()) {
-		fTargetPorts->erase(port->PortID());
-		delete port;
+/*!	\brief Sends the messages queued for the port, until it is full.
+	\return \c false, if the port has no messages left, or if an error
+			occurred (the port is probably gone), \c true otherwise.
+*/
+bool
+MessageDeliverer::_SendMessages(TargetPort *port)
+{
+	port->DropTimedOutMessages();
+
+	int32 token;
+	while (Message *message = port->PeekMessage(token)) {
+		status_t error = _SendMessage(message, port->PortID(), token);
+		if (error == B_OK) {
+			port->PopMessage();
+		} else if (error == B_WOULD_BLOCK) {
+			// no luck yet -- port is still full
+			return true;
+		} else {
+			// unexpected error -- probably the port is gone
+			return false;
+		}
 	}
+
+	return false;
 }
 
 
@@ -755,46 +964,35 @@ MessageDeliverer::_DelivererThreadEntry(void *data)
 int32
 MessageDeliverer::_DelivererThread()
 {
+	bigtime_t nextRetry = 0;
+
 	while (!fTerminating) {
-		snooze(kRetryDelay);
+		// wait for incoming messages, or until the full ports are to be
+		// retried
+		bigtime_t timeout = B_INFINITE_TIMEOUT;
+		if (!fTargetPorts->empty())
+			timeout = max_c(nextRetry - system_time(), 0);
+		acquire_sem_etc(fWakeUpSemaphore, 1, B_RELATIVE_TIMEOUT, timeout);
 		if (fTerminating)
 			break;
 
+		bool hadFullPorts = !fTargetPorts->empty();
+		_CollectIncomingMessages();
+
+		// ports that just became full have just been tried
+		if (!hadFullPorts)
+			nextRetry = system_time() + kRetryDelay;
+		if (system_time() < nextRetry)
+			continue;
+		nextRetry = system_time() + kRetryDelay;
+
 		// iterate through all target ports and try sending the messages
-		BAutolock _(fLock);
 		for (TargetPortMap::iterator it = fTargetPorts->begin();
 			 it != fTargetPorts->end();) {
 			TargetPort *port = it->second;
-			bool portError = false;
-
-			port->DropTimedOutMessages();
-
-			// try sending all messages
-			int32 token;
-			while (Message *message = port->PeekMessage(token)) {
-				status_t error = B_OK;
-//				if (message->TimeoutTime() > system_time()) {
-					error = _SendMessage(message, port->PortID(), token);
-//				} else {
-//					// timeout, drop message
-//					PRINT("MessageDeliverer::_DelivererThread(): port %ld, "
-//						"message %p timed out\n", port->PortID(), message);
-//				}
-
-				if (error == B_OK) {
-					port->PopMessage();
-				} else if (error == B_WOULD_BLOCK) {
-					// no luck yet -- port is still full
-					break;
-				} else {
-					// unexpected error -- probably the port is gone
-					portError = true;
-					break;
-				}
-			}
 
 			// next port
-			if (portError || port->IsEmpty()) {
+			if (!_SendMessages(port)) {
 				TargetPortMap::iterator oldIt = it;
 				++it;
 				delete port;
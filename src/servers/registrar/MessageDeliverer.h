@@ -6,11 +6,21 @@
 #ifndef MESSAGE_DELIVERER_H
 #define MESSAGE_DELIVERER_H
 
-#include <Locker.h>
+#include <atomic>
+
 #include <Messenger.h>
 
 struct messaging_target;
 
+// delivery priorities of messages that have to be queued
+enum {
+	MESSAGE_DELIVERY_PRIORITY_LOW		= 0,	// watcher notifications
+	MESSAGE_DELIVERY_PRIORITY_NORMAL,
+	MESSAGE_DELIVERY_PRIORITY_HIGH,				// shutdown requests
+
+	MESSAGE_DELIVERY_PRIORITY_COUNT
+};
+
 // MessagingTargetSet
 class MessagingTargetSet {
 public:
@@ -69,11 +79,14 @@ public:
 	static MessageDeliverer *Default();
 
 	status_t DeliverMessage(BMessage *message, BMessenger target,
-		bigtime_t timeout = B_INFINITE_TIMEOUT);
+		bigtime_t timeout = B_INFINITE_TIMEOUT,
+		int32 priority = MESSAGE_DELIVERY_PRIORITY_NORMAL);
 	status_t DeliverMessage(BMessage *message, MessagingTargetSet &targets,
-		bigtime_t timeout = B_INFINITE_TIMEOUT);
+		bigtime_t timeout = B_INFINITE_TIMEOUT,
+		int32 priority = MESSAGE_DELIVERY_PRIORITY_NORMAL);
 	status_t DeliverMessage(const void *message, int32 messageSize,
-		MessagingTargetSet &targets, bigtime_t timeout = B_INFINITE_TIMEOUT);
+		MessagingTargetSet &targets, bigtime_t timeout = B_INFINITE_TIMEOUT,
+		int32 priority = MESSAGE_DELIVERY_PRIORITY_NORMAL);
 
 private:
 	class Message;
@@ -82,9 +95,21 @@ private:
 	class TargetPort;
 	struct TargetPortMap;
 
+	struct delivery_statistics {
+		int64		delivered;
+		int64		dropped;
+		bigtime_t	total_wait;
+		bigtime_t	max_wait;
+	};
+
+	void _PushIncomingMessage(TargetMessage *message);
+	void _CollectIncomingMessages();
+	void _MessageDone(TargetMessage *message, bool delivered);
+
 	TargetPort *_GetTargetPort(port_id portID, bool create = false);
-	void _PutTargetPort(TargetPort *port);
+	void _RemoveTargetPort(TargetPort *port);
 
+	bool _SendMessages(TargetPort *port);
 	status_t _SendMessage(Message *message, port_id portID, int32 token);
 
 	static int32 _DelivererThreadEntry(void *data);
@@ -92,10 +117,13 @@ private:
 
 	static MessageDeliverer	*sDeliverer;
 
-	BLocker			fLock;
-	TargetPortMap	*fTargetPorts;
-	thread_id		fDelivererThread;
-	volatile bool	fTerminating;
+	TargetPortMap				*fTargetPorts;
+	std::atomic<TargetMessage*>	fIncomingMessages;
+	std::atomic<int32>			fQueuedMessages;
+	sem_id						fWakeUpSemaphore;
+	thread_id					fDelivererThread;
+	volatile bool				fTerminating;
+	delivery_statistics			fStatistics[MESSAGE_DELIVERY_PRIORITY_COUNT];
 };
 
 #endif	// MESSAGE_DELIVERER_H
@@ -39,13 +39,14 @@ using std::nothrow;
 	runner message to the respective target and schedules the event for the
 	next time the message has to be sent (_ScheduleEvent()).
 
-	A couple of helper methods provide convenient access to the RunnerInfo
-	list (\a fRunnerInfos). A BLocker (\a fLock) and respective locking
-	methods are used to serialize the access to the member variables.
+	A couple of helper methods provide convenient access to the RunnerInfos
+	(\a fRunnerInfos), which are hashed by token. A BLocker (\a fLock) and
+	respective locking methods are used to serialize the access to the member
+	variables.
 */
 
-/*! \var BList MessageRunnerManager::fRunnerInfos
-	\brief The list of RunnerInfos.
+/*! \var RunnerInfoMap MessageRunnerManager::fRunnerInfos
+	\brief The RunnerInfos, keyed by their token.
 */
 
 /*! \var BLocker MessageRunnerManager::fLock
@@ -83,18 +84,20 @@ add_time(bigtime_t a, bigtime_t b)
 /*!	\brief Event class used to by the message runner manager.
 
 	For each active message runner such an event is used. It invokes
-	MessageRunnerManager::_DoEvent() on execution.
+	MessageRunnerManager::_DoEvent() on execution. The event refers to its
+	runner by token, since the RunnerInfo may already be gone when the event
+	gets executed.
 */
 class MessageRunnerManager::RunnerEvent : public Event {
 public:
 	/*!	\brief Creates a new RunnerEvent.
 		\param manager The message runner manager.
-		\param info The RunnerInfo for the message runner.
+		\param token The token of the message runner.
 	*/
-	RunnerEvent(MessageRunnerManager *manager, RunnerInfo *info)
+	RunnerEvent(MessageRunnerManager *manager, int32 token)
 		: Event(false),
 		  fManager(manager),
-		  fInfo(info)
+		  fToken(token)
 	{
 	}
 
@@ -107,12 +110,12 @@ public:
 	*/
 	virtual bool Do(EventQueue *queue)
 	{
-		return fManager->_DoEvent(fInfo);
+		return fManager->_DoEvent(fToken);
 	}
 
 private:
 	MessageRunnerManager	*fManager;	//!< The message runner manager.
-	RunnerInfo				*fInfo;		//!< The message runner info.
+	int32					fToken;		//!< The message runner's token.
 };
 
 
@@ -231,12 +234,14 @@ MessageRunnerManager::~MessageRunnerManager()
 	// If it is still running and an event gets executed after we've locked
 	// ourselves, then it will access an already deleted manager.
 	BAutolock _lock(fLock);
-	for (int32 i = 0; RunnerInfo *info = _InfoAt(i); i++) {
+	RunnerInfoMap::Iterator it = fRunnerInfos.GetIterator();
+	while (it.HasNext()) {
+		RunnerInfo *info = it.Next().value;
 		if (!fEventQueue->RemoveEvent(info->event))
 			info->event = NULL;
 		delete info;
 	}
-	fRunnerInfos.MakeEmpty();
+	fRunnerInfos.Clear();
 }
 
 // HandleRegisterRunner
@@ -297,7 +302,7 @@ MessageRunnerManager::HandleRegisterRunner(BMessage *request)
 	// create a new event
 	RunnerEvent *event = NULL;
 	if (error == B_OK) {
-		event = new(nothrow) RunnerEvent(this, info);
+		event = new(nothrow) RunnerEvent(this, info->token);
 		if (event) {
 			info->event = event;
 			if (!_ScheduleEvent(info))
@@ -481,6 +486,55 @@ MessageRunnerManager::HandleGetRunnerInfo(BMessage *request)
 	FUNCTION_END();
 }
 
+// HandleGetRunnerList
+/*!	\brief Handles a request for the list of active message runners.
+
+	The reply contains one entry per runner in each of the fields "team",
+	"token", "interval", "count" and "time" (the time the next message is
+	due). If the request contains a "team" field, only the runners of that
+	team are listed.
+
+	\param request The request message.
+*/
+void
+MessageRunnerManager::HandleGetRunnerList(BMessage *request)
+{
+	FUNCTION_START();
+
+	BAutolock _lock(fLock);
+	team_id team;
+	if (request->FindInt32("team", &team) != B_OK)
+		team = -1;
+
+	BMessage reply(B_REG_SUCCESS);
+	status_t error = B_OK;
+	RunnerInfoMap::Iterator it = fRunnerInfos.GetIterator();
+	while (error == B_OK && it.HasNext()) {
+		RunnerInfo *info = it.Next().value;
+		if (team >= 0 && info->team != team)
+			continue;
+		error = reply.AddInt32("team", info->team);
+		if (error == B_OK)
+			error = reply.AddInt32("token", info->token);
+		if (error == B_OK)
+			error = reply.AddInt64("interval", info->interval);
+		if (error == B_OK)
+			error = reply.AddInt32("count", info->count);
+		if (error == B_OK)
+			error = reply.AddInt64("time", info->time);
+	}
+
+	if (error == B_OK)
+		request->SendReply(&reply);
+	else {
+		BMessage errorReply(B_REG_ERROR);
+		errorReply.AddInt32("error", error);
+		request->SendReply(&errorReply);
+	}
+
+	FUNCTION_END();
+}
+
 // Lock
 /*!	\brief Locks the manager.
 	\return \c true, if locked successfully, \c false otherwise.
@@ -501,7 +555,7 @@ MessageRunnerManager::Unlock()
 }
 
 // _AddInfo
-/*!	\brief Adds a RunnerInfo to the list of RunnerInfos.
+/*!	\brief Adds a RunnerInfo to the RunnerInfos.
 
 	\note The manager must be locked.
 
@@ -511,67 +565,37 @@ MessageRunnerManager::Unlock()
 bool
 MessageRunnerManager::_AddInfo(RunnerInfo *info)
 {
-	return fRunnerInfos.AddItem(info);
+	return fRunnerInfos.Put(info->token, info) == B_OK;
 }
 
 // _RemoveInfo
-/*!	\brief Removes a RunnerInfo from the list of RunnerInfos.
+/*!	\brief Removes a RunnerInfo from the RunnerInfos.
 
 	\note The manager must be locked.
 
 	\param info The RunnerInfo to be removed.
-	\return \c true, if removed successfully, \c false, if the list doesn't
-			contain the supplied info.
+	\return \c true, if removed successfully, \c false, if the manager doesn't
+			know the supplied info.
 */
 bool
 MessageRunnerManager::_RemoveInfo(RunnerInfo *info)
 {
-	return fRunnerInfos.RemoveItem(info);
-}
-
-// _RemoveInfo
-/*!	\brief Removes a RunnerInfo at a given index from the list of RunnerInfos.
-
-	\note The manager must be locked.
-
-	\param index The index of the RunnerInfo to be removed.
-	\return \c true, if removed successfully, \c false, if the supplied index
-			is out of range.
-*/
-MessageRunnerManager::RunnerInfo*
-MessageRunnerManager::_RemoveInfo(int32 index)
-{
-	return (RunnerInfo*)fRunnerInfos.RemoveItem(index);
-}
-
-// _RemoveInfoWithToken
-/*!	\brief Removes a RunnerInfo with a specified token from the list of
-		   RunnerInfos.
-
-	\note The manager must be locked.
-
-	\param token The token identifying the RunnerInfo to be removed.
-	\return \c true, if removed successfully, \c false, if the list doesn't
-			contain an info with the supplied token.
-*/
-MessageRunnerManager::RunnerInfo*
-MessageRunnerManager::_RemoveInfoWithToken(int32 token)
-{
-	RunnerInfo *info = NULL;
-	int32 index = _IndexOfToken(token);
-	if (index >= 0)
-		info = _RemoveInfo(index);
-	return info;
+	if (_InfoForToken(info->token) != info)
+		return false;
+	fRunnerInfos.Remove(info->token);
+	return true;
 }
 
 // _DeleteInfo
-/*!	\brief Removes a RunnerInfo from the list of RunnerInfos and deletes it.
+/*!	\brief Removes a RunnerInfo from the RunnerInfos and deletes it.
 
 	\note The manager must be locked.
 
-	\param index The index of the RunnerInfo to be deleted.
+	\param info The RunnerInfo to be deleted.
+	\param eventRemoved \c true, if the info's event has already been removed
+		   from the event queue.
 	\return \c true, if removed and deleted successfully, \c false, if the
-			list doesn't contain the supplied info.
+			manager doesn't know the supplied info.
 */
 bool
 MessageRunnerManager::_DeleteInfo(RunnerInfo *info, bool eventRemoved)
@@ -588,84 +612,31 @@ MessageRunnerManager::_DeleteInfo(RunnerInfo *info, bool eventRemoved)
 }
 
 // _CountInfos
-/*!	\brief Returns the number of RunnerInfos in the list of RunnerInfos.
+/*!	\brief Returns the number of RunnerInfos.
 
 	\note The manager must be locked.
 
-	\return Returns the number of RunnerInfos in the list of RunnerInfos.
+	\return Returns the number of RunnerInfos.
 */
 int32
 MessageRunnerManager::_CountInfos() const
 {
-	return fRunnerInfos.CountItems();
-}
-
-// _InfoAt
-/*!	\brief Returns the RunnerInfo at the specified index in the list of
-		   RunnerInfos.
-
-	\note The manager must be locked.
-
-	\param index The index of the RunnerInfo to be returned.
-	\return The runner info at the specified index, or \c NULL, if the index
-			is out of range.
-*/
-MessageRunnerManager::RunnerInfo*
-MessageRunnerManager::_InfoAt(int32 index) const
-{
-	return (RunnerInfo*)fRunnerInfos.ItemAt(index);
+	return fRunnerInfos.Size();
 }
 
 // _InfoForToken
-/*!	\brief Returns the RunnerInfo with the specified index.
+/*!	\brief Returns the RunnerInfo with the specified token.
 
 	\note The manager must be locked.
 
 	\param token The token identifying the RunnerInfo to be returned.
-	\return The runner info at the specified index, or \c NULL, if the list
-			doesn't contain an info with the specified token.
+	\return The runner info with the specified token, or \c NULL, if the
+			manager doesn't know an info with the specified token.
 */
 MessageRunnerManager::RunnerInfo*
 MessageRunnerManager::_InfoForToken(int32 token) const
 {
-	return _InfoAt(_IndexOfToken(token));
-}
-
-// _IndexOf
-/*!	\brief Returns the index of the supplied RunnerInfo in the list of
-		   RunnerInfos.
-
-	\note The manager must be locked.
-
-	\param info The RunnerInfo whose index shall be returned.
-	\return The index of the supplied RunnerInfo, or -1, if the list doesn't
-			contain the supplied info.
-*/
-int32
-MessageRunnerManager::_IndexOf(RunnerInfo *info) const
-{
-	return fRunnerInfos.IndexOf(info);
-}
-
-// _IndexOfToken
-/*!	\brief Returns the index of the RunnerInfo identified by the supplied
-		   token in the list of RunnerInfos.
-
-	\note The manager must be locked.
-
-	\param token The token identifying the RunnerInfo whose index shall be
-		   returned.
-	\return The index of the requested RunnerInfo, or -1, if the list doesn't
-			contain an info with the supplied token.
-*/
-int32
-MessageRunnerManager::_IndexOfToken(int32 token) const
-{
-	for (int32 i = 0; RunnerInfo *info = _InfoAt(i); i++) {
-		if (info->token == token)
-			return i;
-	}
-	return -1;
+	return fRunnerInfos.Get(token);
 }
 
 // _DoEvent
@@ -675,18 +646,19 @@ MessageRunnerManager::_IndexOfToken(int32 token) const
 	rescheduled, the message is delivered to the message runner's target
 	and the event is rescheduled.
 
-	\param info The message runner's info.
+	\param token The message runner's token.
 	\return \c true, if the event object shall be deleted, \c false otherwise.
 */
 bool
-MessageRunnerManager::_DoEvent(RunnerInfo *info)
+MessageRunnerManager::_DoEvent(int32 token)
 {
 	FUNCTION_START();
 
 	BAutolock _lock(fLock);
 	bool deleteEvent = false;
 	// first check whether the info does still exist
-	if (_lock.IsLocked() && _IndexOf(info) >= 0) {
+	RunnerInfo *info = _lock.IsLocked() ? _InfoForToken(token) : NULL;
+	if (info != NULL) {
 		// If the event has been rescheduled after being removed from the
 		// queue for execution, it needs to be ignored. This may happen, when
 		// the interval is modified.
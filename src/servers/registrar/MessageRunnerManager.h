@@ -27,7 +27,7 @@
 #ifndef MESSAGE_RUNNER_MANAGER_H
 #define MESSAGE_RUNNER_MANAGER_H
 
-#include <List.h>
+#include <HashMap.h>
 #include <Locker.h>
 
 class BMessage;
@@ -42,6 +42,7 @@ public:
 	void HandleUnregisterRunner(BMessage *request);
 	void HandleSetRunnerParams(BMessage *request);
 	void HandleGetRunnerInfo(BMessage *request);
+	void HandleGetRunnerList(BMessage *request);
 
 	bool Lock();
 	void Unlock();
@@ -52,32 +53,26 @@ private:
 	friend class RunnerEvent;
 
 private:
+	typedef HashMap<HashKey32<int32>, RunnerInfo*> RunnerInfoMap;
+
 	bool _AddInfo(RunnerInfo *info);
 	bool _RemoveInfo(RunnerInfo *info);
-	RunnerInfo *_RemoveInfo(int32 index);
-	RunnerInfo *_RemoveInfoWithToken(int32 token);
 	bool _DeleteInfo(RunnerInfo *info, bool eventRemoved);
 
 	int32 _CountInfos() const;
 
-	RunnerInfo *_InfoAt(int32 index) const;
 	RunnerInfo *_InfoForToken(int32 token) const;
 
-	bool _HasInfo(RunnerInfo *info) const;
-
-	int32 _IndexOf(RunnerInfo *info) const;
-	int32 _IndexOfToken(int32 token) const;
-
-	bool _DoEvent(RunnerInfo *info);
+	bool _DoEvent(int32 token);
 	bool _ScheduleEvent(RunnerInfo *info);
 
 	int32 _NextToken();
 
 private:
-	BList		fRunnerInfos;
-	BLocker		fLock;
-	EventQueue	*fEventQueue;
-	int32		fNextToken;
+	RunnerInfoMap	fRunnerInfos;
+	BLocker			fLock;
+	EventQueue		*fEventQueue;
+	int32			fNextToken;
 };
 
 #endif	// MESSAGE_RUNNER_MANAGER_H
@@ -50,6 +50,11 @@ using namespace BPrivate;
 //! Name of the event queue.
 static const char *kEventQueueName = "timer_thread";
 
+//! Timer slack of the event queue: wake-ups are coalesced to this granularity.
+//! It spans several ticks of the timer wheel (1 ms), so that message runners
+//! firing within a few milliseconds of each other share a single wake-up.
+static const bigtime_t kEventQueueSlack = 5000LL;
+
 //! Message code for the periodic roster sanity check event.
 static const uint32 kMsgRosterSanityCheck = 'rSAN';
 
@@ -97,12 +102,14 @@ Registrar::~Registrar()
 		delete fLogindBridge;
 		fLogindBridge = NULL;
 	}
+	// The MIME manager removes its pending events, so it has to go before
+	// the event queue.
+	fMIMEManager->Lock();
+	fMIMEManager->Quit();
 	fEventQueue->Die();
 	delete fSanityCheckEvent;
 	delete fMessageRunnerManager;
 	delete fEventQueue;
-	fMIMEManager->Lock();
-	fMIMEManager->Quit();
 	RemoveHandler(fClipboardHandler);
 	delete fClipboardHandler;
 	delete fRoster;
@@ -151,6 +158,7 @@ Registrar::ReadyToRun()
 
 	// create event queue
 	fEventQueue = new EventQueue(kEventQueueName);
+	fEventQueue->SetSlack(kEventQueueSlack);
 
 	// create roster
 	fRoster = new TRoster;
@@ -161,7 +169,7 @@ Registrar::ReadyToRun()
 	AddHandler(fClipboardHandler);
 
 	// create MIME manager
-	fMIMEManager = new MIMEManager;
+	fMIMEManager = new MIMEManager(fEventQueue);
 	fMIMEManager->Run();
 
 	// create message runner manager
@@ -388,6 +396,9 @@ Registrar::_MessageReceived(BMessage *message)
 		case B_REG_GET_MESSAGE_RUNNER_INFO:
 			fMessageRunnerManager->HandleGetRunnerInfo(message);
 			break;
+		case B_REG_GET_MESSAGE_RUNNER_LIST:
+			fMessageRunnerManager->HandleGetRunnerList(message);
+			break;
 
 		// internal messages
 		case B_SYSTEM_OBJECT_UPDATE:
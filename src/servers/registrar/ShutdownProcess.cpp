@@ -1592,7 +1592,8 @@ ShutdownProcess::_QuitApps(AppInfoList& list, bool systemApps)
 		PRINT("  sending team %" B_PRId32 " (port: %" B_PRId32 ") a shutdown "
 			"message\n", team, port);
 		SingleMessagingTargetSet target(port, B_PREFERRED_TOKEN);
-		MessageDeliverer::Default()->DeliverMessage(&message, target);
+		MessageDeliverer::Default()->DeliverMessage(&message, target,
+			B_INFINITE_TIMEOUT, MESSAGE_DELIVERY_PRIORITY_HIGH);
 
 		// schedule a timeout event
 		_ScheduleTimeoutEvent(kAppQuitTimeout, team);
@@ -1642,7 +1643,8 @@ ShutdownProcess::_QuitBackgroundApps()
 			fBackgroundApps.CountInfos());
 
 		status_t error = MessageDeliverer::Default()->DeliverMessage(
-			&message, targetSet);
+			&message, targetSet, B_INFINITE_TIMEOUT,
+			MESSAGE_DELIVERY_PRIORITY_HIGH);
 		if (error != B_OK) {
 			WARNING("_QuitBackgroundApps::_Worker(): Failed to deliver "
 				"shutdown message to all applications: %s\n",
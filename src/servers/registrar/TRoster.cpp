@@ -349,7 +349,7 @@ TRoster::HandleCompleteRegistration(BMessage* request)
 			RosterAppInfo* info = fRegisteredApps.InfoFor(team);
 			if (info && info->state == APP_STATE_PRE_REGISTERED) {
 				info->thread = thread;
-				info->port = port;
+				fRegisteredApps.SetPort(info, port);
 				info->state = APP_STATE_REGISTERED;
 				_AppAdded(info);
 			} else
@@ -625,7 +625,7 @@ TRoster::HandleSetSignature(BMessage* request)
 	// find the app and set the signature
 	if (error == B_OK) {
 		if (RosterAppInfo* info = fRegisteredApps.InfoFor(team))
-			strcpy(info->signature, signature);
+			fRegisteredApps.SetSignature(info, signature);
 		else
 			SET_ERROR(error, B_REG_APP_NOT_REGISTERED);
 	}
@@ -1472,22 +1472,18 @@ TRoster::AddAppInfo(AppInfoList& apps, team_id team)
 {
 	BAutolock _(fLock);
 
-	for (AppInfoList::Iterator it(fRegisteredApps.It());
-			RosterAppInfo* info = *it; ++it) {
-		if (info->team == team) {
-			RosterAppInfo* clonedInfo = info->Clone();
-			status_t error = B_NO_MEMORY;
-			if (clonedInfo != NULL) {
-				if (!apps.AddInfo(clonedInfo))
-					delete clonedInfo;
-				else
-					error = B_OK;
-			}
-			return error;
-		}
-	}
+	RosterAppInfo* info = fRegisteredApps.InfoFor(team);
+	if (info == NULL)
+		return B_BAD_TEAM_ID;
 
-	return B_BAD_TEAM_ID;
+	RosterAppInfo* clonedInfo = info->Clone();
+	if (clonedInfo == NULL)
+		return B_NO_MEMORY;
+	if (!apps.AddInfo(clonedInfo)) {
+		delete clonedInfo;
+		return B_NO_MEMORY;
+	}
+	return B_OK;
 }
 
 
@@ -89,7 +89,8 @@ Watcher::Target() const
 status_t
 Watcher::SendMessage(BMessage *message)
 {
-	return MessageDeliverer::Default()->DeliverMessage(message, fTarget);
+	return MessageDeliverer::Default()->DeliverMessage(message, fTarget,
+		B_INFINITE_TIMEOUT, MESSAGE_DELIVERY_PRIORITY_LOW);
 }
 
 
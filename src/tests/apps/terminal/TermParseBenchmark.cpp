@@ -0,0 +1,218 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Measures the throughput of the Terminal's pty reader and escape parser:
+	writes a file (or generated log output) to a pty whose master side is
+	read by a TermParse, like "cat" in a Terminal would, and waits until the
+	parser has processed all of it.
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+#include "TermApp.h"
+#include "TermConst.h"
+#include "TermParse.h"
+#include "TerminalBuffer.h"
+
+
+static const int32 kDefaultMegabytes = 256;
+static const char* kStatusRequest = "\033[5n";
+static const char* kStatusReply = "\033[0n";
+
+
+// The terminal buffer takes its initial palette from the application.
+rgb_color TermApp::fDefaultPalette[kTermColorCount];
+
+
+static void
+usage()
+{
+	fprintf(stderr, "usage: TermParseBenchmark [-m <megabytes>] [<file>]\n"
+		"Without a file, <megabytes> (default %" B_PRId32 ") of generated log "
+		"lines are used.\n", kDefaultMegabytes);
+	exit(1);
+}
+
+
+static bool
+write_fully(int fd, const char* data, size_t size)
+{
+	while (size > 0) {
+		ssize_t written = write(fd, data, size);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		data += written;
+		size -= written;
+	}
+	return true;
+}
+
+
+//! Fills \a buffer with build log like lines, some of them colored.
+static size_t
+generate_log(char* buffer, size_t size)
+{
+	static const char* kLines[] = {
+		"[ 42%%] Building CXX object src/kits/app/CMakeFiles/app.dir/"
+			"Message.cpp.o\n",
+		"\033[1;32m[ 42%%]\033[0m Linking CXX shared library libbe.so\n",
+		"src/kits/interface/View.cpp:%d:5: \033[35mwarning:\033[0m unused "
+			"variable 'result' [-Wunused-variable]\n",
+		"Oct 19 12:34:56 host service[%d]: request handled in 3 ms, "
+			"status 200, 1532 bytes\n",
+	};
+	static const int32 kLineCount = sizeof(kLines) / sizeof(kLines[0]);
+
+	size_t length = 0;
+	for (int32 i = 0; length < size; i++) {
+		char line[256];
+		int lineLength = snprintf(line, sizeof(line), kLines[i % kLineCount],
+			i);
+		if (length + lineLength > size)
+			break;
+		memcpy(buffer + length, line, lineLength);
+		length += lineLength;
+	}
+	return length;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int64 megabytes = kDefaultMegabytes;
+	const char* path = NULL;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-m") && i + 1 < argc)
+			megabytes = atoll(argv[++i]);
+		else if (argv[i][0] == '-' || path != NULL)
+			usage();
+		else
+			path = argv[i];
+	}
+	if (megabytes <= 0)
+		usage();
+
+	int source = -1;
+	if (path != NULL) {
+		source = open(path, O_RDONLY);
+		if (source < 0) {
+			fprintf(stderr, "%s: %s\n", path, strerror(errno));
+			return 1;
+		}
+	}
+
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	const char* ttyName;
+	if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0
+		|| (ttyName = ptsname(master)) == NULL) {
+		fprintf(stderr, "could not create a pty: %s\n", strerror(errno));
+		return 1;
+	}
+
+	int slave = open(ttyName, O_RDWR | O_NOCTTY);
+	if (slave < 0) {
+		fprintf(stderr, "%s: %s\n", ttyName, strerror(errno));
+		return 1;
+	}
+
+	// no echo and line editing, but the usual output processing
+	struct termios termios;
+	tcgetattr(slave, &termios);
+	cfmakeraw(&termios);
+	termios.c_oflag |= OPOST | ONLCR;
+	tcsetattr(slave, TCSANOW, &termios);
+
+	TerminalBuffer buffer;
+	if (buffer.Init(80, 25, 10000) != B_OK) {
+		fprintf(stderr, "could not create the terminal buffer\n");
+		return 1;
+	}
+	buffer.SetEncoding(M_UTF8);
+
+	TermParse* parser = new TermParse(master);
+	if (parser->StartThreads(&buffer) != B_OK) {
+		fprintf(stderr, "could not start the parser\n");
+		return 1;
+	}
+
+	const size_t kChunkSize = 1024 * 1024;
+	char* chunk = (char*)malloc(kChunkSize);
+	if (chunk == NULL)
+		return 1;
+
+	size_t generatedSize = 0;
+	if (source < 0)
+		generatedSize = generate_log(chunk, kChunkSize);
+
+	bigtime_t start = system_time();
+	off_t total = 0;
+	while (true) {
+		ssize_t size;
+		if (source >= 0) {
+			size = read(source, chunk, kChunkSize);
+			if (size < 0) {
+				fprintf(stderr, "%s: %s\n", path, strerror(errno));
+				return 1;
+			}
+		} else {
+			size = min_c((off_t)generatedSize,
+				megabytes * 1024 * 1024 - total);
+		}
+		if (size <= 0)
+			break;
+
+		if (!write_fully(slave, chunk, size)) {
+			fprintf(stderr, "writing to the pty failed: %s\n",
+				strerror(errno));
+			return 1;
+		}
+		total += size;
+	}
+
+	// The parser answers the status request once it got through everything
+	// before it.
+	write_fully(slave, kStatusRequest, strlen(kStatusRequest));
+
+	char reply[16];
+	size_t replyLength = 0;
+	while (replyLength < strlen(kStatusReply)) {
+		ssize_t bytesRead = read(slave, reply + replyLength,
+			strlen(kStatusReply) - replyLength);
+		if (bytesRead <= 0) {
+			fprintf(stderr, "reading the reply failed: %s\n",
+				strerror(errno));
+			return 1;
+		}
+		replyLength += bytesRead;
+	}
+
+	bigtime_t elapsed = system_time() - start;
+
+	printf("%" B_PRIdOFF " bytes in %.3f s: %.1f MB/s\n", total,
+		elapsed / 1000000.0, total / 1048576.0 / (elapsed / 1000000.0));
+
+	close(slave);
+	parser->StopThreads();
+	delete parser;
+	close(master);
+	if (source >= 0)
+		close(source);
+	free(chunk);
+
+	return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+// Sets 10 and 100 MB of text in a word wrapping BTextView, changes the wrap
+// width like a resize does, and prints how long the window was blocked for
+// each, and how long laying out the rest of the text takes afterwards.
+
+
+#include <Application.h>
+#include <ScrollView.h>
+#include <TextView.h>
+#include <Window.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+static const char* kWords[] = {
+	"lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing",
+	"elit", "sed", "do", "eiusmod", "tempor", "incididunt", "ut", "labore",
+	"et", "dolore", "magna", "aliqua"
+};
+
+
+static char*
+create_text(size_t size)
+{
+	char* text = (char*)malloc(size);
+	if (text == NULL)
+		return NULL;
+
+	// paragraphs of varying length, so that some of them need to be wrapped
+	size_t offset = 0;
+	uint32 seed = 1;
+	int32 paragraphLength = 0;
+	while (offset < size) {
+		seed = seed * 1103515245 + 12345;
+		const char* word = kWords[(seed >> 16) % B_COUNT_OF(kWords)];
+		size_t length = strlen(word);
+		if (offset + length + 1 > size)
+			break;
+
+		memcpy(text + offset, word, length);
+		offset += length;
+		paragraphLength += length + 1;
+		if (paragraphLength > (int32)((seed >> 8) % 400)) {
+			text[offset++] = '\n';
+			paragraphLength = 0;
+		} else
+			text[offset++] = ' ';
+	}
+	memset(text + offset, '\n', size - offset);
+	return text;
+}
+
+
+static void
+benchmark(BWindow* window, BTextView* textView, size_t size)
+{
+	char* text = create_text(size);
+	if (text == NULL) {
+		fprintf(stderr, "out of memory\n");
+		return;
+	}
+
+	window->Lock();
+
+	bigtime_t start = system_time();
+	textView->SetText(text, size);
+	bigtime_t setText = system_time() - start;
+
+	start = system_time();
+	textView->SetInsets(0, 0, textView->Bounds().Width() / 3, 0);
+	bigtime_t resize = system_time() - start;
+
+	start = system_time();
+	int32 lines = textView->CountLines();
+	bigtime_t rest = system_time() - start;
+
+	window->Unlock();
+
+	printf("%4zu MB: SetText() %6.1f ms, resize %6.1f ms, remaining layout "
+		"%8.1f ms (%" B_PRId32 " lines)\n", size / (1024 * 1024),
+		setText / 1000.0, resize / 1000.0, rest / 1000.0, lines);
+
+	window->Lock();
+	textView->SetText("");
+	textView->SetInsets(0, 0, 0, 0);
+	window->Unlock();
+	free(text);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	BApplication app("application/x-vnd.Test-TextViewLayoutBenchmark");
+
+	BWindow* window = new BWindow(BRect(100, 100, 800, 700),
+		"TextView layout benchmark", B_TITLED_WINDOW, 0);
+	BRect rect = window->Bounds();
+	rect.right -= B_V_SCROLL_BAR_WIDTH;
+	BTextView* textView = new BTextView(rect, "text", rect,
+		B_FOLLOW_ALL, B_WILL_DRAW);
+	window->AddChild(new BScrollView("scroll", textView, B_FOLLOW_ALL, 0,
+		false, true, B_NO_BORDER));
+	window->Show();
+
+	benchmark(window, textView, 10 * 1024 * 1024);
+	benchmark(window, textView, 100 * 1024 * 1024);
+
+	window->Lock();
+	window->Quit();
+	return 0;
+}
@@ -1,9 +1,42 @@
 #include "../common.h"
 
+#include <ctype.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <string>
+
 #include <Application.h>
 #include <String.h>
 #include <TextView.h>
 
+
+static std::string
+get_text(BTextView* view, int32 offset, int32 length)
+{
+	char* buffer = new char[length + 1];
+	view->GetText(offset, length, buffer);
+	std::string text(buffer, length);
+	delete[] buffer;
+	return text;
+}
+
+
+static int32
+find_offset(size_t offset)
+{
+	return offset == std::string::npos ? B_ERROR : (int32)offset;
+}
+
+
+static void
+set_run(text_run& run, int32 offset, const BFont& font, uint8 red)
+{
+	run.offset = offset;
+	run.font = font;
+	run.color = make_color(red, 0, 0);
+}
+
 class TextViewTestcase: public TestCase {
 public:
 	void
@@ -24,6 +57,183 @@ public:
 		v->GetText(2, 11, buffer);
 		CPPUNIT_ASSERT_EQUAL(BString("itial (inse"), buffer);
 	}
+
+	void
+	RopeEditTest()
+	{
+		BApplication app("application/x-vnd.Haiku-interfacekit-textviewtest");
+		BRect textRect(0, 0, 100, 100);
+		BTextView* v = new BTextView(textRect, "test", textRect, 0, 0);
+		v->SetTextStorage(B_TEXT_STORAGE_ROPE);
+		CPPUNIT_ASSERT_EQUAL(B_TEXT_STORAGE_ROPE, v->TextStorage());
+
+		// start with a few chunks worth of text
+		std::string expected;
+		for (int32 i = 0; expected.length() < 200000; i++) {
+			BString line;
+			line.SetToFormat("line %" B_PRId32 "\n", i);
+			expected += line.String();
+		}
+		v->SetText(expected.c_str());
+
+		// insert and remove all over the text, in amounts that cross the
+		// chunk boundaries
+		srand(42);
+		for (int32 i = 0; i < 300; i++) {
+			int32 length = v->TextLength();
+			if (rand() % 2 == 0 || length < 1000) {
+				int32 offset = rand() % (length + 1);
+				std::string insert(rand() % 100000 + 1, 'a' + i % 26);
+				v->Insert(offset, insert.c_str(), insert.length());
+				expected.insert(offset, insert);
+			} else {
+				int32 start = rand() % length;
+				int32 end = std::min(length, start + rand() % 100000 + 1);
+				v->Delete(start, end);
+				expected.erase(start, end - start);
+			}
+
+			CPPUNIT_ASSERT_EQUAL((int32)expected.length(), v->TextLength());
+
+			int32 offset = rand() % (v->TextLength() + 1);
+			int32 span = std::min(v->TextLength() - offset, (int32)70000);
+			CPPUNIT_ASSERT(get_text(v, offset, span)
+				== expected.substr(offset, span));
+			if (v->TextLength() > 0) {
+				CPPUNIT_ASSERT_EQUAL(expected[offset % expected.length()],
+					v->ByteAt(offset % expected.length()));
+			}
+
+			if (i % 25 == 0)
+				CPPUNIT_ASSERT(expected == v->Text());
+		}
+
+		CPPUNIT_ASSERT(expected == v->Text());
+		delete v;
+	}
+
+	void
+	RopeFindTest()
+	{
+		BApplication app("application/x-vnd.Haiku-interfacekit-textviewtest");
+		BRect textRect(0, 0, 100, 100);
+		BTextView* v = new BTextView(textRect, "test", textRect, 0, 0);
+		v->SetTextStorage(B_TEXT_STORAGE_ROPE);
+
+		// a needle every so often, some of them straddle chunk boundaries
+		srand(7);
+		std::string text;
+		while (text.length() < 300000) {
+			text.append(rand() % 5000, 'x');
+			text += rand() % 2 == 0 ? "Needle" : "nEEDLE";
+		}
+		v->SetText(text.c_str());
+
+		// build the same text in pieces, so that it is split differently
+		BTextView* pieces = new BTextView(textRect, "test", textRect, 0, 0);
+		pieces->SetTextStorage(B_TEXT_STORAGE_ROPE);
+		for (size_t offset = 0; offset < text.length(); offset += 1000) {
+			pieces->Insert(pieces->TextLength(), text.c_str() + offset,
+				std::min((size_t)1000, text.length() - offset));
+		}
+
+		std::string lower = text;
+		for (size_t i = 0; i < lower.length(); i++)
+			lower[i] = tolower(lower[i]);
+
+		const int32 length = 6;
+		for (int32 from = 0; from <= (int32)text.length() + 10; from += 997) {
+			int32 expected = find_offset(text.find("Needle", from));
+			CPPUNIT_ASSERT_EQUAL(expected, v->Find("Needle", from));
+			CPPUNIT_ASSERT_EQUAL(expected, pieces->Find("Needle", from));
+
+			expected = find_offset(lower.find("needle", from));
+			CPPUNIT_ASSERT_EQUAL(expected, v->Find("needle", from, false));
+			CPPUNIT_ASSERT_EQUAL(expected,
+				pieces->Find("NEEDLE", from, false));
+
+			int32 before = std::min(from, (int32)text.length());
+			expected = before < length ? B_ERROR
+				: find_offset(text.rfind("Needle", before - length));
+			CPPUNIT_ASSERT_EQUAL(expected,
+				v->Find("Needle", from, true, true));
+			CPPUNIT_ASSERT_EQUAL(expected,
+				pieces->Find("Needle", from, true, true));
+
+			expected = before < length ? B_ERROR
+				: find_offset(lower.rfind("needle", before - length));
+			CPPUNIT_ASSERT_EQUAL(expected,
+				v->Find("nEEdle", from, false, true));
+		}
+
+		CPPUNIT_ASSERT_EQUAL((int32)B_ERROR, v->Find("needles", 0, false));
+		CPPUNIT_ASSERT_EQUAL((int32)B_ERROR, v->Find("", 0));
+
+		delete pieces;
+		delete v;
+	}
+
+	void
+	ReplaceAllTest()
+	{
+		BApplication app("application/x-vnd.Haiku-interfacekit-textviewtest");
+		BRect textRect(0, 0, 100, 100);
+		BTextView* v = new BTextView(textRect, "test", textRect, 0, 0);
+		v->SetStylable(true);
+		v->SetDoesUndo(true);
+
+		// the second run starts inside of the first match, the third one
+		// right at the second match
+		const char* text = "one FOO two FOO three";
+		text_run_array* runs = BTextView::AllocRunArray(4);
+		set_run(runs->runs[0], 0, *be_plain_font, 10);
+		set_run(runs->runs[1], 5, *be_plain_font, 20);
+		set_run(runs->runs[2], 12, *be_plain_font, 30);
+		set_run(runs->runs[3], 16, *be_plain_font, 40);
+		v->SetText(text, runs);
+
+		CPPUNIT_ASSERT_EQUAL((int32)2, v->ReplaceAll("foo", "bar!", false));
+		CPPUNIT_ASSERT_EQUAL(BString("one bar! two bar! three"), v->Text());
+
+		// the replacements take the style of the text they replace, the
+		// run that started inside of the match moves behind it
+		const int32 kExpectedOffsets[] = { 0, 8, 13, 18 };
+		int32 size;
+		text_run_array* newRuns = v->RunArray(0, v->TextLength(), &size);
+		CPPUNIT_ASSERT(newRuns != NULL);
+		CPPUNIT_ASSERT_EQUAL((int32)4, newRuns->count);
+		for (int32 i = 0; i < 4; i++) {
+			CPPUNIT_ASSERT_EQUAL(kExpectedOffsets[i],
+				newRuns->runs[i].offset);
+			CPPUNIT_ASSERT_EQUAL(runs->runs[i].color.red,
+				newRuns->runs[i].color.red);
+		}
+		BTextView::FreeRunArray(newRuns);
+
+		// undo brings back the text and its runs in one step
+		bool isRedo;
+		CPPUNIT_ASSERT_EQUAL(B_UNDO_REPLACE, v->UndoState(&isRedo));
+		v->Undo(NULL);
+		CPPUNIT_ASSERT_EQUAL(BString(text), v->Text());
+
+		newRuns = v->RunArray(0, v->TextLength(), &size);
+		CPPUNIT_ASSERT(newRuns != NULL);
+		CPPUNIT_ASSERT_EQUAL((int32)4, newRuns->count);
+		for (int32 i = 0; i < 4; i++) {
+			CPPUNIT_ASSERT_EQUAL(runs->runs[i].offset,
+				newRuns->runs[i].offset);
+			CPPUNIT_ASSERT_EQUAL(runs->runs[i].color.red,
+				newRuns->runs[i].color.red);
+		}
+		BTextView::FreeRunArray(newRuns);
+
+		// nothing to replace leaves the text and the undo state alone
+		CPPUNIT_ASSERT_EQUAL((int32)0, v->ReplaceAll("none", "bar!"));
+		CPPUNIT_ASSERT_EQUAL(BString(text), v->Text());
+
+		BTextView::FreeRunArray(runs);
+		delete v;
+	}
 };
 
 
@@ -36,6 +246,12 @@ TextViewTestSuite()
 		"BTextView_Size", &TextViewTestcase::SizeTest));
 	testSuite->addTest(new CppUnit::TestCaller<TextViewTestcase>(
 		"BTextView_GetText", &TextViewTestcase::GetTextTest));
+	testSuite->addTest(new CppUnit::TestCaller<TextViewTestcase>(
+		"BTextView_RopeEdit", &TextViewTestcase::RopeEditTest));
+	testSuite->addTest(new CppUnit::TestCaller<TextViewTestcase>(
+		"BTextView_RopeFind", &TextViewTestcase::RopeFindTest));
+	testSuite->addTest(new CppUnit::TestCaller<TextViewTestcase>(
+		"BTextView_ReplaceAll", &TextViewTestcase::ReplaceAllTest));
 
 	return testSuite;
 }
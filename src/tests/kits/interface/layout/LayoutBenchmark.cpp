@@ -0,0 +1,114 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+// Builds a preferences-like window of nested grid and group layouts, resizes
+// it step by step like a live resize does, and prints how long each frame
+// took. The second sweep goes back over the same sizes.
+
+
+#include <Application.h>
+#include <Button.h>
+#include <CheckBox.h>
+#include <GridLayout.h>
+#include <GroupLayout.h>
+#include <StringView.h>
+#include <TextControl.h>
+#include <Window.h>
+
+#include <stdio.h>
+
+
+static const int32 kDepth = 3;
+static const int32 kSections = 3;
+static const int32 kRows = 5;
+static const int32 kSteps = 200;
+
+
+static BLayoutItem*
+create_section(int32 depth)
+{
+	BGridLayout* grid = new BGridLayout(5, 5);
+	grid->SetInsets(10, 10, 10, 10);
+
+	int32 row = 0;
+	for (; row < kRows; row++) {
+		char label[32];
+		snprintf(label, sizeof(label), "Setting %" B_PRId32 ":", row);
+		BTextControl* control = new BTextControl(label, "value", NULL);
+		grid->AddItem(control->CreateLabelLayoutItem(), 0, row);
+		grid->AddItem(control->CreateTextViewLayoutItem(), 1, row, 2);
+	}
+
+	// items spanning several columns, and ones with a maximum size, are what
+	// needs the complex layouter
+	grid->AddView(new BCheckBox("Enable all of the settings above"), 0, row,
+		2);
+	grid->AddView(new BButton("Defaults"), 2, row++);
+
+	if (depth > 0) {
+		BGroupLayout* group = new BGroupLayout(B_HORIZONTAL, 5);
+		for (int32 i = 0; i < 2; i++)
+			group->AddItem(create_section(depth - 1));
+		grid->AddItem(group, 0, row, 3);
+	}
+
+	return grid;
+}
+
+
+static void
+benchmark(BWindow* window, float fromWidth, float toWidth, const char* name)
+{
+	float height = window->Bounds().Height();
+	float step = (toWidth - fromWidth) / kSteps;
+
+	bigtime_t total = 0;
+	bigtime_t longest = 0;
+	for (int32 i = 0; i <= kSteps; i++) {
+		window->Lock();
+		bigtime_t start = system_time();
+		window->ResizeTo(fromWidth + i * step, height);
+		window->Layout(false);
+		bigtime_t time = system_time() - start;
+		window->Unlock();
+
+		total += time;
+		if (time > longest)
+			longest = time;
+	}
+
+	printf("%s: %6.3f ms per frame on average, %6.3f ms at most\n", name,
+		total / 1000.0 / (kSteps + 1), longest / 1000.0);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	BApplication app("application/x-vnd.Test-LayoutBenchmark");
+
+	BWindow* window = new BWindow(BRect(100, 100, 500, 400),
+		"Layout benchmark", B_TITLED_WINDOW,
+		B_AUTO_UPDATE_SIZE_LIMITS | B_QUIT_ON_WINDOW_CLOSE);
+
+	BGroupLayout* layout = new BGroupLayout(B_VERTICAL, 5);
+	window->SetLayout(layout);
+	for (int32 i = 0; i < kSections; i++)
+		layout->AddItem(create_section(kDepth));
+
+	window->Show();
+
+	window->Lock();
+	window->ResizeToPreferred();
+	float width = window->Bounds().Width();
+	window->Unlock();
+
+	benchmark(window, width, width + 800, "growing  ");
+	benchmark(window, width + 800, width, "shrinking");
+
+	window->Lock();
+	window->Quit();
+	return 0;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+// Parses the same response header many times, once storing the fields in a
+// BHttpFields object like libnetservices2 used to, and once in an
+// HttpFieldArena, and prints the time per response for both.
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <string_view>
+
+#include <HttpFields.h>
+#include <NetServicesDefs.h>
+#include <OS.h>
+
+#include "HttpBuffer.h"
+#include "HttpFieldArena.h"
+#include "HttpParser.h"
+
+using namespace std::literals;
+using namespace BPrivate::Network;
+
+
+static const char* kResponse =
+	"HTTP/1.1 200 OK\r\n"
+	"Date: Mon, 19 Oct 2026 10:00:00 GMT\r\n"
+	"Server: nginx/1.24.0\r\n"
+	"Content-Type: application/json; charset=utf-8\r\n"
+	"Content-Length: 2\r\n"
+	"Connection: keep-alive\r\n"
+	"Cache-Control: no-cache, no-store, must-revalidate\r\n"
+	"ETag: \"5f1c0a7e-2\"\r\n"
+	"Vary: Accept-Encoding\r\n"
+	"X-Request-Id: 4c1d7bb8-8a0e-4d2a-9d55-0d3f0b1e6a11\r\n"
+	"X-Content-Type-Options: nosniff\r\n"
+	"Strict-Transport-Security: max-age=63072000; includeSubDomains\r\n"
+	"Access-Control-Allow-Origin: *\r\n"
+	"\r\n"
+	"{}";
+
+static const int32 kIterations = 200000;
+
+
+static void
+check(bool condition, const char* what)
+{
+	if (!condition) {
+		fprintf(stderr, "check failed: %s\n", what);
+		exit(1);
+	}
+}
+
+
+static bigtime_t
+parse_into_fields(const std::string_view& response)
+{
+	bigtime_t start = system_time();
+	for (int32 i = 0; i < kIterations; i++) {
+		HttpBuffer buffer(response.size());
+		buffer << response;
+
+		buffer.GetNextLine();
+			// the status line
+		BHttpFields fields;
+		for (auto line = buffer.GetNextLine(); line && !line->IsEmpty();
+				line = buffer.GetNextLine()) {
+			fields.AddField(*line);
+		}
+		check(fields.FindField("Content-Length"sv) != fields.end(), "Content-Length");
+	}
+	return system_time() - start;
+}
+
+
+static bigtime_t
+parse_into_arena(const std::string_view& response)
+{
+	bigtime_t start = system_time();
+	for (int32 i = 0; i < kIterations; i++) {
+		HttpBuffer buffer(response.size());
+		buffer << response;
+
+		HttpParser parser;
+		BHttpStatus status;
+		HttpFieldArena fields;
+		check(parser.ParseStatus(buffer, status), "status line");
+		check(parser.ParseFields(buffer, fields), "fields");
+		check(parser.BodyBytesTotal() == 2, "body size");
+		check(fields.FindField("content-length"sv) == "2"sv, "Content-Length");
+	}
+	return system_time() - start;
+}
+
+
+int
+main()
+{
+	std::string_view response(kResponse);
+
+	// Lines can arrive in pieces; feed the header byte by byte once
+	{
+		HttpBuffer buffer(response.size());
+		HttpParser parser;
+		BHttpStatus status;
+		HttpFieldArena fields;
+		size_t offset = 0;
+		bool statusDone = false;
+		bool fieldsDone = false;
+		while (!fieldsDone && offset < response.size()) {
+			buffer << response.substr(offset++, 1);
+			if (!statusDone)
+				statusDone = parser.ParseStatus(buffer, status);
+			if (statusDone)
+				fieldsDone = parser.ParseFields(buffer, fields);
+		}
+		check(fieldsDone, "incremental parsing");
+		check(status.code == 200, "status code");
+		check(fields.CountFields() == 12, "field count");
+		check(fields.FindField("ETag"sv) == "\"5f1c0a7e-2\""sv, "ETag");
+		check(fields.ToFields().CountFields() == 12, "conversion");
+	}
+
+	bigtime_t fieldsTime = parse_into_fields(response);
+	bigtime_t arenaTime = parse_into_arena(response);
+
+	printf("BHttpFields:    %6.0f ns per response\n", fieldsTime * 1000.0 / kIterations);
+	printf("HttpFieldArena: %6.0f ns per response\n", arenaTime * 1000.0 / kIterations);
+	if (arenaTime > 0)
+		printf("speed-up: %.2fx\n", (double)fieldsTime / arenaTime);
+	return 0;
+}
@@ -7,6 +7,7 @@
 #include <cppunit/TestCaller.h>
 #include <sniffer/Rule.h>
 #include <sniffer/Parser.h>
+#include <sniffer/RuleIndex.h>
 #include <DataIO.h>
 #include <Mime.h>
 #include <String.h>		// BString
@@ -1351,11 +1352,22 @@ std::string("\000\034	000 034", 10),	// Otherwise, it thinks the NULL is the end
 },
 	};	// tests[]
 	const int32 testCount = sizeof(tests)/sizeof(test_case);
+
+	// The compiled index must never rule out a matching rule
+	Rule indexedRules[ruleCount];
+	RuleIndex index;
+	for (int j = 0; j < ruleCount; j++) {
+		BString errorMsg;
+		CHK(parse(rules[j], &indexedRules[j], &errorMsg) == B_OK);
+		CHK(index.Add(&indexedRules[j]) == j);
+	}
 	
 	for (int i = 0; i < testCount; i++) {
 		if (i > 0)
 			NextSubTestBlock();
 		test_case &test = tests[i];
+		std::vector<bool> candidates;
+		index.GetCandidates(test.data.data(), test.data.length(), candidates);
 //		cout << "--------------------------------------------------------------------------------" << endl;
 //		cout << test.data << endl;
 		
@@ -1381,6 +1393,7 @@ std::string("\000\034	000 034", 10),	// Otherwise, it thinks the NULL is the end
 //				cout << "match == " << (match ? "yes" : "no") << ", "
 //					 << ((match == test.result[j]) ? "SUCCESS" : "FAILURE") << endl;
 				CHK(match == test.result[j]);			
+				CHK(!match || candidates[j]);
 			} 
 		}
 	}
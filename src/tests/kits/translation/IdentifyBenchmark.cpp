@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026, The Vitruvian Project. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Measures BTranslatorRoster::Identify() and GetTranslators() for the
+	files given on the command line, using the default roster.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Application.h>
+#include <File.h>
+#include <OS.h>
+#include <TranslatorRoster.h>
+
+
+static const int32 kDefaultIterations = 1000;
+
+
+static void
+usage()
+{
+	fprintf(stderr, "usage: IdentifyBenchmark [-n <iterations>] <file> ...\n");
+	exit(1);
+}
+
+
+static void
+benchmark_file(BTranslatorRoster* roster, const char* path, int32 iterations)
+{
+	BFile file(path, B_READ_ONLY);
+	status_t status = file.InitCheck();
+	if (status != B_OK) {
+		fprintf(stderr, "%s: %s\n", path, strerror(status));
+		return;
+	}
+
+	translator_info info;
+	status = roster->Identify(&file, NULL, &info);
+	if (status != B_OK) {
+		printf("%s: %s\n", path, strerror(status));
+		return;
+	}
+
+	bigtime_t start = system_time();
+	for (int32 i = 0; i < iterations; i++)
+		roster->Identify(&file, NULL, &info);
+	bigtime_t identifyTime = system_time() - start;
+
+	int32 count = 0;
+	start = system_time();
+	for (int32 i = 0; i < iterations; i++) {
+		translator_info* infos;
+		if (roster->GetTranslators(&file, NULL, &infos, &count) == B_OK)
+			delete[] infos;
+	}
+	bigtime_t getTranslatorsTime = system_time() - start;
+
+	printf("%s: %s (%s)\n", path, info.name, info.MIME);
+	printf("  Identify():       %8.1f us\n",
+		(double)identifyTime / iterations);
+	printf("  GetTranslators(): %8.1f us, %" B_PRId32 " translators\n",
+		(double)getTranslatorsTime / iterations, count);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 iterations = kDefaultIterations;
+	int first = 1;
+	if (argc > 2 && !strcmp(argv[1], "-n")) {
+		iterations = atol(argv[2]);
+		first = 3;
+	}
+	if (first >= argc || iterations <= 0)
+		usage();
+
+	BApplication app("application/x-vnd.Haiku-IdentifyBenchmark");
+
+	BTranslatorRoster* roster = BTranslatorRoster::Default();
+
+	int32 count = 0;
+	translator_id* ids;
+	if (roster->GetAllTranslators(&ids, &count) == B_OK)
+		delete[] ids;
+	printf("%" B_PRId32 " translators, %" B_PRId32 " iterations\n\n", count,
+		iterations);
+
+	for (int i = first; i < argc; i++)
+		benchmark_file(roster, argv[i], iterations);
+
+	return 0;
+}